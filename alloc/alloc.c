@@ -0,0 +1,237 @@
+#include "alloc.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define ALLOC_USABLE_SIZE(p) malloc_usable_size(p)
+#else
+#define ALLOC_USABLE_SIZE(p) ((size_t)0) // Counts only; byte totals need glibc
+#endif
+
+#define ALLOC_CACHE_LINE 64
+
+// Per-subsystem counters, padded and aligned so concurrent subsystems do not share a cache line
+typedef struct
+{
+  _Alignas(ALLOC_CACHE_LINE) atomic_ullong allocs;
+  atomic_ullong frees;
+  atomic_ullong reallocs;
+  atomic_ullong bytes;      // cumulative bytes handed out
+  atomic_llong live_bytes;  // currently outstanding
+  atomic_llong peak_bytes;  // high-water mark of live_bytes
+  char pad[ALLOC_CACHE_LINE - 6 * sizeof(long long)];
+} AllocStats;
+
+_Static_assert(sizeof(AllocStats) == ALLOC_CACHE_LINE, "AllocStats must fill exactly one cache line");
+
+enum
+{
+  ALLOC_UNINITIALIZED,
+  ALLOC_OFF,
+  ALLOC_ON
+};
+
+static const char *alloc_site_names[ALLOC_NSITES] = {
+    "vec", "string", "parser", "matrix", "sparse", "stack", "list", "input", "writer", "expr", "chain", "queue", "hash", "bitset"};
+
+static atomic_int alloc_state = ALLOC_UNINITIALIZED; // Published by alloc_init_once
+static pthread_once_t alloc_once = PTHREAD_ONCE_INIT;
+static const char *alloc_out_path = NULL;
+static AllocStats alloc_stats[ALLOC_NSITES];
+
+static void alloc_at_exit(void)
+{
+  FILE *out = stderr;
+  if (alloc_out_path != NULL)
+  {
+    out = fopen(alloc_out_path, "w");
+    if (out == NULL)
+    {
+      fprintf(stderr, "Error: Cannot open '%s' for allocation report.\n", alloc_out_path);
+      return;
+    }
+  }
+  alloc_report(out);
+  if (out != stderr)
+    fclose(out);
+}
+
+static void alloc_init_once(void)
+{
+  const char *env = getenv("LAB_ALLOC");
+  if (env == NULL || *env == '\0' || strcmp(env, "0") == 0)
+  {
+    atomic_store_explicit(&alloc_state, ALLOC_OFF, memory_order_release);
+    return;
+  }
+  if (strcmp(env, "1") != 0 && strcmp(env, "stderr") != 0)
+    alloc_out_path = env;
+  atexit(alloc_at_exit);
+  atomic_store_explicit(&alloc_state, ALLOC_ON, memory_order_release);
+}
+
+// reads LAB_ALLOC once, even when the first allocations race on several
+// threads; called lazily by the first allocation if not called explicitly
+void alloc_init(void)
+{
+  pthread_once(&alloc_once, alloc_init_once);
+}
+
+static inline int alloc_tracking(void)
+{
+  int state = atomic_load_explicit(&alloc_state, memory_order_acquire);
+  if (state == ALLOC_UNINITIALIZED)
+  {
+    alloc_init();
+    state = atomic_load_explicit(&alloc_state, memory_order_acquire);
+  }
+  return state == ALLOC_ON;
+}
+
+int alloc_enabled(void)
+{
+  return alloc_tracking();
+}
+
+static void alloc_raise_peak(atomic_llong *peak, long long live)
+{
+  long long seen = atomic_load_explicit(peak, memory_order_relaxed);
+  while (live > seen &&
+         !atomic_compare_exchange_weak_explicit(peak, &seen, live, memory_order_relaxed, memory_order_relaxed))
+    ;
+}
+
+static void alloc_charge(AllocStats *st, long long delta)
+{
+  long long live = atomic_fetch_add_explicit(&st->live_bytes, delta, memory_order_relaxed) + delta;
+  if (delta > 0)
+    alloc_raise_peak(&st->peak_bytes, live);
+}
+
+// Only the site's own line is touched: the total is summed at report time
+static void alloc_record(AllocSite site, size_t usable, long long delta)
+{
+  if (usable > 0)
+    atomic_fetch_add_explicit(&alloc_stats[site].bytes, usable, memory_order_relaxed);
+  alloc_charge(&alloc_stats[site], delta);
+}
+
+void *alloc_malloc(size_t size, AllocSite site)
+{
+  void *ptr = malloc(size);
+  if (!alloc_tracking())
+    return ptr;
+  if (ptr != NULL)
+  {
+    size_t usable = ALLOC_USABLE_SIZE(ptr);
+    atomic_fetch_add_explicit(&alloc_stats[site].allocs, 1, memory_order_relaxed);
+    alloc_record(site, usable, (long long)usable);
+  }
+  return ptr;
+}
+
+void *alloc_calloc(size_t count, size_t size, AllocSite site)
+{
+  void *ptr = calloc(count, size);
+  if (!alloc_tracking())
+    return ptr;
+  if (ptr != NULL)
+  {
+    size_t usable = ALLOC_USABLE_SIZE(ptr);
+    atomic_fetch_add_explicit(&alloc_stats[site].allocs, 1, memory_order_relaxed);
+    alloc_record(site, usable, (long long)usable);
+  }
+  return ptr;
+}
+
+// realloc(NULL, n) counts as an allocation; growth is charged as the size difference
+void *alloc_realloc(void *ptr, size_t size, AllocSite site)
+{
+  if (!alloc_tracking())
+    return realloc(ptr, size);
+  if (ptr == NULL)
+    return alloc_malloc(size, site);
+
+  size_t old_usable = ALLOC_USABLE_SIZE(ptr);
+  void *new_ptr = realloc(ptr, size);
+  if (new_ptr == NULL)
+    return NULL; // Old block untouched
+  size_t new_usable = ALLOC_USABLE_SIZE(new_ptr);
+  atomic_fetch_add_explicit(&alloc_stats[site].reallocs, 1, memory_order_relaxed);
+  alloc_record(site, new_usable > old_usable ? new_usable - old_usable : 0,
+               (long long)new_usable - (long long)old_usable);
+  return new_ptr;
+}
+
+void alloc_free(void *ptr, AllocSite site)
+{
+  if (ptr == NULL)
+    return;
+  if (!alloc_tracking())
+  {
+    free(ptr);
+    return;
+  }
+  size_t usable = ALLOC_USABLE_SIZE(ptr);
+  free(ptr);
+  atomic_fetch_add_explicit(&alloc_stats[site].frees, 1, memory_order_relaxed);
+  alloc_record(site, 0, -(long long)usable);
+}
+
+// A plain copy of one site's counters, or of their sum
+typedef struct
+{
+  unsigned long long allocs, frees, reallocs, bytes;
+  long long live_bytes, peak_bytes;
+} AllocCounts;
+
+static AllocCounts alloc_counts(AllocStats *st)
+{
+  AllocCounts c = {atomic_load(&st->allocs), atomic_load(&st->frees), atomic_load(&st->reallocs),
+                   atomic_load(&st->bytes), atomic_load(&st->live_bytes), atomic_load(&st->peak_bytes)};
+  return c;
+}
+
+// peak_bytes < 0 is written as null
+static void alloc_report_counts(FILE *out, const char *name, const AllocCounts *c)
+{
+  fprintf(out,
+          "{\"site\": \"%s\", \"allocs\": %llu, \"frees\": %llu, \"reallocs\": %llu, "
+          "\"bytes\": %llu, \"live_bytes\": %lld, \"peak_bytes\": ",
+          name, c->allocs, c->frees, c->reallocs, c->bytes, c->live_bytes);
+  if (c->peak_bytes < 0)
+    fprintf(out, "null}");
+  else
+    fprintf(out, "%lld}", c->peak_bytes);
+}
+
+// writes per-subsystem and total counters as JSON (byte figures are usable sizes).
+// The total is summed here from the sites; its peak is null because sites
+// peak at different times and no global high-water mark is kept.
+void alloc_report(FILE *out)
+{
+  AllocCounts total = {0, 0, 0, 0, 0, -1};
+  fprintf(out, "{\n  \"sites\": [\n");
+  int first = 1;
+  for (int s = 0; s < ALLOC_NSITES; s++)
+  {
+    AllocCounts c = alloc_counts(&alloc_stats[s]);
+    if (c.allocs == 0)
+      continue; // Skip subsystems this program never used
+    fprintf(out, "%s    ", first ? "" : ",\n");
+    alloc_report_counts(out, alloc_site_names[s], &c);
+    first = 0;
+    total.allocs += c.allocs;
+    total.frees += c.frees;
+    total.reallocs += c.reallocs;
+    total.bytes += c.bytes;
+    total.live_bytes += c.live_bytes;
+  }
+  fprintf(out, "%s  ],\n  \"total\": ", first ? "" : "\n");
+  alloc_report_counts(out, "total", &total);
+  fprintf(out, "\n}\n");
+  fflush(out);
+}
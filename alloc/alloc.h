@@ -0,0 +1,38 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h> // for size_t
+#include <stdio.h>
+
+// Subsystems that allocations are charged to
+typedef enum
+{
+  ALLOC_VEC,
+  ALLOC_STRING,
+  ALLOC_PARSER, // Parsed values handed out in Result/ReadResult
+  ALLOC_MATRIX,
+  ALLOC_SPARSE,
+  ALLOC_STACK,
+  ALLOC_LIST,
+  ALLOC_INPUT,  // Batch reader buffers
+  ALLOC_WRITER, // Output writer buffers
+  ALLOC_EXPR,   // Expression trees and their term lists
+  ALLOC_CHAIN,  // Matrix-chain plans and intermediate buffers
+  ALLOC_QUEUE,  // Concurrent queue nodes, rings and thread handles
+  ALLOC_HASH,   // Hash table control bytes and slots
+  ALLOC_BITSET, // Bitsets, rank directories and compressed bitmap containers
+  ALLOC_NSITES
+} AllocSite;
+
+// Accounting is off unless the LAB_ALLOC environment variable is set:
+//   LAB_ALLOC=1 (or "stderr") reports JSON to stderr at exit, any other value is a file path.
+// When off, every call is a plain malloc/realloc/free behind one branch.
+void alloc_init(void);
+int alloc_enabled(void);
+void *alloc_malloc(size_t size, AllocSite site);
+void *alloc_calloc(size_t count, size_t size, AllocSite site);
+void *alloc_realloc(void *ptr, size_t size, AllocSite site);
+void alloc_free(void *ptr, AllocSite site);
+void alloc_report(FILE *out);
+
+#endif // ALLOC_H
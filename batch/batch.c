@@ -0,0 +1,102 @@
+#define _POSIX_C_SOURCE 200809L
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../input/input.h"
+#include "../alloc/alloc.h"
+
+#define BATCH_STDOUT_BUFSIZE (1 << 20)
+
+static char batch_stdout_buf[BATCH_STDOUT_BUFSIZE];
+
+static double batch_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int batch_requested(int argc, char **argv, const char **path)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--batch") == 0)
+    {
+      // A following option ("--format ...") is not a script path
+      *path = (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) ? argv[i + 1] : "-";
+      return 1;
+    }
+  }
+  return 0;
+}
+
+const char *batch_option(int argc, char **argv, const char *flag)
+{
+  for (int i = 1; i + 1 < argc; i++)
+  {
+    if (strcmp(argv[i], flag) == 0)
+      return argv[i + 1];
+  }
+  return NULL;
+}
+
+// Opens the script and switches stdout to a large fully buffered block
+BatchRun *batch_start(const char *program, const char *path)
+{
+  BatchRun *run = alloc_malloc(sizeof(BatchRun), ALLOC_INPUT);
+  if (!run)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for batch run.\n");
+    return NULL;
+  }
+  run->in = int_reader_open(path);
+  if (!run->in)
+  {
+    fprintf(stderr, "Error: Cannot open batch input '%s'.\n", path);
+    alloc_free(run, ALLOC_INPUT);
+    return NULL;
+  }
+  setvbuf(stdout, batch_stdout_buf, _IOFBF, sizeof(batch_stdout_buf));
+  run->program = program;
+  run->ops = 0;
+  run->errors = 0;
+  run->start_ns = batch_now_ns();
+  return run;
+}
+
+ReadStatus batch_next(BatchRun *run, int *out_value)
+{
+  while (1)
+  {
+    ReadStatus status = int_reader_next(run->in, out_value);
+    if (status != READ_ERR)
+      return status;
+    fprintf(stderr, "%s: line %zu: invalid integer, skipped.\n", run->program, run->in->line);
+    run->errors++;
+  }
+}
+
+ReadStatus batch_operand(BatchRun *run, int *out_value)
+{
+  ReadStatus status = batch_next(run, out_value);
+  if (status != READ_OK)
+  {
+    fprintf(stderr, "%s: line %zu: script ended inside a command.\n", run->program, run->in->line);
+    run->errors++;
+  }
+  return status;
+}
+
+void batch_finish(BatchRun *run)
+{
+  if (!run)
+    return;
+  fflush(stdout);
+  double seconds = (batch_now_ns() - run->start_ns) / 1e9;
+  fprintf(stderr, "%s: %zu operations, %zu errors in %.6f s (%.0f ops/s)\n", run->program, run->ops,
+          run->errors, seconds, seconds > 0 ? (double)run->ops / seconds : 0.0);
+  int_reader_close(run->in);
+  alloc_free(run, ALLOC_INPUT);
+}
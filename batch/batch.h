@@ -0,0 +1,32 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h> // for size_t
+#include "../input/input.h"
+
+// Non-interactive run of a lab program: reads the same numbers the interactive
+// menus ask for from a script file (or stdin), prints no prompts, buffers stdout
+// fully and reports throughput on stderr when finished.
+typedef struct
+{
+  const char *program;
+  IntReader *in;
+  size_t ops;      // operations executed, counted by the program
+  size_t errors;   // bad tokens or rejected operations
+  double start_ns;
+} BatchRun;
+
+// Returns 1 and sets *path if argv contains "--batch [FILE|-]" (no FILE means stdin)
+int batch_requested(int argc, char **argv, const char **path);
+// Returns the argument following flag (e.g. "--format"), or NULL if absent
+const char *batch_option(int argc, char **argv, const char *flag);
+BatchRun *batch_start(const char *program, const char *path);
+// Reads the next integer; bad tokens are reported, counted and skipped.
+// Returns READ_OK or READ_STOPPED.
+ReadStatus batch_next(BatchRun *run, int *out_value);
+// batch_next for a command's operand: stopping here means the script was cut
+// short, which is reported and counted as an error
+ReadStatus batch_operand(BatchRun *run, int *out_value);
+void batch_finish(BatchRun *run); // Flushes output, prints the summary and frees the run
+
+#endif // BATCH_H
@@ -0,0 +1,2518 @@
+#define _GNU_SOURCE // pthread_setaffinity_np for --pin
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include "harness.h"
+#include "../types/types.h"
+#include "../result/result.h"
+#include "../string/string.h"
+#include "../parser/parser.h"
+#include "../vector/vector.h"
+#include "../matrix/matrix.h"
+#include "../sparse/sparse.h"
+#include "../stack/stack.h"
+#include "../list/list.h"
+#include "../skiplist/skiplist.h"
+#include "../lfqueue/lfqueue.h"
+#include "../ring/ring.h"
+#include "../segvec/segvec.h"
+#include "../cow/cow.h"
+#include "../persist/persist.h"
+#include "../search/search.h"
+#include "../hashmap/hashmap.h"
+#include "../bitset/bitset.h"
+#include "../roaring/roaring.h"
+#include "../perf/perf.h"
+#include "../writer/writer.h"
+#include "../expr/expr.h"
+#include "../chain/chain.h"
+#include "../tmat/tmat.h"
+#include "../smallgemm/smallgemm.h"
+#include "../csr/csr.h"
+#include "../sell/sell.h"
+#include "../reorder/reorder.h"
+#include "../dynsparse/dynsparse.h"
+
+#define MAX_SIZES 16
+#define SPARSE_FILL_PERCENT 1
+#define GET_INDEX_QUERIES 16
+#define QUEUE_ITEMS (1 << 17)
+#define QUEUE_ROUNDS 4096
+#define QUEUE_RING_CAPACITY 1024
+#define RING_BATCH 64
+#define MAX_THREADS 64
+
+// --- Deterministic input generation ---
+
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned int bench_rand(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (unsigned int)(rng_state >> 32);
+}
+
+static Mat *random_mat(int n)
+{
+  Mat *mat = mat_new(n, n);
+  if (!mat)
+    return NULL;
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = 0; j < n; j++)
+    {
+      matrix_set(mat, i, j, (int)(bench_rand() % 100) - 50);
+    }
+  }
+  return mat;
+}
+
+static SparseMat *random_sparse(int n)
+{
+  SparseMat *mat = sparse_new(n, n);
+  if (!mat)
+    return NULL;
+  size_t nnz = (size_t)n * n * SPARSE_FILL_PERCENT / 100;
+  for (size_t k = 0; k < nnz; k++)
+  {
+    sparse_add(mat, bench_rand() % n, bench_rand() % n, (int)(bench_rand() % 99) + 1);
+  }
+  return mat;
+}
+
+// Row r gets about size / (8 * rank) entries for a random rank: a few very
+// long rows and many of length 1, like a power-law graph's adjacency
+static SparseMat *random_powerlaw_sparse(int n)
+{
+  SparseMat *mat = sparse_new(n, n);
+  if (!mat)
+    return NULL;
+  for (int r = 0; r < n; r++)
+  {
+    int len = n / (8 * (int)(bench_rand() % n + 1));
+    for (int k = 0; k < (len > 0 ? len : 1); k++)
+      sparse_add(mat, r, bench_rand() % n, (int)(bench_rand() % 99) + 1);
+  }
+  return mat;
+}
+
+// --- Dense matrix cases ---
+
+typedef struct
+{
+  Mat *a;
+  Mat *b;
+  Mat *c;
+} MatState;
+
+static void *mat_setup(size_t size)
+{
+  MatState *st = calloc(1, sizeof(MatState));
+  if (!st)
+    return NULL;
+  st->a = random_mat((int)size);
+  st->b = random_mat((int)size);
+  if (!st->a || !st->b)
+  {
+    mat_destroy(st->a);
+    mat_destroy(st->b);
+    free(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void mat_teardown(void *state)
+{
+  MatState *st = state;
+  mat_destroy(st->a);
+  mat_destroy(st->b);
+  mat_destroy(st->c);
+  free(st);
+}
+
+static void run_mat_add(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  st->c = mat_add(st->a, st->b);
+}
+
+static void run_mat_mult(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  st->c = mat_mult(st->a, st->b);
+}
+
+static void run_mat_mult_blocked(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  st->c = mat_mult_mode(st->a, st->b, MAT_MULT_BLOCKED);
+}
+
+static void run_mat_mult_strassen(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  st->c = mat_mult_mode(st->a, st->b, MAT_MULT_STRASSEN);
+}
+
+// A + B + A: two mat_add calls (one temporary) against one fused expression pass
+static void run_mat_add_chain(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  Mat *tmp = mat_add(st->a, st->b);
+  st->c = mat_add(tmp, st->a);
+  mat_destroy(tmp);
+}
+
+static void run_expr_add_chain(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  Expr *e = expr_add(expr_add(expr_mat(st->a), expr_mat(st->b)), expr_mat(st->a));
+  st->c = expr_eval_new(e);
+  expr_destroy(e);
+}
+
+// A * B + A: GEMM with an add epilogue
+static void run_expr_gemm_add(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  Expr *e = expr_add(expr_mul(expr_mat(st->a), expr_mat(st->b)), expr_mat(st->a));
+  st->c = expr_eval_new(e);
+  expr_destroy(e);
+}
+
+// B is transposed once in setup, as a pipeline reusing the same right-hand side would
+static void *mat_transposed_setup(size_t size)
+{
+  MatState *st = mat_setup(size);
+  if (!st)
+    return NULL;
+  Mat *bt = mat_transpose(st->b);
+  mat_destroy(st->b);
+  st->b = bt;
+  return st;
+}
+
+static void run_mat_mult_transposed(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  st->c = mat_mult_transposed(st->a, st->b);
+}
+
+static void run_mat_transpose(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  st->c = mat_transpose(st->a);
+}
+
+static void run_mat_transpose_inplace(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  mat_transpose_inplace(st->a);
+}
+
+// Output cases write to /dev/null so only formatting and syscall cost is measured
+static int bench_null_fd(void)
+{
+  static int fd = -1;
+  if (fd < 0)
+    fd = open("/dev/null", O_WRONLY);
+  return fd;
+}
+
+static void run_mat_write(void *state, size_t size)
+{
+  MatState *st = state;
+  (void)size;
+  Writer *w = writer_new(bench_null_fd(), 0);
+  mat_write(st->a, w, OUT_TSV);
+  writer_destroy(w);
+}
+
+static size_t items_square(size_t size) { return size * size; }
+static size_t items_cube(size_t size) { return size * size * size; }
+
+// --- Snapshot cases: size snapshots, each followed by one write ---
+
+static void run_mat_snapshot_copy(void *state, size_t size)
+{
+  MatState *st = state;
+  int n = (int)size;
+  for (size_t s = 0; s < size; s++)
+  {
+    Mat *copy = mat_new(n, n);
+    if (!copy)
+      return;
+    for (int i = 0; i < n; i++)
+      memcpy((*(Vec **)vec_get(copy->rows, i))->data, (*(Vec **)vec_get(st->a->rows, i))->data, sizeof(int) * size);
+    matrix_set(st->a, (int)(s % size), 0, (int)s);
+    mat_destroy(copy);
+  }
+}
+
+typedef struct
+{
+  CowMat *mat;
+} CowState;
+
+static void *cow_setup(size_t size)
+{
+  CowState *st = calloc(1, sizeof(CowState));
+  Mat *mat = random_mat((int)size);
+  if (st && mat)
+    st->mat = cow_mat_from_mat(mat);
+  mat_destroy(mat);
+  if (!st || !st->mat)
+  {
+    free(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void cow_teardown(void *state)
+{
+  CowState *st = state;
+  cow_mat_destroy(st->mat);
+  free(st);
+}
+
+static void run_cow_snapshot(void *state, size_t size)
+{
+  CowState *st = state;
+  for (size_t s = 0; s < size; s++)
+  {
+    CowMat *snap = cow_mat_snapshot(st->mat);
+    cow_mat_set(st->mat, (int)(s % size), 0, (int)s);
+    cow_mat_destroy(snap);
+  }
+}
+
+// --- Sparse matrix cases ---
+
+typedef struct
+{
+  SparseMat *mat;
+  CsrMat *csr; // Only set by sparse_csr_setup
+} SparseState;
+
+static void *sparse_empty_setup(size_t size)
+{
+  (void)size;
+  return calloc(1, sizeof(SparseState));
+}
+
+static void *sparse_filled_setup(size_t size)
+{
+  SparseState *st = calloc(1, sizeof(SparseState));
+  if (!st)
+    return NULL;
+  st->mat = random_sparse((int)size);
+  if (!st->mat)
+  {
+    free(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void sparse_teardown(void *state)
+{
+  SparseState *st = state;
+  sparse_mat_destroy(st->mat);
+  csr_destroy(st->csr);
+  free(st);
+}
+
+static void *sparse_csr_setup(size_t size)
+{
+  SparseState *st = sparse_filled_setup(size);
+  if (!st)
+    return NULL;
+  st->csr = csr_from_sparse(st->mat);
+  if (!st->csr)
+  {
+    sparse_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void run_sparse_build(void *state, size_t size)
+{
+  SparseState *st = state;
+  st->mat = random_sparse((int)size);
+}
+
+static void run_sparse_get(void *state, size_t size)
+{
+  SparseState *st = state;
+  long sum = 0;
+  for (size_t q = 0; q < size; q++)
+  {
+    sum += sparse_get(st->mat, bench_rand() % size, bench_rand() % size);
+  }
+  bench_sink(sum);
+}
+
+static void run_sparse_write(void *state, size_t size)
+{
+  SparseState *st = state;
+  (void)size;
+  Writer *w = writer_new(bench_null_fd(), 0);
+  sparse_write(st->mat, w, OUT_TSV);
+  writer_destroy(w);
+}
+
+static void run_sparse_to_csr(void *state, size_t size)
+{
+  SparseState *st = state;
+  (void)size;
+  csr_destroy(csr_from_sparse(st->mat));
+}
+
+static void run_csr_transpose(void *state, size_t size)
+{
+  SparseState *st = state;
+  (void)size;
+  csr_destroy(csr_transpose(st->csr));
+}
+
+static void run_csr_add(void *state, size_t size)
+{
+  SparseState *st = state;
+  (void)size;
+  csr_destroy(csr_add(st->csr, st->csr));
+}
+
+static void run_sparse_to_mat(void *state, size_t size)
+{
+  SparseState *st = state;
+  (void)size;
+  mat_destroy(sparse_to_mat(st->mat));
+}
+
+static size_t items_sparse_nnz(size_t size) { return size * size * SPARSE_FILL_PERCENT / 100; }
+
+// SpMV on a uniform (random_sparse) or power-law matrix: plain CSR against
+// the format spmv_tune picks
+typedef struct
+{
+  CsrMat *csr;
+  SpmvMat *tuned;
+  int *x;
+  int *y;
+} SpmvState;
+
+static void spmv_teardown(void *state)
+{
+  SpmvState *st = state;
+  csr_destroy(st->csr);
+  spmv_destroy(st->tuned);
+  free(st->x);
+  free(st->y);
+  free(st);
+}
+
+static void *spmv_setup(size_t size, int powerlaw)
+{
+  SpmvState *st = calloc(1, sizeof(SpmvState));
+  if (!st)
+    return NULL;
+  SparseMat *mat = powerlaw ? random_powerlaw_sparse((int)size) : random_sparse((int)size);
+  st->csr = csr_from_sparse(mat);
+  st->tuned = spmv_new(mat);
+  sparse_mat_destroy(mat);
+  st->x = malloc(sizeof(int) * size);
+  st->y = malloc(sizeof(int) * size);
+  if (!st->csr || !st->tuned || !st->x || !st->y)
+  {
+    spmv_teardown(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < size; i++)
+    st->x[i] = (int)(bench_rand() % 100) - 50;
+  return st;
+}
+
+static void *spmv_uniform_setup(size_t size) { return spmv_setup(size, 0); }
+static void *spmv_powerlaw_setup(size_t size) { return spmv_setup(size, 1); }
+
+static void run_spmv_csr(void *state, size_t size)
+{
+  SpmvState *st = state;
+  (void)size;
+  csr_spmv(st->csr, st->x, st->y);
+}
+
+static void run_spmv_tuned(void *state, size_t size)
+{
+  SpmvState *st = state;
+  (void)size;
+  spmv_run(st->tuned, st->x, st->y);
+}
+
+// 5-point stencil on a size x size grid with randomly shuffled vertex
+// numbers: banded structure hidden behind a random labelling
+static CsrMat *shuffled_grid(int side)
+{
+  int n = side * side;
+  int *label = malloc(sizeof(int) * (size_t)n);
+  SparseMat *mat = sparse_new(n, n);
+  CsrMat *csr = NULL;
+  if (label && mat)
+  {
+    for (int i = 0; i < n; i++)
+      label[i] = i;
+    for (int i = n - 1; i > 0; i--)
+    {
+      int j = (int)(bench_rand() % (unsigned)(i + 1)), tmp = label[i];
+      label[i] = label[j];
+      label[j] = tmp;
+    }
+    for (int i = 0; i < side; i++)
+    {
+      for (int j = 0; j < side; j++)
+      {
+        int v = label[i * side + j];
+        sparse_add(mat, v, v, 4);
+        if (i > 0)
+          sparse_add(mat, v, label[(i - 1) * side + j], -1);
+        if (i + 1 < side)
+          sparse_add(mat, v, label[(i + 1) * side + j], -1);
+        if (j > 0)
+          sparse_add(mat, v, label[i * side + j - 1], -1);
+        if (j + 1 < side)
+          sparse_add(mat, v, label[i * side + j + 1], -1);
+      }
+    }
+    csr = csr_from_sparse(mat);
+  }
+  free(label);
+  sparse_mat_destroy(mat);
+  return csr;
+}
+
+typedef struct
+{
+  CsrMat *shuffled;
+  CsrMat *reordered; // RCM of shuffled
+  int *x;
+  int *y;
+} GridState;
+
+static void grid_teardown(void *state)
+{
+  GridState *st = state;
+  csr_destroy(st->shuffled);
+  csr_destroy(st->reordered);
+  free(st->x);
+  free(st->y);
+  free(st);
+}
+
+static void *grid_setup(size_t size)
+{
+  GridState *st = calloc(1, sizeof(GridState));
+  if (!st)
+    return NULL;
+  size_t n = size * size;
+  st->shuffled = shuffled_grid((int)size);
+  Reordering *p = st->shuffled ? reorder_compute(st->shuffled, REORDER_RCM) : NULL;
+  st->reordered = p ? reorder_apply(st->shuffled, p) : NULL;
+  reorder_destroy(p);
+  st->x = malloc(sizeof(int) * n);
+  st->y = malloc(sizeof(int) * n);
+  if (!st->reordered || !st->x || !st->y)
+  {
+    grid_teardown(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < n; i++)
+    st->x[i] = (int)(bench_rand() % 100) - 50;
+  return st;
+}
+
+static void run_reorder_rcm(void *state, size_t size)
+{
+  GridState *st = state;
+  (void)size;
+  reorder_destroy(reorder_compute(st->shuffled, REORDER_RCM));
+}
+
+static void run_spmv_shuffled(void *state, size_t size)
+{
+  GridState *st = state;
+  (void)size;
+  csr_spmv(st->shuffled, st->x, st->y);
+}
+
+static void run_spmv_rcm(void *state, size_t size)
+{
+  GridState *st = state;
+  (void)size;
+  csr_spmv(st->reordered, st->x, st->y);
+}
+
+// A random sparse matrix taking size random updates (a tenth of them deletes)
+typedef struct
+{
+  DynSparse *dyn;
+  int *x;
+  int *y;
+} DynState;
+
+static void dyn_teardown(void *state)
+{
+  DynState *st = state;
+  dyn_sparse_destroy(st->dyn);
+  free(st->x);
+  free(st->y);
+  free(st);
+}
+
+static void *dyn_setup(size_t size)
+{
+  DynState *st = calloc(1, sizeof(DynState));
+  if (!st)
+    return NULL;
+  SparseMat *mat = random_sparse((int)size);
+  st->dyn = mat ? dyn_sparse_from_sparse(mat) : NULL;
+  sparse_mat_destroy(mat);
+  st->x = malloc(sizeof(int) * size);
+  st->y = malloc(sizeof(int) * size);
+  if (!st->dyn || !st->x || !st->y)
+  {
+    dyn_teardown(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < size; i++)
+    st->x[i] = (int)(bench_rand() % 100) - 50;
+  return st;
+}
+
+static void dyn_updates(DynState *st, size_t size)
+{
+  for (size_t q = 0; q < size; q++)
+  {
+    int value = bench_rand() % 10 == 0 ? 0 : (int)(bench_rand() % 100) + 1;
+    dyn_sparse_set(st->dyn, (int)(bench_rand() % size), (int)(bench_rand() % size), value);
+  }
+}
+
+static void run_dyn_set(void *state, size_t size)
+{
+  dyn_updates(state, size);
+}
+
+static void run_dyn_set_compact(void *state, size_t size)
+{
+  DynState *st = state;
+  dyn_updates(st, size);
+  dyn_sparse_compact(st->dyn);
+}
+
+static void run_dyn_spmv(void *state, size_t size)
+{
+  DynState *st = state;
+  (void)size;
+  dyn_sparse_spmv(st->dyn, st->x, st->y);
+}
+
+// --- Matrix chain cases ---
+
+// A1 A2 A3 A4 x with four size x size matrices and a size x 1 vector: the
+// written (left-to-right) order costs O(n^3), the planned one O(n^2)
+#define CHAIN_LENGTH 5
+
+typedef struct
+{
+  Mat *mats[CHAIN_LENGTH];
+  ChainOperand ops[CHAIN_LENGTH];
+  ChainPlan *plan;
+  Mat *result;
+} ChainState;
+
+static void chain_teardown(void *state)
+{
+  ChainState *st = state;
+  for (int i = 0; i < CHAIN_LENGTH; i++)
+    mat_destroy(st->mats[i]);
+  chain_plan_destroy(st->plan);
+  mat_destroy(st->result);
+  free(st);
+}
+
+static void *chain_setup(size_t size)
+{
+  ChainState *st = calloc(1, sizeof(ChainState));
+  if (!st)
+    return NULL;
+  for (int i = 0; i < CHAIN_LENGTH; i++)
+  {
+    st->mats[i] = i + 1 < CHAIN_LENGTH ? random_mat((int)size) : mat_new((int)size, 1);
+    if (!st->mats[i])
+    {
+      chain_teardown(st);
+      return NULL;
+    }
+    st->ops[i] = chain_dense(st->mats[i]);
+  }
+  st->plan = chain_plan_new(st->ops, CHAIN_LENGTH);
+  if (!st->plan)
+  {
+    chain_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void run_chain_written_order(void *state, size_t size)
+{
+  ChainState *st = state;
+  (void)size;
+  Mat *acc = mat_mult(st->mats[0], st->mats[1]);
+  for (int i = 2; i < CHAIN_LENGTH; i++)
+  {
+    Mat *next = mat_mult(acc, st->mats[i]);
+    mat_destroy(acc);
+    acc = next;
+  }
+  mat_destroy(st->result);
+  st->result = acc;
+}
+
+static void run_chain_planned(void *state, size_t size)
+{
+  ChainState *st = state;
+  (void)size;
+  mat_destroy(st->result);
+  st->result = chain_plan_run(st->plan, st->ops);
+}
+
+// --- Typed matrix cases ---
+
+// The same random size x size operands (values in [-50, 50)) in each element type
+typedef struct
+{
+  Mat *a;
+  Mat *b;
+  MatI8 *a8, *b8;
+  MatI16 *a16, *b16;
+  MatF32 *a32f, *b32f;
+} TmatState;
+
+static void tmat_teardown(void *state)
+{
+  TmatState *st = state;
+  mat_destroy(st->a);
+  mat_destroy(st->b);
+  tmat_destroy(st->a8);
+  tmat_destroy(st->b8);
+  tmat_destroy(st->a16);
+  tmat_destroy(st->b16);
+  tmat_destroy(st->a32f);
+  tmat_destroy(st->b32f);
+  free(st);
+}
+
+static void *tmat_setup(size_t size)
+{
+  TmatState *st = calloc(1, sizeof(TmatState));
+  if (!st)
+    return NULL;
+  st->a = random_mat((int)size);
+  st->b = random_mat((int)size);
+  if (st->a && st->b)
+  {
+    st->a8 = tmat_from_mat(i8, st->a);
+    st->b8 = tmat_from_mat(i8, st->b);
+    st->a16 = tmat_from_mat(i16, st->a);
+    st->b16 = tmat_from_mat(i16, st->b);
+    st->a32f = tmat_from_mat(f32, st->a);
+    st->b32f = tmat_from_mat(f32, st->b);
+  }
+  if (!st->a8 || !st->b8 || !st->a16 || !st->b16 || !st->a32f || !st->b32f)
+  {
+    tmat_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void run_tmat_mult_i8(void *state, size_t size)
+{
+  TmatState *st = state;
+  (void)size;
+  tmat_destroy(tmat_mult(st->a8, st->b8));
+}
+
+static void run_tmat_mult_i16(void *state, size_t size)
+{
+  TmatState *st = state;
+  (void)size;
+  tmat_destroy(tmat_mult(st->a16, st->b16));
+}
+
+static void run_tmat_mult_f32(void *state, size_t size)
+{
+  TmatState *st = state;
+  (void)size;
+  tmat_destroy(tmat_mult(st->a32f, st->b32f));
+}
+
+static void run_mat_mult_exact(void *state, size_t size)
+{
+  TmatState *st = state;
+  (void)size;
+  tmat_destroy(mat_mult_exact(st->a, st->b));
+}
+
+// --- Small-matrix batch cases (size = number of products) ---
+
+typedef struct
+{
+  MatBatch *a;
+  MatBatch *b;
+  MatBatch *c;
+  Mat *one_a; // A single pair for the one-Mat-per-product baseline
+  Mat *one_b;
+} SmallState;
+
+static void small_teardown(void *state)
+{
+  SmallState *st = state;
+  mat_batch_destroy(st->a);
+  mat_batch_destroy(st->b);
+  mat_batch_destroy(st->c);
+  mat_destroy(st->one_a);
+  mat_destroy(st->one_b);
+  free(st);
+}
+
+static void *small_setup(size_t size, int n)
+{
+  SmallState *st = calloc(1, sizeof(SmallState));
+  if (!st)
+    return NULL;
+  st->a = mat_batch_new(size, n, n);
+  st->b = mat_batch_new(size, n, n);
+  st->c = mat_batch_new(size, n, n);
+  st->one_a = random_mat(n);
+  st->one_b = random_mat(n);
+  if (!st->a || !st->b || !st->c || !st->one_a || !st->one_b)
+  {
+    small_teardown(st);
+    return NULL;
+  }
+  for (size_t t = 0; t < size; t++)
+  {
+    int *a = mat_batch_at(st->a, t), *b = mat_batch_at(st->b, t);
+    for (int i = 0; i < n * n; i++)
+    {
+      a[i] = (int)(bench_rand() % 100) - 50;
+      b[i] = (int)(bench_rand() % 100) - 50;
+    }
+  }
+  return st;
+}
+
+static void *small4_setup(size_t size) { return small_setup(size, 4); }
+static void *small16_setup(size_t size) { return small_setup(size, 16); }
+
+static void run_smallgemm(void *state, size_t size)
+{
+  SmallState *st = state;
+  (void)size;
+  mat_batch_mult(st->c, st->a, st->b);
+}
+
+static void run_mat_mult_each(void *state, size_t size)
+{
+  SmallState *st = state;
+  for (size_t t = 0; t < size; t++)
+    mat_destroy(mat_mult(st->one_a, st->one_b));
+}
+
+// --- Vec, stack and search cases ---
+
+static void *vec_empty_setup(size_t size)
+{
+  (void)size;
+  return vec_new(sizeof(int), 0);
+}
+
+static void *vec_filled_setup(size_t size)
+{
+  Vec *vec = vec_new(sizeof(int), size);
+  if (!vec)
+    return NULL;
+  for (size_t i = 0; i < size; i++)
+  {
+    int value = (int)i;
+    vec_append(vec, &value);
+  }
+  return vec;
+}
+
+static void vec_teardown(void *state)
+{
+  vec_destroy(state);
+}
+
+static void run_vec_append(void *state, size_t size)
+{
+  Vec *vec = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    int value = (int)i;
+    vec_append(vec, &value);
+  }
+}
+
+static void *segvec_empty_setup(size_t size)
+{
+  (void)size;
+  return segvec_new(sizeof(int), 0);
+}
+
+static void segvec_teardown(void *state)
+{
+  segvec_destroy(state);
+}
+
+static void run_segvec_append(void *state, size_t size)
+{
+  SegVec *vec = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    int value = (int)i;
+    segvec_append(vec, &value, NULL);
+  }
+}
+
+// Appends in batches of RING_BATCH, as an ingestion thread would after parsing a block
+static void run_segvec_append_batch(void *state, size_t size)
+{
+  SegVec *vec = state;
+  int values[RING_BATCH];
+  for (size_t i = 0; i < size; i += RING_BATCH)
+  {
+    size_t n = size - i < RING_BATCH ? size - i : RING_BATCH;
+    for (size_t j = 0; j < n; j++)
+      values[j] = (int)(i + j);
+    segvec_append_batch(vec, values, n, NULL);
+  }
+}
+
+static void *segvec_append_worker(void *arg)
+{
+  SegVec *vec = arg;
+  for (int i = 0; i < QUEUE_ITEMS / MAX_THREADS; i++)
+    segvec_append(vec, &i, NULL);
+  return NULL;
+}
+
+// QUEUE_ITEMS appends split over size threads
+static void run_segvec_append_threads(void *state, size_t size)
+{
+  pthread_t threads[MAX_THREADS];
+  int started[MAX_THREADS] = {0};
+  size_t n = size < 1 ? 1 : size > MAX_THREADS ? MAX_THREADS : size;
+  // Each of the MAX_THREADS shares goes to thread t % n
+  for (size_t share = 0; share < MAX_THREADS; share += n)
+  {
+    for (size_t t = 0; t < n && share + t < MAX_THREADS; t++)
+      started[t] = pthread_create(&threads[t], NULL, segvec_append_worker, state) == 0;
+    for (size_t t = 0; t < n && share + t < MAX_THREADS; t++)
+      if (started[t])
+        pthread_join(threads[t], NULL);
+  }
+}
+
+static void run_get_index(void *state, size_t size)
+{
+  Vec *vec = state;
+  long sum = 0;
+  for (int q = 0; q < GET_INDEX_QUERIES; q++)
+  {
+    sum += get_index(vec, -1 - q); // Never present: full scan
+  }
+  bench_sink(sum + (long)size);
+}
+
+static size_t items_get_index(size_t size) { return size * GET_INDEX_QUERIES; }
+
+// Membership tests: size keys (the even numbers below 2 * size, shuffled)
+// and size queries, about half of them present
+typedef struct
+{
+  Vec *vec;
+  IntMap *ints;
+  HashSet *set;
+  HashSet *strings;
+  int *queries;
+  String **key_strings;
+  String **query_strings;
+  size_t size;
+} LookupState;
+
+static String *lookup_string(int value)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "key-%d", value);
+  String *s = String_new(16);
+  if (s)
+    String_append(s, buf);
+  return s;
+}
+
+static void lookup_teardown(void *state)
+{
+  LookupState *st = state;
+  vec_destroy(st->vec);
+  intmap_destroy(st->ints);
+  hashset_destroy(st->set);
+  hashset_destroy(st->strings);
+  for (size_t i = 0; i < st->size; i++)
+  {
+    if (st->key_strings)
+      String_destroy(st->key_strings[i]);
+    if (st->query_strings)
+      String_destroy(st->query_strings[i]);
+  }
+  free(st->key_strings);
+  free(st->query_strings);
+  free(st->queries);
+  free(st);
+}
+
+static void *lookup_setup(size_t size)
+{
+  LookupState *st = calloc(1, sizeof(LookupState));
+  if (!st)
+    return NULL;
+  st->size = size;
+  st->vec = vec_new(sizeof(int), size);
+  st->ints = intmap_new();
+  st->set = hashset_new(sizeof(int), NULL, NULL);
+  st->strings = hashset_new(sizeof(String *), hash_string, hash_string_eq);
+  st->queries = malloc(size * sizeof(int));
+  st->key_strings = calloc(size, sizeof(String *));
+  st->query_strings = calloc(size, sizeof(String *));
+  int *keys = malloc(size * sizeof(int));
+  if (!st->vec || !st->ints || !st->set || !st->strings || !st->queries || !st->key_strings ||
+      !st->query_strings || !keys)
+  {
+    free(keys);
+    lookup_teardown(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < size; i++)
+    keys[i] = 2 * (int)i;
+  for (size_t i = size; i > 1; i--)
+  {
+    size_t j = bench_rand() % i;
+    int t = keys[i - 1];
+    keys[i - 1] = keys[j];
+    keys[j] = t;
+  }
+  for (size_t i = 0; i < size; i++)
+  {
+    vec_append(st->vec, &keys[i]);
+    intmap_put(st->ints, keys[i], (int)i);
+    hashset_add(st->set, &keys[i]);
+    st->key_strings[i] = lookup_string(keys[i]);
+    if (st->key_strings[i])
+      hashset_add(st->strings, &st->key_strings[i]);
+    st->queries[i] = (int)(bench_rand() % (2 * size));
+    st->query_strings[i] = lookup_string(st->queries[i]);
+  }
+  free(keys);
+  return st;
+}
+
+static void run_lookup_linear_scan(void *state, size_t size)
+{
+  LookupState *st = state;
+  long hits = 0;
+  for (size_t i = 0; i < size; i++)
+    hits += get_index(st->vec, st->queries[i]) >= 0;
+  bench_sink(hits);
+}
+
+static void run_intmap_lookup(void *state, size_t size)
+{
+  LookupState *st = state;
+  long hits = 0;
+  for (size_t i = 0; i < size; i++)
+    hits += intmap_contains(st->ints, st->queries[i]);
+  bench_sink(hits);
+}
+
+static void run_hashset_lookup(void *state, size_t size)
+{
+  LookupState *st = state;
+  long hits = 0;
+  for (size_t i = 0; i < size; i++)
+    hits += hashset_contains(st->set, &st->queries[i]);
+  bench_sink(hits);
+}
+
+static void run_hashset_string_lookup(void *state, size_t size)
+{
+  LookupState *st = state;
+  long hits = 0;
+  for (size_t i = 0; i < size; i++)
+    hits += hashset_contains(st->strings, &st->query_strings[i]);
+  bench_sink(hits);
+}
+
+static void *intmap_empty_setup(size_t size)
+{
+  (void)size;
+  return intmap_new();
+}
+
+static void intmap_teardown(void *state)
+{
+  intmap_destroy(state);
+}
+
+static void run_intmap_put(void *state, size_t size)
+{
+  IntMap *map = state;
+  for (size_t i = 0; i < size; i++)
+    intmap_put(map, (int)(i * 2654435761u), (int)i);
+  bench_sink((long)intmap_size(map));
+}
+
+static void *stack_empty_setup(size_t size)
+{
+  (void)size;
+  return stack_new(1);
+}
+
+static void *stack_filled_setup(size_t size)
+{
+  Stack *s = stack_new(size);
+  if (!s)
+    return NULL;
+  for (size_t i = 0; i < size; i++)
+  {
+    stack_push(s, (int)i);
+  }
+  return s;
+}
+
+static void stack_teardown(void *state)
+{
+  stack_destroy(state);
+}
+
+static void run_stack_push_pop(void *state, size_t size)
+{
+  Stack *s = state;
+  long sum = 0;
+  int value;
+  for (size_t i = 0; i < size; i++)
+  {
+    stack_push(s, (int)i);
+  }
+  while (stack_pop(s, &value))
+  {
+    sum += value;
+  }
+  bench_sink(sum);
+}
+
+static void run_stack_peek(void *state, size_t size)
+{
+  Stack *s = state;
+  long sum = 0;
+  int value;
+  for (size_t i = 0; i < size; i++)
+  {
+    stack_peek(s, &value);
+    sum += value;
+  }
+  bench_sink(sum);
+}
+
+static size_t items_double(size_t size) { return 2 * size; }
+
+// Undo history: keep every version of a stack while pushing size values
+typedef struct
+{
+  Stack **clones;
+  PersistStore *store;
+  PStack *versions;
+} StackVersionsState;
+
+static void *stack_versions_setup(size_t size)
+{
+  StackVersionsState *st = calloc(1, sizeof(StackVersionsState));
+  if (!st)
+    return NULL;
+  st->clones = calloc(size + 1, sizeof(Stack *));
+  st->versions = calloc(size + 1, sizeof(PStack));
+  st->store = persist_store_new();
+  if (!st->clones || !st->versions || !st->store)
+  {
+    free(st->clones);
+    free(st->versions);
+    persist_store_destroy(st->store);
+    free(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void stack_versions_teardown(void *state)
+{
+  StackVersionsState *st = state;
+  free(st->clones);
+  free(st->versions);
+  persist_store_destroy(st->store);
+  free(st);
+}
+
+// Each version is a full copy of the previous one plus the new top
+static void run_stack_versions_clone(void *state, size_t size)
+{
+  StackVersionsState *st = state;
+  long sum = 0;
+  st->clones[0] = stack_new(1);
+  for (size_t i = 0; i < size && st->clones[i] != NULL; i++)
+  {
+    Vec *prev = st->clones[i]->elements;
+    Stack *next = stack_new(prev->length + 1);
+    memcpy(next->elements->data, prev->data, prev->length * prev->elem_size);
+    next->elements->length = prev->length;
+    stack_push(next, (int)i);
+    st->clones[i + 1] = next;
+  }
+  for (size_t i = 0; i <= size && st->clones[i] != NULL; i++)
+  {
+    sum += (long)stack_size(st->clones[i]);
+    stack_destroy(st->clones[i]);
+    st->clones[i] = NULL;
+  }
+  bench_sink(sum);
+}
+
+// Each version is one node sharing the previous version as its tail
+static void run_pstack_versions(void *state, size_t size)
+{
+  StackVersionsState *st = state;
+  long sum = 0;
+  size_t kept = 1;
+  st->versions[0] = pstack_empty();
+  for (size_t i = 0; i < size && pstack_push(st->store, st->versions[i], (int)i, &st->versions[i + 1]); i++)
+    kept++;
+  for (size_t i = 0; i < kept; i++)
+  {
+    sum += (long)st->versions[i].length;
+    pstack_release(st->store, st->versions[i]);
+  }
+  bench_sink(sum);
+}
+
+
+// --- Linked list cases ---
+
+typedef struct
+{
+  Node *head;
+} ListState;
+
+static void *list_empty_setup(size_t size)
+{
+  (void)size;
+  return calloc(1, sizeof(ListState));
+}
+
+static void *list_filled_setup(size_t size)
+{
+  ListState *st = calloc(1, sizeof(ListState));
+  if (!st)
+    return NULL;
+  for (size_t i = 0; i < size; i++)
+  {
+    insert_at_head(&st->head, (int)i);
+  }
+  return st;
+}
+
+static void list_teardown(void *state)
+{
+  ListState *st = state;
+  destroy_list(&st->head);
+  free(st);
+}
+
+static void run_list_insert_head(void *state, size_t size)
+{
+  ListState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    insert_at_head(&st->head, (int)i);
+  }
+}
+
+static void run_list_insert_tail(void *state, size_t size)
+{
+  ListState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    insert_at_tail(&st->head, (int)i);
+  }
+}
+
+static void run_list_insert_index(void *state, size_t size)
+{
+  ListState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    insert_at_index(&st->head, (int)i, (int)(i / 2)); // Always the middle
+  }
+}
+
+static void run_list_delete_head(void *state, size_t size)
+{
+  ListState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    delete_at_head(&st->head, NULL);
+  }
+}
+
+static void run_list_delete_tail(void *state, size_t size)
+{
+  ListState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    delete_at_tail(&st->head, NULL);
+  }
+}
+
+static void run_list_delete_index(void *state, size_t size)
+{
+  ListState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    delete_at_index(&st->head, (int)((size - i - 1) / 2), NULL);
+  }
+}
+
+static void run_destroy_list(void *state, size_t size)
+{
+  ListState *st = state;
+  (void)size;
+  destroy_list(&st->head);
+}
+
+// size random values, as an array and as a list built from it
+typedef struct
+{
+  Node *head;
+  int *values;
+} ListBulkState;
+
+static void list_bulk_teardown(void *state)
+{
+  ListBulkState *st = state;
+  destroy_list(&st->head);
+  free(st->values);
+  free(st);
+}
+
+static void *list_values_setup(size_t size)
+{
+  ListBulkState *st = calloc(1, sizeof(ListBulkState));
+  if (!st)
+    return NULL;
+  st->values = malloc(sizeof(int) * (size > 0 ? size : 1));
+  if (!st->values)
+  {
+    free(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < size; i++)
+    st->values[i] = (int)bench_rand();
+  return st;
+}
+
+static void *list_bulk_setup(size_t size)
+{
+  ListBulkState *st = list_values_setup(size);
+  if (st && !list_from_array(&st->head, st->values, size))
+  {
+    list_bulk_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+// The same values pushed one node at a time
+static void *list_bulk_heads_setup(size_t size)
+{
+  ListBulkState *st = list_values_setup(size);
+  if (!st)
+    return NULL;
+  for (size_t i = 0; i < size; i++)
+    insert_at_head(&st->head, st->values[i]);
+  return st;
+}
+
+static void run_list_from_array(void *state, size_t size)
+{
+  ListBulkState *st = state;
+  list_from_array(&st->head, st->values, size);
+}
+
+static void run_list_to_array(void *state, size_t size)
+{
+  ListBulkState *st = state;
+  bench_sink((long)list_to_array(st->head, st->values, size));
+}
+
+static void run_list_sort(void *state, size_t size)
+{
+  ListBulkState *st = state;
+  (void)size;
+  list_sort(&st->head);
+}
+
+// A list whose nodes sit in random memory order, as after long churn, and
+// its jump table
+typedef struct
+{
+  Node *head;
+  ListJumps *jumps;
+} ListWalkState;
+
+static void list_walk_teardown(void *state)
+{
+  ListWalkState *st = state;
+  destroy_list(&st->head);
+  list_jumps_destroy(st->jumps);
+  free(st);
+}
+
+static void *list_shuffled_setup(size_t size)
+{
+  ListWalkState *st = calloc(1, sizeof(ListWalkState));
+  Node **nodes = malloc(sizeof(Node *) * (size > 0 ? size : 1));
+  if (!st || !nodes)
+  {
+    free(st);
+    free(nodes);
+    return NULL;
+  }
+  size_t n = 0;
+  for (; n < size; n++)
+  {
+    nodes[n] = new_node((int)(bench_rand() % 1000));
+    if (!nodes[n])
+      break;
+  }
+  for (size_t i = n; i > 1; i--)
+  {
+    size_t j = bench_rand() % i;
+    Node *tmp = nodes[i - 1];
+    nodes[i - 1] = nodes[j];
+    nodes[j] = tmp;
+  }
+  for (size_t i = n; i-- > 0;)
+  {
+    nodes[i]->next = st->head;
+    st->head = nodes[i];
+  }
+  free(nodes);
+  st->jumps = list_jumps_build(st->head, 0);
+  if (n < size || !st->jumps)
+  {
+    list_walk_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void run_list_sum(void *state, size_t size)
+{
+  ListWalkState *st = state;
+  (void)size;
+  bench_sink((long)list_sum(st->head, NULL));
+}
+
+static void run_list_sum_jumps(void *state, size_t size)
+{
+  ListWalkState *st = state;
+  (void)size;
+  bench_sink((long)list_sum(st->head, st->jumps));
+}
+
+static void run_destroy_list_shuffled(void *state, size_t size)
+{
+  ListWalkState *st = state;
+  (void)size;
+  destroy_list(&st->head);
+}
+
+static void run_destroy_list_jumps(void *state, size_t size)
+{
+  ListWalkState *st = state;
+  (void)size;
+  destroy_list_jumps(&st->head, st->jumps);
+}
+
+// Same workloads on the indexable skip list
+typedef struct
+{
+  SkipList *list;
+} SkipState;
+
+static void *skip_empty_setup(size_t size)
+{
+  (void)size;
+  SkipState *st = calloc(1, sizeof(SkipState));
+  if (!st)
+    return NULL;
+  st->list = skiplist_new();
+  if (!st->list)
+  {
+    free(st);
+    return NULL;
+  }
+  return st;
+}
+
+static void *skip_filled_setup(size_t size)
+{
+  SkipState *st = skip_empty_setup(size);
+  if (!st)
+    return NULL;
+  for (size_t i = 0; i < size; i++)
+  {
+    skiplist_insert_at_tail(st->list, (int)i);
+  }
+  return st;
+}
+
+static void skip_teardown(void *state)
+{
+  SkipState *st = state;
+  skiplist_destroy(st->list);
+  free(st);
+}
+
+static void run_skip_insert_index(void *state, size_t size)
+{
+  SkipState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    skiplist_insert_at_index(st->list, (int)i, i / 2); // Always the middle
+  }
+}
+
+static void run_skip_delete_index(void *state, size_t size)
+{
+  SkipState *st = state;
+  for (size_t i = 0; i < size; i++)
+  {
+    skiplist_delete_at_index(st->list, (size - i - 1) / 2, NULL);
+  }
+}
+
+static void run_skip_get(void *state, size_t size)
+{
+  SkipState *st = state;
+  long sum = 0;
+  for (size_t q = 0; q < size; q++)
+  {
+    int value = 0;
+    skiplist_get(st->list, bench_rand() % size, &value);
+    sum += value;
+  }
+  bench_sink(sum);
+}
+
+// --- SPSC ring cases ---
+
+typedef struct
+{
+  Ring *ring;
+  size_t count;
+  int batch; // Move RING_BATCH elements per call instead of one
+} RingState;
+
+static RingState *ring_state_new(size_t capacity)
+{
+  RingState *st = calloc(1, sizeof(RingState));
+  if (!st)
+    return NULL;
+  st->ring = ring_new(capacity);
+  if (!st->ring)
+  {
+    free(st);
+    return NULL;
+  }
+  return st;
+}
+
+// Used as a stack: room for all size elements
+static void *ring_stack_setup(size_t size) { return ring_state_new(size); }
+static void *ring_setup(size_t size) { (void)size; return ring_state_new(QUEUE_RING_CAPACITY); }
+
+static void *ring_batch_setup(size_t size)
+{
+  RingState *st = ring_setup(size);
+  if (st)
+    st->batch = 1;
+  return st;
+}
+
+static void ring_teardown(void *state)
+{
+  RingState *st = state;
+  ring_destroy(st->ring);
+  free(st);
+}
+
+static void run_ring_push_pop(void *state, size_t size)
+{
+  RingState *st = state;
+  int value;
+  for (size_t i = 0; i < size; i++)
+    ring_push(st->ring, (int)i);
+  for (size_t i = 0; i < size; i++)
+    ring_pop_back(st->ring, &value);
+}
+
+// CPUs for the SPSC consumer and producer (--pin); -1 leaves placement to the scheduler
+static int ring_pin_cpus[2] = {-1, -1};
+
+// Pins the calling thread to cpu; warns once if the CPU cannot be used
+static void ring_pin(int cpu)
+{
+  static atomic_int warned = 0;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (err != 0 && !atomic_exchange(&warned, 1))
+    fprintf(stderr, "Warning: Cannot pin to CPU %d (%s); running unpinned.\n", cpu, strerror(err));
+}
+
+static void *ring_producer(void *arg)
+{
+  RingState *st = arg;
+  if (ring_pin_cpus[1] >= 0)
+    ring_pin(ring_pin_cpus[1]);
+  int values[RING_BATCH];
+  for (size_t i = 0; i < RING_BATCH; i++)
+    values[i] = (int)i;
+  for (size_t sent = 0; sent < st->count;)
+  {
+    size_t n = 0;
+    if (st->batch)
+      n = ring_push_batch(st->ring, values, st->count - sent < RING_BATCH ? st->count - sent : RING_BATCH);
+    else
+      n = (size_t)ring_push(st->ring, (int)sent);
+    if (n == 0)
+      sched_yield();
+    sent += n;
+  }
+  return NULL;
+}
+
+// One producer thread, the calling thread consumes. With --pin both sides run
+// on fixed cores, so the cross-core handoff is measured the same way each run.
+static void run_ring_spsc(void *state, size_t size)
+{
+  RingState *st = state;
+  pthread_t producer;
+  st->count = size;
+  if (pthread_create(&producer, NULL, ring_producer, st) != 0)
+    return;
+  // Pinned after the create, so the producer does not inherit the consumer's CPU
+  cpu_set_t saved;
+  int pinned = ring_pin_cpus[0] >= 0 && pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0;
+  if (pinned)
+    ring_pin(ring_pin_cpus[0]);
+  int values[RING_BATCH];
+  long sum = 0;
+  for (size_t received = 0; received < size;)
+  {
+    size_t n = st->batch ? ring_pop_batch(st->ring, values, RING_BATCH) : (size_t)ring_pop(st->ring, values);
+    if (n == 0)
+      sched_yield();
+    received += n;
+    sum += values[0];
+  }
+  pthread_join(producer, NULL);
+  if (pinned)
+    pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+  bench_sink(sum);
+}
+
+// --- Concurrent queue cases (size = threads) ---
+
+typedef enum
+{
+  QUEUE_LOCKED, // Node list behind one mutex, the old way of handing off work
+  QUEUE_MS,
+  QUEUE_RING
+} QueueKind;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  Node *head;
+  Node *tail;
+} LockedQueue;
+
+typedef struct
+{
+  QueueKind kind;
+  size_t nqueues;
+  void *queues[MAX_THREADS];
+  atomic_long consumed;
+} QueueState;
+
+// One thread's view of a queue (MS queues need a per-thread handle)
+typedef struct
+{
+  QueueKind kind;
+  void *queue;
+  LfHandle *handle;
+} QueuePort;
+
+static QueuePort queue_open(QueueState *st, size_t i)
+{
+  QueuePort port = {st->kind, st->queues[i], NULL};
+  if (st->kind == QUEUE_MS)
+    port.handle = lfqueue_attach(port.queue);
+  return port;
+}
+
+static void queue_close(QueuePort *port)
+{
+  lfqueue_detach(port->handle);
+}
+
+static int queue_push(QueuePort *port, int value)
+{
+  if (port->kind == QUEUE_MS)
+    return lfqueue_enqueue(port->handle, value);
+  if (port->kind == QUEUE_RING)
+    return lfring_push(port->queue, value);
+  LockedQueue *q = port->queue;
+  Node *node = new_node(value);
+  if (!node)
+    return 0;
+  pthread_mutex_lock(&q->lock);
+  if (q->tail)
+    q->tail->next = node;
+  else
+    q->head = node;
+  q->tail = node;
+  pthread_mutex_unlock(&q->lock);
+  return 1;
+}
+
+static int queue_pop(QueuePort *port, int *out_value)
+{
+  if (port->kind == QUEUE_MS)
+    return lfqueue_dequeue(port->handle, out_value);
+  if (port->kind == QUEUE_RING)
+    return lfring_pop(port->queue, out_value);
+  LockedQueue *q = port->queue;
+  pthread_mutex_lock(&q->lock);
+  Node *node = q->head;
+  if (node)
+  {
+    q->head = node->next;
+    if (!q->head)
+      q->tail = NULL;
+  }
+  pthread_mutex_unlock(&q->lock);
+  if (!node)
+    return 0;
+  *out_value = node->data;
+  free_node(node);
+  return 1;
+}
+
+static void queue_teardown(void *state)
+{
+  QueueState *st = state;
+  for (size_t i = 0; i < st->nqueues; i++)
+  {
+    if (st->kind == QUEUE_MS)
+      lfqueue_destroy(st->queues[i]);
+    else if (st->kind == QUEUE_RING)
+      lfring_destroy(st->queues[i]);
+    else if (st->queues[i])
+    {
+      LockedQueue *q = st->queues[i];
+      destroy_list(&q->head);
+      pthread_mutex_destroy(&q->lock);
+      free(q);
+    }
+  }
+  free(st);
+}
+
+static QueueState *queue_setup(QueueKind kind, size_t nqueues)
+{
+  QueueState *st = calloc(1, sizeof(QueueState));
+  if (!st)
+    return NULL;
+  st->kind = kind;
+  st->nqueues = nqueues;
+  atomic_init(&st->consumed, 0);
+  for (size_t i = 0; i < nqueues; i++)
+  {
+    if (kind == QUEUE_MS)
+      st->queues[i] = lfqueue_new();
+    else if (kind == QUEUE_RING)
+      st->queues[i] = lfring_new(QUEUE_RING_CAPACITY);
+    else if ((st->queues[i] = calloc(1, sizeof(LockedQueue))) != NULL)
+      pthread_mutex_init(&((LockedQueue *)st->queues[i])->lock, NULL);
+    if (!st->queues[i])
+    {
+      queue_teardown(st);
+      return NULL;
+    }
+  }
+  return st;
+}
+
+// Throughput: one shared queue; size = producers + consumers (one thread
+// alternates push and pop when size is 1)
+static void *queue_locked_setup(size_t size) { (void)size; return queue_setup(QUEUE_LOCKED, 1); }
+static void *queue_ms_setup(size_t size) { (void)size; return queue_setup(QUEUE_MS, 1); }
+static void *queue_ring_setup(size_t size) { (void)size; return queue_setup(QUEUE_RING, 1); }
+// Latency: size / 2 pairs bouncing a token over a queue each way
+static size_t queue_pairs(size_t size) { return size < 2 ? 1 : size / 2; }
+static void *pingpong_ms_setup(size_t size) { return queue_setup(QUEUE_MS, 2 * queue_pairs(size)); }
+static void *pingpong_ring_setup(size_t size) { return queue_setup(QUEUE_RING, 2 * queue_pairs(size)); }
+
+typedef enum
+{
+  ROLE_PRODUCER,
+  ROLE_CONSUMER,
+  ROLE_BOTH,
+  ROLE_PING,
+  ROLE_PONG
+} QueueRole;
+
+typedef struct
+{
+  QueueState *st;
+  QueueRole role;
+  size_t count; // Items to push (producers) or rounds (ping-pong)
+  size_t queue; // First queue used
+} QueueWorker;
+
+static void *queue_worker(void *arg)
+{
+  QueueWorker *w = arg;
+  QueueState *st = w->st;
+  QueuePort in = queue_open(st, w->queue);
+  QueuePort out = w->role >= ROLE_PING ? queue_open(st, w->queue + 1) : in;
+  int value;
+  if (w->role == ROLE_PING || w->role == ROLE_PONG)
+  {
+    // Ping sends on the first queue and waits on the second; pong the reverse
+    QueuePort *send = w->role == ROLE_PING ? &in : &out;
+    QueuePort *recv = w->role == ROLE_PING ? &out : &in;
+    for (size_t i = 0; i < w->count; i++)
+    {
+      if (w->role == ROLE_PING)
+        queue_push(send, (int)i);
+      while (!queue_pop(recv, &value))
+        sched_yield();
+      if (w->role == ROLE_PONG)
+        queue_push(send, value);
+    }
+  }
+  else if (w->role == ROLE_BOTH)
+  {
+    for (size_t i = 0; i < w->count; i++)
+    {
+      queue_push(&in, (int)i);
+      queue_pop(&in, &value);
+    }
+  }
+  else if (w->role == ROLE_PRODUCER)
+  {
+    for (size_t i = 0; i < w->count; i++)
+      while (!queue_push(&in, (int)i))
+        sched_yield();
+  }
+  else
+  {
+    while (atomic_load_explicit(&st->consumed, memory_order_relaxed) < QUEUE_ITEMS)
+    {
+      if (queue_pop(&in, &value))
+        atomic_fetch_add_explicit(&st->consumed, 1, memory_order_relaxed);
+      else
+        sched_yield();
+    }
+  }
+  if (out.handle != in.handle)
+    queue_close(&out);
+  queue_close(&in);
+  return NULL;
+}
+
+static void queue_run_workers(QueueWorker *workers, size_t n)
+{
+  pthread_t threads[MAX_THREADS];
+  int started[MAX_THREADS];
+  for (size_t t = 0; t < n; t++)
+    started[t] = pthread_create(&threads[t], NULL, queue_worker, &workers[t]) == 0;
+  for (size_t t = 0; t < n; t++)
+    if (started[t])
+      pthread_join(threads[t], NULL);
+}
+
+static void run_queue_throughput(void *state, size_t size)
+{
+  QueueState *st = state;
+  QueueWorker workers[MAX_THREADS];
+  size_t n = size < 1 ? 1 : size > MAX_THREADS ? MAX_THREADS : size;
+  if (n == 1)
+  {
+    workers[0] = (QueueWorker){st, ROLE_BOTH, QUEUE_ITEMS, 0};
+    queue_run_workers(workers, 1);
+    return;
+  }
+  size_t producers = (n + 1) / 2;
+  for (size_t t = 0; t < n; t++)
+  {
+    size_t share = QUEUE_ITEMS / producers + (t + 1 == producers ? QUEUE_ITEMS % producers : 0);
+    workers[t] = (QueueWorker){st, t < producers ? ROLE_PRODUCER : ROLE_CONSUMER, t < producers ? share : 0, 0};
+  }
+  queue_run_workers(workers, n);
+}
+
+static void run_queue_pingpong(void *state, size_t size)
+{
+  QueueState *st = state;
+  QueueWorker workers[MAX_THREADS];
+  size_t pairs = queue_pairs(size > MAX_THREADS ? MAX_THREADS : size);
+  for (size_t p = 0; p < pairs; p++)
+  {
+    workers[2 * p] = (QueueWorker){st, ROLE_PING, QUEUE_ROUNDS, 2 * p};
+    workers[2 * p + 1] = (QueueWorker){st, ROLE_PONG, QUEUE_ROUNDS, 2 * p};
+  }
+  queue_run_workers(workers, 2 * pairs);
+}
+
+static size_t items_queue(size_t size)
+{
+  (void)size;
+  return QUEUE_ITEMS;
+}
+
+static size_t items_rounds(size_t size)
+{
+  (void)size;
+  return QUEUE_ROUNDS;
+}
+
+// --- Bitset and bitmap cases (size = 64-bit words, i.e. 64 * size positions) ---
+
+typedef struct
+{
+  unsigned char *flags_a; // One byte per position: the per-element baseline
+  unsigned char *flags_b;
+  Bitset *a;
+  Bitset *b;
+  Bitset *dst;
+  BitsetIndex *index;
+  Roaring *ra;
+  Roaring *rb;
+  int *values; // size * 64 values below size * 64, with repeats
+} BitsState;
+
+static void bits_teardown(void *state)
+{
+  BitsState *st = state;
+  free(st->flags_a);
+  free(st->flags_b);
+  bitset_index_destroy(st->index);
+  bitset_destroy(st->a);
+  bitset_destroy(st->b);
+  bitset_destroy(st->dst);
+  roaring_destroy(st->ra);
+  roaring_destroy(st->rb);
+  free(st->values);
+  free(st);
+}
+
+// a and b each hold about a third of the positions
+static void *bits_setup(size_t size)
+{
+  size_t nbits = size * 64;
+  BitsState *st = calloc(1, sizeof(BitsState));
+  if (!st)
+    return NULL;
+  st->flags_a = calloc(nbits, 1);
+  st->flags_b = calloc(nbits, 1);
+  st->a = bitset_new(nbits);
+  st->b = bitset_new(nbits);
+  st->dst = bitset_new(nbits);
+  st->values = malloc(nbits * sizeof(int));
+  if (!st->flags_a || !st->flags_b || !st->a || !st->b || !st->dst || !st->values)
+  {
+    bits_teardown(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < nbits; i++)
+  {
+    if (bench_rand() % 3 == 0)
+    {
+      st->flags_a[i] = 1;
+      bitset_set(st->a, i);
+    }
+    if (bench_rand() % 3 == 0)
+    {
+      st->flags_b[i] = 1;
+      bitset_set(st->b, i);
+    }
+    st->values[i] = (int)(bench_rand() % nbits);
+  }
+  st->index = bitset_index_new(st->a);
+  if (!st->index)
+  {
+    bits_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+// Roaring bitmaps of n random values below limit each
+static void *roaring_pair_setup(size_t n, size_t limit)
+{
+  BitsState *st = calloc(1, sizeof(BitsState));
+  if (!st)
+    return NULL;
+  st->ra = roaring_new();
+  st->rb = roaring_new();
+  if (!st->ra || !st->rb)
+  {
+    bits_teardown(st);
+    return NULL;
+  }
+  for (size_t i = 0; i < n; i++)
+  {
+    roaring_add(st->ra, (uint32_t)(bench_rand() % limit));
+    roaring_add(st->rb, (uint32_t)(bench_rand() % limit));
+  }
+  return st;
+}
+
+// One value per 64 positions: array containers
+static void *roaring_sparse_setup(size_t size) { return roaring_pair_setup(size, size * 64); }
+
+// Half the positions: bitmap containers
+static void *roaring_dense_setup(size_t size) { return roaring_pair_setup(size * 32, size * 64); }
+
+static void run_bool_and_count(void *state, size_t size)
+{
+  BitsState *st = state;
+  long count = 0;
+  for (size_t i = 0; i < size * 64; i++)
+    count += st->flags_a[i] && st->flags_b[i];
+  bench_sink(count);
+}
+
+static void run_bitset_and_count(void *state, size_t size)
+{
+  BitsState *st = state;
+  (void)size;
+  bench_sink((long)bitset_op_count(st->a, st->b, BITSET_AND));
+}
+
+static void run_bitset_and(void *state, size_t size)
+{
+  BitsState *st = state;
+  size_t count = 0;
+  (void)size;
+  bitset_op(st->dst, st->a, st->b, BITSET_AND, &count);
+  bench_sink((long)count);
+}
+
+static void run_bitset_count(void *state, size_t size)
+{
+  BitsState *st = state;
+  (void)size;
+  bench_sink((long)bitset_count(st->a));
+}
+
+// size selects of random ranks through the rank directory
+static void run_bitset_index_select(void *state, size_t size)
+{
+  BitsState *st = state;
+  size_t total = bitset_index_rank(st->index, st->a->nbits);
+  long sum = 0;
+  for (size_t i = 0; i < size && total > 0; i++)
+  {
+    size_t pos = 0;
+    bitset_index_select(st->index, (size_t)st->values[i] % total, &pos);
+    sum += (long)pos;
+  }
+  bench_sink(sum);
+}
+
+static void run_roaring_and(void *state, size_t size)
+{
+  BitsState *st = state;
+  (void)size;
+  Roaring *r = roaring_and(st->ra, st->rb);
+  bench_sink((long)roaring_count(r));
+  roaring_destroy(r);
+}
+
+static void run_roaring_or(void *state, size_t size)
+{
+  BitsState *st = state;
+  (void)size;
+  Roaring *r = roaring_or(st->ra, st->rb);
+  bench_sink((long)roaring_count(r));
+  roaring_destroy(r);
+}
+
+// Distinct values among size * 64: a hash set per value, or a bit per value
+static void run_dedup_hashset(void *state, size_t size)
+{
+  BitsState *st = state;
+  IntMap *seen = intmap_new();
+  if (!seen)
+    return;
+  intmap_reserve(seen, size * 64);
+  for (size_t i = 0; i < size * 64; i++)
+    intmap_put(seen, st->values[i], 1);
+  bench_sink((long)intmap_size(seen));
+  intmap_destroy(seen);
+}
+
+static void run_dedup_bitset(void *state, size_t size)
+{
+  BitsState *st = state;
+  bitset_clear_all(st->dst);
+  uint64_t *words = st->dst->words;
+  for (size_t i = 0; i < size * 64; i++)
+    words[st->values[i] / 64] |= 1ULL << (st->values[i] % 64);
+  bench_sink((long)bitset_count(st->dst));
+}
+
+// Positions shared by the sparsity patterns of two random matrices
+typedef struct
+{
+  SparseMat *a;
+  SparseMat *b;
+  Roaring *pa;
+  Roaring *pb;
+  unsigned char *mask;
+} PatternState;
+
+static void pattern_teardown(void *state)
+{
+  PatternState *st = state;
+  sparse_mat_destroy(st->a);
+  sparse_mat_destroy(st->b);
+  roaring_destroy(st->pa);
+  roaring_destroy(st->pb);
+  free(st->mask);
+  free(st);
+}
+
+static Roaring *sparse_pattern(SparseMat *mat)
+{
+  Roaring *r = roaring_new();
+  for (int k = 0; r != NULL && k < mat->nnz; k++)
+    roaring_add(r, (uint32_t)(mat->data[k].row * (size_t)mat->ncols + mat->data[k].col));
+  return r;
+}
+
+static void *pattern_setup(size_t size)
+{
+  PatternState *st = calloc(1, sizeof(PatternState));
+  if (!st)
+    return NULL;
+  st->a = random_sparse((int)size);
+  st->b = random_sparse((int)size);
+  st->mask = malloc(size * size);
+  if (!st->a || !st->b || !st->mask)
+  {
+    pattern_teardown(st);
+    return NULL;
+  }
+  st->pa = sparse_pattern(st->a);
+  st->pb = sparse_pattern(st->b);
+  if (!st->pa || !st->pb)
+  {
+    pattern_teardown(st);
+    return NULL;
+  }
+  return st;
+}
+
+// Per-element: stamp a's positions into a dense mask, then probe b's
+static void run_pattern_overlap_mask(void *state, size_t size)
+{
+  PatternState *st = state;
+  memset(st->mask, 0, size * size);
+  for (int k = 0; k < st->a->nnz; k++)
+    st->mask[st->a->data[k].row * size + st->a->data[k].col] = 1;
+  long count = 0;
+  for (int k = 0; k < st->b->nnz; k++)
+  {
+    unsigned char *cell = &st->mask[st->b->data[k].row * size + st->b->data[k].col];
+    count += *cell;
+    *cell = 0; // Count repeated coordinates once
+  }
+  bench_sink(count);
+}
+
+static void run_pattern_overlap_roaring(void *state, size_t size)
+{
+  PatternState *st = state;
+  (void)size;
+  bench_sink((long)roaring_and_count(st->pa, st->pb));
+}
+
+// --- Parsing and line input cases ---
+
+typedef struct
+{
+  char **strings;
+  size_t count;
+} ParseState;
+
+static void parse_teardown(void *state)
+{
+  ParseState *st = state;
+  for (size_t i = 0; i < st->count; i++)
+  {
+    free(st->strings[i]);
+  }
+  free(st->strings);
+  free(st);
+}
+
+static void *parse_setup(size_t size)
+{
+  ParseState *st = malloc(sizeof(ParseState));
+  if (!st)
+    return NULL;
+  st->strings = malloc(sizeof(char *) * size);
+  if (!st->strings)
+  {
+    free(st);
+    return NULL;
+  }
+  st->count = 0; // Strings allocated so far, for cleanup on failure
+  for (size_t i = 0; i < size; i++)
+  {
+    st->strings[i] = malloc(16);
+    if (!st->strings[i])
+    {
+      parse_teardown(st);
+      return NULL;
+    }
+    st->count++;
+    // Spread over the whole int range; widen first so the subtraction cannot overflow
+    snprintf(st->strings[i], 16, "%lld", (long long)bench_rand() - 2147483648LL);
+  }
+  return st;
+}
+
+static void run_parse_to_int(void *state, size_t size)
+{
+  ParseState *st = state;
+  long sum = 0;
+  for (size_t i = 0; i < size; i++)
+  {
+    Result r = parse_to_int(st->strings[i]);
+    if (r.status == OK)
+      sum += *(int *)r.data.ok;
+    destroy_result(&r);
+  }
+  bench_sink(sum);
+}
+
+// Redirects stdin to a temporary file of `size` integer lines
+static void *read_line_setup(size_t size)
+{
+  FILE *tmp = tmpfile();
+  if (!tmp)
+    return NULL;
+  for (size_t i = 0; i < size; i++)
+  {
+    fprintf(tmp, "%d\n", (int)bench_rand());
+  }
+  fflush(tmp);
+  if (dup2(fileno(tmp), STDIN_FILENO) < 0)
+  {
+    fclose(tmp);
+    return NULL;
+  }
+  fclose(tmp);
+  clearerr(stdin);
+  fseek(stdin, 0, SEEK_SET);
+  return String_new(16);
+}
+
+static void read_line_teardown(void *state)
+{
+  String_destroy(state);
+}
+
+static void run_string_read_line(void *state, size_t size)
+{
+  String *s = state;
+  long sum = 0;
+  for (size_t i = 0; i < size; i++)
+  {
+    Result r = String_read_line(s);
+    if (r.status == OK)
+      sum += (long)s->length;
+  }
+  bench_sink(sum);
+}
+
+// --- Driver ---
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [--warmup N] [--reps N] [--filter NAME] [--json FILE|-]\n"
+          "          [--mat-sizes A,B,..] [--sizes A,B,..] [--small-sizes A,B,..] [--threads A,B,..]\n"
+          "          [--pin C,P]\n"
+          "  --mat-sizes    matrix dimensions for dense and sparse cases (default 32,64,128)\n"
+          "  --sizes        element counts for linear-time cases (default 1000,10000,100000)\n"
+          "  --small-sizes  element counts for quadratic cases (default 100,1000,4000)\n"
+          "  --threads      thread counts for concurrent queue cases (default 1,2,4,16,64, at most 64)\n"
+          "  --pin C,P      pin the ring_spsc consumer to CPU C and its producer to CPU P\n"
+          "Set LAB_PERF=1 (or LAB_PERF=FILE) to also collect hardware counters per case.\n",
+          prog);
+}
+
+int main(int argc, char **argv)
+{
+  BenchConfig cfg = {.warmup = 2, .reps = 11, .filter = NULL, .json = NULL};
+  size_t mat_sizes[MAX_SIZES] = {32, 64, 128};
+  size_t sizes[MAX_SIZES] = {1000, 10000, 100000};
+  size_t small_sizes[MAX_SIZES] = {100, 1000, 4000};
+  size_t thread_counts[MAX_SIZES] = {1, 2, 4, 16, 64};
+  size_t n_mat = 3, n_sizes = 3, n_small = 3, n_threads = 5;
+  const char *json_path = NULL;
+
+  perf_init(); // LAB_PERF=1 adds hardware counters per case and size
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (val == NULL)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    if (strcmp(arg, "--warmup") == 0)
+      cfg.warmup = atoi(val);
+    else if (strcmp(arg, "--reps") == 0)
+      cfg.reps = atoi(val);
+    else if (strcmp(arg, "--filter") == 0)
+      cfg.filter = val;
+    else if (strcmp(arg, "--json") == 0)
+      json_path = val;
+    else if (strcmp(arg, "--mat-sizes") == 0)
+      n_mat = bench_parse_sizes(val, mat_sizes, MAX_SIZES);
+    else if (strcmp(arg, "--sizes") == 0)
+      n_sizes = bench_parse_sizes(val, sizes, MAX_SIZES);
+    else if (strcmp(arg, "--small-sizes") == 0)
+      n_small = bench_parse_sizes(val, small_sizes, MAX_SIZES);
+    else if (strcmp(arg, "--threads") == 0)
+      n_threads = bench_parse_sizes(val, thread_counts, MAX_SIZES);
+    else if (strcmp(arg, "--pin") == 0)
+    {
+      char extra;
+      if (sscanf(val, "%d,%d%c", &ring_pin_cpus[0], &ring_pin_cpus[1], &extra) != 2 || ring_pin_cpus[0] < 0 ||
+          ring_pin_cpus[1] < 0 || ring_pin_cpus[0] >= CPU_SETSIZE || ring_pin_cpus[1] >= CPU_SETSIZE)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    if (n_mat == 0 || n_sizes == 0 || n_small == 0 || n_threads == 0 || cfg.reps < 1 || cfg.warmup < 0)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    i++;
+  }
+
+  if (json_path != NULL)
+  {
+    cfg.json = (strcmp(json_path, "-") == 0) ? stdout : fopen(json_path, "w");
+    if (cfg.json == NULL)
+    {
+      fprintf(stderr, "Error: Cannot open '%s' for JSON output.\n", json_path);
+      return 1;
+    }
+  }
+
+  BenchSuite *suite = bench_suite_new(cfg);
+  if (!suite)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for benchmark suite.\n");
+    return 1;
+  }
+
+  const BenchCase mat_cases[] = {
+      {"mat_add", mat_setup, run_mat_add, mat_teardown, items_square},
+      {"mat_mult", mat_setup, run_mat_mult, mat_teardown, items_cube},
+      {"mat_mult_blocked", mat_setup, run_mat_mult_blocked, mat_teardown, items_cube},
+      {"mat_mult_strassen", mat_setup, run_mat_mult_strassen, mat_teardown, items_cube},
+      {"mat_mult_transposed", mat_transposed_setup, run_mat_mult_transposed, mat_teardown, items_cube},
+      {"mat_add_chain", mat_setup, run_mat_add_chain, mat_teardown, items_square},
+      {"expr_add_chain", mat_setup, run_expr_add_chain, mat_teardown, items_square},
+      {"expr_gemm_add", mat_setup, run_expr_gemm_add, mat_teardown, items_cube},
+      {"tmat_mult_i8", tmat_setup, run_tmat_mult_i8, tmat_teardown, items_cube},
+      {"tmat_mult_i16", tmat_setup, run_tmat_mult_i16, tmat_teardown, items_cube},
+      {"tmat_mult_f32", tmat_setup, run_tmat_mult_f32, tmat_teardown, items_cube},
+      {"mat_mult_exact", tmat_setup, run_mat_mult_exact, tmat_teardown, items_cube},
+      {"chain_written_order", chain_setup, run_chain_written_order, chain_teardown, items_square},
+      {"chain_planned", chain_setup, run_chain_planned, chain_teardown, items_square},
+      {"mat_transpose", mat_setup, run_mat_transpose, mat_teardown, items_square},
+      {"mat_transpose_inplace", mat_setup, run_mat_transpose_inplace, mat_teardown, items_square},
+      {"mat_write_tsv", mat_setup, run_mat_write, mat_teardown, items_square},
+      {"mat_snapshot_copy", mat_setup, run_mat_snapshot_copy, mat_teardown, NULL},
+      {"cow_mat_snapshot", cow_setup, run_cow_snapshot, cow_teardown, NULL},
+      {"sparse_build", sparse_empty_setup, run_sparse_build, sparse_teardown, items_sparse_nnz},
+      {"sparse_get", sparse_filled_setup, run_sparse_get, sparse_teardown, NULL},
+      {"sparse_write_tsv", sparse_filled_setup, run_sparse_write, sparse_teardown, items_square},
+      {"sparse_to_csr", sparse_filled_setup, run_sparse_to_csr, sparse_teardown, items_sparse_nnz},
+      {"csr_transpose", sparse_csr_setup, run_csr_transpose, sparse_teardown, items_sparse_nnz},
+      {"csr_add", sparse_csr_setup, run_csr_add, sparse_teardown, items_sparse_nnz},
+      {"spmv_csr", spmv_uniform_setup, run_spmv_csr, spmv_teardown, items_sparse_nnz},
+      {"spmv_tuned", spmv_uniform_setup, run_spmv_tuned, spmv_teardown, items_sparse_nnz},
+      {"spmv_csr_powerlaw", spmv_powerlaw_setup, run_spmv_csr, spmv_teardown, NULL},
+      {"spmv_tuned_powerlaw", spmv_powerlaw_setup, run_spmv_tuned, spmv_teardown, NULL},
+      {"reorder_rcm_grid", grid_setup, run_reorder_rcm, grid_teardown, items_square},
+      {"spmv_shuffled_grid", grid_setup, run_spmv_shuffled, grid_teardown, items_square},
+      {"spmv_rcm_grid", grid_setup, run_spmv_rcm, grid_teardown, items_square},
+      {"dyn_sparse_set", dyn_setup, run_dyn_set, dyn_teardown, NULL},
+      {"dyn_sparse_set_compact", dyn_setup, run_dyn_set_compact, dyn_teardown, NULL},
+      {"dyn_sparse_spmv", dyn_setup, run_dyn_spmv, dyn_teardown, items_sparse_nnz},
+      {"sparse_to_mat", sparse_filled_setup, run_sparse_to_mat, sparse_teardown, items_square},
+      {"sparse_pattern_overlap_mask", pattern_setup, run_pattern_overlap_mask, pattern_teardown, items_square},
+      {"sparse_pattern_overlap_roaring", pattern_setup, run_pattern_overlap_roaring, pattern_teardown, items_square},
+  };
+  const BenchCase linear_cases[] = {
+      {"vec_append", vec_empty_setup, run_vec_append, vec_teardown, NULL},
+      {"segvec_append", segvec_empty_setup, run_segvec_append, segvec_teardown, NULL},
+      {"segvec_append_batch", segvec_empty_setup, run_segvec_append_batch, segvec_teardown, NULL},
+      {"get_index", vec_filled_setup, run_get_index, vec_teardown, items_get_index},
+      {"intmap_lookup", lookup_setup, run_intmap_lookup, lookup_teardown, NULL},
+      {"hashset_lookup", lookup_setup, run_hashset_lookup, lookup_teardown, NULL},
+      {"hashset_string_lookup", lookup_setup, run_hashset_string_lookup, lookup_teardown, NULL},
+      {"intmap_put", intmap_empty_setup, run_intmap_put, intmap_teardown, NULL},
+      {"stack_push_pop", stack_empty_setup, run_stack_push_pop, stack_teardown, items_double},
+      {"stack_peek", stack_filled_setup, run_stack_peek, stack_teardown, NULL},
+      {"pstack_versions", stack_versions_setup, run_pstack_versions, stack_versions_teardown, NULL},
+      {"ring_push_pop", ring_stack_setup, run_ring_push_pop, ring_teardown, items_double},
+      {"ring_spsc", ring_setup, run_ring_spsc, ring_teardown, NULL},
+      {"ring_spsc_batch", ring_batch_setup, run_ring_spsc, ring_teardown, NULL},
+      {"list_insert_head", list_empty_setup, run_list_insert_head, list_teardown, NULL},
+      {"list_delete_head", list_filled_setup, run_list_delete_head, list_teardown, NULL},
+      {"destroy_list", list_filled_setup, run_destroy_list, list_teardown, NULL},
+      {"list_from_array", list_values_setup, run_list_from_array, list_bulk_teardown, NULL},
+      {"list_to_array", list_bulk_setup, run_list_to_array, list_bulk_teardown, NULL},
+      {"list_sort", list_bulk_setup, run_list_sort, list_bulk_teardown, NULL},
+      {"list_sort_scattered", list_bulk_heads_setup, run_list_sort, list_bulk_teardown, NULL},
+      {"list_sum_shuffled", list_shuffled_setup, run_list_sum, list_walk_teardown, NULL},
+      {"list_sum_jumps_shuffled", list_shuffled_setup, run_list_sum_jumps, list_walk_teardown, NULL},
+      {"destroy_list_shuffled", list_shuffled_setup, run_destroy_list_shuffled, list_walk_teardown, NULL},
+      {"destroy_list_jumps_shuffled", list_shuffled_setup, run_destroy_list_jumps, list_walk_teardown, NULL},
+      {"skiplist_insert_index", skip_empty_setup, run_skip_insert_index, skip_teardown, NULL},
+      {"skiplist_delete_index", skip_filled_setup, run_skip_delete_index, skip_teardown, NULL},
+      {"skiplist_get", skip_filled_setup, run_skip_get, skip_teardown, NULL},
+      {"bool_and_count", bits_setup, run_bool_and_count, bits_teardown, NULL},
+      {"bitset_and_count", bits_setup, run_bitset_and_count, bits_teardown, NULL},
+      {"bitset_and", bits_setup, run_bitset_and, bits_teardown, NULL},
+      {"bitset_count", bits_setup, run_bitset_count, bits_teardown, NULL},
+      {"bitset_index_select", bits_setup, run_bitset_index_select, bits_teardown, NULL},
+      {"roaring_and_sparse", roaring_sparse_setup, run_roaring_and, bits_teardown, NULL},
+      {"roaring_or_dense", roaring_dense_setup, run_roaring_or, bits_teardown, NULL},
+      {"dedup_hashset", bits_setup, run_dedup_hashset, bits_teardown, NULL},
+      {"dedup_bitset", bits_setup, run_dedup_bitset, bits_teardown, NULL},
+      {"smallgemm_4x4", small4_setup, run_smallgemm, small_teardown, NULL},
+      {"smallgemm_16x16", small16_setup, run_smallgemm, small_teardown, NULL},
+      {"mat_mult_4x4_each", small4_setup, run_mat_mult_each, small_teardown, NULL},
+      {"parse_to_int", parse_setup, run_parse_to_int, parse_teardown, NULL},
+      {"String_read_line", read_line_setup, run_string_read_line, read_line_teardown, NULL},
+  };
+  const BenchCase quadratic_cases[] = {
+      {"lookup_linear_scan", lookup_setup, run_lookup_linear_scan, lookup_teardown, NULL},
+      {"stack_versions_clone", stack_versions_setup, run_stack_versions_clone, stack_versions_teardown, NULL},
+      {"list_insert_tail", list_empty_setup, run_list_insert_tail, list_teardown, NULL},
+      {"list_insert_index", list_empty_setup, run_list_insert_index, list_teardown, NULL},
+      {"list_delete_tail", list_filled_setup, run_list_delete_tail, list_teardown, NULL},
+      {"list_delete_index", list_filled_setup, run_list_delete_index, list_teardown, NULL},
+  };
+  const BenchCase thread_cases[] = {
+      {"queue_locked_list", queue_locked_setup, run_queue_throughput, queue_teardown, items_queue},
+      {"queue_lockfree_ms", queue_ms_setup, run_queue_throughput, queue_teardown, items_queue},
+      {"queue_lockfree_ring", queue_ring_setup, run_queue_throughput, queue_teardown, items_queue},
+      {"queue_pingpong_ms", pingpong_ms_setup, run_queue_pingpong, queue_teardown, items_rounds},
+      {"queue_pingpong_ring", pingpong_ring_setup, run_queue_pingpong, queue_teardown, items_rounds},
+      {"segvec_append_threads", segvec_empty_setup, run_segvec_append_threads, segvec_teardown, items_queue},
+  };
+
+  int ok = 1;
+  for (size_t i = 0; i < sizeof(mat_cases) / sizeof(mat_cases[0]); i++)
+    ok &= bench_run(suite, &mat_cases[i], mat_sizes, n_mat);
+  for (size_t i = 0; i < sizeof(linear_cases) / sizeof(linear_cases[0]); i++)
+    ok &= bench_run(suite, &linear_cases[i], sizes, n_sizes);
+  for (size_t i = 0; i < sizeof(quadratic_cases) / sizeof(quadratic_cases[0]); i++)
+    ok &= bench_run(suite, &quadratic_cases[i], small_sizes, n_small);
+  for (size_t i = 0; i < sizeof(thread_cases) / sizeof(thread_cases[0]); i++)
+    ok &= bench_run(suite, &thread_cases[i], thread_counts, n_threads);
+
+  bench_suite_report(suite);
+  bench_suite_destroy(suite);
+  if (cfg.json != NULL && cfg.json != stdout)
+    fclose(cfg.json);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#define _POSIX_C_SOURCE 200809L
+#include "harness.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../perf/perf.h"
+
+static volatile long bench_sink_value;
+
+// monotonic wall-clock time in nanoseconds
+double bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+void bench_sink(long value)
+{
+  bench_sink_value += value;
+}
+
+// parses a comma separated list of positive sizes ("64,128,256")
+int bench_parse_sizes(const char *arg, size_t *out, size_t max)
+{
+  size_t n = 0;
+  const char *p = arg;
+  while (*p != '\0')
+  {
+    char *end;
+    unsigned long long v = strtoull(p, &end, 10);
+    if (end == p || v == 0 || n >= max)
+      return 0;
+    out[n++] = (size_t)v;
+    if (*end == ',')
+      end++;
+    else if (*end != '\0')
+      return 0;
+    p = end;
+  }
+  return (int)n;
+}
+
+BenchSuite *bench_suite_new(BenchConfig config)
+{
+  BenchSuite *suite = malloc(sizeof(BenchSuite));
+  if (!suite)
+    return NULL;
+  suite->config = config;
+  suite->length = 0;
+  suite->capacity = 16;
+  suite->results = malloc(sizeof(BenchResult) * suite->capacity);
+  if (!suite->results)
+  {
+    free(suite);
+    return NULL;
+  }
+  return suite;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static int bench_push_result(BenchSuite *suite, BenchResult r)
+{
+  if (suite->length >= suite->capacity)
+  {
+    size_t new_capacity = suite->capacity * 2;
+    BenchResult *new_results = realloc(suite->results, sizeof(BenchResult) * new_capacity);
+    if (!new_results)
+      return 0;
+    suite->results = new_results;
+    suite->capacity = new_capacity;
+  }
+  suite->results[suite->length++] = r;
+  return 1;
+}
+
+// one untimed setup, timed body and untimed teardown; returns elapsed ns or -1
+static double bench_once(const BenchCase *bc, size_t size)
+{
+  void *state = bc->setup ? bc->setup(size) : NULL;
+  if (bc->setup && state == NULL)
+    return -1.0;
+  // Counters bracket the timed body so their reads stay out of the wall-clock sample
+  char region_name[64];
+  PerfScope scope;
+  snprintf(region_name, sizeof(region_name), "%s/%zu", bc->name, size);
+  perf_begin(&scope, region_name);
+  double t0 = bench_now_ns();
+  bc->run(state, size);
+  double t1 = bench_now_ns();
+  perf_end(&scope);
+  if (bc->teardown)
+    bc->teardown(state);
+  return t1 - t0;
+}
+
+// runs a case for every size: warmup, then reps timed runs summarised as min/median/p99
+// Returns 1 on success, 0 on failure (setup or allocation error).
+int bench_run(BenchSuite *suite, const BenchCase *bc, const size_t *sizes, size_t nsizes)
+{
+  const BenchConfig *cfg = &suite->config;
+  if (cfg->filter != NULL && strstr(bc->name, cfg->filter) == NULL)
+    return 1;
+
+  int reps = cfg->reps > 0 ? cfg->reps : 1;
+  double *samples = malloc(sizeof(double) * reps);
+  if (!samples)
+    return 0;
+
+  for (size_t s = 0; s < nsizes; s++)
+  {
+    size_t size = sizes[s];
+    for (int w = 0; w < cfg->warmup; w++)
+    {
+      if (bench_once(bc, size) < 0)
+        goto fail;
+    }
+    double sum = 0.0;
+    for (int r = 0; r < reps; r++)
+    {
+      samples[r] = bench_once(bc, size);
+      if (samples[r] < 0)
+        goto fail;
+      sum += samples[r];
+    }
+    qsort(samples, reps, sizeof(double), compare_double);
+
+    size_t p99_rank = (size_t)((reps * 99 + 99) / 100); // ceil(0.99 * reps), nearest-rank
+    BenchResult res = {
+        .name = bc->name,
+        .size = size,
+        .items = bc->items ? bc->items(size) : size,
+        .reps = reps,
+        .min_ns = samples[0],
+        .median_ns = (reps % 2) ? samples[reps / 2] : (samples[reps / 2 - 1] + samples[reps / 2]) / 2.0,
+        .p99_ns = samples[p99_rank - 1],
+        .mean_ns = sum / reps,
+        .max_ns = samples[reps - 1],
+    };
+    if (!bench_push_result(suite, res))
+      goto fail;
+
+    // Human-readable progress goes to stderr when the JSON document owns stdout
+    FILE *log = (cfg->json == stdout) ? stderr : stdout;
+    double per_item = res.items ? res.median_ns / (double)res.items : 0.0;
+    fprintf(log, "%-28s size=%-9zu median=%12.0f ns  p99=%12.0f ns  %8.2f ns/item\n",
+            res.name, res.size, res.median_ns, res.p99_ns, per_item);
+    fflush(log);
+  }
+  free(samples);
+  return 1;
+
+fail:
+  fprintf(stderr, "Error: benchmark '%s' failed during setup.\n", bc->name);
+  free(samples);
+  return 0;
+}
+
+// writes all collected results as a JSON document to the configured stream
+void bench_suite_report(BenchSuite *suite)
+{
+  FILE *out = suite->config.json;
+  if (out == NULL)
+    return;
+  fprintf(out, "{\n  \"warmup\": %d,\n  \"reps\": %d,\n  \"results\": [\n",
+          suite->config.warmup, suite->config.reps);
+  for (size_t i = 0; i < suite->length; i++)
+  {
+    BenchResult *r = &suite->results[i];
+    double items_per_sec = r->median_ns > 0 ? (double)r->items * 1e9 / r->median_ns : 0.0;
+    fprintf(out, "    {\"name\": ");
+    perf_json_string(out, r->name);
+    fprintf(out,
+            ", \"size\": %zu, \"items\": %zu, \"reps\": %d, "
+            "\"min_ns\": %.0f, \"median_ns\": %.0f, \"p99_ns\": %.0f, \"mean_ns\": %.1f, "
+            "\"max_ns\": %.0f, \"items_per_sec\": %.1f}%s\n",
+            r->size, r->items, r->reps, r->min_ns, r->median_ns, r->p99_ns,
+            r->mean_ns, r->max_ns, items_per_sec, (i + 1 < suite->length) ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  fflush(out);
+}
+
+void bench_suite_destroy(BenchSuite *suite)
+{
+  if (suite)
+  {
+    free(suite->results);
+    free(suite);
+  }
+}
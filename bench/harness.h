@@ -0,0 +1,58 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <stddef.h> // for size_t
+#include <stdio.h>
+
+// A benchmark case: setup builds fresh state (untimed), run is the timed body,
+// teardown releases the state (untimed). setup and teardown may be NULL.
+typedef struct
+{
+  const char *name;
+  void *(*setup)(size_t size);
+  void (*run)(void *state, size_t size);
+  void (*teardown)(void *state);
+  size_t (*items)(size_t size); // work items per run, for throughput (NULL = size)
+} BenchCase;
+
+typedef struct
+{
+  int warmup;          // untimed runs before measuring
+  int reps;            // timed runs per case and size
+  const char *filter;  // only run cases whose name contains this (NULL = all)
+  FILE *json;          // machine-readable output (NULL = none)
+} BenchConfig;
+
+typedef struct
+{
+  const char *name;
+  size_t size;
+  size_t items;
+  int reps;
+  double min_ns;
+  double median_ns;
+  double p99_ns;
+  double mean_ns;
+  double max_ns;
+} BenchResult;
+
+typedef struct
+{
+  BenchConfig config;
+  BenchResult *results;
+  size_t length;
+  size_t capacity;
+} BenchSuite;
+
+BenchSuite *bench_suite_new(BenchConfig config);
+int bench_run(BenchSuite *suite, const BenchCase *bc, const size_t *sizes, size_t nsizes);
+void bench_suite_report(BenchSuite *suite);
+void bench_suite_destroy(BenchSuite *suite);
+
+double bench_now_ns(void);
+int bench_parse_sizes(const char *arg, size_t *out, size_t max); // Returns number of sizes parsed, 0 on error
+
+// Keeps a computed value alive so the optimizer cannot drop the timed work
+void bench_sink(long value);
+
+#endif // HARNESS_H
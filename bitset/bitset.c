@@ -0,0 +1,451 @@
+#include "bitset.h"
+#include <stdio.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BITSET_HAVE_X86 1
+#endif
+
+#define BITSET_ALIGN 64
+#define BITSET_BLOCK_WORDS 8 // Words per rank directory entry
+
+// --- Word kernels ---
+
+// Without POPCNT (the baseline x86-64 target) __builtin_popcountll is a
+// libgcc call; this is the same bit-parallel sum, inline
+static inline unsigned bitset_popcount(uint64_t w)
+{
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (unsigned)((w * 0x0101010101010101ULL) >> 56);
+}
+
+static inline uint64_t bitset_combine(uint64_t x, uint64_t y, BitsetOp op)
+{
+  switch (op)
+  {
+  case BITSET_AND:
+    return x & y;
+  case BITSET_OR:
+    return x | y;
+  case BITSET_XOR:
+    return x ^ y;
+  default:
+    return x & ~y;
+  }
+}
+
+// One pass combining, storing and counting. The loop invariant switches in
+// bitset_combine and on dst/b are unswitched by the compiler, so each case
+// gets its own straight loop.
+#define BITSET_DEFINE_SCALAR_KERNEL(fn, attr, popcount)                                                \
+  attr static size_t fn(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n, BitsetOp op)    \
+  {                                                                                                    \
+    size_t count = 0;                                                                                  \
+    for (size_t i = 0; i < n; i++)                                                                     \
+    {                                                                                                  \
+      uint64_t w = bitset_combine(a[i], b ? b[i] : 0, op);                                             \
+      if (dst)                                                                                         \
+        dst[i] = w;                                                                                    \
+      count += (size_t)popcount(w);                                                                    \
+    }                                                                                                  \
+    return count;                                                                                      \
+  }
+
+BITSET_DEFINE_SCALAR_KERNEL(bitset_kernel_generic, , bitset_popcount)
+
+#ifdef BITSET_HAVE_X86
+// The build targets baseline x86-64, whose popcount is a bit-twiddling
+// sequence; POPCNT machines get the one-instruction version
+BITSET_DEFINE_SCALAR_KERNEL(bitset_kernel_popcnt, __attribute__((target("popcnt"))), __builtin_popcountll)
+
+__attribute__((target("avx2"))) static inline __m256i bitset_combine256(__m256i x, __m256i y, BitsetOp op)
+{
+  switch (op)
+  {
+  case BITSET_AND:
+    return _mm256_and_si256(x, y);
+  case BITSET_OR:
+    return _mm256_or_si256(x, y);
+  case BITSET_XOR:
+    return _mm256_xor_si256(x, y);
+  default:
+    return _mm256_andnot_si256(y, x);
+  }
+}
+
+// AVX2 has no vector popcount: look up each nibble's count with vpshufb and
+// sum the bytes of every 64-bit lane with vpsadbw
+__attribute__((target("avx2,popcnt"))) static size_t bitset_kernel_avx2(uint64_t *dst, const uint64_t *a,
+                                                                        const uint64_t *b, size_t n, BitsetOp op)
+{
+  const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2,
+                                       2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i y = b ? _mm256_loadu_si256((const __m256i *)(b + i)) : _mm256_setzero_si256();
+    __m256i w = bitset_combine256(x, y, op);
+    if (dst)
+      _mm256_storeu_si256((__m256i *)(dst + i), w);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(w, low));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(w, 4), low));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+  }
+  size_t count = (size_t)(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) + _mm256_extract_epi64(acc, 2) +
+                          _mm256_extract_epi64(acc, 3));
+  for (; i < n; i++)
+  {
+    uint64_t w = bitset_combine(a[i], b ? b[i] : 0, op);
+    if (dst)
+      dst[i] = w;
+    count += (size_t)__builtin_popcountll(w);
+  }
+  return count;
+}
+
+__attribute__((target("avx512f"))) static inline __m512i bitset_combine512(__m512i x, __m512i y, BitsetOp op)
+{
+  switch (op)
+  {
+  case BITSET_AND:
+    return _mm512_and_si512(x, y);
+  case BITSET_OR:
+    return _mm512_or_si512(x, y);
+  case BITSET_XOR:
+    return _mm512_xor_si512(x, y);
+  default:
+    return _mm512_andnot_si512(y, x);
+  }
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt"))) static size_t
+bitset_kernel_avx512(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n, BitsetOp op)
+{
+  __m512i acc = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m512i x = _mm512_loadu_si512(a + i);
+    __m512i y = b ? _mm512_loadu_si512(b + i) : _mm512_setzero_si512();
+    __m512i w = bitset_combine512(x, y, op);
+    if (dst)
+      _mm512_storeu_si512(dst + i, w);
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(w));
+  }
+  size_t count = (size_t)_mm512_reduce_add_epi64(acc);
+  for (; i < n; i++)
+  {
+    uint64_t w = bitset_combine(a[i], b ? b[i] : 0, op);
+    if (dst)
+      dst[i] = w;
+    count += (size_t)__builtin_popcountll(w);
+  }
+  return count;
+}
+
+__attribute__((target("bmi2"))) static unsigned bitset_word_select_bmi2(uint64_t word, unsigned k)
+{
+  return (unsigned)__builtin_ctzll(_pdep_u64(1ULL << k, word));
+}
+#endif
+
+typedef size_t (*BitsetKernel)(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n, BitsetOp op);
+
+static BitsetKernel bitset_kernel(void)
+{
+  static BitsetKernel cached = NULL;
+  if (cached == NULL)
+  {
+    BitsetKernel kernel = bitset_kernel_generic;
+#ifdef BITSET_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vpopcntdq"))
+      kernel = bitset_kernel_avx512;
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+      kernel = bitset_kernel_avx2;
+    else if (__builtin_cpu_supports("popcnt"))
+      kernel = bitset_kernel_popcnt;
+#endif
+    cached = kernel;
+  }
+  return cached;
+}
+
+size_t bitset_words_op(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords, BitsetOp op)
+{
+  return bitset_kernel()(dst, a, b, nwords, op);
+}
+
+unsigned bitset_word_count(uint64_t word)
+{
+  return bitset_popcount(word);
+}
+
+size_t bitset_words_count(const uint64_t *words, size_t nwords)
+{
+  return bitset_kernel()(NULL, words, NULL, nwords, BITSET_OR);
+}
+
+unsigned bitset_word_select(uint64_t word, unsigned k)
+{
+#ifdef BITSET_HAVE_X86
+  static int use_bmi2 = -1;
+  if (use_bmi2 < 0)
+  {
+    __builtin_cpu_init();
+    use_bmi2 = __builtin_cpu_supports("bmi2") != 0;
+  }
+  if (use_bmi2)
+    return bitset_word_select_bmi2(word, k);
+#endif
+  for (unsigned i = 0; i < k; i++)
+    word &= word - 1; // Drop the lowest set bit
+  return (unsigned)__builtin_ctzll(word);
+}
+
+// --- Bitset ---
+
+Bitset *bitset_new(size_t nbits)
+{
+  Bitset *bs = alloc_malloc(sizeof(Bitset), ALLOC_BITSET);
+  if (!bs)
+  {
+    fprintf(stderr, "Memory allocation failed for Bitset struct.\n");
+    return NULL;
+  }
+  bs->nbits = nbits;
+  bs->nwords = (nbits + 63) / 64;
+  bs->block = alloc_calloc(bs->nwords * sizeof(uint64_t) + BITSET_ALIGN, 1, ALLOC_BITSET);
+  if (!bs->block)
+  {
+    fprintf(stderr, "Memory allocation failed for Bitset words (%zu bits).\n", nbits);
+    alloc_free(bs, ALLOC_BITSET);
+    return NULL;
+  }
+  bs->words = (uint64_t *)(((uintptr_t)bs->block + BITSET_ALIGN - 1) & ~(uintptr_t)(BITSET_ALIGN - 1));
+  return bs;
+}
+
+void bitset_destroy(Bitset *bs)
+{
+  if (bs == NULL)
+    return;
+  alloc_free(bs->block, ALLOC_BITSET);
+  alloc_free(bs, ALLOC_BITSET);
+}
+
+void bitset_clear_all(Bitset *bs)
+{
+  if (bs != NULL)
+    memset(bs->words, 0, bs->nwords * sizeof(uint64_t));
+}
+
+int bitset_set(Bitset *bs, size_t pos)
+{
+  if (bs == NULL || pos >= bs->nbits)
+  {
+    fprintf(stderr, "Error: Bit %zu is out of range.\n", pos);
+    return 0;
+  }
+  bs->words[pos / 64] |= 1ULL << (pos % 64);
+  return 1;
+}
+
+int bitset_clear(Bitset *bs, size_t pos)
+{
+  if (bs == NULL || pos >= bs->nbits)
+  {
+    fprintf(stderr, "Error: Bit %zu is out of range.\n", pos);
+    return 0;
+  }
+  bs->words[pos / 64] &= ~(1ULL << (pos % 64));
+  return 1;
+}
+
+int bitset_test(Bitset *bs, size_t pos)
+{
+  if (bs == NULL || pos >= bs->nbits)
+    return 0;
+  return (int)((bs->words[pos / 64] >> (pos % 64)) & 1);
+}
+
+size_t bitset_count(Bitset *bs)
+{
+  return bs ? bitset_words_count(bs->words, bs->nwords) : 0;
+}
+
+int bitset_op(Bitset *dst, Bitset *a, Bitset *b, BitsetOp op, size_t *out_count)
+{
+  if (dst == NULL || a == NULL || b == NULL || a->nbits != b->nbits || dst->nbits != a->nbits)
+  {
+    fprintf(stderr, "Error: Bitset operands must be non-NULL and of the same size.\n");
+    return 0;
+  }
+  size_t count = bitset_words_op(dst->words, a->words, b->words, a->nwords, op);
+  if (out_count != NULL)
+    *out_count = count;
+  return 1;
+}
+
+size_t bitset_op_count(Bitset *a, Bitset *b, BitsetOp op)
+{
+  if (a == NULL || b == NULL || a->nbits != b->nbits)
+  {
+    fprintf(stderr, "Error: Bitset operands must be non-NULL and of the same size.\n");
+    return 0;
+  }
+  return bitset_words_op(NULL, a->words, b->words, a->nwords, op);
+}
+
+size_t bitset_rank(Bitset *bs, size_t pos)
+{
+  if (bs == NULL)
+    return 0;
+  if (pos > bs->nbits)
+    pos = bs->nbits;
+  size_t rank = bitset_words_count(bs->words, pos / 64);
+  if (pos % 64 != 0)
+    rank += (size_t)bitset_popcount(bs->words[pos / 64] & ((1ULL << (pos % 64)) - 1));
+  return rank;
+}
+
+int bitset_select(Bitset *bs, size_t k, size_t *out_pos)
+{
+  if (bs == NULL)
+    return 0;
+  // Count a block at a time with the fast kernel, then find the word
+  for (size_t w = 0; w < bs->nwords; w += BITSET_BLOCK_WORDS)
+  {
+    size_t n = bs->nwords - w < BITSET_BLOCK_WORDS ? bs->nwords - w : BITSET_BLOCK_WORDS;
+    size_t count = bitset_words_count(bs->words + w, n);
+    if (k >= count)
+    {
+      k -= count;
+      continue;
+    }
+    for (;; w++)
+    {
+      size_t c = (size_t)bitset_popcount(bs->words[w]);
+      if (k < c)
+        break;
+      k -= c;
+    }
+    if (out_pos != NULL)
+      *out_pos = w * 64 + bitset_word_select(bs->words[w], (unsigned)k);
+    return 1;
+  }
+  return 0;
+}
+
+size_t bitset_next(Bitset *bs, size_t from)
+{
+  if (bs == NULL || from >= bs->nbits)
+    return bs ? bs->nbits : 0;
+  size_t w = from / 64;
+  uint64_t word = bs->words[w] & (~0ULL << (from % 64));
+  while (word == 0)
+  {
+    if (++w >= bs->nwords)
+      return bs->nbits;
+    word = bs->words[w];
+  }
+  return w * 64 + (size_t)__builtin_ctzll(word);
+}
+
+size_t bitset_to_indices(Bitset *bs, size_t *out)
+{
+  if (bs == NULL)
+    return 0;
+  size_t n = 0;
+  for (size_t w = 0; w < bs->nwords; w++)
+  {
+    for (uint64_t word = bs->words[w]; word != 0; word &= word - 1)
+      out[n++] = w * 64 + (size_t)__builtin_ctzll(word);
+  }
+  return n;
+}
+
+// --- Rank directory ---
+
+BitsetIndex *bitset_index_new(Bitset *bs)
+{
+  if (bs == NULL)
+    return NULL;
+  BitsetIndex *index = alloc_malloc(sizeof(BitsetIndex), ALLOC_BITSET);
+  if (!index)
+  {
+    fprintf(stderr, "Memory allocation failed for BitsetIndex struct.\n");
+    return NULL;
+  }
+  index->bits = bs;
+  index->nblocks = (bs->nwords + BITSET_BLOCK_WORDS - 1) / BITSET_BLOCK_WORDS;
+  index->ranks = alloc_malloc((index->nblocks + 1) * sizeof(uint64_t), ALLOC_BITSET);
+  if (!index->ranks)
+  {
+    fprintf(stderr, "Memory allocation failed for Bitset rank directory (%zu blocks).\n", index->nblocks);
+    alloc_free(index, ALLOC_BITSET);
+    return NULL;
+  }
+  uint64_t total = 0;
+  for (size_t blk = 0; blk < index->nblocks; blk++)
+  {
+    index->ranks[blk] = total;
+    size_t w = blk * BITSET_BLOCK_WORDS;
+    size_t n = bs->nwords - w < BITSET_BLOCK_WORDS ? bs->nwords - w : BITSET_BLOCK_WORDS;
+    total += bitset_words_count(bs->words + w, n);
+  }
+  index->ranks[index->nblocks] = total;
+  return index;
+}
+
+void bitset_index_destroy(BitsetIndex *index)
+{
+  if (index == NULL)
+    return;
+  alloc_free(index->ranks, ALLOC_BITSET);
+  alloc_free(index, ALLOC_BITSET);
+}
+
+size_t bitset_index_rank(BitsetIndex *index, size_t pos)
+{
+  if (index == NULL)
+    return 0;
+  Bitset *bs = index->bits;
+  if (pos >= bs->nbits)
+    return (size_t)index->ranks[index->nblocks];
+  size_t w = pos / 64;
+  size_t rank = (size_t)index->ranks[w / BITSET_BLOCK_WORDS];
+  for (size_t i = w / BITSET_BLOCK_WORDS * BITSET_BLOCK_WORDS; i < w; i++)
+    rank += (size_t)bitset_popcount(bs->words[i]);
+  return rank + (size_t)bitset_popcount(bs->words[w] & ((1ULL << (pos % 64)) - 1));
+}
+
+int bitset_index_select(BitsetIndex *index, size_t k, size_t *out_pos)
+{
+  if (index == NULL || k >= index->ranks[index->nblocks])
+    return 0;
+  // Last block starting at or below k; the halving step compiles to a
+  // conditional move, so random queries cost no mispredictions
+  size_t lo = 0;
+  for (size_t n = index->nblocks; n > 1; n -= n / 2)
+    lo = index->ranks[lo + n / 2] <= k ? lo + n / 2 : lo;
+  k -= (size_t)index->ranks[lo];
+  const uint64_t *words = index->bits->words;
+  size_t w = lo * BITSET_BLOCK_WORDS;
+  for (;; w++)
+  {
+    size_t c = (size_t)bitset_popcount(words[w]);
+    if (k < c)
+      break;
+    k -= c;
+  }
+  if (out_pos != NULL)
+    *out_pos = w * 64 + bitset_word_select(words[w], (unsigned)k);
+  return 1;
+}
@@ -0,0 +1,67 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stddef.h> // for size_t
+#include <stdint.h>
+
+// Dense bitsets over 64-bit words. The bulk operations combine and count a
+// whole word array in one pass, with AVX-512 (VPOPCNTDQ), AVX2 or POPCNT
+// kernels picked at run time, so they run at memory bandwidth instead of
+// a bit at a time.
+typedef enum
+{
+  BITSET_AND,
+  BITSET_OR,
+  BITSET_XOR,
+  BITSET_ANDNOT // a & ~b
+} BitsetOp;
+
+typedef struct
+{
+  uint64_t *words; // nwords words, 64-byte aligned; bits at nbits and above stay zero
+  size_t nbits;
+  size_t nwords;
+  void *block; // Allocation holding words
+} Bitset;
+
+Bitset *bitset_new(size_t nbits); // All bits clear; NULL on error
+void bitset_destroy(Bitset *bs);
+void bitset_clear_all(Bitset *bs);
+int bitset_set(Bitset *bs, size_t pos);   // Returns 1 on success, 0 when pos is out of range
+int bitset_clear(Bitset *bs, size_t pos); // Returns 1 on success, 0 when pos is out of range
+int bitset_test(Bitset *bs, size_t pos);  // 0 when pos is out of range
+size_t bitset_count(Bitset *bs);
+
+// dst = a op b for bitsets of the same size; dst may be a or b. The number
+// of bits set in dst goes to out_count when it is not NULL. 1 on success.
+int bitset_op(Bitset *dst, Bitset *a, Bitset *b, BitsetOp op, size_t *out_count);
+// Bits set in a op b, without storing it (e.g. the overlap of two patterns)
+size_t bitset_op_count(Bitset *a, Bitset *b, BitsetOp op);
+
+size_t bitset_rank(Bitset *bs, size_t pos); // Set bits below pos, O(pos / 64)
+int bitset_select(Bitset *bs, size_t k, size_t *out_pos); // Position of the k-th set bit (from 0); 0 if none
+size_t bitset_next(Bitset *bs, size_t from); // First set bit >= from, or nbits
+size_t bitset_to_indices(Bitset *bs, size_t *out); // Positions in ascending order; returns how many
+
+// Rank directory: counts before every 512-bit block make rank O(1) and
+// select O(log n). It describes the bitset as it was when built.
+typedef struct
+{
+  Bitset *bits;
+  size_t nblocks;
+  uint64_t *ranks; // nblocks + 1 prefix counts
+} BitsetIndex;
+
+BitsetIndex *bitset_index_new(Bitset *bs); // NULL on error
+void bitset_index_destroy(BitsetIndex *index);
+size_t bitset_index_rank(BitsetIndex *index, size_t pos);
+int bitset_index_select(BitsetIndex *index, size_t k, size_t *out_pos);
+
+// Word-array kernels shared with the compressed bitmaps (roaring/).
+// dst may be NULL to only count; b may be NULL to count a alone.
+size_t bitset_words_op(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords, BitsetOp op);
+size_t bitset_words_count(const uint64_t *words, size_t nwords);
+unsigned bitset_word_count(uint64_t word);
+unsigned bitset_word_select(uint64_t word, unsigned k); // Position of the k-th set bit; k < popcount(word)
+
+#endif // BITSET_H
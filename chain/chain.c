@@ -0,0 +1,506 @@
+#include "chain.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../matrix/matrix.h"
+#include "../sparse/sparse.h"
+#include "../gemm/gemm.h"
+#include "../strassen/strassen.h"
+#include "../alloc/alloc.h"
+
+// A factor of one product: a sparse leaf, or a dense view (of a leaf or of an
+// intermediate held in a plan buffer)
+typedef struct
+{
+  SparseMat *sparse;
+  MatView view;
+  int owns_view;
+  ChainBuffer *buffer;
+} ChainFactor;
+
+ChainOperand chain_dense(Mat *mat)
+{
+  ChainOperand op = {mat, NULL};
+  return op;
+}
+
+ChainOperand chain_sparse(SparseMat *mat)
+{
+  ChainOperand op = {NULL, mat};
+  return op;
+}
+
+static int chain_operand_rows(ChainOperand op)
+{
+  return op.dense ? op.dense->nrows : op.sparse->nrows;
+}
+
+static int chain_operand_cols(ChainOperand op)
+{
+  return op.dense ? op.dense->ncols : op.sparse->ncols;
+}
+
+// estimated multiply-adds of (i..k) * (k+1..j); only leaves can be sparse
+static double chain_product_cost(ChainPlan *plan, int i, int k, int j)
+{
+  double p = plan->dims[i], q = plan->dims[k + 1], r = plan->dims[j + 1];
+  if (i == k && plan->nnz[i] > 0)
+    return (double)plan->nnz[i] * r; // Each stored entry scales one row of the right factor
+  if (k + 1 == j && plan->nnz[j] > 0)
+    return p * (double)plan->nnz[j]; // Each stored entry scales one column of the left factor
+  return p * q * r;
+}
+
+ChainPlan *chain_plan_new(ChainOperand *ops, int count)
+{
+  if (ops == NULL || count < 1)
+  {
+    fprintf(stderr, "Error: A matrix chain needs at least one operand.\n");
+    return NULL;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    if ((ops[i].dense == NULL) == (ops[i].sparse == NULL))
+    {
+      fprintf(stderr, "Error: Chain operand %d must be exactly one dense or sparse matrix.\n", i + 1);
+      return NULL;
+    }
+    if (i > 0 && chain_operand_cols(ops[i - 1]) != chain_operand_rows(ops[i]))
+    {
+      fprintf(stderr, "Error: Incompatible matrix dimensions in chain. "
+                      "Operand %d has %d columns but operand %d has %d rows.\n",
+              i, chain_operand_cols(ops[i - 1]), i + 1, chain_operand_rows(ops[i]));
+      return NULL;
+    }
+  }
+
+  ChainPlan *plan = alloc_calloc(1, sizeof(ChainPlan), ALLOC_CHAIN);
+  if (!plan)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for chain plan.\n");
+    return NULL;
+  }
+  size_t cells = (size_t)count * count;
+  plan->count = count;
+  plan->dims = alloc_malloc(sizeof(int) * (count + 1), ALLOC_CHAIN);
+  plan->nnz = alloc_malloc(sizeof(size_t) * count, ALLOC_CHAIN);
+  plan->cost = alloc_malloc(sizeof(double) * cells, ALLOC_CHAIN);
+  plan->split = alloc_malloc(sizeof(int) * cells, ALLOC_CHAIN);
+  plan->buffers = alloc_calloc(count, sizeof(ChainBuffer), ALLOC_CHAIN); // At most count intermediates live at once
+  if (!plan->dims || !plan->nnz || !plan->cost || !plan->split || !plan->buffers)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for chain plan tables.\n");
+    chain_plan_destroy(plan);
+    return NULL;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    plan->dims[i] = chain_operand_rows(ops[i]);
+    plan->nnz[i] = ops[i].sparse ? (size_t)(ops[i].sparse->nnz > 0 ? ops[i].sparse->nnz : 1) : 0;
+  }
+  plan->dims[count] = chain_operand_cols(ops[count - 1]);
+
+  // Classic O(n^3) dynamic programme over chain lengths
+  for (int i = 0; i < count; i++)
+    plan->cost[i * count + i] = 0.0;
+  for (int len = 2; len <= count; len++)
+  {
+    for (int i = 0; i + len - 1 < count; i++)
+    {
+      int j = i + len - 1;
+      double best = -1.0;
+      for (int k = i; k < j; k++)
+      {
+        double c = plan->cost[i * count + k] + plan->cost[(k + 1) * count + j] + chain_product_cost(plan, i, k, j);
+        if (best < 0.0 || c < best)
+        {
+          best = c;
+          plan->split[i * count + j] = k;
+        }
+      }
+      plan->cost[i * count + j] = best;
+    }
+  }
+  return plan;
+}
+
+double chain_plan_cost(ChainPlan *plan)
+{
+  return plan->cost[plan->count - 1];
+}
+
+double chain_plan_left_to_right_cost(ChainPlan *plan)
+{
+  double total = 0.0;
+  for (int j = 1; j < plan->count; j++)
+    total += chain_product_cost(plan, 0, j - 1, j);
+  return total;
+}
+
+static void chain_print_range(ChainPlan *plan, FILE *out, int i, int j)
+{
+  if (i == j)
+  {
+    fprintf(out, "A%d", i + 1);
+    return;
+  }
+  int k = plan->split[i * plan->count + j];
+  fputc('(', out);
+  chain_print_range(plan, out, i, k);
+  fputc(' ', out);
+  chain_print_range(plan, out, k + 1, j);
+  fputc(')', out);
+}
+
+void chain_plan_print(ChainPlan *plan, FILE *out)
+{
+  chain_print_range(plan, out, 0, plan->count - 1);
+  fputc('\n', out);
+}
+
+// Hands out a free buffer of at least rows x cols, preferring the smallest that
+// fits and otherwise growing one; buffers stay with the plan for the next run.
+static ChainBuffer *chain_buffer_acquire(ChainPlan *plan, int rows, int cols, MatView *view)
+{
+  size_t need = (size_t)rows * cols;
+  ChainBuffer *best = NULL, *spare = NULL;
+  for (int b = 0; b < plan->nbuffers; b++)
+  {
+    ChainBuffer *buf = &plan->buffers[b];
+    if (buf->in_use)
+      continue;
+    if (buf->capacity >= need && buf->row_capacity >= (size_t)rows)
+    {
+      if (best == NULL || buf->capacity < best->capacity)
+        best = buf;
+    }
+    else if (spare == NULL || buf->capacity > spare->capacity)
+      spare = buf;
+  }
+  if (best == NULL)
+  {
+    best = spare ? spare : &plan->buffers[plan->nbuffers++];
+    if (best->capacity < need)
+    {
+      int *data = alloc_realloc(best->data, sizeof(int) * need, ALLOC_CHAIN);
+      if (!data)
+        return NULL;
+      best->data = data;
+      best->capacity = need;
+    }
+    if (best->row_capacity < (size_t)rows)
+    {
+      int **row_ptrs = alloc_realloc(best->row_ptrs, sizeof(int *) * rows, ALLOC_CHAIN);
+      if (!row_ptrs)
+        return NULL;
+      best->row_ptrs = row_ptrs;
+      best->row_capacity = rows;
+    }
+  }
+  for (int i = 0; i < rows; i++)
+    best->row_ptrs[i] = best->data + (size_t)i * cols;
+  best->in_use = 1;
+  *view = (MatView){best->row_ptrs, 0, rows, cols};
+  return best;
+}
+
+static void chain_zero(MatView dst)
+{
+  for (int i = 0; i < dst.nrows; i++)
+    memset(dst.rows[i] + dst.col, 0, sizeof(int) * (size_t)dst.ncols);
+}
+
+// An entry tagged with its position, so sorting keeps the first of each coordinate
+typedef struct
+{
+  size_t row;
+  size_t col;
+  size_t index;
+  int value;
+} ChainEntry;
+
+static int chain_entry_cmp(const void *a, const void *b)
+{
+  const ChainEntry *x = a, *y = b;
+  if (x->row != y->row)
+    return x->row < y->row ? -1 : 1;
+  if (x->col != y->col)
+    return x->col < y->col ? -1 : 1;
+  return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+// The products below add every entry they are given, so repeated coordinates
+// are resolved first as in sparse_get: the first stored entry wins. Returns
+// mat itself when it has no repeats, otherwise a row-major copy without them
+// that the caller frees; NULL on error.
+static SparseMat *chain_unique_entries(SparseMat *mat)
+{
+  size_t nnz = (size_t)mat->nnz;
+  ChainEntry *entries = alloc_malloc(sizeof(ChainEntry) * (nnz > 0 ? nnz : 1), ALLOC_CHAIN);
+  if (!entries)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for %zu sparse chain entries.\n", nnz);
+    return NULL;
+  }
+  for (size_t k = 0; k < nnz; k++)
+    entries[k] = (ChainEntry){mat->data[k].row, mat->data[k].col, k, mat->data[k].value};
+  qsort(entries, nnz, sizeof(ChainEntry), chain_entry_cmp);
+  size_t unique = 0;
+  for (size_t k = 0; k < nnz; k++)
+  {
+    if (unique == 0 || entries[k].row != entries[unique - 1].row || entries[k].col != entries[unique - 1].col)
+      entries[unique++] = entries[k];
+  }
+  if (unique == nnz)
+  {
+    alloc_free(entries, ALLOC_CHAIN);
+    return mat;
+  }
+  SparseMat *copy = sparse_new(mat->nrows, mat->ncols);
+  SparseEntry *data = alloc_malloc(sizeof(SparseEntry) * unique, ALLOC_SPARSE);
+  if (!copy || !data)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for %zu sparse chain entries.\n", unique);
+    sparse_mat_destroy(copy);
+    alloc_free(data, ALLOC_SPARSE);
+    alloc_free(entries, ALLOC_CHAIN);
+    return NULL;
+  }
+  for (size_t k = 0; k < unique; k++)
+    data[k] = (SparseEntry){entries[k].row, entries[k].col, entries[k].value};
+  alloc_free(copy->data, ALLOC_SPARSE);
+  copy->data = data;
+  copy->capacity = unique;
+  copy->nnz = (int)unique;
+  alloc_free(entries, ALLOC_CHAIN);
+  return copy;
+}
+
+// dst = sparse as a dense block; entries are unique (see chain_unique_entries)
+static void chain_densify(MatView dst, SparseMat *sparse)
+{
+  chain_zero(dst);
+  for (int e = 0; e < sparse->nnz; e++)
+  {
+    SparseEntry *entry = &sparse->data[e];
+    dst.rows[entry->row][dst.col + entry->col] = entry->value;
+  }
+}
+
+// dst = sparse * b: each entry (r, c, v) adds v * row c of b to row r of dst
+static void chain_sparse_dense(MatView dst, SparseMat *sparse, MatView b)
+{
+  chain_zero(dst);
+  for (int e = 0; e < sparse->nnz; e++)
+  {
+    SparseEntry *entry = &sparse->data[e];
+    unsigned v = (unsigned)entry->value;
+    unsigned *drow = (unsigned *)dst.rows[entry->row] + dst.col;
+    const unsigned *brow = (const unsigned *)b.rows[entry->col] + b.col;
+    for (int j = 0; j < dst.ncols; j++)
+      drow[j] += v * brow[j];
+  }
+}
+
+// dst = a * sparse: each entry (r, c, v) adds v * column r of a to column c of dst
+static void chain_dense_sparse(MatView dst, MatView a, SparseMat *sparse)
+{
+  chain_zero(dst);
+  for (int e = 0; e < sparse->nnz; e++)
+  {
+    SparseEntry *entry = &sparse->data[e];
+    unsigned v = (unsigned)entry->value;
+    for (int i = 0; i < dst.nrows; i++)
+      ((unsigned *)dst.rows[i])[dst.col + entry->col] += v * (unsigned)a.rows[i][a.col + entry->row];
+  }
+}
+
+static int chain_eval(ChainPlan *plan, ChainOperand *ops, int i, int j, MatView dst);
+
+static int chain_factor(ChainPlan *plan, ChainOperand *ops, int i, int j, ChainFactor *f)
+{
+  memset(f, 0, sizeof(ChainFactor));
+  if (i == j && ops[i].sparse)
+  {
+    f->sparse = ops[i].sparse;
+    return 1;
+  }
+  if (i == j)
+  {
+    f->view = mat_view(ops[i].dense);
+    f->owns_view = 1;
+    return f->view.rows != NULL;
+  }
+  f->buffer = chain_buffer_acquire(plan, plan->dims[i], plan->dims[j + 1], &f->view);
+  if (!f->buffer)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for chain intermediate (%dx%d).\n", plan->dims[i],
+            plan->dims[j + 1]);
+    return 0;
+  }
+  return chain_eval(plan, ops, i, j, f->view);
+}
+
+static void chain_factor_release(ChainFactor *f)
+{
+  if (f->owns_view)
+    mat_view_release(f->view);
+  if (f->buffer)
+    f->buffer->in_use = 0;
+}
+
+static int chain_dense_dense(MatView dst, MatView a, MatView b)
+{
+  if (a.nrows < STRASSEN_CROSSOVER || a.ncols < STRASSEN_CROSSOVER || b.ncols < STRASSEN_CROSSOVER)
+  {
+    gemm_blocked(dst, a, b, 0);
+    return 1;
+  }
+  StrassenWorkspace *ws = strassen_workspace_new(a.nrows, a.ncols, b.ncols, STRASSEN_CROSSOVER);
+  int ok = ws && strassen_mult(ws, dst, a, b);
+  strassen_workspace_destroy(ws);
+  return ok;
+}
+
+// computes operands i..j into dst in the planned order
+static int chain_eval(ChainPlan *plan, ChainOperand *ops, int i, int j, MatView dst)
+{
+  if (i == j)
+  {
+    if (ops[i].sparse)
+    {
+      chain_densify(dst, ops[i].sparse);
+      return 1;
+    }
+    MatView src = mat_view(ops[i].dense);
+    if (!src.rows)
+      return 0;
+    for (int r = 0; r < dst.nrows; r++)
+      memcpy(dst.rows[r] + dst.col, src.rows[r], sizeof(int) * (size_t)dst.ncols);
+    mat_view_release(src);
+    return 1;
+  }
+
+  int k = plan->split[i * plan->count + j];
+  ChainFactor left = {0}, right = {0};
+  int ok = chain_factor(plan, ops, i, k, &left);
+  ok = ok && chain_factor(plan, ops, k + 1, j, &right);
+  if (ok && left.sparse && right.sparse)
+  {
+    // Densify the right factor into a scratch buffer, then scale its rows
+    MatView dense;
+    ChainBuffer *buf = chain_buffer_acquire(plan, right.sparse->nrows, right.sparse->ncols, &dense);
+    ok = buf != NULL;
+    if (ok)
+    {
+      chain_densify(dense, right.sparse);
+      chain_sparse_dense(dst, left.sparse, dense);
+      buf->in_use = 0;
+    }
+  }
+  else if (ok && left.sparse)
+    chain_sparse_dense(dst, left.sparse, right.view);
+  else if (ok && right.sparse)
+    chain_dense_sparse(dst, left.view, right.sparse);
+  else if (ok)
+    ok = chain_dense_dense(dst, left.view, right.view);
+  chain_factor_release(&left);
+  chain_factor_release(&right);
+  return ok;
+}
+
+Mat *chain_plan_run(ChainPlan *plan, ChainOperand *ops)
+{
+  if (plan == NULL || ops == NULL)
+  {
+    fprintf(stderr, "Error: Cannot run a NULL chain plan.\n");
+    return NULL;
+  }
+  for (int i = 0; i < plan->count; i++)
+  {
+    if ((ops[i].dense == NULL) == (ops[i].sparse == NULL) || (ops[i].sparse != NULL) != (plan->nnz[i] > 0) ||
+        chain_operand_rows(ops[i]) != plan->dims[i] || chain_operand_cols(ops[i]) != plan->dims[i + 1])
+    {
+      fprintf(stderr, "Error: Chain operand %d does not match the plan.\n", i + 1);
+      return NULL;
+    }
+  }
+  // Evaluate on a copy of the operands whose sparse factors have unique coordinates
+  ChainOperand *unique = alloc_malloc(sizeof(ChainOperand) * plan->count, ALLOC_CHAIN);
+  if (!unique)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for chain operands.\n");
+    return NULL;
+  }
+  int ok = 1;
+  for (int i = 0; i < plan->count; i++)
+  {
+    unique[i] = ops[i];
+    if (ok && ops[i].sparse)
+    {
+      unique[i].sparse = chain_unique_entries(ops[i].sparse);
+      ok = unique[i].sparse != NULL;
+    }
+  }
+  Mat *result = ok ? mat_new(plan->dims[0], plan->dims[plan->count]) : NULL;
+  if (result)
+  {
+    MatView dst = mat_view(result);
+    ok = dst.rows && chain_eval(plan, unique, 0, plan->count - 1, dst);
+    mat_view_release(dst);
+  }
+  for (int i = 0; i < plan->count; i++)
+  {
+    if (unique[i].sparse && unique[i].sparse != ops[i].sparse)
+      sparse_mat_destroy(unique[i].sparse);
+  }
+  alloc_free(unique, ALLOC_CHAIN);
+  if (!result || !ok)
+  {
+    mat_destroy(result);
+    return NULL;
+  }
+  return result;
+}
+
+void chain_plan_destroy(ChainPlan *plan)
+{
+  if (plan == NULL)
+    return;
+  if (plan->buffers)
+  {
+    for (int b = 0; b < plan->nbuffers; b++)
+    {
+      alloc_free(plan->buffers[b].data, ALLOC_CHAIN);
+      alloc_free(plan->buffers[b].row_ptrs, ALLOC_CHAIN);
+    }
+  }
+  alloc_free(plan->dims, ALLOC_CHAIN);
+  alloc_free(plan->nnz, ALLOC_CHAIN);
+  alloc_free(plan->cost, ALLOC_CHAIN);
+  alloc_free(plan->split, ALLOC_CHAIN);
+  alloc_free(plan->buffers, ALLOC_CHAIN);
+  alloc_free(plan, ALLOC_CHAIN);
+}
+
+Mat *mat_chain_mult(Mat **mats, int count)
+{
+  if (mats == NULL || count < 1)
+  {
+    fprintf(stderr, "Error: A matrix chain needs at least one operand.\n");
+    return NULL;
+  }
+  ChainOperand *ops = alloc_malloc(sizeof(ChainOperand) * count, ALLOC_CHAIN);
+  if (!ops)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for chain operands.\n");
+    return NULL;
+  }
+  for (int i = 0; i < count; i++)
+    ops[i] = mats[i] ? chain_dense(mats[i]) : (ChainOperand){NULL, NULL};
+  ChainPlan *plan = chain_plan_new(ops, count);
+  Mat *result = plan ? chain_plan_run(plan, ops) : NULL;
+  chain_plan_destroy(plan);
+  alloc_free(ops, ALLOC_CHAIN);
+  return result;
+}
@@ -0,0 +1,58 @@
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include <stddef.h> // for size_t
+#include <stdio.h>
+#include "../matrix/matrix.h"
+#include "../sparse/sparse.h"
+#include "../gemm/gemm.h"
+
+// One factor of a chain: exactly one of dense/sparse is set
+typedef struct
+{
+  Mat *dense;
+  SparseMat *sparse;
+} ChainOperand;
+
+// Scratch block for an intermediate product, kept by the plan across runs
+typedef struct
+{
+  int *data;
+  size_t capacity; // ints
+  int **row_ptrs;
+  size_t row_capacity;
+  int in_use;
+} ChainBuffer;
+
+// Optimal parenthesization of A1 * A2 * ... * An by dynamic programming on
+// the shapes. Products with a sparse factor are costed by its nnz instead of
+// its full size. A plan can be run any number of times on operands of the
+// same shapes and keeps its intermediate buffers between runs.
+typedef struct
+{
+  int count;
+  int *dims;       // count + 1 boundaries: operand i is dims[i] x dims[i + 1]
+  size_t *nnz;     // Per operand; 0 marks a dense operand
+  double *cost;    // count x count: cheapest multiply-adds for operands i..j
+  int *split;      // count x count: (i..split) * (split+1..j) is optimal
+  ChainBuffer *buffers;
+  int nbuffers;
+} ChainPlan;
+
+ChainOperand chain_dense(Mat *mat);
+ChainOperand chain_sparse(SparseMat *mat);
+
+ChainPlan *chain_plan_new(ChainOperand *ops, int count);
+double chain_plan_cost(ChainPlan *plan);          // Estimated multiply-adds of the optimal order
+double chain_plan_left_to_right_cost(ChainPlan *plan); // Same estimate for ((A1 A2) A3)...
+void chain_plan_print(ChainPlan *plan, FILE *out); // e.g. "((A1 A2) (A3 A4))"
+// Multiplies the chain in the planned order into a new matrix; NULL on error.
+// Repeated coordinates in a sparse operand resolve as in sparse_get: the
+// first stored entry wins.
+Mat *chain_plan_run(ChainPlan *plan, ChainOperand *ops);
+void chain_plan_destroy(ChainPlan *plan);
+
+// One-shot plan and run for an all-dense chain
+Mat *mat_chain_mult(Mat **mats, int count);
+
+#endif // CHAIN_H
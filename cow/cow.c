@@ -0,0 +1,403 @@
+#include "cow.h"
+#include <stdio.h>
+#include <string.h>
+#include "../vector/vector.h"
+#include "../alloc/alloc.h"
+
+static CowChunk *cow_chunk_new(CowVec *vec, int zero)
+{
+  size_t bytes = sizeof(CowChunk) + vec->chunk_elems * vec->elem_size;
+  CowChunk *chunk = zero ? alloc_calloc(1, bytes, ALLOC_VEC) : alloc_malloc(bytes, ALLOC_VEC);
+  if (!chunk)
+  {
+    fprintf(stderr, "Memory allocation failed for copy-on-write chunk (%zu bytes).\n", bytes);
+    return NULL;
+  }
+  atomic_init(&chunk->refs, 1);
+  return chunk;
+}
+
+static void cow_chunk_release(CowChunk *chunk)
+{
+  if (chunk != NULL && atomic_fetch_sub_explicit(&chunk->refs, 1, memory_order_acq_rel) == 1)
+    alloc_free(chunk, ALLOC_VEC);
+}
+
+static CowTable *cow_table_new(size_t capacity)
+{
+  CowTable *table = alloc_malloc(sizeof(CowTable) + sizeof(CowChunk *) * capacity, ALLOC_VEC);
+  if (!table)
+  {
+    fprintf(stderr, "Memory allocation failed for copy-on-write table (%zu chunks).\n", capacity);
+    return NULL;
+  }
+  atomic_init(&table->refs, 1);
+  table->count = 0;
+  table->capacity = capacity;
+  return table;
+}
+
+static void cow_table_release(CowTable *table)
+{
+  if (table == NULL || atomic_fetch_sub_explicit(&table->refs, 1, memory_order_acq_rel) != 1)
+    return;
+  for (size_t i = 0; i < table->count; i++)
+    cow_chunk_release(table->chunks[i]);
+  alloc_free(table, ALLOC_VEC);
+}
+
+// Gives vec a table of its own: a new one pointing at the same chunks
+static int cow_table_unshare(CowVec *vec)
+{
+  CowTable *old = vec->table;
+  if (atomic_load_explicit(&old->refs, memory_order_acquire) == 1)
+    return 1;
+  CowTable *table = cow_table_new(old->capacity);
+  if (!table)
+    return 0;
+  for (size_t i = 0; i < old->count; i++)
+  {
+    atomic_fetch_add_explicit(&old->chunks[i]->refs, 1, memory_order_relaxed);
+    table->chunks[i] = old->chunks[i];
+  }
+  table->count = old->count;
+  vec->table = table;
+  cow_table_release(old);
+  return 1;
+}
+
+// Chunk ci of vec, copied first if another table also holds it
+static CowChunk *cow_chunk_unshare(CowVec *vec, size_t ci)
+{
+  if (!cow_table_unshare(vec))
+    return NULL;
+  CowChunk *old = vec->table->chunks[ci];
+  if (atomic_load_explicit(&old->refs, memory_order_acquire) == 1)
+    return old;
+  CowChunk *chunk = cow_chunk_new(vec, 0);
+  if (!chunk)
+    return NULL;
+  memcpy(chunk->data, old->data, vec->chunk_elems * vec->elem_size);
+  vec->table->chunks[ci] = chunk;
+  cow_chunk_release(old);
+  return chunk;
+}
+
+// Appends an empty chunk to a table vec owns alone
+static CowChunk *cow_chunk_push(CowVec *vec, int zero)
+{
+  CowTable *table = vec->table;
+  if (table->count == table->capacity)
+  {
+    size_t capacity = table->capacity ? table->capacity * 2 : 4;
+    table = alloc_realloc(table, sizeof(CowTable) + sizeof(CowChunk *) * capacity, ALLOC_VEC);
+    if (!table)
+    {
+      fprintf(stderr, "Memory allocation failed for copy-on-write table (%zu chunks).\n", capacity);
+      return NULL;
+    }
+    table->capacity = capacity;
+    vec->table = table;
+  }
+  CowChunk *chunk = cow_chunk_new(vec, zero);
+  if (chunk)
+    table->chunks[table->count++] = chunk;
+  return chunk;
+}
+
+CowVec *cow_vec_new(size_t elem_size)
+{
+  if (elem_size == 0)
+  {
+    fprintf(stderr, "Error: Copy-on-write element size must be positive.\n");
+    return NULL;
+  }
+  CowVec *vec = alloc_malloc(sizeof(CowVec), ALLOC_VEC);
+  if (!vec)
+  {
+    fprintf(stderr, "Memory allocation failed for CowVec struct.\n");
+    return NULL;
+  }
+  vec->elem_size = elem_size;
+  vec->chunk_elems = elem_size < COW_CHUNK_BYTES ? COW_CHUNK_BYTES / elem_size : 1;
+  vec->length = 0;
+  vec->table = cow_table_new(4);
+  if (!vec->table)
+  {
+    alloc_free(vec, ALLOC_VEC);
+    return NULL;
+  }
+  return vec;
+}
+
+// length zero-filled elements
+static CowVec *cow_vec_zeroed(size_t elem_size, size_t length)
+{
+  CowVec *vec = cow_vec_new(elem_size);
+  if (!vec)
+    return NULL;
+  for (size_t n = 0; n < length; n += vec->chunk_elems)
+  {
+    if (!cow_chunk_push(vec, 1))
+    {
+      cow_vec_destroy(vec);
+      return NULL;
+    }
+  }
+  vec->length = length;
+  return vec;
+}
+
+// Copies n elements from src to index onwards, chunk by chunk
+static int cow_vec_write_range(CowVec *vec, size_t index, const void *src, size_t n)
+{
+  const char *from = src;
+  while (n > 0)
+  {
+    size_t ci = index / vec->chunk_elems, offset = index % vec->chunk_elems;
+    size_t count = vec->chunk_elems - offset < n ? vec->chunk_elems - offset : n;
+    CowChunk *chunk = cow_chunk_unshare(vec, ci);
+    if (!chunk)
+      return 0;
+    memcpy((char *)chunk->data + offset * vec->elem_size, from, count * vec->elem_size);
+    from += count * vec->elem_size;
+    index += count;
+    n -= count;
+  }
+  return 1;
+}
+
+CowVec *cow_vec_from_vec(Vec *src)
+{
+  if (src == NULL)
+  {
+    fprintf(stderr, "Error: Cannot build a copy-on-write vector from a NULL Vec.\n");
+    return NULL;
+  }
+  CowVec *vec = cow_vec_zeroed(src->elem_size, src->length);
+  if (vec && !cow_vec_write_range(vec, 0, src->data, src->length))
+  {
+    cow_vec_destroy(vec);
+    return NULL;
+  }
+  return vec;
+}
+
+Vec *cow_vec_to_vec(CowVec *vec)
+{
+  if (vec == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL copy-on-write vector.\n");
+    return NULL;
+  }
+  Vec *out = vec_new(vec->elem_size, vec->length > 0 ? vec->length : 1);
+  if (!out)
+  {
+    fprintf(stderr, "Memory allocation failed for Vec of %zu elements.\n", vec->length);
+    return NULL;
+  }
+  for (size_t i = 0; i < vec->length; i += vec->chunk_elems)
+  {
+    size_t count = vec->length - i < vec->chunk_elems ? vec->length - i : vec->chunk_elems;
+    memcpy((char *)out->data + i * vec->elem_size, vec->table->chunks[i / vec->chunk_elems]->data,
+           count * vec->elem_size);
+  }
+  out->length = vec->length;
+  return out;
+}
+
+void cow_vec_destroy(CowVec *vec)
+{
+  if (vec == NULL)
+    return;
+  cow_table_release(vec->table);
+  alloc_free(vec, ALLOC_VEC);
+}
+
+CowVec *cow_vec_snapshot(CowVec *vec)
+{
+  if (vec == NULL)
+  {
+    fprintf(stderr, "Error: Cannot snapshot a NULL copy-on-write vector.\n");
+    return NULL;
+  }
+  CowVec *snap = alloc_malloc(sizeof(CowVec), ALLOC_VEC);
+  if (!snap)
+  {
+    fprintf(stderr, "Memory allocation failed for CowVec struct.\n");
+    return NULL;
+  }
+  *snap = *vec;
+  atomic_fetch_add_explicit(&vec->table->refs, 1, memory_order_relaxed);
+  return snap;
+}
+
+size_t cow_vec_length(CowVec *vec)
+{
+  return vec ? vec->length : 0;
+}
+
+const void *cow_vec_get(CowVec *vec, size_t index)
+{
+  if (vec == NULL || index >= vec->length)
+    return NULL;
+  return (const char *)vec->table->chunks[index / vec->chunk_elems]->data +
+         (index % vec->chunk_elems) * vec->elem_size;
+}
+
+void *cow_vec_get_mut(CowVec *vec, size_t index)
+{
+  if (vec == NULL || index >= vec->length)
+    return NULL;
+  CowChunk *chunk = cow_chunk_unshare(vec, index / vec->chunk_elems);
+  return chunk ? (char *)chunk->data + (index % vec->chunk_elems) * vec->elem_size : NULL;
+}
+
+int cow_vec_set(CowVec *vec, size_t index, const void *elem)
+{
+  void *slot = cow_vec_get_mut(vec, index);
+  if (slot == NULL)
+  {
+    if (vec != NULL && index >= vec->length)
+      fprintf(stderr, "Error: Index %zu is out of bounds for a vector of %zu elements.\n", index, vec->length);
+    return 0;
+  }
+  memcpy(slot, elem, vec->elem_size);
+  return 1;
+}
+
+int cow_vec_append(CowVec *vec, const void *elem)
+{
+  if (vec == NULL)
+  {
+    fprintf(stderr, "Error: Cannot append to a NULL copy-on-write vector.\n");
+    return 0;
+  }
+  size_t ci = vec->length / vec->chunk_elems;
+  CowChunk *chunk;
+  if (ci < vec->table->count)
+    chunk = cow_chunk_unshare(vec, ci);
+  else
+    chunk = cow_table_unshare(vec) ? cow_chunk_push(vec, 0) : NULL;
+  if (!chunk)
+    return 0;
+  memcpy((char *)chunk->data + (vec->length % vec->chunk_elems) * vec->elem_size, elem, vec->elem_size);
+  vec->length++;
+  return 1;
+}
+
+CowMat *cow_mat_new(int nrows, int ncols)
+{
+  if (nrows < 1 || ncols < 1)
+  {
+    fprintf(stderr, "Error: Dimensions must be positive integers (got %dx%d).\n", nrows, ncols);
+    return NULL;
+  }
+  CowMat *mat = alloc_malloc(sizeof(CowMat), ALLOC_MATRIX);
+  if (!mat)
+  {
+    fprintf(stderr, "Memory allocation failed for CowMat struct.\n");
+    return NULL;
+  }
+  mat->nrows = nrows;
+  mat->ncols = ncols;
+  mat->cells = cow_vec_zeroed(sizeof(int), (size_t)nrows * (size_t)ncols);
+  if (!mat->cells)
+  {
+    alloc_free(mat, ALLOC_MATRIX);
+    return NULL;
+  }
+  return mat;
+}
+
+CowMat *cow_mat_from_mat(Mat *src)
+{
+  if (src == NULL)
+  {
+    fprintf(stderr, "Error: Cannot build a copy-on-write matrix from a NULL matrix.\n");
+    return NULL;
+  }
+  CowMat *mat = cow_mat_new(src->nrows, src->ncols);
+  if (!mat)
+    return NULL;
+  for (int i = 0; i < src->nrows; i++)
+  {
+    const int *row = (*(Vec **)vec_get(src->rows, i))->data;
+    if (!cow_vec_write_range(mat->cells, (size_t)i * (size_t)src->ncols, row, (size_t)src->ncols))
+    {
+      cow_mat_destroy(mat);
+      return NULL;
+    }
+  }
+  return mat;
+}
+
+Mat *cow_mat_to_mat(CowMat *src)
+{
+  if (src == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL copy-on-write matrix.\n");
+    return NULL;
+  }
+  Mat *mat = mat_new(src->nrows, src->ncols);
+  if (!mat)
+    return NULL;
+  for (int i = 0; i < src->nrows; i++)
+  {
+    int *row = (*(Vec **)vec_get(mat->rows, i))->data;
+    for (int j = 0; j < src->ncols; j++)
+      row[j] = *(const int *)cow_vec_get(src->cells, (size_t)i * (size_t)src->ncols + (size_t)j);
+  }
+  return mat;
+}
+
+void cow_mat_destroy(CowMat *mat)
+{
+  if (mat == NULL)
+    return;
+  cow_vec_destroy(mat->cells);
+  alloc_free(mat, ALLOC_MATRIX);
+}
+
+CowMat *cow_mat_snapshot(CowMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot snapshot a NULL copy-on-write matrix.\n");
+    return NULL;
+  }
+  CowMat *snap = alloc_malloc(sizeof(CowMat), ALLOC_MATRIX);
+  if (!snap)
+  {
+    fprintf(stderr, "Memory allocation failed for CowMat struct.\n");
+    return NULL;
+  }
+  *snap = *mat;
+  snap->cells = cow_vec_snapshot(mat->cells);
+  if (!snap->cells)
+  {
+    alloc_free(snap, ALLOC_MATRIX);
+    return NULL;
+  }
+  return snap;
+}
+
+int cow_mat_get(CowMat *mat, int row, int col)
+{
+  if (mat == NULL || row < 0 || row >= mat->nrows || col < 0 || col >= mat->ncols)
+  {
+    fprintf(stderr, "Warning: Attempted to get element at out-of-bounds position (%d, %d).\n", row, col);
+    return 0;
+  }
+  return *(const int *)cow_vec_get(mat->cells, (size_t)row * (size_t)mat->ncols + (size_t)col);
+}
+
+int cow_mat_set(CowMat *mat, int row, int col, int value)
+{
+  if (mat == NULL || row < 0 || row >= mat->nrows || col < 0 || col >= mat->ncols)
+  {
+    fprintf(stderr, "Error: Position (%d, %d) is out of bounds.\n", row, col);
+    return 0;
+  }
+  return cow_vec_set(mat->cells, (size_t)row * (size_t)mat->ncols + (size_t)col, &value);
+}
@@ -0,0 +1,74 @@
+#ifndef COW_H
+#define COW_H
+
+#include <stdatomic.h>
+#include <stddef.h> // for size_t
+#include "../types/types.h"
+#include "../matrix/matrix.h"
+
+// Copy-on-write arrays. Elements live in fixed-size chunks (about
+// COW_CHUNK_BYTES each) listed in a chunk table; chunks and tables are
+// reference counted. A snapshot shares the table, so it costs one atomic
+// increment. The first write through a handle whose table is shared copies
+// the table (one pointer per chunk); a write into a shared chunk copies that
+// chunk only. Snapshots are ordinary handles: they stay unchanged while the
+// original is written, and writing to them copies in the same way.
+//
+// One handle must not be used by two threads at once, but different
+// handles sharing storage may be used from different threads: a writer can
+// keep updating its handle while readers work on snapshots of it.
+#define COW_CHUNK_BYTES 4096
+
+typedef struct
+{
+  atomic_int refs;
+  max_align_t data[]; // chunk_elems elements
+} CowChunk;
+
+typedef struct
+{
+  atomic_int refs;
+  size_t count;
+  size_t capacity;
+  CowChunk *chunks[];
+} CowTable;
+
+typedef struct
+{
+  size_t elem_size;
+  size_t chunk_elems;
+  size_t length;
+  CowTable *table;
+} CowVec;
+
+CowVec *cow_vec_new(size_t elem_size); // NULL on error
+CowVec *cow_vec_from_vec(Vec *vec);
+Vec *cow_vec_to_vec(CowVec *vec);
+void cow_vec_destroy(CowVec *vec);
+CowVec *cow_vec_snapshot(CowVec *vec); // O(1); NULL on error
+size_t cow_vec_length(CowVec *vec);
+// Read access; NULL when index >= length. Valid until the next write through this handle.
+const void *cow_vec_get(CowVec *vec, size_t index);
+// Write access, copying the table and chunk first if they are shared. NULL on error.
+void *cow_vec_get_mut(CowVec *vec, size_t index);
+int cow_vec_set(CowVec *vec, size_t index, const void *elem); // Returns 1 on success, 0 on error
+int cow_vec_append(CowVec *vec, const void *elem);
+
+// Row-major int matrix on a CowVec; a snapshot of a large matrix shares
+// every untouched page with the original
+typedef struct
+{
+  int nrows;
+  int ncols;
+  CowVec *cells;
+} CowMat;
+
+CowMat *cow_mat_new(int nrows, int ncols); // Zero-filled; NULL on error
+CowMat *cow_mat_from_mat(Mat *mat);
+Mat *cow_mat_to_mat(CowMat *mat);
+void cow_mat_destroy(CowMat *mat);
+CowMat *cow_mat_snapshot(CowMat *mat);
+int cow_mat_get(CowMat *mat, int row, int col);
+int cow_mat_set(CowMat *mat, int row, int col, int value); // Returns 1 on success, 0 on error
+
+#endif // COW_H
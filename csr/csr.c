@@ -0,0 +1,336 @@
+#include "csr.h"
+#include <stdio.h>
+#include <string.h>
+#include "../vector/vector.h"
+#include "../alloc/alloc.h"
+
+CsrMat *csr_new(int nrows, int ncols, size_t nnz)
+{
+  if (nrows < 1 || ncols < 1)
+  {
+    fprintf(stderr, "Error: Dimensions must be positive integers (got %dx%d).\n", nrows, ncols);
+    return NULL;
+  }
+  CsrMat *mat = alloc_malloc(sizeof(CsrMat), ALLOC_SPARSE);
+  if (!mat)
+  {
+    fprintf(stderr, "Memory allocation failed for CsrMat struct.\n");
+    return NULL;
+  }
+  mat->nrows = nrows;
+  mat->ncols = ncols;
+  mat->nnz = 0;
+  mat->row_ptr = alloc_calloc((size_t)nrows + 1, sizeof(size_t), ALLOC_SPARSE);
+  mat->col_idx = alloc_malloc(sizeof(int) * (nnz > 0 ? nnz : 1), ALLOC_SPARSE);
+  mat->values = alloc_malloc(sizeof(int) * (nnz > 0 ? nnz : 1), ALLOC_SPARSE);
+  if (!mat->row_ptr || !mat->col_idx || !mat->values)
+  {
+    fprintf(stderr, "Memory allocation failed for CSR arrays (%dx%d, %zu entries).\n", nrows, ncols, nnz);
+    csr_destroy(mat);
+    return NULL;
+  }
+  return mat;
+}
+
+void csr_destroy(CsrMat *mat)
+{
+  if (mat == NULL)
+    return;
+  alloc_free(mat->row_ptr, ALLOC_SPARSE);
+  alloc_free(mat->col_idx, ALLOC_SPARSE);
+  alloc_free(mat->values, ALLOC_SPARSE);
+  alloc_free(mat, ALLOC_SPARSE);
+}
+
+int csr_get(CsrMat *mat, int row, int col)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot get element from a NULL CSR matrix.\n");
+    return 0;
+  }
+  if (row < 0 || row >= mat->nrows || col < 0 || col >= mat->ncols)
+  {
+    fprintf(stderr, "Warning: Attempted to get element at out-of-bounds position (%d, %d).\n", row, col);
+    return 0;
+  }
+  size_t lo = mat->row_ptr[row], hi = mat->row_ptr[row + 1];
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (mat->col_idx[mid] < col)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < mat->row_ptr[row + 1] && mat->col_idx[lo] == col ? mat->values[lo] : 0;
+}
+
+// Stable counting sort of the entry indices in src by row (or column) into
+// dst. start must hold nkeys + 1 zeroed counters.
+static void csr_counting_sort(size_t *dst, const size_t *src, size_t n, const SparseEntry *e, int by_row,
+                              size_t *start, int nkeys)
+{
+  for (size_t i = 0; i < n; i++)
+    start[(by_row ? e[src[i]].row : e[src[i]].col) + 1]++;
+  for (int k = 0; k < nkeys; k++)
+    start[k + 1] += start[k];
+  for (size_t i = 0; i < n; i++)
+    dst[start[by_row ? e[src[i]].row : e[src[i]].col]++] = src[i];
+}
+
+CsrMat *csr_from_sparse(SparseMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL sparse matrix.\n");
+    return NULL;
+  }
+  size_t nnz = (size_t)mat->nnz;
+  CsrMat *csr = csr_new(mat->nrows, mat->ncols, nnz);
+  size_t slots = nnz > 0 ? nnz : 1;
+  size_t *by_col = alloc_malloc(sizeof(size_t) * slots, ALLOC_SPARSE);
+  size_t *by_row = alloc_malloc(sizeof(size_t) * slots, ALLOC_SPARSE);
+  size_t *start = alloc_malloc(sizeof(size_t) * ((size_t)(mat->nrows > mat->ncols ? mat->nrows : mat->ncols) + 1),
+                               ALLOC_SPARSE);
+  if (!csr || !by_col || !by_row || !start)
+  {
+    if (csr)
+      fprintf(stderr, "Error: Memory allocation failed for CSR conversion.\n");
+    csr_destroy(csr);
+    alloc_free(by_col, ALLOC_SPARSE);
+    alloc_free(by_row, ALLOC_SPARSE);
+    alloc_free(start, ALLOC_SPARSE);
+    return NULL;
+  }
+
+  // Least significant key first: after both passes entries are ordered by
+  // (row, col), and equal coordinates keep their insertion order
+  SparseEntry *e = mat->data;
+  for (size_t i = 0; i < nnz; i++)
+    by_row[i] = i;
+  memset(start, 0, sizeof(size_t) * ((size_t)mat->ncols + 1));
+  csr_counting_sort(by_col, by_row, nnz, e, 0, start, mat->ncols);
+  memset(start, 0, sizeof(size_t) * ((size_t)mat->nrows + 1));
+  csr_counting_sort(by_row, by_col, nnz, e, 1, start, mat->nrows);
+
+  // Copy out, keeping only the first of each run of equal coordinates
+  size_t out = 0, k = 0;
+  for (int r = 0; r < mat->nrows; r++)
+  {
+    csr->row_ptr[r] = out;
+    for (; k < nnz && e[by_row[k]].row == (size_t)r; k++)
+    {
+      SparseEntry *entry = &e[by_row[k]];
+      if (out > csr->row_ptr[r] && csr->col_idx[out - 1] == (int)entry->col)
+        continue;
+      csr->col_idx[out] = (int)entry->col;
+      csr->values[out] = entry->value;
+      out++;
+    }
+  }
+  csr->row_ptr[mat->nrows] = out;
+  csr->nnz = out;
+  alloc_free(by_col, ALLOC_SPARSE);
+  alloc_free(by_row, ALLOC_SPARSE);
+  alloc_free(start, ALLOC_SPARSE);
+  return csr;
+}
+
+SparseMat *csr_to_sparse(CsrMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL CSR matrix.\n");
+    return NULL;
+  }
+  SparseMat *sparse = sparse_new(mat->nrows, mat->ncols);
+  if (!sparse)
+    return NULL;
+  if (mat->nnz > sparse->capacity)
+  {
+    SparseEntry *data = alloc_realloc(sparse->data, sizeof(SparseEntry) * mat->nnz, ALLOC_SPARSE);
+    if (!data)
+    {
+      fprintf(stderr, "Error: Memory allocation failed for %zu sparse entries.\n", mat->nnz);
+      sparse_mat_destroy(sparse);
+      return NULL;
+    }
+    sparse->data = data;
+    sparse->capacity = mat->nnz;
+  }
+  for (int r = 0; r < mat->nrows; r++)
+  {
+    for (size_t k = mat->row_ptr[r]; k < mat->row_ptr[r + 1]; k++)
+    {
+      sparse->data[k].row = (size_t)r;
+      sparse->data[k].col = (size_t)mat->col_idx[k];
+      sparse->data[k].value = mat->values[k];
+    }
+  }
+  sparse->nnz = (int)mat->nnz;
+  return sparse;
+}
+
+CsrMat *csr_from_mat(Mat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL matrix.\n");
+    return NULL;
+  }
+  // Count first so the arrays are allocated once at their exact size
+  size_t nnz = 0;
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    const int *row = (*(Vec **)vec_get(mat->rows, i))->data;
+    for (int j = 0; j < mat->ncols; j++)
+      nnz += row[j] != 0;
+  }
+  CsrMat *csr = csr_new(mat->nrows, mat->ncols, nnz);
+  if (!csr)
+    return NULL;
+  size_t out = 0;
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    const int *row = (*(Vec **)vec_get(mat->rows, i))->data;
+    csr->row_ptr[i] = out;
+    for (int j = 0; j < mat->ncols; j++)
+    {
+      if (row[j] != 0)
+      {
+        csr->col_idx[out] = j;
+        csr->values[out] = row[j];
+        out++;
+      }
+    }
+  }
+  csr->row_ptr[mat->nrows] = out;
+  csr->nnz = out;
+  return csr;
+}
+
+Mat *csr_to_mat(CsrMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL CSR matrix.\n");
+    return NULL;
+  }
+  Mat *dense = mat_new(mat->nrows, mat->ncols);
+  if (!dense)
+    return NULL;
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    int *row = (*(Vec **)vec_get(dense->rows, i))->data;
+    memset(row, 0, sizeof(int) * (size_t)mat->ncols);
+    for (size_t k = mat->row_ptr[i]; k < mat->row_ptr[i + 1]; k++)
+      row[mat->col_idx[k]] = mat->values[k];
+  }
+  return dense;
+}
+
+// Scatters rows in ascending order, so each output row comes out sorted
+CsrMat *csr_transpose(CsrMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot transpose a NULL CSR matrix.\n");
+    return NULL;
+  }
+  CsrMat *t = csr_new(mat->ncols, mat->nrows, mat->nnz);
+  if (!t)
+    return NULL;
+  size_t *next = t->row_ptr; // Counts, then the next free slot of each output row
+  for (size_t k = 0; k < mat->nnz; k++)
+    next[mat->col_idx[k] + 1]++;
+  for (int c = 0; c < mat->ncols; c++)
+    next[c + 1] += next[c];
+  for (int r = 0; r < mat->nrows; r++)
+  {
+    for (size_t k = mat->row_ptr[r]; k < mat->row_ptr[r + 1]; k++)
+    {
+      size_t slot = next[mat->col_idx[k]]++;
+      t->col_idx[slot] = r;
+      t->values[slot] = mat->values[k];
+    }
+  }
+  // next[c] now holds the end of row c, i.e. the start of row c + 1
+  for (int c = mat->ncols; c > 0; c--)
+    next[c] = next[c - 1];
+  next[0] = 0;
+  t->nnz = mat->nnz;
+  return t;
+}
+
+CsrMat *csr_add(CsrMat *a, CsrMat *b)
+{
+  if (a == NULL || b == NULL)
+  {
+    fprintf(stderr, "Error: Cannot add a NULL CSR matrix.\n");
+    return NULL;
+  }
+  if (a->nrows != b->nrows || a->ncols != b->ncols)
+  {
+    fprintf(stderr, "Error: Matrix dimensions do not match for addition. "
+                    "Matrix 1: %dx%d, Matrix 2: %dx%d.\n",
+            a->nrows, a->ncols, b->nrows, b->ncols);
+    return NULL;
+  }
+  CsrMat *sum = csr_new(a->nrows, a->ncols, a->nnz + b->nnz);
+  if (!sum)
+    return NULL;
+  size_t out = 0;
+  for (int r = 0; r < a->nrows; r++)
+  {
+    size_t i = a->row_ptr[r], iend = a->row_ptr[r + 1];
+    size_t j = b->row_ptr[r], jend = b->row_ptr[r + 1];
+    sum->row_ptr[r] = out;
+    while (i < iend || j < jend)
+    {
+      int col;
+      unsigned value;
+      if (j == jend || (i < iend && a->col_idx[i] < b->col_idx[j]))
+      {
+        col = a->col_idx[i];
+        value = (unsigned)a->values[i++];
+      }
+      else if (i == iend || b->col_idx[j] < a->col_idx[i])
+      {
+        col = b->col_idx[j];
+        value = (unsigned)b->values[j++];
+      }
+      else
+      {
+        col = a->col_idx[i];
+        value = (unsigned)a->values[i++] + (unsigned)b->values[j++];
+      }
+      if (value != 0)
+      {
+        sum->col_idx[out] = col;
+        sum->values[out] = (int)value;
+        out++;
+      }
+    }
+  }
+  sum->row_ptr[a->nrows] = out;
+  sum->nnz = out;
+  return sum;
+}
+
+int csr_spmv(CsrMat *mat, const int *x, int *y)
+{
+  if (mat == NULL || x == NULL || y == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL CSR matrix or vector.\n");
+    return 0;
+  }
+  for (int r = 0; r < mat->nrows; r++)
+  {
+    unsigned acc = 0;
+    for (size_t k = mat->row_ptr[r]; k < mat->row_ptr[r + 1]; k++)
+      acc += (unsigned)mat->values[k] * (unsigned)x[mat->col_idx[k]];
+    y[r] = (int)acc;
+  }
+  return 1;
+}
@@ -0,0 +1,42 @@
+#ifndef CSR_H
+#define CSR_H
+
+#include <stddef.h> // for size_t
+#include "../matrix/matrix.h"
+#include "../sparse/sparse.h"
+
+// Compressed sparse rows: the entries of row r are col_idx/values at
+// row_ptr[r] .. row_ptr[r + 1] - 1, with strictly ascending columns and no
+// stored zeros. The CSC form of A is the CSR form of A^T, so csr_transpose
+// also converts CSR <-> CSC. Every operation except the dense conversions
+// runs in O(nnz + nrows + ncols).
+typedef struct
+{
+  int nrows;
+  int ncols;
+  size_t nnz;
+  size_t *row_ptr; // nrows + 1 offsets
+  int *col_idx;
+  int *values;
+} CsrMat;
+
+// nnz is the capacity reserved for entries; row_ptr starts zeroed. NULL on error.
+CsrMat *csr_new(int nrows, int ncols, size_t nnz);
+void csr_destroy(CsrMat *mat);
+int csr_get(CsrMat *mat, int row, int col); // Binary search within the row
+
+// COO -> CSR by two stable counting sorts (column, then row). Of repeated
+// coordinates the first stored entry wins, as in sparse_get.
+CsrMat *csr_from_sparse(SparseMat *mat);
+SparseMat *csr_to_sparse(CsrMat *mat); // Entries in row-major order
+CsrMat *csr_from_mat(Mat *mat);
+Mat *csr_to_mat(CsrMat *mat);
+
+CsrMat *csr_transpose(CsrMat *mat);
+// a + b by merging sorted rows; entries that cancel are dropped. Sums wrap on
+// int overflow like mat_add.
+CsrMat *csr_add(CsrMat *a, CsrMat *b);
+// y = mat * x (x has ncols elements, y nrows); wraps on overflow. Returns 1 on success.
+int csr_spmv(CsrMat *mat, const int *x, int *y);
+
+#endif // CSR_H
@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+#include "dynsparse.h"
+#include <stdio.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+
+static DynSnapshot *dyn_snapshot_new(CsrMat *csr, unsigned long version)
+{
+  DynSnapshot *snap = alloc_malloc(sizeof(DynSnapshot), ALLOC_SPARSE);
+  if (!snap)
+  {
+    fprintf(stderr, "Memory allocation failed for DynSnapshot struct.\n");
+    return NULL;
+  }
+  snap->csr = csr;
+  snap->version = version;
+  atomic_init(&snap->refs, 1);
+  return snap;
+}
+
+void dyn_snapshot_release(DynSnapshot *snap)
+{
+  if (snap == NULL)
+    return;
+  if (atomic_fetch_sub_explicit(&snap->refs, 1, memory_order_acq_rel) == 1)
+  {
+    csr_destroy(snap->csr);
+    alloc_free(snap, ALLOC_SPARSE);
+  }
+}
+
+static DynDelta *dyn_delta_new(int nrows)
+{
+  DynDelta *delta = alloc_malloc(sizeof(DynDelta), ALLOC_SPARSE);
+  if (!delta)
+  {
+    fprintf(stderr, "Memory allocation failed for DynDelta struct.\n");
+    return NULL;
+  }
+  delta->count = 0;
+  delta->rows = alloc_calloc((size_t)nrows, sizeof(DynRow), ALLOC_SPARSE);
+  if (!delta->rows)
+  {
+    fprintf(stderr, "Memory allocation failed for delta rows (%d rows).\n", nrows);
+    alloc_free(delta, ALLOC_SPARSE);
+    return NULL;
+  }
+  return delta;
+}
+
+static void dyn_delta_destroy(DynDelta *delta, int nrows)
+{
+  if (delta == NULL)
+    return;
+  for (int r = 0; r < nrows; r++)
+  {
+    alloc_free(delta->rows[r].cols, ALLOC_SPARSE);
+    alloc_free(delta->rows[r].values, ALLOC_SPARSE);
+  }
+  alloc_free(delta->rows, ALLOC_SPARSE);
+  alloc_free(delta, ALLOC_SPARSE);
+}
+
+// First position in the row whose column is >= col
+static int dyn_row_find(const DynRow *row, int col)
+{
+  int lo = 0, hi = row->len;
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (row->cols[mid] < col)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Records (col, value) in the delta. Returns 1 on success, 0 on error.
+static int dyn_delta_put(DynDelta *delta, int row, int col, int value)
+{
+  DynRow *r = &delta->rows[row];
+  int pos = dyn_row_find(r, col);
+  if (pos < r->len && r->cols[pos] == col)
+  {
+    r->values[pos] = value;
+    return 1;
+  }
+  if (r->len == r->capacity)
+  {
+    int capacity = r->capacity ? r->capacity * 2 : 4;
+    int *cols = alloc_realloc(r->cols, sizeof(int) * (size_t)capacity, ALLOC_SPARSE);
+    if (!cols)
+      return 0;
+    r->cols = cols;
+    int *values = alloc_realloc(r->values, sizeof(int) * (size_t)capacity, ALLOC_SPARSE);
+    if (!values)
+      return 0;
+    r->values = values;
+    r->capacity = capacity;
+  }
+  memmove(r->cols + pos + 1, r->cols + pos, sizeof(int) * (size_t)(r->len - pos));
+  memmove(r->values + pos + 1, r->values + pos, sizeof(int) * (size_t)(r->len - pos));
+  r->cols[pos] = col;
+  r->values[pos] = value;
+  r->len++;
+  delta->count++;
+  return 1;
+}
+
+// 1 and the value in *value when the delta has an entry for (row, col)
+static int dyn_delta_lookup(const DynDelta *delta, int row, int col, int *value)
+{
+  const DynRow *r = &delta->rows[row];
+  int pos = dyn_row_find(r, col);
+  if (pos < r->len && r->cols[pos] == col)
+  {
+    *value = r->values[pos];
+    return 1;
+  }
+  return 0;
+}
+
+// base with the delta applied: a merge of two sorted lists per row, delta
+// entries replacing base ones and zeros dropped
+static CsrMat *dyn_merge(CsrMat *base, const DynDelta *delta)
+{
+  CsrMat *out = csr_new(base->nrows, base->ncols, base->nnz + delta->count);
+  if (!out)
+    return NULL;
+  size_t n = 0;
+  for (int r = 0; r < base->nrows; r++)
+  {
+    size_t i = base->row_ptr[r], end = base->row_ptr[r + 1];
+    const DynRow *d = &delta->rows[r];
+    int j = 0;
+    while (i < end || j < d->len)
+    {
+      int col, value;
+      if (j == d->len || (i < end && base->col_idx[i] < d->cols[j]))
+      {
+        col = base->col_idx[i];
+        value = base->values[i++];
+      }
+      else
+      {
+        if (i < end && base->col_idx[i] == d->cols[j])
+          i++;
+        col = d->cols[j];
+        value = d->values[j++];
+      }
+      if (value != 0)
+      {
+        out->col_idx[n] = col;
+        out->values[n++] = value;
+      }
+    }
+    out->row_ptr[r + 1] = n;
+  }
+  out->nnz = n;
+  return out;
+}
+
+DynSparse *dyn_sparse_new(CsrMat *base)
+{
+  if (base == NULL)
+  {
+    fprintf(stderr, "Error: Cannot build a dynamic matrix from a NULL CSR matrix.\n");
+    return NULL;
+  }
+  DynSparse *d = alloc_malloc(sizeof(DynSparse), ALLOC_SPARSE);
+  if (!d)
+  {
+    fprintf(stderr, "Memory allocation failed for DynSparse struct.\n");
+    return NULL;
+  }
+  d->nrows = base->nrows;
+  d->ncols = base->ncols;
+  d->frozen = NULL;
+  atomic_init(&d->running, 0);
+  d->stopping = 0;
+  atomic_init(&d->threshold, 0);
+  atomic_init(&d->signalled, 0);
+  d->active = dyn_delta_new(base->nrows);
+  d->current = d->active ? dyn_snapshot_new(base, 0) : NULL;
+  if (!d->current)
+  {
+    dyn_delta_destroy(d->active, base->nrows);
+    alloc_free(d, ALLOC_SPARSE);
+    return NULL;
+  }
+  pthread_rwlock_init(&d->lock, NULL);
+  pthread_mutex_init(&d->compact_lock, NULL);
+  pthread_mutex_init(&d->signal_lock, NULL);
+  pthread_cond_init(&d->signal, NULL);
+  return d;
+}
+
+DynSparse *dyn_sparse_from_sparse(SparseMat *mat)
+{
+  CsrMat *base = csr_from_sparse(mat);
+  if (!base)
+    return NULL;
+  DynSparse *d = dyn_sparse_new(base);
+  if (!d)
+    csr_destroy(base);
+  return d;
+}
+
+void dyn_sparse_destroy(DynSparse *d)
+{
+  if (d == NULL)
+    return;
+  dyn_sparse_stop_compactor(d);
+  dyn_delta_destroy(d->active, d->nrows);
+  dyn_snapshot_release(d->current);
+  pthread_rwlock_destroy(&d->lock);
+  pthread_mutex_destroy(&d->compact_lock);
+  pthread_mutex_destroy(&d->signal_lock);
+  pthread_cond_destroy(&d->signal);
+  alloc_free(d, ALLOC_SPARSE);
+}
+
+int dyn_sparse_set(DynSparse *d, int row, int col, int value)
+{
+  if (d == NULL)
+  {
+    fprintf(stderr, "Error: Cannot set element in a NULL dynamic matrix.\n");
+    return 0;
+  }
+  if (row < 0 || row >= d->nrows || col < 0 || col >= d->ncols)
+  {
+    fprintf(stderr, "Error: Position (%d, %d) is out of bounds for a %dx%d matrix.\n", row, col, d->nrows, d->ncols);
+    return 0;
+  }
+  pthread_rwlock_wrlock(&d->lock);
+  int ok = dyn_delta_put(d->active, row, col, value);
+  size_t pending = d->active->count;
+  pthread_rwlock_unlock(&d->lock);
+  if (!ok)
+  {
+    fprintf(stderr, "Memory allocation failed for delta row %d.\n", row);
+    return 0;
+  }
+  // Wake the compactor once per batch: the first set at or past the threshold
+  // signals, later ones see the flag until the compactor takes the batch. It
+  // rechecks the count before sleeping, so a wakeup during a compaction is not lost.
+  if (atomic_load_explicit(&d->running, memory_order_acquire) &&
+      pending >= atomic_load_explicit(&d->threshold, memory_order_relaxed) &&
+      !atomic_exchange_explicit(&d->signalled, 1, memory_order_relaxed))
+  {
+    pthread_mutex_lock(&d->signal_lock);
+    pthread_cond_signal(&d->signal);
+    pthread_mutex_unlock(&d->signal_lock);
+  }
+  return 1;
+}
+
+int dyn_sparse_get(DynSparse *d, int row, int col)
+{
+  if (d == NULL)
+  {
+    fprintf(stderr, "Error: Cannot get element from a NULL dynamic matrix.\n");
+    return 0;
+  }
+  if (row < 0 || row >= d->nrows || col < 0 || col >= d->ncols)
+  {
+    fprintf(stderr, "Warning: Attempted to get element at out-of-bounds position (%d, %d).\n", row, col);
+    return 0;
+  }
+  int value;
+  pthread_rwlock_rdlock(&d->lock);
+  if (!dyn_delta_lookup(d->active, row, col, &value) &&
+      !(d->frozen && dyn_delta_lookup(d->frozen, row, col, &value)))
+    value = csr_get(d->current->csr, row, col);
+  pthread_rwlock_unlock(&d->lock);
+  return value;
+}
+
+size_t dyn_sparse_pending(DynSparse *d)
+{
+  if (d == NULL)
+    return 0;
+  pthread_rwlock_rdlock(&d->lock);
+  size_t pending = d->active->count + (d->frozen ? d->frozen->count : 0);
+  pthread_rwlock_unlock(&d->lock);
+  return pending;
+}
+
+DynSnapshot *dyn_sparse_snapshot(DynSparse *d)
+{
+  if (d == NULL)
+  {
+    fprintf(stderr, "Error: Cannot take a snapshot of a NULL dynamic matrix.\n");
+    return NULL;
+  }
+  pthread_rwlock_rdlock(&d->lock);
+  DynSnapshot *snap = d->current;
+  atomic_fetch_add_explicit(&snap->refs, 1, memory_order_relaxed);
+  pthread_rwlock_unlock(&d->lock);
+  return snap;
+}
+
+// Freezes the active delta, merges it into the base without holding the lock
+// (writers keep going into a fresh delta, readers see frozen over the old
+// base), then publishes the result.
+int dyn_sparse_compact(DynSparse *d)
+{
+  if (d == NULL)
+  {
+    fprintf(stderr, "Error: Cannot compact a NULL dynamic matrix.\n");
+    return 0;
+  }
+  pthread_mutex_lock(&d->compact_lock);
+  DynDelta *fresh = dyn_delta_new(d->nrows);
+  if (!fresh)
+  {
+    pthread_mutex_unlock(&d->compact_lock);
+    return 0;
+  }
+  pthread_rwlock_wrlock(&d->lock);
+  if (d->active->count == 0)
+  {
+    pthread_rwlock_unlock(&d->lock);
+    pthread_mutex_unlock(&d->compact_lock);
+    dyn_delta_destroy(fresh, d->nrows);
+    return 1;
+  }
+  DynDelta *frozen = d->active;
+  d->frozen = frozen;
+  d->active = fresh;
+  DynSnapshot *base = d->current;
+  pthread_rwlock_unlock(&d->lock);
+
+  // Only this thread replaces current, so base stays alive without a reference
+  CsrMat *merged = dyn_merge(base->csr, frozen);
+  DynSnapshot *snap = merged ? dyn_snapshot_new(merged, base->version + 1) : NULL;
+  if (!snap)
+  {
+    csr_destroy(merged);
+    // Put the frozen changes back under the ones made meanwhile
+    pthread_rwlock_wrlock(&d->lock);
+    int ok = 1;
+    for (int r = 0; r < d->nrows; r++)
+    {
+      DynRow *fr = &frozen->rows[r];
+      for (int j = 0; j < fr->len; j++)
+      {
+        int value;
+        if (!dyn_delta_lookup(d->active, r, fr->cols[j], &value))
+          ok &= dyn_delta_put(d->active, r, fr->cols[j], fr->values[j]);
+      }
+    }
+    d->frozen = NULL;
+    pthread_rwlock_unlock(&d->lock);
+    pthread_mutex_unlock(&d->compact_lock);
+    dyn_delta_destroy(frozen, d->nrows);
+    if (!ok)
+      fprintf(stderr, "Error: Lost pending changes while recovering from a failed compaction.\n");
+    return 0;
+  }
+
+  pthread_rwlock_wrlock(&d->lock);
+  d->current = snap;
+  d->frozen = NULL;
+  pthread_rwlock_unlock(&d->lock);
+  pthread_mutex_unlock(&d->compact_lock);
+  dyn_snapshot_release(base);
+  dyn_delta_destroy(frozen, d->nrows);
+  return 1;
+}
+
+static void *dyn_compactor_main(void *arg)
+{
+  DynSparse *d = arg;
+  pthread_mutex_lock(&d->signal_lock);
+  for (;;)
+  {
+    size_t threshold = atomic_load_explicit(&d->threshold, memory_order_relaxed);
+    while (!d->stopping && dyn_sparse_pending(d) < threshold)
+      pthread_cond_wait(&d->signal, &d->signal_lock);
+    if (d->stopping)
+      break;
+    atomic_store_explicit(&d->signalled, 0, memory_order_relaxed); // Sets after this point may signal again
+    pthread_mutex_unlock(&d->signal_lock);
+    if (!dyn_sparse_compact(d))
+      fprintf(stderr, "Error: Background compaction failed.\n");
+    pthread_mutex_lock(&d->signal_lock);
+  }
+  pthread_mutex_unlock(&d->signal_lock);
+  return NULL;
+}
+
+int dyn_sparse_start_compactor(DynSparse *d, size_t threshold)
+{
+  if (d == NULL)
+  {
+    fprintf(stderr, "Error: Cannot start a compactor for a NULL dynamic matrix.\n");
+    return 0;
+  }
+  if (atomic_load_explicit(&d->running, memory_order_acquire))
+    return 1;
+  atomic_store_explicit(&d->threshold, threshold > 0 ? threshold : 1, memory_order_relaxed);
+  atomic_store_explicit(&d->signalled, 0, memory_order_relaxed);
+  d->stopping = 0;
+  if (pthread_create(&d->thread, NULL, dyn_compactor_main, d) != 0)
+  {
+    fprintf(stderr, "Error: Failed to start the compactor thread.\n");
+    return 0;
+  }
+  atomic_store_explicit(&d->running, 1, memory_order_release);
+  return 1;
+}
+
+void dyn_sparse_stop_compactor(DynSparse *d)
+{
+  if (d == NULL || !atomic_load_explicit(&d->running, memory_order_acquire))
+    return;
+  atomic_store_explicit(&d->running, 0, memory_order_release);
+  pthread_mutex_lock(&d->signal_lock);
+  d->stopping = 1;
+  pthread_cond_signal(&d->signal);
+  pthread_mutex_unlock(&d->signal_lock);
+  pthread_join(d->thread, NULL);
+}
+
+int dyn_sparse_spmv(DynSparse *d, const int *x, int *y)
+{
+  DynSnapshot *snap = dyn_sparse_snapshot(d);
+  if (!snap)
+    return 0;
+  int ok = csr_spmv(snap->csr, x, y);
+  dyn_snapshot_release(snap);
+  return ok;
+}
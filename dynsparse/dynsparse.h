@@ -0,0 +1,85 @@
+#ifndef DYNSPARSE_H
+#define DYNSPARSE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h> // for size_t
+#include "../csr/csr.h"
+#include "../sparse/sparse.h"
+
+// A sparse matrix that takes a continuous stream of updates. The bulk of the
+// entries live in an immutable CSR base; inserts, updates and deletes go to
+// per-row sorted delta buffers, and reads merge deltas over the base.
+// Compaction folds the deltas into a new CSR (synchronously, or on a
+// background thread once enough are pending) and publishes it as a new
+// snapshot; readers such as SpMV hold a reference to the snapshot they
+// started with, so they never see a half-applied batch of updates.
+
+// The CSR as of one compaction. Freed when the last reference is released.
+typedef struct
+{
+  CsrMat *csr;
+  unsigned long version; // 0 for the initial base, +1 per compaction
+  atomic_int refs;
+} DynSnapshot;
+
+// Pending changes of one row, sorted by column; value 0 marks a delete
+typedef struct
+{
+  int *cols;
+  int *values;
+  int len;
+  int capacity;
+} DynRow;
+
+typedef struct
+{
+  DynRow *rows; // nrows entries, buffers allocated on first change
+  size_t count; // Changed coordinates
+} DynDelta;
+
+typedef struct
+{
+  int nrows;
+  int ncols;
+  pthread_rwlock_t lock; // Guards active, frozen and current
+  DynDelta *active;      // Receives new changes
+  DynDelta *frozen;      // Being folded in by a running compaction, else NULL
+  DynSnapshot *current;  // Latest published base
+  pthread_mutex_t compact_lock; // One compaction at a time
+
+  // Background compactor
+  pthread_mutex_t signal_lock;
+  pthread_cond_t signal;
+  pthread_t thread;
+  atomic_int running;       // Read by dyn_sparse_set without signal_lock
+  int stopping;             // Guarded by signal_lock
+  atomic_size_t threshold;  // Pending changes that wake the compactor
+  atomic_int signalled;     // A wakeup is outstanding; cleared when a compaction starts
+} DynSparse;
+
+// Takes ownership of base. NULL on error.
+DynSparse *dyn_sparse_new(CsrMat *base);
+DynSparse *dyn_sparse_from_sparse(SparseMat *mat);
+void dyn_sparse_destroy(DynSparse *d); // Stops the compactor; snapshots still held stay valid
+
+// Insert or update (row, col); value 0 deletes. Returns 1 on success, 0 on error.
+int dyn_sparse_set(DynSparse *d, int row, int col, int value);
+int dyn_sparse_get(DynSparse *d, int row, int col);
+size_t dyn_sparse_pending(DynSparse *d);
+
+// Folds all pending changes into a new snapshot. Returns 1 on success.
+int dyn_sparse_compact(DynSparse *d);
+// Starts a thread that compacts whenever threshold changes are pending.
+// Returns 1 on success (or if one is already running). Starting and
+// stopping must not race with each other; sets may run concurrently.
+int dyn_sparse_start_compactor(DynSparse *d, size_t threshold);
+void dyn_sparse_stop_compactor(DynSparse *d);
+
+// Latest published snapshot with a reference held for the caller
+DynSnapshot *dyn_sparse_snapshot(DynSparse *d);
+void dyn_snapshot_release(DynSnapshot *snap);
+// y = A x on the latest snapshot (changes since the last compaction are not included)
+int dyn_sparse_spmv(DynSparse *d, const int *x, int *y);
+
+#endif // DYNSPARSE_H
@@ -0,0 +1,437 @@
+#include "expr.h"
+#include <stdio.h>
+#include <string.h>
+#include "../matrix/matrix.h"
+#include "../gemm/gemm.h"
+#include "../strassen/strassen.h"
+#include "../vector/vector.h"
+#include "../alloc/alloc.h"
+
+// Columns per tile of the fused pass: one destination tile (4 KiB) stays in L1
+// while every element-wise term is added into it
+#define EXPR_TILE_COLS 1024
+
+// coeff * mat, added element by element
+typedef struct
+{
+  int coeff;
+  Mat *mat;
+} ExprTerm;
+
+// coeff * lhs * rhs, added with a GEMM update; owned operands are temporaries
+typedef struct
+{
+  int coeff;
+  Mat *lhs;
+  Mat *rhs;
+  int owns_lhs;
+  int owns_rhs;
+} ExprProduct;
+
+// The flattened form of a tree: dst = sum(terms) + sum(products)
+typedef struct
+{
+  ExprTerm *terms;
+  int nterms;
+  ExprProduct *products;
+  int nproducts;
+  int failed;
+} ExprPlan;
+
+static Expr *expr_node(ExprKind kind, int nrows, int ncols, Expr *lhs, Expr *rhs)
+{
+  Expr *e = alloc_malloc(sizeof(Expr), ALLOC_EXPR);
+  if (!e)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for expression node.\n");
+    expr_destroy(lhs);
+    expr_destroy(rhs);
+    return NULL;
+  }
+  e->kind = kind;
+  e->nrows = nrows;
+  e->ncols = ncols;
+  e->mat = NULL;
+  e->scalar = 1;
+  e->lhs = lhs;
+  e->rhs = rhs;
+  return e;
+}
+
+Expr *expr_mat(Mat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot build an expression from a NULL matrix.\n");
+    return NULL;
+  }
+  Expr *e = expr_node(EXPR_MAT, mat->nrows, mat->ncols, NULL, NULL);
+  if (e)
+    e->mat = mat;
+  return e;
+}
+
+// shared by expr_add and expr_sub: both operands must have the same shape
+static Expr *expr_elementwise(ExprKind kind, Expr *lhs, Expr *rhs)
+{
+  if (lhs == NULL || rhs == NULL)
+  {
+    expr_destroy(lhs);
+    expr_destroy(rhs);
+    return NULL;
+  }
+  if (lhs->nrows != rhs->nrows || lhs->ncols != rhs->ncols)
+  {
+    fprintf(stderr, "Error: Matrix dimensions do not match for %s. Left: %dx%d, Right: %dx%d.\n",
+            kind == EXPR_ADD ? "addition" : "subtraction", lhs->nrows, lhs->ncols, rhs->nrows, rhs->ncols);
+    expr_destroy(lhs);
+    expr_destroy(rhs);
+    return NULL;
+  }
+  return expr_node(kind, lhs->nrows, lhs->ncols, lhs, rhs);
+}
+
+Expr *expr_add(Expr *lhs, Expr *rhs)
+{
+  return expr_elementwise(EXPR_ADD, lhs, rhs);
+}
+
+Expr *expr_sub(Expr *lhs, Expr *rhs)
+{
+  return expr_elementwise(EXPR_SUB, lhs, rhs);
+}
+
+Expr *expr_scale(int scalar, Expr *operand)
+{
+  if (operand == NULL)
+    return NULL;
+  Expr *e = expr_node(EXPR_SCALE, operand->nrows, operand->ncols, operand, NULL);
+  if (e)
+    e->scalar = scalar;
+  return e;
+}
+
+Expr *expr_mul(Expr *lhs, Expr *rhs)
+{
+  if (lhs == NULL || rhs == NULL)
+  {
+    expr_destroy(lhs);
+    expr_destroy(rhs);
+    return NULL;
+  }
+  if (lhs->ncols != rhs->nrows)
+  {
+    fprintf(stderr, "Error: Incompatible matrix dimensions for multiplication. "
+                    "Left has %d columns, right has %d rows.\n",
+            lhs->ncols, rhs->nrows);
+    expr_destroy(lhs);
+    expr_destroy(rhs);
+    return NULL;
+  }
+  return expr_node(EXPR_MUL, lhs->nrows, rhs->ncols, lhs, rhs);
+}
+
+void expr_destroy(Expr *e)
+{
+  if (e == NULL)
+    return;
+  expr_destroy(e->lhs);
+  expr_destroy(e->rhs);
+  alloc_free(e, ALLOC_EXPR);
+}
+
+static int expr_count_nodes(Expr *e)
+{
+  return e == NULL ? 0 : 1 + expr_count_nodes(e->lhs) + expr_count_nodes(e->rhs);
+}
+
+// adds coeff * mat, merging repeated matrices so each appears in one term
+static void expr_plan_term(ExprPlan *plan, int coeff, Mat *mat)
+{
+  for (int t = 0; t < plan->nterms; t++)
+  {
+    if (plan->terms[t].mat == mat)
+    {
+      plan->terms[t].coeff = (int)((unsigned)plan->terms[t].coeff + (unsigned)coeff);
+      return;
+    }
+  }
+  plan->terms[plan->nterms++] = (ExprTerm){coeff, mat};
+}
+
+// returns a matrix holding operand e; scale factors are folded into *coeff and
+// anything other than a (scaled) leaf is materialized into a temporary
+static Mat *expr_plan_operand(Expr *e, int *coeff, int *owned)
+{
+  while (e->kind == EXPR_SCALE)
+  {
+    *coeff = (int)((unsigned)*coeff * (unsigned)e->scalar);
+    e = e->lhs;
+  }
+  *owned = e->kind != EXPR_MAT;
+  return *owned ? expr_eval_new(e) : e->mat;
+}
+
+static void expr_plan_collect(ExprPlan *plan, Expr *e, int coeff)
+{
+  switch (e->kind)
+  {
+  case EXPR_MAT:
+    expr_plan_term(plan, coeff, e->mat);
+    break;
+  case EXPR_ADD:
+    expr_plan_collect(plan, e->lhs, coeff);
+    expr_plan_collect(plan, e->rhs, coeff);
+    break;
+  case EXPR_SUB:
+    expr_plan_collect(plan, e->lhs, coeff);
+    expr_plan_collect(plan, e->rhs, (int)(0u - (unsigned)coeff));
+    break;
+  case EXPR_SCALE:
+    expr_plan_collect(plan, e->lhs, (int)((unsigned)coeff * (unsigned)e->scalar));
+    break;
+  case EXPR_MUL:
+  {
+    ExprProduct *p = &plan->products[plan->nproducts++];
+    p->coeff = coeff;
+    p->lhs = expr_plan_operand(e->lhs, &p->coeff, &p->owns_lhs);
+    p->rhs = expr_plan_operand(e->rhs, &p->coeff, &p->owns_rhs);
+    if (!p->lhs || !p->rhs)
+      plan->failed = 1;
+    break;
+  }
+  }
+}
+
+static void expr_plan_destroy(ExprPlan *plan)
+{
+  for (int p = 0; p < plan->nproducts; p++)
+  {
+    if (plan->products[p].owns_lhs)
+      mat_destroy(plan->products[p].lhs);
+    if (plan->products[p].owns_rhs)
+      mat_destroy(plan->products[p].rhs);
+  }
+  alloc_free(plan->terms, ALLOC_EXPR);
+  alloc_free(plan->products, ALLOC_EXPR);
+}
+
+// Flattens e (plus dst itself when accumulating). Product operands are
+// materialized here, before dst is written, so dst may appear anywhere in e.
+static int expr_plan_build(ExprPlan *plan, Expr *e, Mat *dst, int accumulate)
+{
+  int nodes = expr_count_nodes(e) + 1;
+  plan->terms = alloc_malloc(sizeof(ExprTerm) * nodes, ALLOC_EXPR);
+  plan->products = alloc_calloc(nodes, sizeof(ExprProduct), ALLOC_EXPR);
+  plan->nterms = 0;
+  plan->nproducts = 0;
+  plan->failed = 0;
+  if (!plan->terms || !plan->products)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for expression plan.\n");
+    expr_plan_destroy(plan);
+    return 0;
+  }
+  if (accumulate)
+    expr_plan_term(plan, 1, dst);
+  expr_plan_collect(plan, e, 1);
+  if (plan->failed)
+  {
+    expr_plan_destroy(plan);
+    return 0;
+  }
+  return 1;
+}
+
+static int *expr_row(Mat *mat, int i)
+{
+  return (*(Vec **)vec_get(mat->rows, i))->data;
+}
+
+// dst (=|+=) sum of element-wise terms, one row tile at a time. A term reading
+// dst itself is ordered first, so it is consumed before the tile is overwritten.
+static int expr_fused_pass(ExprPlan *plan, Mat *dst, int accumulate)
+{
+  for (int t = 1; t < plan->nterms; t++)
+  {
+    if (plan->terms[t].mat == dst)
+    {
+      ExprTerm tmp = plan->terms[0];
+      plan->terms[0] = plan->terms[t];
+      plan->terms[t] = tmp;
+    }
+  }
+  const unsigned **src = alloc_malloc(sizeof(unsigned *) * (plan->nterms > 0 ? plan->nterms : 1), ALLOC_EXPR);
+  if (!src)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for expression pass.\n");
+    return 0;
+  }
+  for (int i = 0; i < dst->nrows; i++)
+  {
+    unsigned *d = (unsigned *)expr_row(dst, i);
+    for (int t = 0; t < plan->nterms; t++)
+      src[t] = (const unsigned *)expr_row(plan->terms[t].mat, i);
+    for (int jj = 0; jj < dst->ncols; jj += EXPR_TILE_COLS)
+    {
+      int jend = jj + EXPR_TILE_COLS < dst->ncols ? jj + EXPR_TILE_COLS : dst->ncols;
+      int t = 0;
+      if (!accumulate)
+      {
+        if (plan->nterms == 0)
+          memset(d + jj, 0, sizeof(int) * (size_t)(jend - jj));
+        else
+        {
+          unsigned c = (unsigned)plan->terms[0].coeff;
+          for (int j = jj; j < jend; j++)
+            d[j] = c * src[0][j];
+          t = 1;
+        }
+      }
+      for (; t < plan->nterms; t++)
+      {
+        unsigned c = (unsigned)plan->terms[t].coeff;
+        const unsigned *s = src[t];
+        if (c == 1)
+          for (int j = jj; j < jend; j++)
+            d[j] += s[j];
+        else if (c == (unsigned)-1)
+          for (int j = jj; j < jend; j++)
+            d[j] -= s[j];
+        else
+          for (int j = jj; j < jend; j++)
+            d[j] += c * s[j];
+      }
+    }
+  }
+  alloc_free(src, ALLOC_EXPR);
+  return 1;
+}
+
+// a product can overwrite dst with Strassen first only if nothing reads dst afterwards
+static int expr_strassen_first(ExprPlan *plan, Mat *dst)
+{
+  if (plan->nproducts == 0 || plan->products[0].coeff != 1)
+    return 0;
+  ExprProduct *p = &plan->products[0];
+  if (p->lhs->nrows < STRASSEN_CROSSOVER || p->lhs->ncols < STRASSEN_CROSSOVER ||
+      p->rhs->ncols < STRASSEN_CROSSOVER)
+    return 0;
+  for (int t = 0; t < plan->nterms; t++)
+  {
+    if (plan->terms[t].mat == dst)
+      return 0;
+  }
+  return 1;
+}
+
+// runs a plan into dst, which no product operand aliases
+static int expr_plan_run(ExprPlan *plan, Mat *dst)
+{
+  int ok = 1;
+  int first_product = 0;
+  MatView c = mat_view(dst);
+  if (!c.rows)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for row views in expression.\n");
+    return 0;
+  }
+  if (expr_strassen_first(plan, dst))
+  {
+    ExprProduct *p = &plan->products[0];
+    MatView a = mat_view(p->lhs), b = mat_view(p->rhs);
+    StrassenWorkspace *ws = NULL;
+    ok = a.rows && b.rows &&
+         (ws = strassen_workspace_new(p->lhs->nrows, p->lhs->ncols, p->rhs->ncols, STRASSEN_CROSSOVER)) &&
+         strassen_mult(ws, c, a, b) && expr_fused_pass(plan, dst, 1);
+    strassen_workspace_destroy(ws);
+    mat_view_release(a);
+    mat_view_release(b);
+    first_product = 1;
+  }
+  else
+  {
+    ok = expr_fused_pass(plan, dst, 0);
+  }
+  for (int k = first_product; ok && k < plan->nproducts; k++)
+  {
+    ExprProduct *p = &plan->products[k];
+    MatView a = mat_view(p->lhs), b = mat_view(p->rhs);
+    ok = a.rows && b.rows;
+    if (ok)
+      gemm_blocked_update(c, a, b, p->coeff); // Add epilogue: dst already holds the other terms
+    mat_view_release(a);
+    mat_view_release(b);
+  }
+  mat_view_release(c);
+  return ok;
+}
+
+static int expr_eval_into(Expr *e, Mat *dst, int accumulate)
+{
+  if (e == NULL || dst == NULL)
+  {
+    fprintf(stderr, "Error: Cannot evaluate a NULL expression or into a NULL matrix.\n");
+    return 0;
+  }
+  if (e->nrows != dst->nrows || e->ncols != dst->ncols)
+  {
+    fprintf(stderr, "Error: Expression is %dx%d but destination is %dx%d.\n", e->nrows, e->ncols, dst->nrows,
+            dst->ncols);
+    return 0;
+  }
+  ExprPlan plan;
+  if (!expr_plan_build(&plan, e, dst, accumulate))
+    return 0;
+
+  int aliased = 0;
+  for (int p = 0; p < plan.nproducts; p++)
+    aliased |= plan.products[p].lhs == dst || plan.products[p].rhs == dst;
+
+  int ok;
+  if (!aliased)
+    ok = expr_plan_run(&plan, dst);
+  else
+  {
+    // dst feeds a GEMM (e.g. C += C*B): compute into a scratch matrix and swap rows in
+    Mat *tmp = mat_new(dst->nrows, dst->ncols);
+    ok = tmp && expr_plan_run(&plan, tmp);
+    if (ok)
+    {
+      Vec *rows = dst->rows;
+      dst->rows = tmp->rows;
+      tmp->rows = rows;
+    }
+    mat_destroy(tmp);
+  }
+  expr_plan_destroy(&plan);
+  return ok;
+}
+
+int expr_eval(Expr *e, Mat *dst)
+{
+  return expr_eval_into(e, dst, 0);
+}
+
+int expr_eval_accumulate(Expr *e, Mat *dst)
+{
+  return expr_eval_into(e, dst, 1);
+}
+
+Mat *expr_eval_new(Expr *e)
+{
+  if (e == NULL)
+  {
+    fprintf(stderr, "Error: Cannot evaluate a NULL expression.\n");
+    return NULL;
+  }
+  Mat *dst = mat_new(e->nrows, e->ncols);
+  if (!dst)
+    return NULL;
+  if (!expr_eval(e, dst))
+  {
+    mat_destroy(dst);
+    return NULL;
+  }
+  return dst;
+}
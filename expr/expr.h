@@ -0,0 +1,50 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "../matrix/matrix.h"
+
+// Deferred matrix expressions. Building a tree does no arithmetic; evaluation
+// flattens it into a sum of scaled terms and writes the destination in one
+// tiled pass (element-wise terms) plus one GEMM update per product, so
+// A + B + C and A*B + D need no temporaries at all.
+typedef enum
+{
+  EXPR_MAT,   // Leaf: a borrowed Mat (never freed by the expression)
+  EXPR_ADD,   // lhs + rhs
+  EXPR_SUB,   // lhs - rhs
+  EXPR_SCALE, // scalar * lhs
+  EXPR_MUL    // lhs * rhs (matrix product)
+} ExprKind;
+
+typedef struct Expr
+{
+  ExprKind kind;
+  int nrows;
+  int ncols;
+  Mat *mat;
+  int scalar;
+  struct Expr *lhs;
+  struct Expr *rhs;
+} Expr;
+
+// Constructors take ownership of their operands. On a NULL operand or a shape
+// mismatch they report the error, free the operands and return NULL, so nested
+// calls such as expr_add(expr_mat(a), expr_mul(expr_mat(b), expr_mat(c))) need
+// only one check at the end.
+Expr *expr_mat(Mat *mat);
+Expr *expr_add(Expr *lhs, Expr *rhs);
+Expr *expr_sub(Expr *lhs, Expr *rhs);
+Expr *expr_scale(int scalar, Expr *operand);
+Expr *expr_mul(Expr *lhs, Expr *rhs);
+void expr_destroy(Expr *e); // Frees the tree, not the leaf matrices
+
+// Evaluation never frees e.
+// dst = e; dst must already have e's shape and may appear inside e.
+// Returns 1 on success, 0 on error.
+int expr_eval(Expr *e, Mat *dst);
+// dst += e (in-place accumulation, e.g. C += A*B)
+int expr_eval_accumulate(Expr *e, Mat *dst);
+// Evaluates into a freshly allocated matrix; returns NULL on error
+Mat *expr_eval_new(Expr *e);
+
+#endif // EXPR_H
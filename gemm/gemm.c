@@ -0,0 +1,120 @@
+#include "gemm.h"
+#include <string.h>
+
+// Arithmetic is done in unsigned int so that sums wrap exactly like the
+// two's-complement products they stand for (signed overflow would be undefined).
+
+MatView mat_view_block(MatView v, int row, int col, int nrows, int ncols)
+{
+  MatView block = {v.rows + row, v.col + (size_t)col, nrows, ncols};
+  return block;
+}
+
+void gemm_blocked_update(MatView c, MatView a, MatView b, int alpha)
+{
+  for (int jj = 0; jj < c.ncols; jj += GEMM_BLOCK_J)
+  {
+    int jend = jj + GEMM_BLOCK_J < c.ncols ? jj + GEMM_BLOCK_J : c.ncols;
+    for (int kk = 0; kk < a.ncols; kk += GEMM_BLOCK_K)
+    {
+      int kend = kk + GEMM_BLOCK_K < a.ncols ? kk + GEMM_BLOCK_K : a.ncols;
+      for (int i = 0; i < c.nrows; i++)
+      {
+        unsigned *restrict crow = (unsigned *)c.rows[i] + c.col;
+        const int *arow = a.rows[i] + a.col;
+        for (int k = kk; k < kend; k++)
+        {
+          unsigned aik = (unsigned)alpha * (unsigned)arow[k];
+          const unsigned *restrict brow = (const unsigned *)b.rows[k] + b.col;
+          for (int j = jj; j < jend; j++) // Unit stride in both B and C: vectorizes
+            crow[j] += aik * brow[j];
+        }
+      }
+    }
+  }
+}
+
+void gemm_blocked(MatView c, MatView a, MatView b, int accumulate)
+{
+  if (!accumulate)
+  {
+    for (int i = 0; i < c.nrows; i++)
+      memset(c.rows[i] + c.col, 0, sizeof(int) * (size_t)c.ncols);
+  }
+  gemm_blocked_update(c, a, b, 1);
+}
+
+void gemm_transposed(MatView c, MatView a, MatView bt, int accumulate)
+{
+  if (!accumulate)
+  {
+    for (int i = 0; i < c.nrows; i++)
+      memset(c.rows[i] + c.col, 0, sizeof(int) * (size_t)c.ncols);
+  }
+  for (int jj = 0; jj < c.ncols; jj += GEMM_BLOCK_N)
+  {
+    int jend = jj + GEMM_BLOCK_N < c.ncols ? jj + GEMM_BLOCK_N : c.ncols;
+    for (int kk = 0; kk < a.ncols; kk += GEMM_BLOCK_DOT)
+    {
+      int klen = kk + GEMM_BLOCK_DOT < a.ncols ? GEMM_BLOCK_DOT : a.ncols - kk;
+      for (int i = 0; i < c.nrows; i++)
+      {
+        unsigned *crow = (unsigned *)c.rows[i] + c.col;
+        const unsigned *restrict arow = (const unsigned *)a.rows[i] + a.col + kk;
+        int j = jj;
+        // Four dot products at once share every load of the A row
+        for (; j + 4 <= jend; j += 4)
+        {
+          const unsigned *restrict b0 = (const unsigned *)bt.rows[j] + bt.col + kk;
+          const unsigned *restrict b1 = (const unsigned *)bt.rows[j + 1] + bt.col + kk;
+          const unsigned *restrict b2 = (const unsigned *)bt.rows[j + 2] + bt.col + kk;
+          const unsigned *restrict b3 = (const unsigned *)bt.rows[j + 3] + bt.col + kk;
+          unsigned s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+          for (int k = 0; k < klen; k++) // Integer reductions: vectorize without reassociation concerns
+          {
+            s0 += arow[k] * b0[k];
+            s1 += arow[k] * b1[k];
+            s2 += arow[k] * b2[k];
+            s3 += arow[k] * b3[k];
+          }
+          crow[j] += s0;
+          crow[j + 1] += s1;
+          crow[j + 2] += s2;
+          crow[j + 3] += s3;
+        }
+        for (; j < jend; j++)
+        {
+          const unsigned *restrict brow = (const unsigned *)bt.rows[j] + bt.col + kk;
+          unsigned sum = 0;
+          for (int k = 0; k < klen; k++)
+            sum += arow[k] * brow[k];
+          crow[j] += sum;
+        }
+      }
+    }
+  }
+}
+
+void mat_view_add(MatView d, MatView x, MatView y)
+{
+  for (int i = 0; i < d.nrows; i++)
+  {
+    unsigned *drow = (unsigned *)d.rows[i] + d.col;
+    const unsigned *xrow = (const unsigned *)x.rows[i] + x.col;
+    const unsigned *yrow = (const unsigned *)y.rows[i] + y.col;
+    for (int j = 0; j < d.ncols; j++)
+      drow[j] = xrow[j] + yrow[j];
+  }
+}
+
+void mat_view_sub(MatView d, MatView x, MatView y)
+{
+  for (int i = 0; i < d.nrows; i++)
+  {
+    unsigned *drow = (unsigned *)d.rows[i] + d.col;
+    const unsigned *xrow = (const unsigned *)x.rows[i] + x.col;
+    const unsigned *yrow = (const unsigned *)y.rows[i] + y.col;
+    for (int j = 0; j < d.ncols; j++)
+      drow[j] = xrow[j] - yrow[j];
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <stddef.h> // for size_t
+
+// A rectangular window onto an int matrix held as one pointer per row, so
+// both Mat rows (separate Vecs) and contiguous scratch blocks can be used.
+// Element (i, j) is rows[i][col + j].
+typedef struct
+{
+  int **rows;
+  size_t col;
+  int nrows;
+  int ncols;
+} MatView;
+
+// Cache blocking for gemm_blocked: a GEMM_BLOCK_K x GEMM_BLOCK_J panel of B
+// (128 KiB) stays resident while every row of A streams past it.
+#define GEMM_BLOCK_K 64
+#define GEMM_BLOCK_J 512
+// gemm_transposed keeps GEMM_BLOCK_N rows of bt, GEMM_BLOCK_DOT ints long (64 KiB), hot
+#define GEMM_BLOCK_N 64
+#define GEMM_BLOCK_DOT 256
+
+MatView mat_view_block(MatView v, int row, int col, int nrows, int ncols);
+// c = a * b, or c += a * b when accumulate is set. c must not overlap a or b.
+void gemm_blocked(MatView c, MatView a, MatView b, int accumulate);
+// c += alpha * a * b (the GEMM update with an add epilogue already in c)
+void gemm_blocked_update(MatView c, MatView a, MatView b, int alpha);
+// c = a * bt^T (or c += ...), with B supplied transposed (n x k) so that every
+// inner product walks a row of A and a row of bt sequentially.
+void gemm_transposed(MatView c, MatView a, MatView bt, int accumulate);
+// Element-wise d = x + y and d = x - y; d may be x or y.
+void mat_view_add(MatView d, MatView x, MatView y);
+void mat_view_sub(MatView d, MatView x, MatView y);
+
+#endif // GEMM_H
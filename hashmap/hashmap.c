@@ -0,0 +1,526 @@
+#include "hashmap.h"
+#include <stdio.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HASH_HAVE_SSE2 1
+#endif
+
+// The probe loops are written once and inlined into each table type, so
+// IntMap's constant hash and compare callbacks become direct inline code
+#define HASH_INLINE static inline __attribute__((always_inline))
+
+#define HASH_SEED0 0xa0761d6478bd642fULL
+#define HASH_SEED1 0xe7037ed1a0b428dbULL
+#define HASH_SEED2 0x8ebc6af09c88c6e3ULL
+
+// --- Hashing ---
+
+// Folded 64x64->128 multiply: every output bit depends on every input bit
+static inline uint64_t hash_mum(uint64_t a, uint64_t b)
+{
+  __extension__ unsigned __int128 r = (unsigned __int128)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t hash_load64(const unsigned char *p)
+{
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t hash_load32(const unsigned char *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint64_t hash_bytes(const void *data, size_t len)
+{
+  const unsigned char *p = data;
+  uint64_t acc = HASH_SEED0 ^ len;
+  while (len > 16)
+  {
+    acc = hash_mum(hash_load64(p) ^ HASH_SEED1, hash_load64(p + 8) ^ acc);
+    p += 16;
+    len -= 16;
+  }
+  // The last 1..16 bytes, read as two possibly overlapping words
+  uint64_t a = 0, b = 0;
+  if (len >= 8)
+  {
+    a = hash_load64(p);
+    b = hash_load64(p + len - 8);
+  }
+  else if (len >= 4)
+  {
+    a = hash_load32(p);
+    b = hash_load32(p + len - 4);
+  }
+  else if (len > 0)
+  {
+    a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+  }
+  return hash_mum(hash_mum(a ^ HASH_SEED1, b ^ acc), HASH_SEED2);
+}
+
+static uint64_t hash_default(const void *key, size_t key_size)
+{
+  return hash_bytes(key, key_size);
+}
+
+static int hash_default_eq(const void *a, const void *b, size_t key_size)
+{
+  return memcmp(a, b, key_size) == 0;
+}
+
+uint64_t hash_string(const void *key, size_t key_size)
+{
+  (void)key_size;
+  const String *s = *(String *const *)key;
+  return hash_bytes(s->data, s->length);
+}
+
+int hash_string_eq(const void *a, const void *b, size_t key_size)
+{
+  (void)key_size;
+  const String *x = *(String *const *)a;
+  const String *y = *(String *const *)b;
+  return x->length == y->length && memcmp(x->data, y->data, x->length) == 0;
+}
+
+// --- Control groups ---
+
+// Bit i set when control byte i of the group equals tag
+static inline unsigned hash_group_match(const int8_t *ctrl, int8_t tag)
+{
+#ifdef HASH_HAVE_SSE2
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HASH_GROUP_WIDTH; i++)
+    mask |= (unsigned)(ctrl[i] == tag) << i;
+  return mask;
+#endif
+}
+
+// EMPTY and DELETED are the control bytes with the sign bit set
+static inline unsigned hash_group_match_free(const int8_t *ctrl)
+{
+#ifdef HASH_HAVE_SSE2
+  return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HASH_GROUP_WIDTH; i++)
+    mask |= (unsigned)(ctrl[i] < 0) << i;
+  return mask;
+#endif
+}
+
+// --- Table core ---
+
+static size_t hash_usable(size_t capacity) { return capacity - capacity / 8; }
+
+static size_t hash_capacity_for(size_t n)
+{
+  size_t capacity = HASH_GROUP_WIDTH;
+  while (hash_usable(capacity) < n && capacity <= SIZE_MAX / 4)
+    capacity *= 2;
+  return capacity;
+}
+
+static int hash_table_alloc(HashTable *t, size_t capacity, size_t slot_size)
+{
+  if (capacity > (SIZE_MAX - capacity) / slot_size)
+  {
+    fprintf(stderr, "Error: Hash table of %zu slots is too large.\n", capacity);
+    return 0;
+  }
+  int8_t *block = alloc_malloc(capacity + capacity * slot_size, ALLOC_HASH);
+  if (!block)
+  {
+    fprintf(stderr, "Memory allocation failed for hash table (%zu slots).\n", capacity);
+    return 0;
+  }
+  memset(block, HASH_CTRL_EMPTY, capacity);
+  t->ctrl = block;
+  t->slots = (char *)block + capacity;
+  t->capacity = capacity;
+  t->size = 0;
+  t->growth_left = hash_usable(capacity);
+  return 1;
+}
+
+static void hash_table_free(HashTable *t)
+{
+  alloc_free(t->ctrl, ALLOC_HASH);
+  *t = (HashTable){0};
+}
+
+// Groups are probed quadratically (1, 2, 3, ... groups apart), which visits
+// every group of a power-of-two table
+HASH_INLINE size_t hash_find(const HashTable *t, uint64_t h, const void *key, size_t key_size, size_t slot_size,
+                             HashEqFn eq)
+{
+  if (t->capacity == 0)
+    return SIZE_MAX;
+  size_t mask = t->capacity / HASH_GROUP_WIDTH - 1;
+  size_t g = (size_t)(h >> 7) & mask;
+  int8_t tag = (int8_t)(h & 0x7F);
+  for (size_t step = 1;; step++)
+  {
+    const int8_t *ctrl = t->ctrl + g * HASH_GROUP_WIDTH;
+    for (unsigned m = hash_group_match(ctrl, tag); m != 0; m &= m - 1)
+    {
+      size_t i = g * HASH_GROUP_WIDTH + (size_t)__builtin_ctz(m);
+      if (eq(t->slots + i * slot_size, key, key_size))
+        return i;
+    }
+    // A key is never placed past a group that still has an EMPTY slot
+    if (hash_group_match(ctrl, HASH_CTRL_EMPTY) != 0)
+      return SIZE_MAX;
+    g = (g + step) & mask;
+  }
+}
+
+// First EMPTY or DELETED slot on the probe path of h (one always exists)
+static inline size_t hash_find_free(const HashTable *t, uint64_t h)
+{
+  size_t mask = t->capacity / HASH_GROUP_WIDTH - 1;
+  size_t g = (size_t)(h >> 7) & mask;
+  for (size_t step = 1;; step++)
+  {
+    unsigned m = hash_group_match_free(t->ctrl + g * HASH_GROUP_WIDTH);
+    if (m != 0)
+      return g * HASH_GROUP_WIDTH + (size_t)__builtin_ctz(m);
+    g = (g + step) & mask;
+  }
+}
+
+// Moves every entry into a fresh table of the given capacity, dropping tombstones
+HASH_INLINE int hash_table_resize(HashTable *t, size_t capacity, size_t key_size, size_t slot_size, HashFn hash)
+{
+  HashTable fresh;
+  if (!hash_table_alloc(&fresh, capacity, slot_size))
+    return 0;
+  for (size_t i = 0; i < t->capacity; i++)
+  {
+    if (t->ctrl[i] < 0)
+      continue;
+    const char *slot = t->slots + i * slot_size;
+    uint64_t h = hash(slot, key_size);
+    size_t j = hash_find_free(&fresh, h);
+    fresh.ctrl[j] = (int8_t)(h & 0x7F);
+    memcpy(fresh.slots + j * slot_size, slot, slot_size);
+  }
+  fresh.size = t->size;
+  fresh.growth_left -= t->size;
+  alloc_free(t->ctrl, ALLOC_HASH);
+  *t = fresh;
+  return 1;
+}
+
+// Claims a slot for a key known to be absent, rehashing first when only
+// EMPTY slots are left to take. Mostly-tombstone tables are rebuilt at the
+// same size; otherwise the capacity doubles. NULL on error.
+HASH_INLINE char *hash_claim(HashTable *t, uint64_t h, size_t key_size, size_t slot_size, HashFn hash)
+{
+  size_t i = t->capacity != 0 ? hash_find_free(t, h) : 0;
+  if (t->capacity == 0 || (t->growth_left == 0 && t->ctrl[i] == HASH_CTRL_EMPTY))
+  {
+    size_t capacity = t->capacity == 0                          ? HASH_GROUP_WIDTH
+                      : t->size < hash_usable(t->capacity) / 2 ? t->capacity
+                                                                : t->capacity * 2;
+    if (!hash_table_resize(t, capacity, key_size, slot_size, hash))
+      return NULL;
+    i = hash_find_free(t, h);
+  }
+  if (t->ctrl[i] == HASH_CTRL_EMPTY)
+    t->growth_left--;
+  t->ctrl[i] = (int8_t)(h & 0x7F);
+  t->size++;
+  return t->slots + i * slot_size;
+}
+
+// A group that still has an EMPTY slot has never been probed past, so the
+// slot can go back to EMPTY; otherwise it must stay a tombstone
+static void hash_erase(HashTable *t, size_t i)
+{
+  const int8_t *group = t->ctrl + (i & ~(size_t)(HASH_GROUP_WIDTH - 1));
+  if (hash_group_match(group, HASH_CTRL_EMPTY) != 0)
+  {
+    t->ctrl[i] = HASH_CTRL_EMPTY;
+    t->growth_left++;
+  }
+  else
+  {
+    t->ctrl[i] = HASH_CTRL_DELETED;
+  }
+  t->size--;
+}
+
+HASH_INLINE int hash_table_reserve(HashTable *t, size_t n, size_t key_size, size_t slot_size, HashFn hash)
+{
+  if (n <= t->size + t->growth_left)
+    return 1;
+  return hash_table_resize(t, hash_capacity_for(n), key_size, slot_size, hash);
+}
+
+// --- Generic map and set ---
+
+// Natural alignment guess for an element: largest power of two dividing size, at most 16
+static size_t hash_align(size_t size)
+{
+  size_t align = 1;
+  while (align < 16 && size % (align * 2) == 0)
+    align *= 2;
+  return align;
+}
+
+HashMap *hashmap_new(size_t key_size, size_t value_size, HashFn hash, HashEqFn eq)
+{
+  if (key_size == 0)
+  {
+    fprintf(stderr, "Error: HashMap key size must be positive.\n");
+    return NULL;
+  }
+  HashMap *map = alloc_malloc(sizeof(HashMap), ALLOC_HASH);
+  if (!map)
+  {
+    fprintf(stderr, "Memory allocation failed for HashMap struct.\n");
+    return NULL;
+  }
+  size_t key_align = hash_align(key_size);
+  size_t value_align = value_size > 0 ? hash_align(value_size) : 1;
+  size_t slot_align = key_align > value_align ? key_align : value_align;
+  map->table = (HashTable){0};
+  map->key_size = key_size;
+  map->value_size = value_size;
+  map->value_offset = (key_size + value_align - 1) / value_align * value_align;
+  map->slot_size = (map->value_offset + value_size + slot_align - 1) / slot_align * slot_align;
+  map->hash = hash ? hash : hash_default;
+  map->eq = eq ? eq : hash_default_eq;
+  return map;
+}
+
+void hashmap_destroy(HashMap *map)
+{
+  if (map == NULL)
+    return;
+  hash_table_free(&map->table);
+  alloc_free(map, ALLOC_HASH);
+}
+
+int hashmap_reserve(HashMap *map, size_t n)
+{
+  if (map == NULL)
+    return 0;
+  return hash_table_reserve(&map->table, n, map->key_size, map->slot_size, map->hash);
+}
+
+int hashmap_put(HashMap *map, const void *key, const void *value)
+{
+  if (map == NULL || key == NULL)
+  {
+    fprintf(stderr, "Error: Cannot put into a NULL HashMap or with a NULL key.\n");
+    return 0;
+  }
+  uint64_t h = map->hash(key, map->key_size);
+  size_t i = hash_find(&map->table, h, key, map->key_size, map->slot_size, map->eq);
+  char *slot;
+  if (i != SIZE_MAX)
+  {
+    slot = map->table.slots + i * map->slot_size;
+  }
+  else
+  {
+    slot = hash_claim(&map->table, h, map->key_size, map->slot_size, map->hash);
+    if (!slot)
+      return 0;
+    memcpy(slot, key, map->key_size);
+  }
+  if (value != NULL)
+    memcpy(slot + map->value_offset, value, map->value_size);
+  else
+    memset(slot + map->value_offset, 0, map->value_size);
+  return 1;
+}
+
+void *hashmap_get(HashMap *map, const void *key)
+{
+  if (map == NULL || key == NULL)
+    return NULL;
+  size_t i = hash_find(&map->table, map->hash(key, map->key_size), key, map->key_size, map->slot_size, map->eq);
+  return i != SIZE_MAX ? map->table.slots + i * map->slot_size + map->value_offset : NULL;
+}
+
+int hashmap_contains(HashMap *map, const void *key)
+{
+  if (map == NULL || key == NULL)
+    return 0;
+  return hash_find(&map->table, map->hash(key, map->key_size), key, map->key_size, map->slot_size, map->eq) !=
+         SIZE_MAX;
+}
+
+int hashmap_remove(HashMap *map, const void *key)
+{
+  if (map == NULL || key == NULL)
+    return 0;
+  size_t i = hash_find(&map->table, map->hash(key, map->key_size), key, map->key_size, map->slot_size, map->eq);
+  if (i == SIZE_MAX)
+    return 0;
+  hash_erase(&map->table, i);
+  return 1;
+}
+
+size_t hashmap_size(HashMap *map)
+{
+  return map ? map->table.size : 0;
+}
+
+void hashmap_clear(HashMap *map)
+{
+  if (map == NULL || map->table.capacity == 0)
+    return;
+  memset(map->table.ctrl, HASH_CTRL_EMPTY, map->table.capacity);
+  map->table.size = 0;
+  map->table.growth_left = hash_usable(map->table.capacity);
+}
+
+int hashmap_next(HashMap *map, size_t *pos, void **key, void **value)
+{
+  if (map == NULL || pos == NULL)
+    return 0;
+  for (size_t i = *pos; i < map->table.capacity; i++)
+  {
+    if (map->table.ctrl[i] < 0)
+      continue;
+    char *slot = map->table.slots + i * map->slot_size;
+    if (key != NULL)
+      *key = slot;
+    if (value != NULL)
+      *value = slot + map->value_offset;
+    *pos = i + 1;
+    return 1;
+  }
+  *pos = map->table.capacity;
+  return 0;
+}
+
+HashSet *hashset_new(size_t key_size, HashFn hash, HashEqFn eq)
+{
+  return hashmap_new(key_size, 0, hash, eq);
+}
+
+void hashset_destroy(HashSet *set) { hashmap_destroy(set); }
+
+int hashset_add(HashSet *set, const void *key) { return hashmap_put(set, key, NULL); }
+
+int hashset_contains(HashSet *set, const void *key) { return hashmap_contains(set, key); }
+
+int hashset_remove(HashSet *set, const void *key) { return hashmap_remove(set, key); }
+
+size_t hashset_size(HashSet *set) { return hashmap_size(set); }
+
+// --- IntMap ---
+
+static inline uint64_t intmap_hash(const void *key, size_t key_size)
+{
+  (void)key_size;
+  return hash_mum((uint64_t)(uint32_t)*(const int *)key ^ HASH_SEED0, HASH_SEED1);
+}
+
+static inline int intmap_eq(const void *a, const void *b, size_t key_size)
+{
+  (void)key_size;
+  return *(const int *)a == *(const int *)b;
+}
+
+IntMap *intmap_new(void)
+{
+  IntMap *map = alloc_malloc(sizeof(IntMap), ALLOC_HASH);
+  if (!map)
+  {
+    fprintf(stderr, "Memory allocation failed for IntMap struct.\n");
+    return NULL;
+  }
+  map->table = (HashTable){0};
+  return map;
+}
+
+void intmap_destroy(IntMap *map)
+{
+  if (map == NULL)
+    return;
+  hash_table_free(&map->table);
+  alloc_free(map, ALLOC_HASH);
+}
+
+int intmap_reserve(IntMap *map, size_t n)
+{
+  if (map == NULL)
+    return 0;
+  return hash_table_reserve(&map->table, n, sizeof(int), sizeof(IntMapSlot), intmap_hash);
+}
+
+int intmap_put(IntMap *map, int key, int value)
+{
+  if (map == NULL)
+  {
+    fprintf(stderr, "Error: Cannot put into a NULL IntMap.\n");
+    return 0;
+  }
+  uint64_t h = intmap_hash(&key, sizeof(int));
+  size_t i = hash_find(&map->table, h, &key, sizeof(int), sizeof(IntMapSlot), intmap_eq);
+  IntMapSlot *slot;
+  if (i != SIZE_MAX)
+  {
+    slot = (IntMapSlot *)map->table.slots + i;
+  }
+  else
+  {
+    slot = (IntMapSlot *)hash_claim(&map->table, h, sizeof(int), sizeof(IntMapSlot), intmap_hash);
+    if (!slot)
+      return 0;
+    slot->key = key;
+  }
+  slot->value = value;
+  return 1;
+}
+
+int intmap_get(IntMap *map, int key, int *out_value)
+{
+  if (map == NULL)
+    return 0;
+  size_t i = hash_find(&map->table, intmap_hash(&key, sizeof(int)), &key, sizeof(int), sizeof(IntMapSlot), intmap_eq);
+  if (i == SIZE_MAX)
+    return 0;
+  if (out_value != NULL)
+    *out_value = ((IntMapSlot *)map->table.slots)[i].value;
+  return 1;
+}
+
+int intmap_contains(IntMap *map, int key)
+{
+  return intmap_get(map, key, NULL);
+}
+
+int intmap_remove(IntMap *map, int key)
+{
+  if (map == NULL)
+    return 0;
+  size_t i = hash_find(&map->table, intmap_hash(&key, sizeof(int)), &key, sizeof(int), sizeof(IntMapSlot), intmap_eq);
+  if (i == SIZE_MAX)
+    return 0;
+  hash_erase(&map->table, i);
+  return 1;
+}
+
+size_t intmap_size(IntMap *map)
+{
+  return map ? map->table.size : 0;
+}
@@ -0,0 +1,98 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stddef.h> // for size_t
+#include <stdint.h>
+#include "../types/types.h"
+
+// Open-addressing hash tables in the SwissTable layout. Next to the flat
+// slot array sits one control byte per slot: a 7-bit tag from the hash for
+// a full slot, or EMPTY / DELETED. Slots are probed a group of
+// HASH_GROUP_WIDTH at a time: one SIMD compare of the group's control bytes
+// against the tag yields a bitmask of candidates, so the keys themselves
+// are compared only on a tag hit (about 1 in 128 for a non-matching key).
+// Tables hold at most 7/8 of their capacity and double when full.
+//
+// Pointers into a table (from get or next) are valid until the next insert.
+#define HASH_GROUP_WIDTH 16
+#define HASH_CTRL_EMPTY ((int8_t)-128)
+#define HASH_CTRL_DELETED ((int8_t)-2)
+
+typedef uint64_t (*HashFn)(const void *key, size_t key_size);
+typedef int (*HashEqFn)(const void *a, const void *b, size_t key_size); // Nonzero when equal
+
+typedef struct
+{
+  int8_t *ctrl;       // capacity control bytes, followed by the slots in the same block
+  char *slots;        // capacity slots
+  size_t capacity;    // 0 or a power of two, at least HASH_GROUP_WIDTH
+  size_t size;        // Full slots
+  size_t growth_left; // Inserts into EMPTY slots left before a rehash
+} HashTable;
+
+// Generic map: keys and values are copied in and out as key_size and
+// value_size bytes, like Vec's elem_size
+typedef struct
+{
+  HashTable table;
+  size_t key_size;
+  size_t value_size;
+  size_t value_offset; // Of the value within a slot
+  size_t slot_size;
+  HashFn hash;
+  HashEqFn eq;
+} HashMap;
+
+// A set is a map without values
+typedef HashMap HashSet;
+
+// hash and eq may be NULL to hash and compare the key bytes. NULL on error.
+HashMap *hashmap_new(size_t key_size, size_t value_size, HashFn hash, HashEqFn eq);
+void hashmap_destroy(HashMap *map);
+int hashmap_reserve(HashMap *map, size_t n); // Room for n entries without rehashing; 1 on success
+// Inserts or overwrites; a NULL value stores zeros. 1 on success.
+int hashmap_put(HashMap *map, const void *key, const void *value);
+void *hashmap_get(HashMap *map, const void *key); // The value, or NULL when absent
+int hashmap_contains(HashMap *map, const void *key);
+int hashmap_remove(HashMap *map, const void *key); // 1 if the key was present
+size_t hashmap_size(HashMap *map);
+void hashmap_clear(HashMap *map); // Keeps the capacity
+// Iteration: start with *pos = 0; returns 0 after the last entry
+int hashmap_next(HashMap *map, size_t *pos, void **key, void **value);
+
+HashSet *hashset_new(size_t key_size, HashFn hash, HashEqFn eq);
+void hashset_destroy(HashSet *set);
+int hashset_add(HashSet *set, const void *key); // 1 on success, whether or not it was present
+int hashset_contains(HashSet *set, const void *key);
+int hashset_remove(HashSet *set, const void *key);
+size_t hashset_size(HashSet *set);
+
+// Fast non-cryptographic hash of len bytes
+uint64_t hash_bytes(const void *data, size_t len);
+// For String * keys: hash and compare the contents. The table stores the
+// pointers, so the strings must outlive their entries and stay unchanged.
+uint64_t hash_string(const void *key, size_t key_size);
+int hash_string_eq(const void *a, const void *b, size_t key_size);
+
+// int -> int map with the hash and key compare inlined into the probe loop
+typedef struct
+{
+  int key;
+  int value;
+} IntMapSlot;
+
+typedef struct
+{
+  HashTable table;
+} IntMap;
+
+IntMap *intmap_new(void); // NULL on error
+void intmap_destroy(IntMap *map);
+int intmap_reserve(IntMap *map, size_t n);
+int intmap_put(IntMap *map, int key, int value);
+int intmap_get(IntMap *map, int key, int *out_value); // 1 when present
+int intmap_contains(IntMap *map, int key);
+int intmap_remove(IntMap *map, int key);
+size_t intmap_size(IntMap *map);
+
+#endif // HASHMAP_H
@@ -2,6 +2,9 @@
 #include "../types/types.h"
 #include "../string/string.h"
 #include "../parser/parser.h"
+#include "../alloc/alloc.h"
+#include "input.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,9 +22,12 @@ ReadResult int_read_line()
     Result rs = String_read_line(s);
     if (rs.status == ERR)
     {
-      fprintf(stderr, "Error: %s\n", rs.data.err_str);
-      String_destroy(s); // Free memory before continuing
-      continue;
+      String_destroy(s); // Free memory before returning
+      if (feof(stdin))
+      { // No more input can arrive (piped or redirected stdin): treat it like 'q'
+        return (ReadResult){READ_STOPPED, .data.ok = NULL};
+      }
+      return (ReadResult){READ_ERR, .data.err_str = rs.data.err_str};
     }
     else
     {
@@ -44,4 +50,146 @@ ReadResult int_read_line()
     }
   }
   return (ReadResult){READ_OK, .data.ok = ri.data.ok};
-}
\ No newline at end of file
+}
+
+// --- Batch Integer Reader ---
+
+#define INT_READER_BUFSIZE (1 << 16)
+
+static int int_reader_is_space(char c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Opens a reader on a file path, or on stdin when path is "-"
+IntReader *int_reader_open(const char *path)
+{
+  IntReader *r = alloc_malloc(sizeof(IntReader), ALLOC_INPUT);
+  if (!r)
+    return NULL;
+  r->buf = alloc_malloc(INT_READER_BUFSIZE, ALLOC_INPUT);
+  if (!r->buf)
+  {
+    alloc_free(r, ALLOC_INPUT);
+    return NULL;
+  }
+  r->fp = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+  if (!r->fp)
+  {
+    alloc_free(r->buf, ALLOC_INPUT);
+    alloc_free(r, ALLOC_INPUT);
+    return NULL;
+  }
+  r->len = 0;
+  r->pos = 0;
+  r->eof = 0;
+  r->line = 1;
+  return r;
+}
+
+// Keeps the unread tail and appends the next block; returns 0 once input is exhausted
+static int int_reader_fill(IntReader *r)
+{
+  if (r->eof)
+    return 0;
+  memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+  r->len -= r->pos;
+  r->pos = 0;
+  size_t n = fread(r->buf + r->len, 1, INT_READER_BUFSIZE - r->len, r->fp);
+  if (n == 0)
+  {
+    r->eof = 1;
+    return 0;
+  }
+  r->len += n;
+  return 1;
+}
+
+// Same rules as parse_to_int, on a token that is not NUL-terminated
+static ReadStatus int_reader_parse(const char *p, const char *end, int *out_value)
+{
+  int sign = 1;
+  if (p < end && *p == '-')
+  {
+    sign = -1;
+    p++;
+  }
+  if (p == end)
+    return READ_ERR;
+  int num = 0;
+  for (; p < end; p++)
+  {
+    if (*p < '0' || *p > '9')
+      return READ_ERR;
+    int digit = *p - '0';
+    if (sign == 1 ? num > (INT_MAX - digit) / 10 : num < (INT_MIN + digit) / 10)
+      return READ_ERR;
+    num = num * 10 + sign * digit;
+  }
+  *out_value = num;
+  return READ_OK;
+}
+
+// Reads the next integer. READ_STOPPED on 'q' or end of input, READ_ERR on a bad token
+// (the token is consumed, so the caller may simply continue).
+ReadStatus int_reader_next(IntReader *r, int *out_value)
+{
+  // Skip whitespace and comments
+  while (1)
+  {
+    if (r->pos >= r->len)
+    {
+      if (!int_reader_fill(r))
+        return READ_STOPPED;
+      continue;
+    }
+    char c = r->buf[r->pos];
+    if (c == '#')
+    {
+      while (r->pos < r->len && r->buf[r->pos] != '\n')
+      {
+        r->pos++;
+        if (r->pos >= r->len && !int_reader_fill(r))
+          return READ_STOPPED;
+      }
+      continue;
+    }
+    if (!int_reader_is_space(c))
+      break;
+    if (c == '\n')
+      r->line++;
+    r->pos++;
+  }
+
+  // Make sure the whole token is buffered
+  size_t end = r->pos;
+  while (1)
+  {
+    while (end < r->len && !int_reader_is_space(r->buf[end]))
+      end++;
+    if (end < r->len || r->eof)
+      break;
+    if (r->pos == 0 && r->len == INT_READER_BUFSIZE)
+      break; // Token fills the whole buffer: certainly not a valid int
+    size_t offset = end - r->pos;
+    int_reader_fill(r);
+    end = r->pos + offset;
+  }
+
+  const char *token = r->buf + r->pos;
+  r->pos = end;
+  if (*token == 'q')
+    return READ_STOPPED;
+  return int_reader_parse(token, r->buf + end, out_value);
+}
+
+void int_reader_close(IntReader *r)
+{
+  if (r)
+  {
+    if (r->fp && r->fp != stdin)
+      fclose(r->fp);
+    alloc_free(r->buf, ALLOC_INPUT);
+    alloc_free(r, ALLOC_INPUT);
+  }
+}
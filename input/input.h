@@ -1,9 +1,26 @@
 #ifndef INPUT_H
 #define INPUT_H
 
+#include <stdio.h>
 #include "../result/result.h"
 #include "../types/types.h"
 
 ReadResult int_read_line();
 
-#endif // INPUT_H
\ No newline at end of file
+// Buffered, prompt-free reader of whitespace separated integers for batch mode.
+// A 'q' token or end of input stops the stream; '#' starts a comment to end of line.
+typedef struct
+{
+  FILE *fp;
+  char *buf;
+  size_t len;
+  size_t pos;
+  int eof;
+  size_t line; // 1-based line of the last token, for error messages
+} IntReader;
+
+IntReader *int_reader_open(const char *path); // "-" reads stdin
+ReadStatus int_reader_next(IntReader *r, int *out_value);
+void int_reader_close(IntReader *r);
+
+#endif // INPUT_H
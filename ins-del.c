@@ -6,6 +6,9 @@
 #include "./vector/vector.h" // Assuming vec_new, vec_destroy, vec_append, vec_get, etc.
 #include "./input/input.h"   // Assuming int_read_line, destroy_read_result, ReadResult, READ_ERR, READ_OK, READ_STOPPED
 #include "./types/types.h"   // Assuming common type definitions like ReadResult (if not already in input.h)
+#include "./perf/perf.h"     // perf_init, perf_begin, perf_end (enabled by LAB_PERF)
+#include "./alloc/alloc.h"   // alloc_realloc (accounting enabled by LAB_ALLOC)
+#include "./batch/batch.h"   // batch_requested, batch_start, batch_next, batch_finish (--batch mode)
 
 // Function prototypes
 // Replaced your custom ResultGetInt and get_int
@@ -18,14 +21,25 @@ int get_value_input(const char *prompt_text);       // Returns specific sentinel
 // Function to get vector of integers from user, now using ReadResult
 void get_vec_int_from_user(Vec *vec); // Modified to be void, prints messages internally
 
-void insert_at_position(Vec *vec, int value, int pos);
-void delete_at_position(Vec *vec, int pos);
+int insert_at_position(Vec *vec, int value, int pos); // Returns 1 on success, 0 on failure
+int delete_at_position(Vec *vec, int pos, int *out_value); // Returns 1 on success, 0 on failure
 void print_array(Vec *vec);
+// Runs the program non-interactively from a script (see Batch Mode below)
+int run_batch(const char *path);
 
 // Main function
-int main()
+int main(int argc, char **argv)
 {
   int pos_val, value_val;
+  int ok;
+  PerfScope scope;
+
+  perf_init();
+  const char *batch_path;
+  if (batch_requested(argc, argv, &batch_path))
+  {
+    return run_batch(batch_path);
+  }
   Vec *vec = vec_new(sizeof(int), 0); // Initialize with 0 capacity
 
   if (vec == NULL)
@@ -73,7 +87,13 @@ int main()
         fprintf(stderr, "Insert position input cancelled or invalid. Returning to menu.\n");
         break;
       }
-      insert_at_position(vec, value_val, pos_val);
+      perf_begin(&scope, "insert_at_position");
+      ok = insert_at_position(vec, value_val, pos_val);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Successfully inserted %d at position %d.\n", value_val, pos_val);
+      }
       print_array(vec); // Print after successful insert
       break;
 
@@ -84,7 +104,13 @@ int main()
         fprintf(stderr, "Delete position input cancelled or invalid. Returning to menu.\n");
         break;
       }
-      delete_at_position(vec, pos_val);
+      perf_begin(&scope, "delete_at_position");
+      ok = delete_at_position(vec, pos_val, &value_val);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Successfully deleted element '%d' at position %d.\n", value_val, pos_val);
+      }
       print_array(vec); // Print after successful delete
       break;
 
@@ -249,18 +275,18 @@ void get_vec_int_from_user(Vec *vec)
 }
 
 // Inserts a value at a specified position in the vector
-void insert_at_position(Vec *vec, int value, int pos)
+int insert_at_position(Vec *vec, int value, int pos)
 {
   if (vec == NULL)
   {
     fprintf(stderr, "Error: Cannot insert into a NULL vector.\n");
-    return;
+    return 0;
   }
   // Check bounds for insertion (pos can be vec->length for appending)
   if (pos < 0 || (size_t)pos > vec->length)
   {
     printf("Error: Invalid position %d for insertion. Position must be between 0 and %zu.\n", pos, vec->length);
-    return;
+    return 0;
   }
 
   // Ensure there is enough capacity for the new element
@@ -269,12 +295,11 @@ void insert_at_position(Vec *vec, int value, int pos)
   if (vec->length >= vec->capacity)
   {
     size_t new_capacity = (vec->capacity == 0) ? 1 : vec->capacity * 2;
-    printf("Resizing vector from capacity %zu to %zu...\n", vec->capacity, new_capacity);
-    void *new_data = realloc(vec->data, new_capacity * vec->elem_size);
+    void *new_data = alloc_realloc(vec->data, new_capacity * vec->elem_size, vec->site); // Charged where the vector was created
     if (!new_data)
     {
       fprintf(stderr, "Error: Memory allocation failed during vector resize for insertion. Cannot insert %d.\n", value);
-      return;
+      return 0;
     }
     vec->data = new_data;
     vec->capacity = new_capacity;
@@ -292,32 +317,34 @@ void insert_at_position(Vec *vec, int value, int pos)
   // Insert the new value at the desired position
   memcpy((char *)vec->data + pos * vec->elem_size, &value, vec->elem_size);
   vec->length++; // Increment the length of the vector
-
-  printf("Successfully inserted %d at position %d.\n", value, pos);
+  return 1;
 }
 
 // Deletes a value at a specified position in the vector
-void delete_at_position(Vec *vec, int pos)
+int delete_at_position(Vec *vec, int pos, int *out_value)
 {
   if (vec == NULL)
   {
     fprintf(stderr, "Error: Cannot delete from a NULL vector.\n");
-    return;
+    return 0;
   }
   if (vec->length == 0)
   {
     printf("Array is empty. Cannot delete any element.\n");
-    return;
+    return 0;
   }
   // Check bounds for deletion (pos must be within existing elements)
   if (pos < 0 || (size_t)pos >= vec->length)
   {
     printf("Error: Invalid position %d for deletion. Position must be between 0 and %zu.\n", pos, vec->length - 1);
-    return;
+    return 0;
   }
 
-  // Get the value being deleted for user feedback (optional)
-  int deleted_value = *(int *)vec_get(vec, pos);
+  // Report the value being deleted for user feedback (optional)
+  if (out_value != NULL)
+  {
+    *out_value = *(int *)vec_get(vec, pos);
+  }
 
   // Shift elements to the left to overwrite the deleted element
   for (size_t i = pos; i < vec->length - 1; i++)
@@ -327,8 +354,7 @@ void delete_at_position(Vec *vec, int pos)
            vec->elem_size);
   }
   vec->length--; // Decrement the length of the vector
-
-  printf("Successfully deleted element '%d' at position %d.\n", deleted_value, pos);
+  return 1;
 }
 
 // Prints all elements in the vector
@@ -351,3 +377,74 @@ void print_array(Vec *vec)
   }
   printf("\n");
 }
+
+// --- Batch Mode ---
+// Script: initial integers terminated by 'q', then the interactive menu numbers,
+// "1 value pos" insert, "2 pos" delete, "3" print, "4" (or 'q') exit. Only printing produces output.
+int run_batch(const char *path)
+{
+  BatchRun *run = batch_start("ins-del", path);
+  if (!run)
+    return 1;
+  Vec *vec = vec_new(sizeof(int), 0);
+  if (vec == NULL)
+  {
+    batch_finish(run);
+    return 1;
+  }
+
+  int choice, value, pos;
+  while (batch_next(run, &value) == READ_OK) // Initial vector, up to the first 'q'
+  {
+    if (!vec_append(vec, &value))
+    {
+      run->errors++;
+      break;
+    }
+    run->ops++;
+  }
+
+  int running = 1;
+  int ok = 1;
+  while (running && batch_next(run, &choice) == READ_OK)
+  {
+    switch (choice)
+    {
+    case 1: // Insert
+      if (batch_operand(run, &value) != READ_OK || batch_operand(run, &pos) != READ_OK)
+      {
+        running = 0;
+        continue;
+      }
+      ok = insert_at_position(vec, value, pos);
+      break;
+    case 2: // Delete
+      if (batch_operand(run, &pos) != READ_OK)
+      {
+        running = 0;
+        continue;
+      }
+      ok = delete_at_position(vec, pos, NULL);
+      break;
+    case 3: // Print
+      print_array(vec);
+      ok = 1;
+      break;
+    case 4: // Exit
+      running = 0;
+      continue;
+    default:
+      fprintf(stderr, "ins-del: invalid choice %d, skipped.\n", choice);
+      ok = 0;
+      break;
+    }
+    run->ops++;
+    if (!ok)
+      run->errors++;
+  }
+
+  vec_destroy(vec);
+  int status = run->errors > 0;
+  batch_finish(run);
+  return status;
+}
@@ -0,0 +1,374 @@
+#include "lfqueue.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "../alloc/alloc.h"
+
+#define LFQUEUE_CHUNK_NODES 256
+#define LFQUEUE_MIN_SCAN 32
+
+static LfChunk *lfqueue_chunk_new(size_t count)
+{
+  LfChunk *chunk = alloc_malloc(sizeof(LfChunk) + sizeof(LfNode) * count, ALLOC_QUEUE);
+  if (!chunk)
+  {
+    fprintf(stderr, "Memory allocation failed for queue nodes (%zu nodes).\n", count);
+    return NULL;
+  }
+  chunk->next = NULL;
+  chunk->count = count;
+  return chunk;
+}
+
+static void lfqueue_chunks_destroy(LfChunk *chunk)
+{
+  while (chunk != NULL)
+  {
+    LfChunk *next = chunk->next;
+    alloc_free(chunk, ALLOC_QUEUE);
+    chunk = next;
+  }
+}
+
+LfQueue *lfqueue_new(void)
+{
+  LfQueue *q = alloc_malloc(sizeof(LfQueue), ALLOC_QUEUE);
+  if (!q)
+  {
+    fprintf(stderr, "Memory allocation failed for LfQueue struct.\n");
+    return NULL;
+  }
+  q->chunks = lfqueue_chunk_new(1);
+  if (!q->chunks)
+  {
+    alloc_free(q, ALLOC_QUEUE);
+    return NULL;
+  }
+  LfNode *dummy = &q->chunks->nodes[0];
+  atomic_init(&dummy->next, NULL);
+  atomic_init(&q->head, dummy);
+  atomic_init(&q->tail, dummy);
+  atomic_init(&q->handles, NULL);
+  atomic_init(&q->nhandles, 0);
+  return q;
+}
+
+void lfqueue_destroy(LfQueue *q)
+{
+  if (q == NULL)
+    return;
+  LfHandle *h = atomic_load(&q->handles);
+  while (h != NULL)
+  {
+    LfHandle *next = h->next;
+    lfqueue_chunks_destroy(h->chunks);
+    alloc_free(h->retired, ALLOC_QUEUE);
+    alloc_free(h, ALLOC_QUEUE);
+    h = next;
+  }
+  lfqueue_chunks_destroy(q->chunks);
+  alloc_free(q, ALLOC_QUEUE);
+}
+
+LfHandle *lfqueue_attach(LfQueue *q)
+{
+  if (q == NULL)
+  {
+    fprintf(stderr, "Error: Cannot attach to a NULL queue.\n");
+    return NULL;
+  }
+  for (LfHandle *h = atomic_load(&q->handles); h != NULL; h = h->next)
+  {
+    int expected = 0;
+    if (atomic_load_explicit(&h->in_use, memory_order_relaxed) == 0 &&
+        atomic_compare_exchange_strong(&h->in_use, &expected, 1))
+      return h;
+  }
+  LfHandle *h = alloc_malloc(sizeof(LfHandle), ALLOC_QUEUE);
+  if (!h)
+  {
+    fprintf(stderr, "Memory allocation failed for LfHandle struct.\n");
+    return NULL;
+  }
+  for (int i = 0; i < LFQUEUE_HAZARDS; i++)
+    atomic_init(&h->hazard[i], NULL);
+  atomic_init(&h->in_use, 1);
+  h->queue = q;
+  h->free_list = NULL;
+  h->retired = NULL;
+  h->nretired = 0;
+  h->retired_capacity = 0;
+  h->chunks = NULL;
+  h->next = atomic_load(&q->handles);
+  while (!atomic_compare_exchange_weak(&q->handles, &h->next, h))
+    ;
+  atomic_fetch_add(&q->nhandles, 1);
+  return h;
+}
+
+void lfqueue_detach(LfHandle *h)
+{
+  if (h == NULL)
+    return;
+  for (int i = 0; i < LFQUEUE_HAZARDS; i++)
+    atomic_store(&h->hazard[i], NULL);
+  atomic_store_explicit(&h->in_use, 0, memory_order_release);
+}
+
+static LfNode *lfqueue_node_new(LfHandle *h)
+{
+  if (h->free_list == NULL)
+  {
+    LfChunk *chunk = lfqueue_chunk_new(LFQUEUE_CHUNK_NODES);
+    if (!chunk)
+      return NULL;
+    chunk->next = h->chunks;
+    h->chunks = chunk;
+    for (size_t i = chunk->count; i-- > 0;)
+    {
+      chunk->nodes[i].free_next = h->free_list;
+      h->free_list = &chunk->nodes[i];
+    }
+  }
+  LfNode *node = h->free_list;
+  h->free_list = node->free_next;
+  return node;
+}
+
+static int lfqueue_hazardous(LfQueue *q, LfNode *node)
+{
+  for (LfHandle *other = atomic_load(&q->handles); other != NULL; other = other->next)
+    for (int i = 0; i < LFQUEUE_HAZARDS; i++)
+      if (atomic_load(&other->hazard[i]) == node)
+        return 1;
+  return 0;
+}
+
+// Moves retired nodes no thread holds a hazard pointer to onto the free list
+static void lfqueue_scan(LfHandle *h)
+{
+  size_t kept = 0;
+  for (size_t i = 0; i < h->nretired; i++)
+  {
+    LfNode *node = h->retired[i];
+    if (lfqueue_hazardous(h->queue, node))
+    {
+      h->retired[kept++] = node;
+    }
+    else
+    {
+      node->free_next = h->free_list;
+      h->free_list = node;
+    }
+  }
+  h->nretired = kept;
+}
+
+static void lfqueue_retire(LfHandle *h, LfNode *node)
+{
+  // Scanning after 2x the hazard pointers in use frees at least half the batch
+  size_t threshold = 2 * LFQUEUE_HAZARDS * (size_t)atomic_load_explicit(&h->queue->nhandles, memory_order_relaxed);
+  if (threshold < LFQUEUE_MIN_SCAN)
+    threshold = LFQUEUE_MIN_SCAN;
+  if (h->nretired == h->retired_capacity)
+  {
+    size_t capacity = h->retired_capacity ? h->retired_capacity * 2 : threshold;
+    LfNode **retired = alloc_realloc(h->retired, sizeof(LfNode *) * capacity, ALLOC_QUEUE);
+    if (!retired)
+    {
+      lfqueue_scan(h);
+      if (h->nretired == h->retired_capacity)
+        return; // Not reused, but still freed with its chunk
+    }
+    else
+    {
+      h->retired = retired;
+      h->retired_capacity = capacity;
+    }
+  }
+  h->retired[h->nretired++] = node;
+  if (h->nretired >= threshold)
+    lfqueue_scan(h);
+}
+
+int lfqueue_enqueue(LfHandle *h, int value)
+{
+  if (h == NULL)
+  {
+    fprintf(stderr, "Error: Cannot enqueue through a NULL queue handle.\n");
+    return 0;
+  }
+  LfQueue *q = h->queue;
+  LfNode *node = lfqueue_node_new(h);
+  if (!node)
+    return 0;
+  node->data = value;
+  atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+  for (;;)
+  {
+    LfNode *tail = atomic_load(&q->tail);
+    atomic_store(&h->hazard[0], tail);
+    if (tail != atomic_load(&q->tail))
+      continue;
+    LfNode *next = atomic_load(&tail->next);
+    if (next != NULL)
+    {
+      // Help a producer that linked its node but has not swung the tail yet
+      atomic_compare_exchange_strong(&q->tail, &tail, next);
+      continue;
+    }
+    if (atomic_compare_exchange_strong(&tail->next, &next, node))
+    {
+      atomic_compare_exchange_strong(&q->tail, &tail, node);
+      break;
+    }
+  }
+  atomic_store_explicit(&h->hazard[0], NULL, memory_order_release);
+  return 1;
+}
+
+int lfqueue_dequeue(LfHandle *h, int *out_value)
+{
+  if (h == NULL)
+  {
+    fprintf(stderr, "Error: Cannot dequeue through a NULL queue handle.\n");
+    return 0;
+  }
+  LfQueue *q = h->queue;
+  LfNode *head;
+  int value;
+  for (;;)
+  {
+    head = atomic_load(&q->head);
+    atomic_store(&h->hazard[0], head);
+    if (head != atomic_load(&q->head))
+      continue;
+    LfNode *tail = atomic_load(&q->tail);
+    LfNode *next = atomic_load(&head->next);
+    atomic_store(&h->hazard[1], next);
+    if (head != atomic_load(&q->head))
+      continue;
+    if (next == NULL)
+    {
+      atomic_store_explicit(&h->hazard[0], NULL, memory_order_release);
+      atomic_store_explicit(&h->hazard[1], NULL, memory_order_release);
+      return 0;
+    }
+    if (head == tail)
+    {
+      atomic_compare_exchange_strong(&q->tail, &tail, next);
+      continue;
+    }
+    // next becomes the new dummy; its value is read before anyone can retire it
+    value = next->data;
+    if (atomic_compare_exchange_strong(&q->head, &head, next))
+      break;
+  }
+  atomic_store_explicit(&h->hazard[0], NULL, memory_order_release);
+  atomic_store_explicit(&h->hazard[1], NULL, memory_order_release);
+  lfqueue_retire(h, head);
+  if (out_value != NULL)
+    *out_value = value;
+  return 1;
+}
+
+LfRing *lfring_new(size_t capacity)
+{
+  size_t size = 2;
+  while (size < capacity)
+  {
+    if (size > SIZE_MAX / 2 / sizeof(LfCell))
+    {
+      fprintf(stderr, "Error: Ring capacity %zu is too large.\n", capacity);
+      return NULL;
+    }
+    size *= 2;
+  }
+  LfRing *r = alloc_malloc(sizeof(LfRing), ALLOC_QUEUE);
+  if (!r)
+  {
+    fprintf(stderr, "Memory allocation failed for LfRing struct.\n");
+    return NULL;
+  }
+  r->cells = alloc_malloc(sizeof(LfCell) * size, ALLOC_QUEUE);
+  if (!r->cells)
+  {
+    fprintf(stderr, "Memory allocation failed for ring cells (%zu cells).\n", size);
+    alloc_free(r, ALLOC_QUEUE);
+    return NULL;
+  }
+  for (size_t i = 0; i < size; i++)
+    atomic_init(&r->cells[i].seq, i);
+  r->mask = size - 1;
+  atomic_init(&r->enqueue_pos, 0);
+  atomic_init(&r->dequeue_pos, 0);
+  return r;
+}
+
+void lfring_destroy(LfRing *r)
+{
+  if (r == NULL)
+    return;
+  alloc_free(r->cells, ALLOC_QUEUE);
+  alloc_free(r, ALLOC_QUEUE);
+}
+
+// A cell is free for the producer at pos when its seq is pos, and holds a
+// value for the consumer at pos when its seq is pos + 1.
+int lfring_push(LfRing *r, int value)
+{
+  size_t pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+  LfCell *cell;
+  for (;;)
+  {
+    cell = &r->cells[pos & r->mask];
+    size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+    if (dif == 0)
+    {
+      if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + 1, memory_order_relaxed,
+                                                memory_order_relaxed))
+        break;
+    }
+    else if (dif < 0)
+    {
+      return 0; // Consumers are a whole lap behind
+    }
+    else
+    {
+      pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    }
+  }
+  cell->data = value;
+  atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+  return 1;
+}
+
+int lfring_pop(LfRing *r, int *out_value)
+{
+  size_t pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+  LfCell *cell;
+  for (;;)
+  {
+    cell = &r->cells[pos & r->mask];
+    size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (dif == 0)
+    {
+      if (atomic_compare_exchange_weak_explicit(&r->dequeue_pos, &pos, pos + 1, memory_order_relaxed,
+                                                memory_order_relaxed))
+        break;
+    }
+    else if (dif < 0)
+    {
+      return 0; // Nothing published at pos yet
+    }
+    else
+    {
+      pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+    }
+  }
+  if (out_value != NULL)
+    *out_value = cell->data;
+  atomic_store_explicit(&cell->seq, pos + r->mask + 1, memory_order_release);
+  return 1;
+}
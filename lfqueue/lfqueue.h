@@ -0,0 +1,99 @@
+#ifndef LFQUEUE_H
+#define LFQUEUE_H
+
+#include <stdatomic.h>
+#include <stddef.h> // for size_t
+
+// Lock-free multi-producer multi-consumer queues of ints.
+//
+// LfQueue is the Michael-Scott linked queue: a list of nodes with a dummy
+// at the head, where producers CAS a node onto the tail and consumers CAS
+// the head forward. Dequeued nodes are reclaimed with hazard pointers: a
+// thread publishes the nodes it is about to dereference, and a retired node
+// is only reused once no hazard pointer names it. Each thread works through
+// an LfHandle that holds its hazard pointers, its retired nodes and a free
+// list of nodes ready for reuse, so steady-state traffic never calls malloc.
+//
+// LfRing is Vyukov's bounded MPMC ring: a power-of-two array of cells with
+// per-cell sequence numbers. No allocation after creation and one CAS per
+// operation, but it rejects pushes when full.
+
+#define LFQUEUE_CACHE_LINE 64
+#define LFQUEUE_HAZARDS 2 // Hazard pointers per thread (dequeue needs head and next)
+
+typedef struct LfNode
+{
+  _Atomic(struct LfNode *) next;
+  int data;
+  struct LfNode *free_next; // Link in a free or chunk list, only touched by its owner
+} LfNode;
+
+// Node storage; nodes move between threads but chunks live until the queue is destroyed
+typedef struct LfChunk
+{
+  struct LfChunk *next;
+  size_t count;
+  LfNode nodes[];
+} LfChunk;
+
+typedef struct LfQueue LfQueue;
+
+// Per-thread state. Records are never freed before the queue; a detached
+// record (with its retired and free nodes) is handed to the next attach.
+typedef struct LfHandle
+{
+  _Atomic(LfNode *) hazard[LFQUEUE_HAZARDS];
+  atomic_int in_use;
+  struct LfHandle *next; // Registry link, set before the record is published
+  LfQueue *queue;
+  LfNode *free_list;
+  LfNode **retired;
+  size_t nretired;
+  size_t retired_capacity;
+  LfChunk *chunks;
+} LfHandle;
+
+struct LfQueue
+{
+  _Atomic(LfNode *) head;
+  char pad0[LFQUEUE_CACHE_LINE - sizeof(LfNode *)];
+  _Atomic(LfNode *) tail;
+  char pad1[LFQUEUE_CACHE_LINE - sizeof(LfNode *)];
+  _Atomic(LfHandle *) handles;
+  atomic_int nhandles;
+  LfChunk *chunks; // Holds the initial dummy
+};
+
+LfQueue *lfqueue_new(void); // NULL on error
+// Frees every node and handle; no thread may still be using the queue
+void lfqueue_destroy(LfQueue *q);
+// Each thread attaches once before using the queue and detaches when done. NULL on error.
+LfHandle *lfqueue_attach(LfQueue *q);
+void lfqueue_detach(LfHandle *h);
+int lfqueue_enqueue(LfHandle *h, int value);    // Returns 1 on success, 0 on allocation failure
+int lfqueue_dequeue(LfHandle *h, int *out_value); // Returns 1 on success, 0 when empty
+
+typedef struct
+{
+  atomic_size_t seq;
+  int data;
+} LfCell;
+
+typedef struct
+{
+  LfCell *cells;
+  size_t mask;
+  char pad0[LFQUEUE_CACHE_LINE - sizeof(LfCell *) - sizeof(size_t)];
+  atomic_size_t enqueue_pos;
+  char pad1[LFQUEUE_CACHE_LINE - sizeof(atomic_size_t)];
+  atomic_size_t dequeue_pos;
+  char pad2[LFQUEUE_CACHE_LINE - sizeof(atomic_size_t)];
+} LfRing;
+
+// capacity is rounded up to a power of two (at least 2). NULL on error.
+LfRing *lfring_new(size_t capacity);
+void lfring_destroy(LfRing *r);
+int lfring_push(LfRing *r, int value);      // Returns 1 on success, 0 when full
+int lfring_pop(LfRing *r, int *out_value);  // Returns 1 on success, 0 when empty
+
+#endif // LFQUEUE_H
@@ -4,6 +4,9 @@
 #include "./result/result.h"
 #include "./parser/parser.h"
 #include "./vector/vector.h"
+#include "./search/search.h"
+#include "./perf/perf.h"     // perf_init, perf_begin, perf_end (enabled by LAB_PERF)
+#include "./batch/batch.h"   // batch_requested, batch_start, batch_next, batch_finish (--batch mode)
 
 // type definitions for the results
 typedef enum
@@ -31,10 +34,18 @@ typedef struct
 // Function prototypes
 ResultGetInt get_int();
 ResultGetVecInt get_vec_int(Vec *vec);
-int get_index(Vec *vec, int el);
+// Runs the program non-interactively from a script (see Batch Mode below)
+int run_batch(const char *path);
 
-int main()
+int main(int argc, char **argv)
 {
+  PerfScope scope;
+  perf_init();
+  const char *batch_path;
+  if (batch_requested(argc, argv, &batch_path))
+  {
+    return run_batch(batch_path);
+  }
   Vec *vec = vec_new(sizeof(int), 0);
 
   ResultGetVecInt r = get_vec_int(vec);
@@ -68,20 +79,11 @@ int main()
       vec_destroy(vec);
       return 0;
     }
-    printf("Found at index %d\n", get_index(vec, value.value));
-  }
-}
-
-int get_index(Vec *vec, int el)
-{
-  for (size_t i = 0; i < vec->length; i++)
-  {
-    if (*(int *)vec_get(vec, i) == el)
-    {
-      return (int)i;
-    }
+    perf_begin(&scope, "get_index");
+    int found = get_index(vec, value.value);
+    perf_end(&scope);
+    printf("Found at index %d\n", found);
   }
-  return -1; // Not found
 }
 
 ResultGetInt get_int()
@@ -99,8 +101,12 @@ ResultGetInt get_int()
     Result rs = String_read_line(s);
     if (rs.status == ERR)
     {
-      fprintf(stderr, "Error: %s\n", rs.data.err_str);
       String_destroy(s); // Free memory before continuing
+      if (feof(stdin))
+      { // No more input can arrive: treat it like 'q'
+        return (ResultGetInt){GET_STOPPED, 0, NULL};
+      }
+      fprintf(stderr, "Error: %s\n", rs.data.err_str);
       continue;
     }
     else
@@ -119,8 +125,9 @@ ResultGetInt get_int()
       }
       else
       {
-        result = ri.data.ok;
-        String_destroy(s); // Free memory before breaking
+        result = *(int *)ri.data.ok;
+        destroy_result(&ri); // Free the parsed integer
+        String_destroy(s);   // Free memory before breaking
         break;
       }
     }
@@ -153,3 +160,45 @@ ResultGetVecInt get_vec_int(Vec *vec)
     }
   }
 }
+
+// --- Batch Mode ---
+// Script: the integers to store terminated by 'q', then the values to search for.
+// Prints one index per search (-1 when not found); no prompts are written.
+int run_batch(const char *path)
+{
+  BatchRun *run = batch_start("linear-search", path);
+  if (!run)
+    return 1;
+  Vec *vec = vec_new(sizeof(int), 0);
+  if (vec == NULL)
+  {
+    batch_finish(run);
+    return 1;
+  }
+
+  int value;
+  while (batch_next(run, &value) == READ_OK)
+  {
+    if (!vec_append(vec, &value))
+    {
+      fprintf(stderr, "Error: Memory allocation failed\n");
+      run->errors++;
+      break;
+    }
+    run->ops++;
+  }
+
+  PerfScope scope;
+  perf_begin(&scope, "get_index");
+  while (batch_next(run, &value) == READ_OK)
+  {
+    printf("%d\n", get_index(vec, value));
+    run->ops++;
+  }
+  perf_end(&scope);
+
+  vec_destroy(vec);
+  int status = run->errors > 0;
+  batch_finish(run);
+  return status;
+}
@@ -3,34 +3,30 @@
 #include "./string/string.h" // Assuming String_new, String_read_line, String_destroy, ResultString, ERR
 #include "./result/result.h" // Assuming Result, ERR, OK
 #include "./input/input.h"   // Assuming int_read_line, destroy_read_result, ReadResult, READ_ERR, READ_OK, READ_STOPPED
+#include "./list/list.h"     // Node, insert_at_*, delete_at_*, print_list, destroy_list
+#include "./perf/perf.h"     // perf_init, perf_begin, perf_end (enabled by LAB_PERF)
+#include "./batch/batch.h"   // batch_requested, batch_start, batch_next, batch_finish (--batch mode)
 
-// --- Linked List Node Structure ---
-typedef struct Node
-{
-  int data;
-  struct Node *next;
-} Node;
-
-// --- Function Prototypes ---
-Node *new_node(int data);
-void print_list(Node *head);
-// Insertion operations
-void insert_at_head(Node **head, int data);
-void insert_at_tail(Node **head, int data);
-void insert_at_index(Node **head, int data, int index);
-// Deletion operations
-void delete_at_head(Node **head);
-void delete_at_tail(Node **head);
-void delete_at_index(Node **head, int index);
-void destroy_list(Node **head); // Function to free all nodes
+// Runs the program non-interactively from a script (see Batch Mode below)
+int run_batch(const char *path);
 
 // --- Main Function ---
-int main()
+int main(int argc, char **argv)
 {
   Node *head = NULL;
   int choice_val;
+  int deleted_val;
+  int ok;
+  PerfScope scope;
   ReadResult input_res; // Use ReadResult for all inputs
 
+  perf_init();
+  const char *batch_path;
+  if (batch_requested(argc, argv, &batch_path))
+  {
+    return run_batch(batch_path);
+  }
+
   printf("--- Linked List Operations ---\n");
   printf("1. Insert at head\n");
   printf("2. Insert at tail\n");
@@ -80,7 +76,13 @@ int main()
         destroy_read_result(&input_res);
         break;
       }
-      insert_at_head(&head, *(int *)input_res.data.ok);
+      perf_begin(&scope, "insert_at_head");
+      ok = insert_at_head(&head, *(int *)input_res.data.ok);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Successfully inserted %d at head.\n", *(int *)input_res.data.ok);
+      }
       destroy_read_result(&input_res); // Free the allocated integer for data
       break;
 
@@ -100,12 +102,24 @@ int main()
         break;
       }
       if (head == NULL)
-      {                                                   // Handle case for empty list where tail insert is head insert
-        insert_at_head(&head, *(int *)input_res.data.ok); // insert_at_head prints success
+      { // Handle case for empty list where tail insert is head insert
+        perf_begin(&scope, "insert_at_head");
+        ok = insert_at_head(&head, *(int *)input_res.data.ok);
+        perf_end(&scope);
+        if (ok)
+        {
+          printf("Successfully inserted %d at head.\n", *(int *)input_res.data.ok);
+        }
       }
       else
       {
-        insert_at_tail(&head, *(int *)input_res.data.ok);
+        perf_begin(&scope, "insert_at_tail");
+        ok = insert_at_tail(&head, *(int *)input_res.data.ok);
+        perf_end(&scope);
+        if (ok)
+        {
+          printf("Successfully inserted %d at tail.\n", *(int *)input_res.data.ok);
+        }
       }
       destroy_read_result(&input_res);
       break;
@@ -145,15 +159,33 @@ int main()
       int insert_index = *(int *)input_res.data.ok;
       destroy_read_result(&input_res); // Free index result
 
-      insert_at_index(&head, data_to_insert, insert_index);
+      perf_begin(&scope, "insert_at_index");
+      ok = insert_at_index(&head, data_to_insert, insert_index);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Successfully inserted %d at index %d.\n", data_to_insert, insert_index);
+      }
       break;
 
     case 4: // Delete at head
-      delete_at_head(&head);
+      perf_begin(&scope, "delete_at_head");
+      ok = delete_at_head(&head, &deleted_val);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Deleted head node with data: %d.\n", deleted_val);
+      }
       break;
 
     case 5: // Delete at tail
-      delete_at_tail(&head);
+      perf_begin(&scope, "delete_at_tail");
+      ok = delete_at_tail(&head, &deleted_val);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Deleted tail node with data: %d.\n", deleted_val);
+      }
       break;
 
     case 6: // Delete at index
@@ -173,7 +205,13 @@ int main()
       }
       int delete_index = *(int *)input_res.data.ok;
       destroy_read_result(&input_res); // Free index result
-      delete_at_index(&head, delete_index);
+      perf_begin(&scope, "delete_at_index");
+      ok = delete_at_index(&head, delete_index, &deleted_val);
+      perf_end(&scope);
+      if (ok)
+      {
+        printf("Deleted node at index %d with data: %d.\n", delete_index, deleted_val);
+      }
       break;
 
     case 7: // Print list
@@ -197,198 +235,74 @@ cleanup:
   return 0;
 }
 
-// --- Linked List Operations Implementation ---
-
-// Creates a new node and allocates memory for it
-Node *new_node(int data)
-{
-  Node *node = malloc(sizeof(Node));
-  if (node == NULL)
-  {
-    fprintf(stderr, "Error: Memory allocation failed for new node (data: %d). Returning NULL.\n", data);
-  }
-  node->data = data;
-  node->next = NULL;
-  return node;
-}
-
-// Prints all elements in the list
-void print_list(Node *head)
-{
-  if (head == NULL)
-  {
-    printf("List is empty.\n");
-    return;
-  }
-  Node *current = head;
-  printf("List: ");
-  while (current != NULL)
-  {
-    printf("%d ", current->data);
-    current = current->next;
-  }
-  printf("\n");
-}
-
-// Inserts a new node at the beginning of the list
-void insert_at_head(Node **head, int data)
+// --- Batch Mode ---
+// Script: the interactive menu numbers, "1 value" insert at head, "2 value" insert at tail,
+// "3 value index" insert at index, "4"/"5" delete at head/tail, "6 index" delete at index,
+// "7" print, "8" (or 'q') exit. Only printing produces output.
+int run_batch(const char *path)
 {
-  Node *new = new_node(data);
-  if (new == NULL)
-  { // Handle allocation failure from new_node
-    return;
-  }
-  new->next = *head;
-  *head = new;
-  printf("Successfully inserted %d at head.\n", data);
-}
+  BatchRun *run = batch_start("linked-list-singly", path);
+  if (!run)
+    return 1;
 
-// Inserts a new node at the end of the list
-void insert_at_tail(Node **head, int data)
-{
-  Node *new = new_node(data);
-  if (new == NULL)
-  { // Handle allocation failure
-    return;
-  }
-  if (*head == NULL)
-  {
-    *head = new; // If list is empty, new node becomes the head
-  }
-  else
+  Node *head = NULL;
+  int choice, value, index;
+  int running = 1;
+  int ok = 1;
+  while (running && batch_next(run, &choice) == READ_OK)
   {
-    Node *current = *head;
-    while (current->next != NULL)
+    switch (choice)
     {
-      current = current->next;
+    case 1: // Insert at head
+    case 2: // Insert at tail
+      if (batch_operand(run, &value) != READ_OK)
+      {
+        running = 0;
+        continue;
+      }
+      ok = (choice == 1) ? insert_at_head(&head, value) : insert_at_tail(&head, value);
+      break;
+    case 3: // Insert at index
+      if (batch_operand(run, &value) != READ_OK || batch_operand(run, &index) != READ_OK)
+      {
+        running = 0;
+        continue;
+      }
+      ok = insert_at_index(&head, value, index);
+      break;
+    case 4: // Delete at head
+      ok = delete_at_head(&head, NULL);
+      break;
+    case 5: // Delete at tail
+      ok = delete_at_tail(&head, NULL);
+      break;
+    case 6: // Delete at index
+      if (batch_operand(run, &index) != READ_OK)
+      {
+        running = 0;
+        continue;
+      }
+      ok = delete_at_index(&head, index, NULL);
+      break;
+    case 7: // Print list
+      print_list(head);
+      ok = 1;
+      break;
+    case 8: // Exit
+      running = 0;
+      continue;
+    default:
+      fprintf(stderr, "linked-list-singly: invalid choice %d, skipped.\n", choice);
+      ok = 0;
+      break;
     }
-    current->next = new;
-  }
-  printf("Successfully inserted %d at tail.\n", data);
-}
-
-// Inserts a new node at a specified index
-void insert_at_index(Node **head, int data, int index)
-{
-  if (index < 0)
-  {
-    printf("Error: Index cannot be negative (%d).\n", index);
-    return;
-  }
-  if (index == 0)
-  {
-    insert_at_head(head, data); // This already prints success
-    return;
+    run->ops++;
+    if (!ok)
+      run->errors++;
   }
-  Node *current = *head;
-  // Traverse to the node *before* the insertion point
-  for (int i = 0; i < index - 1 && current != NULL; i++)
-  {
-    current = current->next;
-  }
-  if (current == NULL)
-  {
-    printf("Error: Index %d is out of bounds. List has fewer than %d elements to insert at this position.\n", index, index);
-    return;
-  }
-  Node *new = new_node(data);
-  if (new == NULL)
-  { // Handle allocation failure
-    return;
-  }
-  new->next = current->next;
-  current->next = new;
-  printf("Successfully inserted %d at index %d.\n", data, index);
-}
 
-// Deletes the node at the beginning of the list
-void delete_at_head(Node **head)
-{
-  if (*head == NULL)
-  {
-    printf("List is empty. Cannot delete from head.\n");
-    return;
-  }
-  Node *current = *head;
-  *head = current->next; // Move head to the next node
-  printf("Deleted head node with data: %d.\n", current->data);
-  free(current); // Free the old head node
+  destroy_list(&head);
+  int status = run->errors > 0;
+  batch_finish(run);
+  return status;
 }
-
-// Deletes the node at the end of the list
-void delete_at_tail(Node **head)
-{
-  if (*head == NULL)
-  {
-    printf("List is empty. Cannot delete from tail.\n");
-    return;
-  }
-  Node *current = *head;
-  if (current->next == NULL) // Only one node in the list
-  {
-    printf("Deleted the only node (tail) with data: %d.\n", current->data);
-    free(current);
-    *head = NULL;
-    return;
-  }
-  // Traverse to the second to last node
-  while (current->next->next != NULL)
-  {
-    current = current->next;
-  }
-  printf("Deleted tail node with data: %d.\n", current->next->data);
-  free(current->next);  // Free the last node
-  current->next = NULL; // Set the new last node's next to NULL
-}
-
-// Deletes the node at a specified index
-void delete_at_index(Node **head, int index)
-{
-  if (*head == NULL)
-  {
-    printf("List is empty. Cannot delete at index %d.\n", index);
-    return;
-  }
-  if (index < 0)
-  {
-    printf("Error: Index cannot be negative (%d).\n", index);
-    return;
-  }
-  if (index == 0) // If deleting at head, use delete_at_head
-  {
-    delete_at_head(head); // This already prints success
-    return;
-  }
-
-  Node *current = *head;
-  // Traverse to the node *before* the deletion point
-  for (int i = 0; i < index - 1 && current != NULL; i++)
-  {
-    current = current->next;
-  }
-
-  if (current == NULL || current->next == NULL)
-  {
-    printf("Error: Index %d is out of bounds. No node to delete at this position.\n", index);
-    return;
-  }
-
-  Node *node_to_delete = current->next;
-  current->next = node_to_delete->next; // Bypass the node to be deleted
-  printf("Deleted node at index %d with data: %d.\n", index, node_to_delete->data);
-  free(node_to_delete); // Free the node
-}
-
-// Frees all nodes in the linked list
-void destroy_list(Node **head)
-{
-  Node *current = *head;
-  Node *next_node;
-  while (current != NULL)
-  {
-    next_node = current->next; // Save pointer to the next node
-    free(current);             // Free the current node
-    current = next_node;       // Move to the next node
-  }
-  *head = NULL; // Set head to NULL after freeing all nodes
-}
\ No newline at end of file
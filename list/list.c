@@ -0,0 +1,560 @@
+#include "list.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../alloc/alloc.h"
+
+// --- Linked List Operations Implementation ---
+
+// Bumped whenever this module creates, frees or relinks nodes, so a jump
+// table can tell it may be stale. Shared by all lists: a change to one only
+// costs the others' tables their next walk until they are refreshed.
+static atomic_ullong list_generation;
+
+static void list_changed(void)
+{
+  atomic_fetch_add_explicit(&list_generation, 1, memory_order_relaxed);
+}
+
+// Creates a new node and allocates memory for it
+Node *new_node(int data)
+{
+  Node *node = alloc_malloc(sizeof(Node), ALLOC_LIST);
+  if (node == NULL)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for new node (data: %d). Returning NULL.\n", data);
+    return NULL;
+  }
+  node->data = data;
+  node->slab_index = 0;
+  node->next = NULL;
+  list_changed();
+  return node;
+}
+
+// Nodes built together by list_from_array share one allocation
+typedef struct
+{
+  size_t live; // Nodes not yet freed
+  size_t pad;  // Keeps the nodes 16-byte aligned
+} NodeSlab;
+
+#define NODE_SLAB_MAX 0x7FFFFFFFu // Nodes per slab, so slab_index fits
+
+static void list_free_node(Node *node)
+{
+  if (node->slab_index == 0)
+  {
+    alloc_free(node, ALLOC_LIST);
+    return;
+  }
+  NodeSlab *slab = (NodeSlab *)(node - (node->slab_index - 1)) - 1;
+  if (--slab->live == 0)
+    alloc_free(slab, ALLOC_LIST);
+}
+
+void free_node(Node *node)
+{
+  if (node == NULL)
+    return;
+  list_free_node(node);
+  list_changed();
+}
+
+static int print_node(Node *node, void *ctx)
+{
+  (void)ctx;
+  printf("%d ", node->data);
+  return 1;
+}
+
+// Prints all elements in the list
+void print_list(Node *head)
+{
+  if (head == NULL)
+  {
+    printf("List is empty.\n");
+    return;
+  }
+  printf("List: ");
+  list_visit(head, print_node, NULL);
+  printf("\n");
+}
+
+// Inserts a new node at the beginning of the list
+int insert_at_head(Node **head, int data)
+{
+  Node *new = new_node(data);
+  if (new == NULL)
+  { // Handle allocation failure from new_node
+    return 0;
+  }
+  new->next = *head;
+  *head = new;
+  return 1;
+}
+
+// Inserts a new node at the end of the list
+int insert_at_tail(Node **head, int data)
+{
+  Node *new = new_node(data);
+  if (new == NULL)
+  { // Handle allocation failure
+    return 0;
+  }
+  if (*head == NULL)
+  {
+    *head = new; // If list is empty, new node becomes the head
+  }
+  else
+  {
+    Node *current = *head;
+    while (current->next != NULL)
+    {
+      current = current->next;
+    }
+    current->next = new;
+  }
+  return 1;
+}
+
+// Inserts a new node at a specified index
+int insert_at_index(Node **head, int data, int index)
+{
+  if (index < 0)
+  {
+    printf("Error: Index cannot be negative (%d).\n", index);
+    return 0;
+  }
+  if (index == 0)
+  {
+    return insert_at_head(head, data);
+  }
+  Node *current = *head;
+  // Traverse to the node *before* the insertion point
+  for (int i = 0; i < index - 1 && current != NULL; i++)
+  {
+    current = current->next;
+  }
+  if (current == NULL)
+  {
+    printf("Error: Index %d is out of bounds. List has fewer than %d elements to insert at this position.\n", index, index);
+    return 0;
+  }
+  Node *new = new_node(data);
+  if (new == NULL)
+  { // Handle allocation failure
+    return 0;
+  }
+  new->next = current->next;
+  current->next = new;
+  return 1;
+}
+
+// Deletes the node at the beginning of the list
+int delete_at_head(Node **head, int *out_value)
+{
+  if (*head == NULL)
+  {
+    printf("List is empty. Cannot delete from head.\n");
+    return 0;
+  }
+  Node *current = *head;
+  *head = current->next; // Move head to the next node
+  if (out_value != NULL)
+  {
+    *out_value = current->data;
+  }
+  free_node(current); // Free the old head node
+  return 1;
+}
+
+// Deletes the node at the end of the list
+int delete_at_tail(Node **head, int *out_value)
+{
+  if (*head == NULL)
+  {
+    printf("List is empty. Cannot delete from tail.\n");
+    return 0;
+  }
+  Node *current = *head;
+  if (current->next == NULL) // Only one node in the list
+  {
+    if (out_value != NULL)
+    {
+      *out_value = current->data;
+    }
+    free_node(current);
+    *head = NULL;
+    return 1;
+  }
+  // Traverse to the second to last node
+  while (current->next->next != NULL)
+  {
+    current = current->next;
+  }
+  if (out_value != NULL)
+  {
+    *out_value = current->next->data;
+  }
+  free_node(current->next); // Free the last node
+  current->next = NULL;     // Set the new last node's next to NULL
+  return 1;
+}
+
+// Deletes the node at a specified index
+int delete_at_index(Node **head, int index, int *out_value)
+{
+  if (*head == NULL)
+  {
+    printf("List is empty. Cannot delete at index %d.\n", index);
+    return 0;
+  }
+  if (index < 0)
+  {
+    printf("Error: Index cannot be negative (%d).\n", index);
+    return 0;
+  }
+  if (index == 0) // If deleting at head, use delete_at_head
+  {
+    return delete_at_head(head, out_value);
+  }
+
+  Node *current = *head;
+  // Traverse to the node *before* the deletion point
+  for (int i = 0; i < index - 1 && current != NULL; i++)
+  {
+    current = current->next;
+  }
+
+  if (current == NULL || current->next == NULL)
+  {
+    printf("Error: Index %d is out of bounds. No node to delete at this position.\n", index);
+    return 0;
+  }
+
+  Node *node_to_delete = current->next;
+  current->next = node_to_delete->next; // Bypass the node to be deleted
+  if (out_value != NULL)
+  {
+    *out_value = node_to_delete->data;
+  }
+  free_node(node_to_delete); // Free the node
+  return 1;
+}
+
+static int free_visited(Node *node, void *ctx)
+{
+  (void)ctx;
+  list_free_node(node); // The caller bumps the generation once for the whole list
+  return 1;
+}
+
+// Frees all nodes in the linked list
+void destroy_list(Node **head)
+{
+  list_changed();
+  list_visit(*head, free_visited, NULL);
+  *head = NULL; // Set head to NULL after freeing all nodes
+}
+
+// --- Bulk operations ---
+
+int list_from_array(Node **head, const int *values, size_t n)
+{
+  if (n == 0)
+    return 1;
+  if (values == NULL)
+  {
+    fprintf(stderr, "Error: Cannot build a list from a NULL array.\n");
+    return 0;
+  }
+  Node *first = NULL;
+  Node **link = &first;
+  for (size_t start = 0; start < n; start += NODE_SLAB_MAX)
+  {
+    size_t count = n - start < NODE_SLAB_MAX ? n - start : NODE_SLAB_MAX;
+    NodeSlab *slab = alloc_malloc(sizeof(NodeSlab) + sizeof(Node) * count, ALLOC_LIST);
+    if (slab == NULL)
+    {
+      fprintf(stderr, "Error: Memory allocation failed for a slab of %zu nodes.\n", count);
+      destroy_list(&first);
+      return 0;
+    }
+    slab->live = count;
+    Node *nodes = (Node *)(slab + 1);
+    for (size_t i = 0; i < count; i++)
+    {
+      nodes[i].data = values[start + i];
+      nodes[i].slab_index = (unsigned int)(i + 1);
+      nodes[i].next = &nodes[i + 1];
+    }
+    nodes[count - 1].next = NULL;
+    *link = nodes;
+    link = &nodes[count - 1].next;
+    list_changed();
+  }
+  while (*head != NULL)
+    head = &(*head)->next;
+  *head = first;
+  return 1;
+}
+
+size_t list_to_array(Node *head, int *out, size_t capacity)
+{
+  size_t n = 0;
+  for (Node *current = head; current != NULL; current = current->next, n++)
+  {
+    if (n < capacity)
+      out[n] = current->data;
+  }
+  return n;
+}
+
+size_t list_length(Node *head)
+{
+  size_t n = 0;
+  for (Node *current = head; current != NULL; current = current->next)
+    n++;
+  return n;
+}
+
+// Merges two sorted lists; ties go to a, which holds the earlier elements
+static Node *list_merge(Node *a, Node *b)
+{
+  Node *merged = NULL;
+  Node **tail = &merged;
+  while (a != NULL && b != NULL)
+  {
+    // Both successors may be needed next; start their misses now
+    __builtin_prefetch(a->next);
+    __builtin_prefetch(b->next);
+    if (b->data < a->data)
+    {
+      *tail = b;
+      tail = &b->next;
+      b = b->next;
+    }
+    else
+    {
+      *tail = a;
+      tail = &a->next;
+      a = a->next;
+    }
+  }
+  *tail = a != NULL ? a : b;
+  return merged;
+}
+
+// runs[k] is empty or a sorted run of 2^k nodes, like the bits of a binary
+// counter. Each node taken from the list is carried up through the full
+// slots, so runs are merged soon after their nodes were last touched
+// instead of in whole-list passes. 64 slots cover any list that fits in memory.
+void list_sort(Node **head)
+{
+  list_changed();
+  Node *runs[64] = {NULL};
+  int top = 0; // Slots in use are below top
+  Node *current = *head;
+  while (current != NULL)
+  {
+    Node *carry = current;
+    current = current->next;
+    carry->next = NULL;
+    int k = 0;
+    for (; k < top && runs[k] != NULL; k++)
+    {
+      carry = list_merge(runs[k], carry);
+      runs[k] = NULL;
+    }
+    runs[k] = carry;
+    if (k == top)
+      top++;
+  }
+  Node *sorted = NULL;
+  for (int k = 0; k < top; k++)
+  {
+    if (runs[k] != NULL)
+      sorted = list_merge(runs[k], sorted);
+  }
+  *head = sorted;
+}
+
+// --- Traversal ---
+
+// The prefetch distance is one node, and a longer lookahead window would not
+// buy more: a node's address is only known once its predecessor has arrived,
+// so the chain has at most one miss in flight however far ahead the walk
+// reads. What the prefetch does buy is overlapping that miss with the
+// visitor's work. More misses in flight need addresses from elsewhere, which
+// is what the jump table provides.
+size_t list_visit(Node *head, ListVisitor visit, void *ctx)
+{
+  size_t visited = 0;
+  Node *current = head;
+  while (current != NULL)
+  {
+    Node *next = current->next;
+    __builtin_prefetch(next);
+    visited++;
+    if (!visit(current, ctx))
+      break;
+    current = next;
+  }
+  return visited;
+}
+
+int list_jumps_refresh(ListJumps *jumps, Node *head)
+{
+  if (jumps == NULL)
+  {
+    fprintf(stderr, "Error: Cannot refresh a NULL jump table.\n");
+    return 0;
+  }
+  jumps->count = 0;
+  jumps->length = 0;
+  jumps->generation = atomic_load_explicit(&list_generation, memory_order_relaxed);
+  for (Node *current = head; current != NULL; current = current->next, jumps->length++)
+  {
+    if (jumps->length % jumps->stride != 0)
+      continue;
+    if (jumps->count == jumps->capacity)
+    {
+      size_t capacity = jumps->capacity ? jumps->capacity * 2 : 16;
+      Node **marks = alloc_realloc(jumps->marks, sizeof(Node *) * capacity, ALLOC_LIST);
+      if (marks == NULL)
+      {
+        fprintf(stderr, "Error: Memory allocation failed for %zu jump pointers.\n", capacity);
+        jumps->count = 0;
+        jumps->length = 0;
+        return 0;
+      }
+      jumps->marks = marks;
+      jumps->capacity = capacity;
+    }
+    jumps->marks[jumps->count++] = current;
+  }
+  return 1;
+}
+
+ListJumps *list_jumps_build(Node *head, size_t stride)
+{
+  ListJumps *jumps = alloc_calloc(1, sizeof(ListJumps), ALLOC_LIST);
+  if (jumps == NULL)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for ListJumps struct.\n");
+    return NULL;
+  }
+  jumps->stride = stride == 0 || stride > LIST_JUMP_MAX_STRIDE ? LIST_JUMP_MAX_STRIDE : stride;
+  if (!list_jumps_refresh(jumps, head))
+  {
+    list_jumps_destroy(jumps);
+    return NULL;
+  }
+  return jumps;
+}
+
+void list_jumps_destroy(ListJumps *jumps)
+{
+  if (jumps == NULL)
+    return;
+  alloc_free(jumps->marks, ALLOC_LIST);
+  alloc_free(jumps, ALLOC_LIST);
+}
+
+int list_jumps_valid(ListJumps *jumps, Node *head)
+{
+  if (jumps == NULL || jumps->generation != atomic_load_explicit(&list_generation, memory_order_relaxed))
+    return 0;
+  return jumps->count > 0 ? jumps->marks[0] == head : head == NULL;
+}
+
+size_t list_visit_jumps(Node *head, ListJumps *jumps, ListVisitor visit, void *ctx)
+{
+  if (!list_jumps_valid(jumps, head))
+    return list_visit(head, visit, ctx);
+  Node *window[LIST_JUMP_LANES][LIST_JUMP_MAX_STRIDE];
+  size_t visited = 0;
+  for (size_t first = 0; first < jumps->count; first += LIST_JUMP_LANES)
+  {
+    size_t lanes = jumps->count - first < LIST_JUMP_LANES ? jumps->count - first : LIST_JUMP_LANES;
+    Node *cursor[LIST_JUMP_LANES];
+    size_t len[LIST_JUMP_LANES] = {0};
+    for (size_t l = 0; l < lanes; l++)
+    {
+      cursor[l] = jumps->marks[first + l];
+      if (first + LIST_JUMP_LANES + l < jumps->count)
+        __builtin_prefetch(jumps->marks[first + LIST_JUMP_LANES + l]);
+    }
+    // One hop per lane per round: the lanes' loads are independent
+    for (size_t step = 0; step < jumps->stride; step++)
+    {
+      for (size_t l = 0; l < lanes; l++)
+      {
+        if (cursor[l] != NULL)
+        {
+          window[l][len[l]++] = cursor[l];
+          cursor[l] = cursor[l]->next;
+        }
+      }
+    }
+    for (size_t l = 0; l < lanes; l++)
+    {
+      for (size_t i = 0; i < len[l]; i++)
+      {
+        visited++;
+        if (!visit(window[l][i], ctx))
+          return visited;
+      }
+    }
+  }
+  return visited;
+}
+
+static int sum_visited(Node *node, void *ctx)
+{
+  *(long long *)ctx += node->data;
+  return 1;
+}
+
+long long list_sum(Node *head, ListJumps *jumps)
+{
+  long long sum = 0;
+  list_visit_jumps(head, jumps, sum_visited, &sum);
+  return sum;
+}
+
+typedef struct
+{
+  int value;
+  Node *found;
+} ListFind;
+
+static int find_visited(Node *node, void *ctx)
+{
+  ListFind *find = ctx;
+  if (node->data != find->value)
+    return 1;
+  find->found = node;
+  return 0;
+}
+
+Node *list_find(Node *head, ListJumps *jumps, int value)
+{
+  ListFind find = {value, NULL};
+  list_visit_jumps(head, jumps, find_visited, &find);
+  return find.found;
+}
+
+void destroy_list_jumps(Node **head, ListJumps *jumps)
+{
+  list_visit_jumps(*head, jumps, free_visited, NULL);
+  list_changed();
+  *head = NULL;
+  if (jumps != NULL)
+  {
+    jumps->count = 0;
+    jumps->length = 0;
+    jumps->generation = atomic_load_explicit(&list_generation, memory_order_relaxed); // Valid for the empty list
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef LIST_H
+#define LIST_H
+
+#include <stddef.h> // for size_t
+
+// --- Linked List Node Structure ---
+typedef struct Node
+{
+  int data;
+  unsigned int slab_index; // 0 for nodes from new_node, else 1 + position in a list_from_array slab
+  struct Node *next;
+} Node;
+
+Node *new_node(int data);
+void free_node(Node *node); // Frees a node from either source
+void print_list(Node *head);
+// Insertion operations (return 1 on success, 0 on failure)
+int insert_at_head(Node **head, int data);
+int insert_at_tail(Node **head, int data);
+int insert_at_index(Node **head, int data, int index);
+// Deletion operations (return 1 on success, 0 on failure; out_value may be NULL)
+int delete_at_head(Node **head, int *out_value);
+int delete_at_tail(Node **head, int *out_value);
+int delete_at_index(Node **head, int index, int *out_value);
+void destroy_list(Node **head); // Function to free all nodes
+
+// --- Bulk operations ---
+// Appends values to the list. The new nodes are carved out of one slab in
+// list order, so walking them reads memory sequentially; the slab is freed
+// when its last node is. Returns 1 on success, 0 on failure.
+int list_from_array(Node **head, const int *values, size_t n);
+// Copies up to capacity values into out and returns the list length
+size_t list_to_array(Node *head, int *out, size_t capacity);
+size_t list_length(Node *head);
+// Stable ascending sort by relinking nodes: bottom-up merge sort with no
+// recursion and no allocation, merging runs while they are still in cache
+void list_sort(Node **head);
+
+// --- Traversal ---
+// Called for each node in order; return 0 to stop. The node's next pointer
+// has already been read, so a visitor may free the node.
+typedef int (*ListVisitor)(Node *node, void *ctx);
+// Visits every node, prefetching the next one before each call. Returns the
+// number of nodes visited (including the one that stopped the walk).
+size_t list_visit(Node *head, ListVisitor visit, void *ctx);
+
+// Jump pointers: a side table holding every stride-th node. A walk with the
+// table follows LIST_JUMP_LANES segments at once, one hop per segment per
+// round, so up to that many misses are in flight instead of one, then
+// visits the gathered nodes in list order. The table is a snapshot stamped
+// with a generation that this module bumps whenever it creates, frees or
+// relinks nodes (of any list). A walk whose table is stale, or was built
+// for a list with another head, falls back to list_visit, so it stays
+// correct but slow until list_jumps_refresh. Changing data is fine; linking
+// nodes by hand without the functions here is not detected.
+#define LIST_JUMP_LANES 8
+#define LIST_JUMP_MAX_STRIDE 64
+
+typedef struct
+{
+  Node **marks;  // marks[i] is node i * stride
+  size_t count;
+  size_t capacity;
+  size_t stride;
+  size_t length; // Nodes in the list when the table was built
+  unsigned long long generation; // List generation at the last refresh
+} ListJumps;
+
+// stride 0 picks LIST_JUMP_MAX_STRIDE; larger strides are clamped to it. NULL on error.
+ListJumps *list_jumps_build(Node *head, size_t stride);
+int list_jumps_refresh(ListJumps *jumps, Node *head); // Returns 1 on success, 0 on failure
+void list_jumps_destroy(ListJumps *jumps);
+// 1 when a walk of head can use the table, 0 when it would fall back
+int list_jumps_valid(ListJumps *jumps, Node *head);
+// Walks with the table when it is valid for head, else (or when jumps is NULL) with list_visit
+size_t list_visit_jumps(Node *head, ListJumps *jumps, ListVisitor visit, void *ctx);
+
+// Bulk operations on top of the visitors; jumps may be NULL for a plain walk
+long long list_sum(Node *head, ListJumps *jumps);
+Node *list_find(Node *head, ListJumps *jumps, int value); // First node holding value, or NULL
+// Frees every node and empties the table
+void destroy_list_jumps(Node **head, ListJumps *jumps);
+
+#endif // LIST_H
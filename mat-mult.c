@@ -1,39 +1,39 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h> // STDOUT_FILENO
 #include "./string/string.h" // Assuming String_new, String_read_line, String_destroy, ResultString, ERR
 #include "./result/result.h" // Assuming Result, ERR, OK
 #include "./vector/vector.h" // Assuming Vec, vec_new, vec_append, vec_get, vec_destroy
 #include "./input/input.h"   // Assuming int_read_line, destroy_read_result, ReadResult, READ_ERR, READ_OK, READ_STOPPED
 #include "./types/types.h"   // Assuming common type definitions if any are used by the above
-
-typedef struct
-{
-  Vec *rows;
-  int nrows;
-  int ncols;
-} Mat;
+#include "./matrix/matrix.h" // Mat, mat_new, mat_input, print_mat, mat_add, mat_mult, mat_destroy
+#include "./perf/perf.h"     // perf_init, perf_begin, perf_end (enabled by LAB_PERF)
+#include "./batch/batch.h"   // batch_requested, batch_option, batch_start, batch_finish (--batch mode)
+#include "./writer/writer.h" // Writer, OutFormat (--format in batch mode)
 
 // --- Function Prototypes ---
-Mat *mat_new(int rows, int cols);
-ReadResult mat_input(Mat *mat);
-void print_mat(Mat *mat);
-int matrix_get(Mat *mat, int i, int j);
-void matrix_set(Mat *mat, int i, int j, int value);
-Mat *mat_mult(Mat *mat1, Mat *mat2);
-void mat_destroy(Mat *mat);
-
 // Helper function to get an integer input with error handling
 // Returns the valid integer (must be positive), or 0 if an error occurred or input was stopped.
 int get_dimension_input(const char *prompt_text);
+// Runs the program non-interactively from a script (see Batch Mode below)
+int run_batch(const char *path, const char *format_name);
 
 // --- Main Function ---
-int main()
+int main(int argc, char **argv)
 {
   int rows1, cols1;
   int rows2, cols2;
   Mat *mat1 = NULL;
   Mat *mat2 = NULL;
   Mat *result_mat = NULL;
+  PerfScope scope;
+
+  perf_init();
+  const char *batch_path;
+  if (batch_requested(argc, argv, &batch_path))
+  {
+    return run_batch(batch_path, batch_option(argc, argv, "--format"));
+  }
 
   printf("--- Matrix Multiplication Program ---\n");
 
@@ -101,7 +101,9 @@ int main()
 
   // --- Perform matrix multiplication ---
   printf("\nPerforming Matrix Multiplication...\n");
+  perf_begin(&scope, "mat_mult");
   result_mat = mat_mult(mat1, mat2);
+  perf_end(&scope);
   if (!result_mat)
   {
     fprintf(stderr, "Error: Matrix multiplication failed (incompatible dimensions or memory allocation issue).\n");
@@ -112,7 +114,9 @@ int main()
   }
 
   printf("\n--- Result Matrix (Multiplication) ---\n");
+  perf_begin(&scope, "print_mat");
   print_mat(result_mat);
+  perf_end(&scope);
 
   // --- Clean up memory ---
   printf("\nCleaning up memory...\n");
@@ -160,174 +164,73 @@ int get_dimension_input(const char *prompt_text)
   }
 }
 
-// --- Matrix Utility Functions ---
-
-// allocates memory for a matrix with nrows rows and ncols columns
-Mat *mat_new(int nrows, int ncols)
+// --- Batch Mode ---
+// Script: one or more jobs of "rows1 cols1 elements1... rows2 cols2 elements2...".
+// Each result is printed with print_mat, or written raw with mat_write when
+// --format tsv|csv|bin|mm is given; no prompts are written.
+int run_batch(const char *path, const char *format_name)
 {
-  Mat *mat = malloc(sizeof(Mat));
-  if (!mat)
-  {
-    fprintf(stderr, "Memory allocation failed for Mat struct.\n");
-    return NULL;
-  }
-  mat->nrows = nrows;
-  mat->ncols = ncols;
-
-  mat->rows = vec_new(sizeof(Vec *), nrows);
-  if (!mat->rows)
-  {
-    fprintf(stderr, "Memory allocation failed for rows vector.\n");
-    free(mat);
-    return NULL;
-  }
-
-  // Allocate each row vector
-  for (int i = 0; i < nrows; i++)
+  OutFormat format = OUT_TSV;
+  if (format_name && !writer_parse_format(format_name, &format))
+    return 1;
+  BatchRun *run = batch_start("mat-mult", path);
+  if (!run)
+    return 1;
+  Writer *out = NULL; // Only used with --format
+  if (format_name)
   {
-    Vec *row = vec_new(sizeof(int), ncols);
-    if (!row)
+    fflush(stdout);
+    out = writer_new(STDOUT_FILENO, 0);
+    if (!out)
     {
-      fprintf(stderr, "Memory allocation failed for row %d.\n", i);
-      // Clean up already allocated rows and the main vector before returning NULL
-      for (int k = 0; k < i; k++)
-      {
-        vec_destroy(*(Vec **)vec_get(mat->rows, k));
-      }
-      vec_destroy(mat->rows); // Destroy the vector storing row pointers
-      free(mat);              // Free the Mat struct itself
-      return NULL;
+      batch_finish(run);
+      return 1;
     }
-    vec_append(mat->rows, &row); // Append pointer to the new row vector
   }
-  return mat;
-}
-
-// returns the value of the element at row i, column j
-int matrix_get(Mat *mat, int i, int j)
-{
-  Vec *row = *(Vec **)vec_get(mat->rows, i);
-  return ((int *)row->data)[j];
-}
-
-// sets the value of the element at row i, column j to value
-void matrix_set(Mat *mat, int i, int j, int value)
-{
-  Vec *row = *(Vec **)vec_get(mat->rows, i);
-  ((int *)row->data)[j] = value;
-}
-
-// reads the elements of the matrix from the user
-ReadResult mat_input(Mat *mat)
-{
-  ReadResult value_result;
-  for (int i = 0; i < mat->nrows; i++)
+  int status = 0;
+  PerfScope scope;
+  while (1)
   {
-    for (int j = 0; j < mat->ncols; j++)
+    Mat *mat1, *mat2;
+    if (mat_read_batch(run, &mat1) != READ_OK)
+      break; // Clean end of script, or an error already counted
+    ReadStatus second = mat_read_batch(run, &mat2);
+    if (second != READ_OK)
     {
-      while (1)
+      if (second == READ_STOPPED)
       {
-        printf("Enter element at row %d, column %d: ", i + 1, j + 1); // User-friendly 1-based indexing
-        value_result = int_read_line();
-        if (value_result.status == READ_ERR)
-        {
-          fprintf(stderr, "Error: %s. Please try again.\n", value_result.data.err_str);
-          destroy_read_result(&value_result);
-          continue;
-        }
-        else if (value_result.status == READ_STOPPED)
-        {
-          fprintf(stderr, "Input stopped by user.\n");
-          // Important: Return READ_STOPPED so main can clean up
-          return (ReadResult){READ_STOPPED, .data.ok = NULL};
-        }
-        matrix_set(mat, i, j, *(int *)value_result.data.ok);
-        destroy_read_result(&value_result); // Destroy the result after use
-        break;
+        fprintf(stderr, "Error: Batch input ended before the second matrix.\n");
+        run->errors++;
       }
+      mat_destroy(mat1);
+      break;
     }
-  }
-  return (ReadResult){READ_OK, .data.ok = NULL}; // Indicate success
-}
-
-// prints the matrix to the screen
-void print_mat(Mat *mat)
-{
-  if (mat == NULL)
-  { // Handle case where matrix is NULL
-    printf("Cannot print a NULL matrix.\n");
-    return;
-  }
-  printf("Matrix (%dx%d):\n", mat->nrows, mat->ncols);
-  for (int i = 0; i < mat->nrows; i++)
-  {
-    for (int j = 0; j < mat->ncols; j++)
+    perf_begin(&scope, "mat_mult");
+    Mat *result_mat = mat_mult(mat1, mat2);
+    perf_end(&scope);
+    if (result_mat && out)
     {
-      printf("%d\t", matrix_get(mat, i, j)); // Use tab for better spacing
+      perf_begin(&scope, "mat_write");
+      mat_write(result_mat, out, format);
+      perf_end(&scope);
     }
-    printf("\n");
-  }
-}
-
-// returns the product of the two matrices
-Mat *mat_mult(Mat *mat1, Mat *mat2)
-{
-  if (mat1 == NULL || mat2 == NULL)
-  {
-    fprintf(stderr, "Error: Cannot multiply a NULL matrix.\n");
-    return NULL;
-  }
-  if (mat1->ncols != mat2->nrows)
-  {
-    fprintf(stderr, "Error: Incompatible matrix dimensions for multiplication. "
-                    "Number of columns in first matrix (%d) must equal number of rows in second matrix (%d).\n",
-            mat1->ncols, mat2->nrows);
-    return NULL;
-  }
-
-  Mat *result = mat_new(mat1->nrows, mat2->ncols);
-  if (!result)
-  {
-    fprintf(stderr, "Error: Memory allocation failed for result matrix in multiplication.\n");
-    return NULL;
-  }
-
-  for (int i = 0; i < result->nrows; i++)
-  {
-    for (int j = 0; j < result->ncols; j++)
+    else if (result_mat)
     {
-      int sum = 0;
-      for (int k = 0; k < mat1->ncols; k++) // mat1->ncols is same as mat2->nrows
-      {
-        sum += matrix_get(mat1, i, k) * matrix_get(mat2, k, j);
-      }
-      matrix_set(result, i, j, sum);
+      print_mat(result_mat);
     }
-  }
-  return result;
-}
-
-// frees memory allocated for the matrix
-void mat_destroy(Mat *mat)
-{
-  if (mat == NULL)
-  {
-    return; // Nothing to destroy if matrix pointer is NULL
-  }
-  if (mat->rows != NULL)
-  {
-    // Destroy each row vector pointed to by the 'rows' vector
-    for (int i = 0; i < mat->nrows; i++)
+    else
     {
-      Vec *row = *(Vec **)vec_get(mat->rows, i);
-      if (row != NULL) // Defensive check, though vec_new should ensure non-NULL
-      {
-        vec_destroy(row);
-      }
+      run->errors++;
+      status = 1;
     }
-    // Destroy the vector that holds pointers to the rows
-    vec_destroy(mat->rows);
+    mat_destroy(result_mat);
+    mat_destroy(mat1);
+    mat_destroy(mat2);
   }
-  // Finally, free the Mat struct itself
-  free(mat);
-}
\ No newline at end of file
+  if (!writer_destroy(out))
+    status = 1;
+  if (run->errors > 0)
+    status = 1;
+  batch_finish(run);
+  return status;
+}
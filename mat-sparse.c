@@ -1,42 +1,34 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h> // STDOUT_FILENO
 #include "./string/string.h" // Assuming String_new, String_read_line, String_destroy, ResultString, ERR
 #include "./result/result.h" // Assuming Result, ERR, OK
 #include "./input/input.h"   // Assuming int_read_line, destroy_read_result, ReadResult, READ_ERR, READ_OK, READ_STOPPED
-
-typedef struct
-{
-  size_t row;
-  size_t col;
-  int value;
-} SparseEntry;
-
-typedef struct
-{
-  int nrows;
-  int ncols;
-  int nnz;           // Number of non-zero elements
-  size_t capacity;   // Current allocated capacity for data
-  SparseEntry *data; // Array of non-zero entries
-} SparseMat;
+#include "./sparse/sparse.h" // SparseMat, sparse_new, sparse_add, sparse_print, sparse_get, mat_print, sparse_mat_destroy
+#include "./perf/perf.h"     // perf_init, perf_begin, perf_end (enabled by LAB_PERF)
+#include "./batch/batch.h"   // batch_requested, batch_option, batch_start, batch_finish (--batch mode)
+#include "./writer/writer.h" // Writer, OutFormat (--format in batch mode)
 
 // Function prototypes
-SparseMat *sparse_new(int nrows, int ncols); // Removed max_nnz, will dynamically resize
-void sparse_add(SparseMat *mat, int row, int col, int value);
-void sparse_print(SparseMat *mat);
-int sparse_get(SparseMat *mat, int row, int col);
-void sparse_mat_destroy(SparseMat *mat);
-void mat_print(SparseMat *mat);
-
 // Helper function for safe integer input
 int get_matrix_dimension_input(const char *prompt_text);
 int get_matrix_element_input(const char *prompt_text);
+// Runs the program non-interactively from a script (see Batch Mode below)
+int run_batch(const char *path, const char *format_name);
 
 // --- Main Function ---
-int main()
+int main(int argc, char **argv)
 {
   int nrows, ncols;
   SparseMat *mat = NULL;
+  PerfScope scope;
+
+  perf_init();
+  const char *batch_path;
+  if (batch_requested(argc, argv, &batch_path))
+  {
+    return run_batch(batch_path, batch_option(argc, argv, "--format"));
+  }
 
   printf("--- Sparse Matrix Creation ---\n");
 
@@ -81,10 +73,14 @@ int main()
   }
 
   printf("\n--- Sparse Matrix Representation ---\n");
+  perf_begin(&scope, "sparse_print");
   sparse_print(mat);
+  perf_end(&scope);
 
   printf("\n--- Matrix in Dense Format ---\n");
+  perf_begin(&scope, "mat_print");
   mat_print(mat);
+  perf_end(&scope);
 
   printf("\nCleaning up memory...\n");
   sparse_mat_destroy(mat);
@@ -160,140 +156,87 @@ int get_matrix_element_input(const char *prompt_text)
   }
 }
 
-// --- Sparse Matrix Operations Implementation ---
-
-#define INITIAL_SPARSE_CAPACITY 10
-#define RESIZE_FACTOR 2
-
-// Allocates memory for a new sparse matrix
-SparseMat *sparse_new(int nrows, int ncols)
+// --- Batch Mode ---
+// Script: one or more jobs of "rows cols elements...". Non-zero elements are stored,
+// then each matrix is printed in COO and dense format (or written with sparse_write
+// when --format tsv|csv|bin|mm is given); no prompts are written.
+int run_batch(const char *path, const char *format_name)
 {
-  SparseMat *mat = malloc(sizeof(SparseMat));
-  if (!mat)
-  {
-    fprintf(stderr, "Memory allocation failed for SparseMat struct.\n");
-    return NULL;
-  }
-
-  mat->nrows = nrows;
-  mat->ncols = ncols;
-  mat->nnz = 0;
-  mat->capacity = INITIAL_SPARSE_CAPACITY; // Start with a default capacity
-
-  mat->data = malloc(sizeof(SparseEntry) * mat->capacity);
-  if (!mat->data)
-  {
-    fprintf(stderr, "Memory allocation failed for SparseEntry data array.\n");
-    free(mat); // Free the partially allocated struct
-    return NULL;
-  }
-  return mat;
-}
-
-// Adds a non-zero element to the sparse matrix. Handles dynamic resizing.
-void sparse_add(SparseMat *mat, int row, int col, int value)
-{
-  if (value == 0) // We only store non-zero values
-    return;
-
-  // Check if we need to resize the data array
-  if (mat->nnz >= mat->capacity)
+  OutFormat format = OUT_TSV;
+  if (format_name && !writer_parse_format(format_name, &format))
+    return 1;
+  BatchRun *run = batch_start("mat-sparse", path);
+  if (!run)
+    return 1;
+  Writer *out = NULL; // Only used with --format
+  if (format_name)
   {
-    size_t new_capacity = mat->capacity * RESIZE_FACTOR;
-    SparseEntry *new_data = realloc(mat->data, sizeof(SparseEntry) * new_capacity);
-    if (!new_data)
+    fflush(stdout);
+    out = writer_new(STDOUT_FILENO, 0);
+    if (!out)
     {
-      fprintf(stderr, "Error: Failed to reallocate memory for sparse matrix data. Cannot add more elements.\n");
-      // In a real application, you might want to return an error status here.
-      // For now, we'll just stop adding new elements to prevent crash.
-      return;
+      batch_finish(run);
+      return 1;
     }
-    mat->data = new_data;
-    mat->capacity = new_capacity;
-    printf("Sparse matrix data array resized to %zu elements.\n", mat->capacity);
-  }
-
-  // Add the new entry
-  mat->data[mat->nnz].row = row;
-  mat->data[mat->nnz].col = col;
-  mat->data[mat->nnz].value = value;
-  mat->nnz++;
-}
-
-// Prints the sparse matrix in COO format (row, col, value)
-void sparse_print(SparseMat *mat)
-{
-  if (mat == NULL)
-  {
-    printf("Cannot print a NULL sparse matrix.\n");
-    return;
-  }
-  printf("Sparse matrix (COO format) - %d non-zero elements:\n", mat->nnz);
-  if (mat->nnz == 0)
-  {
-    printf("No non-zero elements.\n");
-    return;
   }
-  for (size_t i = 0; i < mat->nnz; i++)
+  int status = 0;
+  int nrows, ncols, value;
+  PerfScope scope;
+  while (batch_next(run, &nrows) == READ_OK) // Only a stop before the row count ends cleanly
   {
-    printf("(Row: %zu, Col: %zu, Value: %d)\n", mat->data[i].row + 1, mat->data[i].col + 1, mat->data[i].value); // 1-based indexing for user
-  }
-}
-
-// Retrieves the value at a specific row and column. Returns 0 if not found.
-int sparse_get(SparseMat *mat, int row, int col)
-{
-  if (mat == NULL)
-  {
-    fprintf(stderr, "Error: Cannot get element from a NULL sparse matrix.\n");
-    return 0;
-  }
-  // Basic bounds checking (though `sparse_add` should enforce this for stored entries)
-  if (row < 0 || row >= mat->nrows || col < 0 || col >= mat->ncols)
-  {
-    fprintf(stderr, "Warning: Attempted to get element at out-of-bounds position (%d, %d).\n", row, col);
-    return 0;
-  }
-  for (size_t i = 0; i < mat->nnz; i++)
-  {
-    if (mat->data[i].row == (size_t)row && mat->data[i].col == (size_t)col)
+    if (batch_operand(run, &ncols) != READ_OK)
+      break;
+    if (nrows < 1 || ncols < 1)
     {
-      return mat->data[i].value;
+      fprintf(stderr, "Error: Dimensions must be positive integers (got %dx%d).\n", nrows, ncols);
+      run->errors++;
+      break;
     }
-  }
-  return 0; // Return 0 if the element is not explicitly stored (meaning it's a zero)
-}
-
-// Prints the sparse matrix in dense (full) format
-void mat_print(SparseMat *mat)
-{
-  if (mat == NULL)
-  {
-    printf("Cannot print a NULL matrix in dense format.\n");
-    return;
-  }
-  printf("Matrix in Dense Format (%dx%d):\n", mat->nrows, mat->ncols);
-  for (int i = 0; i < mat->nrows; i++)
-  {
-    for (int j = 0; j < mat->ncols; j++)
+    SparseMat *mat = sparse_new(nrows, ncols);
+    if (!mat)
     {
-      printf("%d\t", sparse_get(mat, i, j)); // Use tab for better spacing
+      run->errors++;
+      break;
     }
-    printf("\n");
-  }
+    for (int i = 0; i < nrows && status == 0; i++)
+    {
+      for (int j = 0; j < ncols; j++)
+      {
+        if (batch_next(run, &value) != READ_OK)
+        {
+          fprintf(stderr, "Error: Batch input ended inside a %dx%d matrix.\n", nrows, ncols);
+          run->errors++;
+          status = 1;
+          break;
+        }
+        sparse_add(mat, i, j, value); // Zeros are skipped by sparse_add
+      }
+    }
+    if (status == 0)
+    {
+      run->ops += (size_t)nrows * ncols;
+      if (out)
+      {
+        perf_begin(&scope, "sparse_write");
+        sparse_write(mat, out, format);
+        perf_end(&scope);
+      }
+      else
+      {
+        sparse_print(mat);
+        perf_begin(&scope, "mat_print");
+        mat_print(mat);
+        perf_end(&scope);
+      }
+    }
+    sparse_mat_destroy(mat);
+    if (status != 0)
+      break;
+  }
+  if (!writer_destroy(out))
+    status = 1;
+  if (run->errors > 0)
+    status = 1;
+  batch_finish(run);
+  return status;
 }
-
-// Frees all memory allocated for the sparse matrix
-void sparse_mat_destroy(SparseMat *mat)
-{
-  if (mat == NULL)
-  {
-    return; // Nothing to destroy
-  }
-  if (mat->data != NULL)
-  {
-    free(mat->data); // Free the array of SparseEntry structs
-    mat->data = NULL;
-  }
-  free(mat); // Free the SparseMat struct itself
-}
\ No newline at end of file
@@ -0,0 +1,473 @@
+#include "matrix.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../result/result.h"
+#include "../types/types.h"
+#include "../vector/vector.h"
+#include "../input/input.h"
+#include "../batch/batch.h"
+#include "../alloc/alloc.h"
+#include "../writer/writer.h"
+#include "../gemm/gemm.h"
+#include "../strassen/strassen.h"
+#include "../transpose/transpose.h"
+
+// allocates memory for a matrix with nrows rows and ncols columns
+Mat *mat_new(int nrows, int ncols)
+{
+  Mat *mat = alloc_malloc(sizeof(Mat), ALLOC_MATRIX);
+  if (!mat)
+  {
+    fprintf(stderr, "Memory allocation failed for Mat struct.\n");
+    return NULL;
+  }
+  mat->nrows = nrows;
+  mat->ncols = ncols;
+
+  mat->rows = vec_new_site(sizeof(Vec *), nrows, ALLOC_MATRIX);
+  if (!mat->rows)
+  {
+    fprintf(stderr, "Memory allocation failed for rows vector.\n");
+    alloc_free(mat, ALLOC_MATRIX);
+    return NULL;
+  }
+
+  // Allocate each row vector
+  for (int i = 0; i < nrows; i++)
+  {
+    Vec *row = vec_new_site(sizeof(int), ncols, ALLOC_MATRIX);
+    if (!row)
+    {
+      fprintf(stderr, "Memory allocation failed for row %d.\n", i);
+      // Clean up already allocated rows and the main vector before returning NULL
+      for (int k = 0; k < i; k++)
+      {
+        vec_destroy(*(Vec **)vec_get(mat->rows, k));
+      }
+      vec_destroy(mat->rows);        // Destroy the vector storing row pointers
+      alloc_free(mat, ALLOC_MATRIX); // Free the Mat struct itself
+      return NULL;
+    }
+    vec_append(mat->rows, &row); // Append pointer to the new row vector
+  }
+  return mat;
+}
+
+// returns the value of the element at row i, column j
+int matrix_get(Mat *mat, int i, int j)
+{
+  Vec *row = *(Vec **)vec_get(mat->rows, i);
+  return ((int *)row->data)[j];
+}
+
+// sets the value of the element at row i, column j to value
+void matrix_set(Mat *mat, int i, int j, int value)
+{
+  Vec *row = *(Vec **)vec_get(mat->rows, i);
+  ((int *)row->data)[j] = value;
+}
+
+// reads the elements of the matrix from the user
+ReadResult mat_input(Mat *mat)
+{
+  ReadResult value_result;
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    for (int j = 0; j < mat->ncols; j++)
+    {
+      while (1)
+      {
+        printf("Enter element at row %d, column %d: ", i + 1, j + 1); // User-friendly 1-based indexing
+        value_result = int_read_line();
+        if (value_result.status == READ_ERR)
+        {
+          fprintf(stderr, "Error: %s. Please try again.\n", value_result.data.err_str);
+          destroy_read_result(&value_result);
+          continue;
+        }
+        else if (value_result.status == READ_STOPPED)
+        {
+          fprintf(stderr, "Input stopped by user.\n");
+          // Important: Return READ_STOPPED so main can clean up
+          return (ReadResult){READ_STOPPED, .data.ok = NULL};
+        }
+        matrix_set(mat, i, j, *(int *)value_result.data.ok);
+        destroy_read_result(&value_result); // Destroy the result after use
+        break;
+      }
+    }
+  }
+  return (ReadResult){READ_OK, .data.ok = NULL}; // Indicate success
+}
+
+// reads "rows cols" followed by rows*cols elements from a batch script.
+// Only a script that ends before the row count is a clean READ_STOPPED; a
+// matrix that is malformed or cut short is a READ_ERR.
+ReadStatus mat_read_batch(BatchRun *run, Mat **out)
+{
+  int nrows, ncols, value;
+  *out = NULL;
+  if (batch_next(run, &nrows) != READ_OK)
+    return READ_STOPPED;
+  if (batch_next(run, &ncols) != READ_OK)
+  {
+    fprintf(stderr, "Error: Batch input ended before the column count.\n");
+    run->errors++;
+    return READ_ERR;
+  }
+  if (nrows < 1 || ncols < 1)
+  {
+    fprintf(stderr, "Error: Dimensions must be positive integers (got %dx%d).\n", nrows, ncols);
+    run->errors++;
+    return READ_ERR;
+  }
+  Mat *mat = mat_new(nrows, ncols);
+  if (!mat)
+  {
+    run->errors++;
+    return READ_ERR;
+  }
+  for (int i = 0; i < nrows; i++)
+  {
+    int *row = (*(Vec **)vec_get(mat->rows, i))->data;
+    for (int j = 0; j < ncols; j++)
+    {
+      if (batch_next(run, &value) != READ_OK)
+      {
+        fprintf(stderr, "Error: Batch input ended inside a %dx%d matrix.\n", nrows, ncols);
+        run->errors++;
+        mat_destroy(mat);
+        return READ_ERR;
+      }
+      row[j] = value;
+    }
+  }
+  run->ops += (size_t)nrows * ncols;
+  *out = mat;
+  return READ_OK;
+}
+
+// writes each row as values separated by sep; trailing puts sep after the last value too
+static void mat_write_delimited(Mat *mat, Writer *w, char sep, int trailing)
+{
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    int *row = (*(Vec **)vec_get(mat->rows, i))->data;
+    for (int j = 0; j < mat->ncols; j++)
+    {
+      if (j > 0)
+        writer_char(w, sep);
+      writer_int(w, row[j]);
+    }
+    if (trailing)
+      writer_char(w, sep);
+    writer_char(w, '\n');
+  }
+}
+
+// Matrix Market arrays are column-major, so this walks a column across all row buffers
+static void mat_write_mm(Mat *mat, Writer *w)
+{
+  writer_str(w, "%%MatrixMarket matrix array integer general\n");
+  writer_int(w, mat->nrows);
+  writer_char(w, ' ');
+  writer_int(w, mat->ncols);
+  writer_char(w, '\n');
+  Vec **rows = mat->rows->data;
+  for (int j = 0; j < mat->ncols; j++)
+  {
+    for (int i = 0; i < mat->nrows; i++)
+    {
+      writer_int(w, ((int *)rows[i]->data)[j]);
+      writer_char(w, '\n');
+    }
+  }
+}
+
+// "LABM", int32 rows, int32 cols, then the rows as native-endian int32
+static void mat_write_binary(Mat *mat, Writer *w)
+{
+  int32_t dims[2] = {mat->nrows, mat->ncols};
+  writer_bytes(w, "LABM", 4);
+  writer_bytes(w, dims, sizeof(dims));
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    Vec *row = *(Vec **)vec_get(mat->rows, i);
+    writer_bytes(w, row->data, sizeof(int) * (size_t)mat->ncols); // Long rows bypass the buffer via writev
+  }
+}
+
+// writes the matrix to w in the given format; returns 1 on success, 0 on error
+int mat_write(Mat *mat, Writer *w, OutFormat format)
+{
+  if (mat == NULL || w == NULL)
+  {
+    fprintf(stderr, "Error: Cannot write a NULL matrix.\n");
+    return 0;
+  }
+  switch (format)
+  {
+  case OUT_TSV:
+    mat_write_delimited(mat, w, '\t', 0);
+    break;
+  case OUT_CSV:
+    mat_write_delimited(mat, w, ',', 0);
+    break;
+  case OUT_MM:
+    mat_write_mm(mat, w);
+    break;
+  case OUT_BINARY:
+    mat_write_binary(mat, w);
+    break;
+  }
+  return !w->failed;
+}
+
+// prints the matrix to the screen
+void print_mat(Mat *mat)
+{
+  if (mat == NULL)
+  { // Handle case where matrix is NULL
+    printf("Cannot print a NULL matrix.\n");
+    return;
+  }
+  fflush(stdout); // The writer goes to fd 1 directly, so stdio's buffer must drain first
+  Writer *w = writer_stdout();
+  if (!w)
+    return;
+  writer_str(w, "Matrix (");
+  writer_int(w, mat->nrows);
+  writer_char(w, 'x');
+  writer_int(w, mat->ncols);
+  writer_str(w, "):\n");
+  mat_write_delimited(mat, w, '\t', 1); // Tab after every value, as before
+  writer_flush(w);
+}
+
+// adds two matrices and returns the result
+Mat *mat_add(Mat *mat1, Mat *mat2)
+{
+  if (mat1 == NULL || mat2 == NULL)
+  {
+    fprintf(stderr, "Error: Cannot add a NULL matrix.\n");
+    return NULL;
+  }
+  if (mat1->nrows != mat2->nrows || mat1->ncols != mat2->ncols)
+  {
+    fprintf(stderr, "Error: Matrix dimensions do not match for addition. "
+                    "Matrix 1: %dx%d, Matrix 2: %dx%d.\n",
+            mat1->nrows, mat1->ncols, mat2->nrows, mat2->ncols);
+    return NULL;
+  }
+  Mat *mat = mat_new(mat1->nrows, mat1->ncols);
+  if (!mat)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for result matrix in addition.\n");
+    return NULL;
+  }
+  for (int i = 0; i < mat1->nrows; i++)
+  {
+    for (int j = 0; j < mat1->ncols; j++)
+    {
+      matrix_set(mat, i, j, matrix_get(mat1, i, j) + matrix_get(mat2, i, j));
+    }
+  }
+  return mat;
+}
+
+// returns a view of the whole matrix (view.rows is NULL if allocation failed)
+MatView mat_view(Mat *mat)
+{
+  MatView view = {alloc_malloc(sizeof(int *) * (size_t)mat->nrows, ALLOC_MATRIX), 0, mat->nrows, mat->ncols};
+  if (view.rows)
+  {
+    for (int i = 0; i < mat->nrows; i++)
+      view.rows[i] = (*(Vec **)vec_get(mat->rows, i))->data;
+  }
+  return view;
+}
+
+void mat_view_release(MatView view)
+{
+  alloc_free(view.rows, ALLOC_MATRIX);
+}
+
+// returns the product of the two matrices
+Mat *mat_mult(Mat *mat1, Mat *mat2)
+{
+  return mat_mult_mode(mat1, mat2, MAT_MULT_AUTO);
+}
+
+// returns the product of the two matrices using the requested kernel
+Mat *mat_mult_mode(Mat *mat1, Mat *mat2, MatMultMode mode)
+{
+  if (mat1 == NULL || mat2 == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL matrix.\n");
+    return NULL;
+  }
+  if (mat1->ncols != mat2->nrows)
+  {
+    fprintf(stderr, "Error: Incompatible matrix dimensions for multiplication. "
+                    "Number of columns in first matrix (%d) must equal number of rows in second matrix (%d).\n",
+            mat1->ncols, mat2->nrows);
+    return NULL;
+  }
+
+  Mat *result = mat_new(mat1->nrows, mat2->ncols);
+  if (!result)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for result matrix in multiplication.\n");
+    return NULL;
+  }
+
+  MatView a = mat_view(mat1), b = mat_view(mat2), c = mat_view(result);
+  int ok = a.rows && b.rows && c.rows;
+  if (!ok)
+    fprintf(stderr, "Error: Memory allocation failed for row views in multiplication.\n");
+  else if (mode == MAT_MULT_BLOCKED)
+    gemm_blocked(c, a, b, 0);
+  else
+  {
+    // AUTO gets no recursion levels below the crossover, so it falls through to the blocked kernel
+    int crossover = STRASSEN_CROSSOVER;
+    if (mode == MAT_MULT_STRASSEN)
+    {
+      int smallest = mat1->nrows < mat1->ncols ? mat1->nrows : mat1->ncols;
+      smallest = smallest < mat2->ncols ? smallest : mat2->ncols;
+      crossover = smallest < crossover ? smallest : crossover;
+    }
+    StrassenWorkspace *ws = strassen_workspace_new(mat1->nrows, mat1->ncols, mat2->ncols, crossover);
+    ok = ws && strassen_mult(ws, c, a, b);
+    strassen_workspace_destroy(ws);
+  }
+  mat_view_release(a);
+  mat_view_release(b);
+  mat_view_release(c);
+  if (!ok)
+  {
+    mat_destroy(result);
+    return NULL;
+  }
+  return result;
+}
+
+// returns mat1 * mat2, given mat2t = mat2 transposed; both operands are read row by row
+Mat *mat_mult_transposed(Mat *mat1, Mat *mat2t)
+{
+  if (mat1 == NULL || mat2t == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL matrix.\n");
+    return NULL;
+  }
+  if (mat1->ncols != mat2t->ncols)
+  {
+    fprintf(stderr, "Error: Incompatible matrix dimensions for multiplication. "
+                    "Number of columns in first matrix (%d) must equal number of columns in the transposed second matrix (%d).\n",
+            mat1->ncols, mat2t->ncols);
+    return NULL;
+  }
+  Mat *result = mat_new(mat1->nrows, mat2t->nrows);
+  if (!result)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for result matrix in multiplication.\n");
+    return NULL;
+  }
+  MatView a = mat_view(mat1), bt = mat_view(mat2t), c = mat_view(result);
+  int ok = a.rows && bt.rows && c.rows;
+  if (ok)
+    gemm_transposed(c, a, bt, 0);
+  else
+    fprintf(stderr, "Error: Memory allocation failed for row views in multiplication.\n");
+  mat_view_release(a);
+  mat_view_release(bt);
+  mat_view_release(c);
+  if (!ok)
+  {
+    mat_destroy(result);
+    return NULL;
+  }
+  return result;
+}
+
+// returns a new matrix holding the transpose of mat
+Mat *mat_transpose(Mat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot transpose a NULL matrix.\n");
+    return NULL;
+  }
+  Mat *result = mat_new(mat->ncols, mat->nrows);
+  if (!result)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for result matrix in transpose.\n");
+    return NULL;
+  }
+  MatView src = mat_view(mat), dst = mat_view(result);
+  int ok = src.rows && dst.rows;
+  if (ok)
+    transpose_view(dst, src);
+  else
+    fprintf(stderr, "Error: Memory allocation failed for row views in transpose.\n");
+  mat_view_release(src);
+  mat_view_release(dst);
+  if (!ok)
+  {
+    mat_destroy(result);
+    return NULL;
+  }
+  return result;
+}
+
+// transposes a square matrix in place; returns 1 on success, 0 on error
+int mat_transpose_inplace(Mat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot transpose a NULL matrix.\n");
+    return 0;
+  }
+  if (mat->nrows != mat->ncols)
+  {
+    fprintf(stderr, "Error: In-place transpose needs a square matrix (got %dx%d); use mat_transpose.\n",
+            mat->nrows, mat->ncols);
+    return 0;
+  }
+  MatView v = mat_view(mat);
+  if (!v.rows)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for row view in transpose.\n");
+    return 0;
+  }
+  transpose_view_inplace(v);
+  mat_view_release(v);
+  return 1;
+}
+
+// frees memory allocated for the matrix
+void mat_destroy(Mat *mat)
+{
+  if (mat == NULL)
+  {
+    return; // Nothing to destroy if matrix pointer is NULL
+  }
+  if (mat->rows != NULL)
+  {
+    // Destroy each row vector pointed to by the 'rows' vector
+    for (int i = 0; i < mat->nrows; i++)
+    {
+      Vec *row = *(Vec **)vec_get(mat->rows, i);
+      if (row != NULL) // Defensive check, though vec_new should ensure non-NULL
+      {
+        vec_destroy(row);
+      }
+    }
+    // Destroy the vector that holds pointers to the rows
+    vec_destroy(mat->rows);
+  }
+  // Finally, free the Mat struct itself
+  alloc_free(mat, ALLOC_MATRIX);
+}
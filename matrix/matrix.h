@@ -0,0 +1,47 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "../result/result.h"
+#include "../types/types.h"
+#include "../batch/batch.h"
+#include "../writer/writer.h"
+#include "../gemm/gemm.h"
+
+// Dense integer matrix stored as a Vec of row Vecs (each row holds ncols ints)
+typedef struct
+{
+  Vec *rows;
+  int nrows;
+  int ncols;
+} Mat;
+
+Mat *mat_new(int nrows, int ncols);
+ReadResult mat_input(Mat *mat);
+// READ_OK with *out set, READ_STOPPED at a clean end of script, READ_ERR (counted in run->errors) otherwise
+ReadStatus mat_read_batch(BatchRun *run, Mat **out);
+void print_mat(Mat *mat);
+int mat_write(Mat *mat, Writer *w, OutFormat format);
+int matrix_get(Mat *mat, int i, int j);
+void matrix_set(Mat *mat, int i, int j, int value);
+Mat *mat_add(Mat *mat1, Mat *mat2);
+Mat *mat_mult(Mat *mat1, Mat *mat2);
+
+// Kernel selection for mat_mult_mode; mat_mult uses MAT_MULT_AUTO
+typedef enum
+{
+  MAT_MULT_AUTO,     // Strassen once every dimension reaches STRASSEN_CROSSOVER
+  MAT_MULT_BLOCKED,  // Cache-blocked O(n^3) kernel
+  MAT_MULT_STRASSEN  // Strassen-Winograd; at least one level even below the crossover
+} MatMultMode;
+
+Mat *mat_mult_mode(Mat *mat1, Mat *mat2, MatMultMode mode);
+// mat1 * mat2 where mat2t holds mat2 already transposed (transpose once, reuse many times)
+Mat *mat_mult_transposed(Mat *mat1, Mat *mat2t);
+Mat *mat_transpose(Mat *mat);
+int mat_transpose_inplace(Mat *mat); // Square matrices only; returns 1 on success
+void mat_destroy(Mat *mat);
+// Whole-matrix view for the gemm kernels; release frees its row pointer array
+MatView mat_view(Mat *mat);
+void mat_view_release(MatView view);
+
+#endif // MATRIX_H
@@ -2,6 +2,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include "../result/result.h"
+#include "../alloc/alloc.h"
 
 Result parse_to_int(const char *str)
 {
@@ -42,7 +43,7 @@ Result parse_to_int(const char *str)
   if (*str != '\0')
     return (Result){ERR, .data.err_str = "Invalid character in input string"};
 
-  int *ptr = malloc(sizeof(int));
+  int *ptr = alloc_malloc(sizeof(int), ALLOC_PARSER);
   *ptr = num;
   return (Result){OK, .data.ok = ptr};
 }
@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+#include "perf.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#define PERF_INITIAL_REGIONS 64
+#define PERF_NAME_LEN 64
+
+typedef struct
+{
+  char name[PERF_NAME_LEN];
+  uint64_t calls;
+  uint64_t wall_ns;
+  uint64_t counters[PERF_NCOUNTERS];
+} PerfRegion;
+
+static const char *perf_counter_names[PERF_NCOUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"};
+
+// One thread's counter fds, opened on its first region (or by perf_init)
+typedef struct
+{
+  int fds[PERF_NCOUNTERS];
+} PerfThread;
+
+static int perf_on = 0; // Checked first by every entry point; keeps disabled cost to one branch
+static pthread_once_t perf_once = PTHREAD_ONCE_INIT;
+static pthread_key_t perf_thread_key; // PerfThread of the calling thread, closed when it exits
+static PerfThread *perf_init_thread = NULL;
+static int perf_available[PERF_NCOUNTERS]; // Counters the init thread could open: the rest report null
+static atomic_int perf_cross_warned;
+static const char *perf_out_path = NULL;
+static PerfRegion *perf_regions = NULL; // Grows by doubling; guarded by perf_lock
+static int perf_nregions = 0;
+static int perf_capacity = 0;
+static int perf_full_warned = 0;
+static pthread_mutex_t perf_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t perf_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef __linux__
+// opens one counting event for the calling thread (user space only); returns fd or -1.
+// inherit makes the event also count threads created afterwards: their counts
+// are folded into the fd's value when they exit, so a region that spawns and
+// joins workers (the thread benchmarks) sees their work too.
+static int perf_open_event(uint32_t type, uint64_t config)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  if (fd >= 0)
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  return fd;
+}
+
+#define PERF_CACHE_EVENT(cache, op, result) \
+  ((cache) | ((op) << 8) | ((result) << 16))
+
+static void perf_open_counters(int *fds)
+{
+  fds[PERF_CYCLES] = perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds[PERF_INSTRUCTIONS] = perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds[PERF_L1D_MISSES] = perf_open_event(PERF_TYPE_HW_CACHE,
+                                         PERF_CACHE_EVENT(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                                          PERF_COUNT_HW_CACHE_RESULT_MISS));
+  fds[PERF_LLC_MISSES] = perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  fds[PERF_DTLB_MISSES] = perf_open_event(PERF_TYPE_HW_CACHE,
+                                          PERF_CACHE_EVENT(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                                           PERF_COUNT_HW_CACHE_RESULT_MISS));
+  fds[PERF_BRANCH_MISSES] = perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+}
+
+// reads a counter, scaling for multiplexing when the PMU was shared
+static uint64_t perf_read_counter(int fd)
+{
+  uint64_t buf[3]; // value, time_enabled, time_running
+  if (read(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf))
+    return 0;
+  if (buf[2] == 0)
+    return 0;
+  if (buf[2] < buf[1])
+    return (uint64_t)((double)buf[0] * (double)buf[1] / (double)buf[2]);
+  return buf[0];
+}
+#else
+static void perf_open_counters(int *fds)
+{
+  for (int c = 0; c < PERF_NCOUNTERS; c++)
+    fds[c] = -1;
+}
+
+static uint64_t perf_read_counter(int fd)
+{
+  (void)fd;
+  return 0;
+}
+#endif
+
+static void perf_thread_close(void *arg)
+{
+  PerfThread *thread = arg;
+  if (thread == perf_init_thread)
+    return; // Closed by perf_at_exit
+  for (int c = 0; c < PERF_NCOUNTERS; c++)
+  {
+    if (thread->fds[c] >= 0)
+      close(thread->fds[c]);
+  }
+  free(thread);
+}
+
+// The calling thread's counters, opened on first use; NULL when out of memory
+static PerfThread *perf_thread(void)
+{
+  PerfThread *thread = pthread_getspecific(perf_thread_key);
+  if (thread != NULL)
+    return thread;
+  thread = malloc(sizeof(PerfThread));
+  if (thread == NULL)
+    return NULL;
+  perf_open_counters(thread->fds);
+  if (pthread_setspecific(perf_thread_key, thread) != 0)
+  {
+    perf_thread_close(thread);
+    return NULL;
+  }
+  return thread;
+}
+
+static void perf_at_exit(void)
+{
+  if (!perf_on)
+    return;
+  FILE *out = stderr;
+  if (perf_out_path != NULL)
+  {
+    out = fopen(perf_out_path, "w");
+    if (out == NULL)
+    {
+      fprintf(stderr, "Error: Cannot open '%s' for perf output.\n", perf_out_path);
+      return;
+    }
+  }
+  perf_dump_json(out);
+  if (out != stderr)
+    fclose(out);
+  free(perf_regions);
+  perf_regions = NULL;
+  perf_nregions = 0;
+  perf_capacity = 0;
+  // Key destructors do not run for the exiting thread and skip the init
+  // thread's counters, so close those here
+  if (perf_init_thread != NULL)
+  {
+    PerfThread *thread = perf_init_thread;
+    if (pthread_getspecific(perf_thread_key) == thread)
+      pthread_setspecific(perf_thread_key, NULL);
+    perf_init_thread = NULL;
+    perf_thread_close(thread);
+  }
+}
+
+static void perf_init_once(void)
+{
+  const char *env = getenv("LAB_PERF");
+  if (env == NULL || *env == '\0' || strcmp(env, "0") == 0)
+    return;
+  if (strcmp(env, "1") != 0 && strcmp(env, "stderr") != 0)
+    perf_out_path = env;
+
+  if (pthread_key_create(&perf_thread_key, perf_thread_close) != 0)
+  {
+    fprintf(stderr, "Warning: Cannot create perf thread key; perf disabled.\n");
+    return;
+  }
+  perf_init_thread = perf_thread();
+  int available = 0;
+  for (int c = 0; c < PERF_NCOUNTERS; c++)
+  {
+    perf_available[c] = perf_init_thread != NULL && perf_init_thread->fds[c] >= 0;
+    available += perf_available[c];
+  }
+  if (available == 0)
+    fprintf(stderr, "Warning: perf_event_open unavailable; recording wall time only.\n");
+
+  perf_on = 1;
+  atexit(perf_at_exit);
+}
+
+// enables instrumentation when LAB_PERF is set; safe to call more than once,
+// from any thread
+void perf_init(void)
+{
+  pthread_once(&perf_once, perf_init_once);
+}
+
+int perf_enabled(void)
+{
+  return perf_on;
+}
+
+// starts a named region; the name must stay valid until perf_end
+void perf_begin(PerfScope *scope, const char *name)
+{
+  scope->active = perf_on;
+  if (!perf_on)
+    return;
+  PerfThread *thread = perf_thread();
+  if (thread == NULL)
+  {
+    scope->active = 0;
+    return;
+  }
+  scope->name = name;
+  scope->thread = thread;
+  for (int c = 0; c < PERF_NCOUNTERS; c++)
+    scope->start[c] = thread->fds[c] >= 0 ? perf_read_counter(thread->fds[c]) : 0;
+  scope->start_ns = perf_now_ns();
+}
+
+// caller holds perf_lock
+static PerfRegion *perf_find_region(const char *name)
+{
+  for (int r = 0; r < perf_nregions; r++)
+  {
+    if (strncmp(perf_regions[r].name, name, PERF_NAME_LEN - 1) == 0)
+      return &perf_regions[r];
+  }
+  if (perf_nregions >= perf_capacity)
+  {
+    int capacity = perf_capacity == 0 ? PERF_INITIAL_REGIONS : perf_capacity * 2;
+    PerfRegion *regions = realloc(perf_regions, (size_t)capacity * sizeof(PerfRegion));
+    if (regions == NULL)
+    {
+      if (!perf_full_warned)
+        fprintf(stderr, "Warning: Out of memory for perf regions; dropping new region '%s'.\n", name);
+      perf_full_warned = 1;
+      return NULL;
+    }
+    perf_regions = regions;
+    perf_capacity = capacity;
+  }
+  PerfRegion *region = &perf_regions[perf_nregions++];
+  memset(region, 0, sizeof(PerfRegion));
+  strncpy(region->name, name, PERF_NAME_LEN - 1);
+  return region;
+}
+
+// closes a region and adds its deltas to the per-name totals
+void perf_end(PerfScope *scope)
+{
+  if (!scope->active)
+    return;
+  uint64_t end_ns = perf_now_ns();
+  scope->active = 0;
+  PerfThread *thread = scope->thread;
+  if (pthread_getspecific(perf_thread_key) != thread)
+  {
+    // The start values came from another thread's counters
+    if (!atomic_exchange(&perf_cross_warned, 1))
+      fprintf(stderr, "Warning: perf region '%s' ended on a different thread; dropped.\n", scope->name);
+    return;
+  }
+  uint64_t end[PERF_NCOUNTERS];
+  for (int c = 0; c < PERF_NCOUNTERS; c++)
+    end[c] = thread->fds[c] >= 0 ? perf_read_counter(thread->fds[c]) : 0;
+
+  pthread_mutex_lock(&perf_lock);
+  PerfRegion *region = perf_find_region(scope->name);
+  if (region != NULL)
+  {
+    region->calls++;
+    region->wall_ns += end_ns - scope->start_ns;
+    for (int c = 0; c < PERF_NCOUNTERS; c++)
+    {
+      if (end[c] > scope->start[c])
+        region->counters[c] += end[c] - scope->start[c];
+    }
+  }
+  pthread_mutex_unlock(&perf_lock);
+}
+
+void perf_json_string(FILE *out, const char *s)
+{
+  fputc('"', out);
+  for (const unsigned char *p = (const unsigned char *)s; *p != '\0'; p++)
+  {
+    if (*p == '"' || *p == '\\')
+      fprintf(out, "\\%c", *p);
+    else if (*p < 0x20)
+      fprintf(out, "\\u%04x", *p);
+    else
+      fputc(*p, out);
+  }
+  fputc('"', out);
+}
+
+// writes every region's totals; unavailable counters are reported as null
+void perf_dump_json(FILE *out)
+{
+  pthread_mutex_lock(&perf_lock);
+  fprintf(out, "{\n  \"regions\": [\n");
+  for (int r = 0; r < perf_nregions; r++)
+  {
+    PerfRegion *region = &perf_regions[r];
+    fprintf(out, "    {\"name\": ");
+    perf_json_string(out, region->name);
+    fprintf(out, ", \"calls\": %llu, \"wall_ns\": %llu", (unsigned long long)region->calls,
+            (unsigned long long)region->wall_ns);
+    for (int c = 0; c < PERF_NCOUNTERS; c++)
+    {
+      if (perf_available[c])
+        fprintf(out, ", \"%s\": %llu", perf_counter_names[c], (unsigned long long)region->counters[c]);
+      else
+        fprintf(out, ", \"%s\": null", perf_counter_names[c]);
+    }
+    if (perf_available[PERF_CYCLES] && perf_available[PERF_INSTRUCTIONS] && region->counters[PERF_CYCLES] > 0)
+      fprintf(out, ", \"ipc\": %.3f",
+              (double)region->counters[PERF_INSTRUCTIONS] / (double)region->counters[PERF_CYCLES]);
+    fprintf(out, "}%s\n", (r + 1 < perf_nregions) ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  fflush(out);
+  pthread_mutex_unlock(&perf_lock);
+}
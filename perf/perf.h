@@ -0,0 +1,45 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Hardware counters sampled around each region (Linux perf_event_open)
+typedef enum
+{
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_NCOUNTERS
+} PerfCounter;
+
+// An open region; lives on the caller's stack between perf_begin and perf_end
+typedef struct
+{
+  const char *name;
+  int active;
+  void *thread; // Counters of the thread that began the region
+  uint64_t start_ns;
+  uint64_t start[PERF_NCOUNTERS];
+} PerfScope;
+
+// Counters are per thread: perf_init opens them for the calling thread, and
+// any other thread opens its own on its first perf_begin. They are opened
+// with inherit set, so a region measures its thread plus any threads that
+// thread creates afterwards and joins before perf_end. A region must end on
+// the thread that began it; perf_end on another thread warns and drops it.
+//
+// Instrumentation is off unless the LAB_PERF environment variable is set:
+//   LAB_PERF=1 (or "stderr") dumps JSON to stderr at exit, any other value is a file path.
+void perf_init(void);
+int perf_enabled(void);
+void perf_begin(PerfScope *scope, const char *name);
+void perf_end(PerfScope *scope);
+void perf_dump_json(FILE *out);
+// Writes s as a quoted JSON string, escaping quotes, backslashes and control characters
+void perf_json_string(FILE *out, const char *s);
+
+#endif // PERF_H
@@ -0,0 +1,277 @@
+#include "persist.h"
+#include <stdio.h>
+#include "../alloc/alloc.h"
+
+PersistStore *persist_store_new(void)
+{
+  PersistStore *store = alloc_malloc(sizeof(PersistStore), ALLOC_STACK);
+  if (!store)
+  {
+    fprintf(stderr, "Memory allocation failed for PersistStore struct.\n");
+    return NULL;
+  }
+  store->pool = pool_new(sizeof(PNode), 0, ALLOC_STACK);
+  if (!store->pool)
+  {
+    alloc_free(store, ALLOC_STACK);
+    return NULL;
+  }
+  return store;
+}
+
+void persist_store_destroy(PersistStore *store)
+{
+  if (store == NULL)
+    return;
+  pool_destroy(store->pool);
+  alloc_free(store, ALLOC_STACK);
+}
+
+// New node holding the caller's reference to next (refs 1)
+static PNode *persist_node(PersistStore *store, int data, PNode *next)
+{
+  PNode *node = pool_alloc(store->pool);
+  if (!node)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for persistent node (data: %d).\n", data);
+    return NULL;
+  }
+  node->data = data;
+  node->refs = 1;
+  node->next = next;
+  return node;
+}
+
+static PNode *persist_retain_node(PNode *node)
+{
+  if (node != NULL)
+    node->refs++;
+  return node;
+}
+
+// Drops one reference, freeing down the chain while counts reach zero
+static void persist_release_node(PersistStore *store, PNode *node)
+{
+  while (node != NULL && --node->refs == 0)
+  {
+    PNode *next = node->next;
+    pool_free(store->pool, node);
+    node = next;
+  }
+}
+
+PList plist_retain(PList list)
+{
+  persist_retain_node(list.head);
+  return list;
+}
+
+void plist_release(PersistStore *store, PList list)
+{
+  if (store != NULL)
+    persist_release_node(store, list.head);
+}
+
+int pstack_push(PersistStore *store, PStack stack, int value, PStack *out)
+{
+  if (store == NULL || out == NULL)
+  {
+    fprintf(stderr, "Error: Cannot push without a store and an output version.\n");
+    return 0;
+  }
+  PNode *node = persist_node(store, value, stack.head);
+  if (!node)
+    return 0;
+  persist_retain_node(stack.head);
+  *out = (PStack){node, stack.length + 1};
+  return 1;
+}
+
+int pstack_pop(PersistStore *store, PStack stack, int *out_value, PStack *out)
+{
+  if (store == NULL || out == NULL)
+  {
+    fprintf(stderr, "Error: Cannot pop without a store and an output version.\n");
+    return 0;
+  }
+  if (stack.head == NULL)
+  {
+    fprintf(stderr, "Stack is empty. Cannot pop.\n");
+    return 0;
+  }
+  if (out_value != NULL)
+    *out_value = stack.head->data;
+  *out = (PStack){persist_retain_node(stack.head->next), stack.length - 1};
+  return 1;
+}
+
+int pstack_peek(PStack stack, int *out_value)
+{
+  if (stack.head == NULL)
+    return 0;
+  if (out_value != NULL)
+    *out_value = stack.head->data;
+  return 1;
+}
+
+int plist_from_array(PersistStore *store, const int *values, size_t n, PList *out)
+{
+  if (store == NULL || out == NULL || (values == NULL && n > 0))
+  {
+    fprintf(stderr, "Error: Cannot build a persistent list without a store, values and an output version.\n");
+    return 0;
+  }
+  PNode *head = NULL;
+  for (size_t i = n; i-- > 0;)
+  {
+    PNode *node = persist_node(store, values[i], head);
+    if (!node)
+    {
+      persist_release_node(store, head);
+      return 0;
+    }
+    head = node;
+  }
+  *out = (PList){head, n};
+  return 1;
+}
+
+size_t plist_to_array(PList list, int *out, size_t capacity)
+{
+  size_t n = 0;
+  for (PNode *node = list.head; node != NULL; node = node->next, n++)
+  {
+    if (n < capacity)
+      out[n] = node->data;
+  }
+  return n;
+}
+
+int plist_get(PList list, size_t index, int *out_value)
+{
+  if (index >= list.length)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, list.length);
+    return 0;
+  }
+  PNode *node = list.head;
+  for (size_t i = 0; i < index; i++)
+    node = node->next;
+  if (out_value != NULL)
+    *out_value = node->data;
+  return 1;
+}
+
+// New list: copies of the first count nodes of list, then suffix (whose
+// reference the caller passes in). On failure the suffix reference is
+// dropped too.
+static PNode *persist_copy_prefix(PersistStore *store, PList list, size_t count, PNode *suffix)
+{
+  PNode *first = NULL;
+  PNode **link = &first;
+  PNode *src = list.head;
+  for (size_t i = 0; i < count; i++, src = src->next)
+  {
+    PNode *node = persist_node(store, src->data, NULL);
+    if (!node)
+    {
+      persist_release_node(store, first);
+      persist_release_node(store, suffix);
+      return NULL;
+    }
+    *link = node;
+    link = &node->next;
+  }
+  *link = suffix;
+  return first != NULL ? first : suffix;
+}
+
+// Node at index (index < length)
+static PNode *persist_node_at(PList list, size_t index)
+{
+  PNode *node = list.head;
+  for (size_t i = 0; i < index; i++)
+    node = node->next;
+  return node;
+}
+
+int plist_insert_at(PersistStore *store, PList list, size_t index, int value, PList *out)
+{
+  if (store == NULL || out == NULL)
+  {
+    fprintf(stderr, "Error: Cannot insert without a store and an output version.\n");
+    return 0;
+  }
+  if (index > list.length)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, list.length);
+    return 0;
+  }
+  PNode *rest = index < list.length ? persist_retain_node(persist_node_at(list, index)) : NULL;
+  PNode *node = persist_node(store, value, rest);
+  if (!node)
+  {
+    persist_release_node(store, rest);
+    return 0;
+  }
+  PNode *head = persist_copy_prefix(store, list, index, node);
+  if (!head)
+    return 0;
+  *out = (PList){head, list.length + 1};
+  return 1;
+}
+
+int plist_delete_at(PersistStore *store, PList list, size_t index, int *out_value, PList *out)
+{
+  if (store == NULL || out == NULL)
+  {
+    fprintf(stderr, "Error: Cannot delete without a store and an output version.\n");
+    return 0;
+  }
+  if (index >= list.length)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, list.length);
+    return 0;
+  }
+  PNode *target = persist_node_at(list, index);
+  PNode *rest = persist_retain_node(target->next);
+  if (out_value != NULL)
+    *out_value = target->data;
+  if (index == 0)
+  {
+    *out = (PList){rest, list.length - 1};
+    return 1;
+  }
+  PNode *head = persist_copy_prefix(store, list, index, rest);
+  if (!head)
+    return 0;
+  *out = (PList){head, list.length - 1};
+  return 1;
+}
+
+int plist_set(PersistStore *store, PList list, size_t index, int value, PList *out)
+{
+  if (store == NULL || out == NULL)
+  {
+    fprintf(stderr, "Error: Cannot set without a store and an output version.\n");
+    return 0;
+  }
+  if (index >= list.length)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, list.length);
+    return 0;
+  }
+  PNode *target = persist_node_at(list, index);
+  PNode *rest = persist_retain_node(target->next);
+  PNode *node = persist_node(store, value, rest);
+  if (!node)
+  {
+    persist_release_node(store, rest);
+    return 0;
+  }
+  PNode *head = persist_copy_prefix(store, list, index, node);
+  if (!head)
+    return 0;
+  *out = (PList){head, list.length};
+  return 1;
+}
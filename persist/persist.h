@@ -0,0 +1,64 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stddef.h> // for size_t
+#include "../pool/pool.h"
+
+// Persistent (immutable) stacks and lists. An update never changes existing
+// nodes; it returns a new version that shares the untouched tail with the
+// old one. Pushing onto or popping from a stack shares everything, so k
+// versions of a size-n stack take O(n + k) nodes. List edits at index i copy
+// the i nodes in front of the change and share the rest.
+//
+// Nodes are reference counted and come from the pool of a PersistStore.
+// Every version handed out holds one reference to its first node: release
+// each version when done with it (or destroy the whole store at once). A
+// store and its versions belong to one thread at a time.
+typedef struct PNode
+{
+  int data;
+  int refs;
+  struct PNode *next;
+} PNode;
+
+typedef struct
+{
+  Pool *pool; // pool->live counts the nodes still referenced
+} PersistStore;
+
+// A version: the first node and the length, passed by value
+typedef struct
+{
+  PNode *head;
+  size_t length;
+} PList;
+
+typedef PList PStack; // Top of stack = head of list
+
+PersistStore *persist_store_new(void); // NULL on error
+void persist_store_destroy(PersistStore *store); // Frees every node, released or not
+
+// A second handle to the same version (both must be released)
+PList plist_retain(PList list);
+void plist_release(PersistStore *store, PList list);
+
+// --- Stack ---
+// Each returns 1 on success (storing the new version in *out) and 0 on
+// failure; the input version stays valid and owned by the caller.
+static inline PStack pstack_empty(void) { return (PStack){NULL, 0}; }
+int pstack_push(PersistStore *store, PStack stack, int value, PStack *out);
+int pstack_pop(PersistStore *store, PStack stack, int *out_value, PStack *out); // 0 when empty
+int pstack_peek(PStack stack, int *out_value);
+#define pstack_retain plist_retain
+#define pstack_release plist_release
+
+// --- List ---
+static inline PList plist_empty(void) { return (PList){NULL, 0}; }
+int plist_from_array(PersistStore *store, const int *values, size_t n, PList *out);
+size_t plist_to_array(PList list, int *out, size_t capacity); // Returns the length
+int plist_get(PList list, size_t index, int *out_value);
+int plist_insert_at(PersistStore *store, PList list, size_t index, int value, PList *out); // index may equal length
+int plist_delete_at(PersistStore *store, PList list, size_t index, int *out_value, PList *out);
+int plist_set(PersistStore *store, PList list, size_t index, int value, PList *out);
+
+#endif // PERSIST_H
@@ -0,0 +1,107 @@
+#include "pool.h"
+#include <stdalign.h>
+#include <stdio.h>
+
+#define POOL_ALIGN alignof(max_align_t)
+#define POOL_SLAB_BYTES 16384
+// Slab header padded so the first object is max-aligned
+#define POOL_HEADER ((sizeof(PoolSlab) + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN)
+
+Pool *pool_new(size_t object_size, size_t slab_objects, AllocSite site)
+{
+  if (object_size == 0)
+  {
+    fprintf(stderr, "Error: Pool object size must be positive.\n");
+    return NULL;
+  }
+  Pool *pool = alloc_malloc(sizeof(Pool), site);
+  if (!pool)
+  {
+    fprintf(stderr, "Memory allocation failed for Pool struct.\n");
+    return NULL;
+  }
+  if (object_size < sizeof(void *))
+    object_size = sizeof(void *);
+  pool->object_size = (object_size + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN;
+  if (slab_objects == 0)
+    slab_objects = POOL_SLAB_BYTES / pool->object_size;
+  pool->slab_objects = slab_objects > 0 ? slab_objects : 1;
+  pool->site = site;
+  pool->slabs = NULL;
+  pool->free_list = NULL;
+  pool->live = 0;
+  pool->capacity = 0;
+  return pool;
+}
+
+void pool_destroy(Pool *pool)
+{
+  if (pool == NULL)
+    return;
+  PoolSlab *slab = pool->slabs;
+  while (slab != NULL)
+  {
+    PoolSlab *next = slab->next;
+    alloc_free(slab, pool->site);
+    slab = next;
+  }
+  alloc_free(pool, pool->site);
+}
+
+// Threads the objects of a slab onto the free list, first object on top
+static void pool_thread_slab(Pool *pool, PoolSlab *slab)
+{
+  char *base = (char *)slab + POOL_HEADER;
+  for (size_t i = pool->slab_objects; i-- > 0;)
+  {
+    void *object = base + i * pool->object_size;
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+  }
+}
+
+void *pool_alloc(Pool *pool)
+{
+  if (pool == NULL)
+  {
+    fprintf(stderr, "Error: Cannot allocate from a NULL pool.\n");
+    return NULL;
+  }
+  if (pool->free_list == NULL)
+  {
+    PoolSlab *slab = alloc_malloc(POOL_HEADER + pool->slab_objects * pool->object_size, pool->site);
+    if (!slab)
+    {
+      fprintf(stderr, "Memory allocation failed for pool slab (%zu objects of %zu bytes).\n", pool->slab_objects,
+              pool->object_size);
+      return NULL;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->capacity += pool->slab_objects;
+    pool_thread_slab(pool, slab);
+  }
+  void *object = pool->free_list;
+  pool->free_list = *(void **)object;
+  pool->live++;
+  return object;
+}
+
+void pool_free(Pool *pool, void *object)
+{
+  if (pool == NULL || object == NULL)
+    return;
+  *(void **)object = pool->free_list;
+  pool->free_list = object;
+  pool->live--;
+}
+
+void pool_reset(Pool *pool)
+{
+  if (pool == NULL)
+    return;
+  pool->free_list = NULL;
+  for (PoolSlab *slab = pool->slabs; slab != NULL; slab = slab->next)
+    pool_thread_slab(pool, slab);
+  pool->live = 0;
+}
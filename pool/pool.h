@@ -0,0 +1,35 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h> // for size_t
+#include "../alloc/alloc.h"
+
+// Fixed-size object pool: objects are carved out of slabs and recycled
+// through an intrusive free list, so allocating or freeing one is a couple
+// of pointer moves instead of a malloc call, and neighbours in a slab stay
+// close in memory. Destroying the pool releases every object at once.
+typedef struct PoolSlab
+{
+  struct PoolSlab *next;
+} PoolSlab;
+
+typedef struct
+{
+  size_t object_size;  // Rounded up to keep objects max-aligned
+  size_t slab_objects; // Objects per slab
+  AllocSite site;      // Where the slabs are charged
+  PoolSlab *slabs;
+  void *free_list;
+  size_t live;         // Objects handed out and not yet returned
+  size_t capacity;     // Objects in all slabs
+} Pool;
+
+// slab_objects 0 picks a slab of about 16 KiB. NULL on error.
+Pool *pool_new(size_t object_size, size_t slab_objects, AllocSite site);
+void pool_destroy(Pool *pool); // Frees all objects, returned or not
+void *pool_alloc(Pool *pool);  // Uninitialized object, NULL on error
+void pool_free(Pool *pool, void *object);
+// Returns every object to the pool while keeping the slabs
+void pool_reset(Pool *pool);
+
+#endif // POOL_H
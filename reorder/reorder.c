@@ -0,0 +1,427 @@
+#include "reorder.h"
+#include <stdlib.h>
+#include "../alloc/alloc.h"
+
+// Pseudo-peripheral search stops after this many BFS sweeps even if the
+// eccentricity is still growing (it rarely takes more than 2-3)
+#define REORDER_MAX_SWEEPS 8
+
+// Adjacency of the pattern of A + A^T without the diagonal; each list is
+// sorted by (degree, index) so Cuthill-McKee can append neighbours in order
+typedef struct
+{
+  int n;
+  size_t *ptr;
+  int *adj;
+  int *degree;
+} ReorderGraph;
+
+typedef struct
+{
+  int degree;
+  int node;
+} ReorderKey;
+
+static int reorder_key_cmp(const void *a, const void *b)
+{
+  const ReorderKey *x = a, *y = b;
+  if (x->degree != y->degree)
+    return x->degree < y->degree ? -1 : 1;
+  return (x->node > y->node) - (x->node < y->node);
+}
+
+static void reorder_graph_free(ReorderGraph *g)
+{
+  alloc_free(g->ptr, ALLOC_SPARSE);
+  alloc_free(g->adj, ALLOC_SPARSE);
+  alloc_free(g->degree, ALLOC_SPARSE);
+}
+
+// merges row r of a and t (both sorted) into out, skipping r itself and
+// repeats; returns the count. out may be NULL to only count.
+static size_t reorder_union_row(CsrMat *a, CsrMat *t, int r, int *out)
+{
+  size_t i = a->row_ptr[r], iend = a->row_ptr[r + 1];
+  size_t j = t->row_ptr[r], jend = t->row_ptr[r + 1];
+  size_t n = 0;
+  while (i < iend || j < jend)
+  {
+    int c;
+    if (j == jend || (i < iend && a->col_idx[i] < t->col_idx[j]))
+      c = a->col_idx[i++];
+    else if (i == iend || t->col_idx[j] < a->col_idx[i])
+      c = t->col_idx[j++];
+    else
+    {
+      c = a->col_idx[i++];
+      j++;
+    }
+    if (c == r)
+      continue;
+    if (out)
+      out[n] = c;
+    n++;
+  }
+  return n;
+}
+
+static int reorder_graph_build(CsrMat *csr, ReorderGraph *g)
+{
+  g->n = csr->nrows;
+  g->ptr = NULL;
+  g->adj = NULL;
+  g->degree = NULL;
+  CsrMat *t = csr_transpose(csr);
+  if (!t)
+    return 0;
+  g->ptr = alloc_malloc(sizeof(size_t) * ((size_t)g->n + 1), ALLOC_SPARSE);
+  g->degree = alloc_malloc(sizeof(int) * (size_t)g->n, ALLOC_SPARSE);
+  if (!g->ptr || !g->degree)
+    goto fail;
+  g->ptr[0] = 0;
+  int max_degree = 0;
+  for (int r = 0; r < g->n; r++)
+  {
+    g->degree[r] = (int)reorder_union_row(csr, t, r, NULL);
+    g->ptr[r + 1] = g->ptr[r] + (size_t)g->degree[r];
+    if (g->degree[r] > max_degree)
+      max_degree = g->degree[r];
+  }
+  g->adj = alloc_malloc(sizeof(int) * (g->ptr[g->n] > 0 ? g->ptr[g->n] : 1), ALLOC_SPARSE);
+  ReorderKey *keys = alloc_malloc(sizeof(ReorderKey) * (size_t)(max_degree > 0 ? max_degree : 1), ALLOC_SPARSE);
+  if (!g->adj || !keys)
+  {
+    alloc_free(keys, ALLOC_SPARSE);
+    goto fail;
+  }
+  for (int r = 0; r < g->n; r++)
+  {
+    int *row = g->adj + g->ptr[r];
+    reorder_union_row(csr, t, r, row);
+    for (int k = 0; k < g->degree[r]; k++)
+    {
+      keys[k].degree = g->degree[row[k]];
+      keys[k].node = row[k];
+    }
+    qsort(keys, (size_t)g->degree[r], sizeof(ReorderKey), reorder_key_cmp);
+    for (int k = 0; k < g->degree[r]; k++)
+      row[k] = keys[k].node;
+  }
+  alloc_free(keys, ALLOC_SPARSE);
+  csr_destroy(t);
+  return 1;
+
+fail:
+  fprintf(stderr, "Error: Memory allocation failed for reordering graph.\n");
+  csr_destroy(t);
+  reorder_graph_free(g);
+  return 0;
+}
+
+// Cuthill-McKee BFS from start, appending to order[*count...] and marking
+// visited. Returns the number of levels; *last_level is where the last begins.
+static int reorder_bfs(ReorderGraph *g, int start, int *order, int *count, char *visited, int *last_level)
+{
+  int head = *count, levels = 0;
+  order[(*count)++] = start;
+  visited[start] = 1;
+  while (head < *count)
+  {
+    int level_end = *count;
+    *last_level = head;
+    levels++;
+    for (; head < level_end; head++)
+    {
+      int v = order[head];
+      for (size_t k = g->ptr[v]; k < g->ptr[v + 1]; k++)
+      {
+        int u = g->adj[k];
+        if (!visited[u])
+        {
+          visited[u] = 1;
+          order[(*count)++] = u;
+        }
+      }
+    }
+  }
+  return levels;
+}
+
+// George-Liu: restart the BFS from a minimum-degree node of the last level
+// while that makes the level structure deeper
+static int reorder_peripheral(ReorderGraph *g, int start, int *scratch, char *visited)
+{
+  int depth = 0;
+  for (int sweep = 0; sweep < REORDER_MAX_SWEEPS; sweep++)
+  {
+    int count = 0, last;
+    int levels = reorder_bfs(g, start, scratch, &count, visited, &last);
+    int candidate = scratch[last];
+    for (int i = last + 1; i < count; i++)
+      if (g->degree[scratch[i]] < g->degree[candidate])
+        candidate = scratch[i];
+    for (int i = 0; i < count; i++)
+      visited[scratch[i]] = 0;
+    if (levels <= depth)
+      break;
+    depth = levels;
+    start = candidate;
+  }
+  return start;
+}
+
+static Reordering *reorder_alloc(int n)
+{
+  Reordering *p = alloc_malloc(sizeof(Reordering), ALLOC_SPARSE);
+  if (!p)
+  {
+    fprintf(stderr, "Memory allocation failed for Reordering struct.\n");
+    return NULL;
+  }
+  p->n = n;
+  p->order = alloc_malloc(sizeof(int) * (size_t)n, ALLOC_SPARSE);
+  p->position = alloc_malloc(sizeof(int) * (size_t)n, ALLOC_SPARSE);
+  if (!p->order || !p->position)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for a permutation of %d.\n", n);
+    reorder_destroy(p);
+    return NULL;
+  }
+  return p;
+}
+
+static void reorder_fill_position(Reordering *p)
+{
+  for (int i = 0; i < p->n; i++)
+    p->position[p->order[i]] = i;
+}
+
+static Reordering *reorder_rcm(CsrMat *csr)
+{
+  ReorderGraph g;
+  if (!reorder_graph_build(csr, &g))
+    return NULL;
+  Reordering *p = reorder_alloc(g.n);
+  int *scratch = alloc_malloc(sizeof(int) * (size_t)g.n, ALLOC_SPARSE);
+  char *visited = alloc_calloc((size_t)g.n, 1, ALLOC_SPARSE);
+  ReorderKey *by_degree = alloc_malloc(sizeof(ReorderKey) * (size_t)g.n, ALLOC_SPARSE);
+  if (!p || !scratch || !visited || !by_degree)
+  {
+    if (p)
+      fprintf(stderr, "Error: Memory allocation failed for RCM.\n");
+    reorder_destroy(p);
+    p = NULL;
+    goto done;
+  }
+  // Each component starts from a peripheral node near its lowest-degree node
+  for (int v = 0; v < g.n; v++)
+  {
+    by_degree[v].degree = g.degree[v];
+    by_degree[v].node = v;
+  }
+  qsort(by_degree, (size_t)g.n, sizeof(ReorderKey), reorder_key_cmp);
+  int count = 0;
+  for (int i = 0; i < g.n; i++)
+  {
+    int v = by_degree[i].node;
+    if (visited[v])
+      continue;
+    int start = reorder_peripheral(&g, v, scratch, visited), last;
+    reorder_bfs(&g, start, p->order, &count, visited, &last);
+  }
+  // Reverse: puts the wide middle levels after their parents, which shrinks
+  // the profile (Liu and Sherman)
+  for (int i = 0, j = g.n - 1; i < j; i++, j--)
+  {
+    int tmp = p->order[i];
+    p->order[i] = p->order[j];
+    p->order[j] = tmp;
+  }
+  reorder_fill_position(p);
+
+done:
+  alloc_free(scratch, ALLOC_SPARSE);
+  alloc_free(visited, ALLOC_SPARSE);
+  alloc_free(by_degree, ALLOC_SPARSE);
+  reorder_graph_free(&g);
+  return p;
+}
+
+// stable counting sort on (entries in row r) + (entries in column r), descending
+static Reordering *reorder_degree(CsrMat *csr)
+{
+  int n = csr->nrows;
+  Reordering *p = reorder_alloc(n);
+  int *degree = alloc_calloc((size_t)n, sizeof(int), ALLOC_SPARSE);
+  size_t *start = NULL;
+  if (!p || !degree)
+    goto fail;
+  int max_degree = 0;
+  for (int r = 0; r < n; r++)
+    degree[r] += (int)(csr->row_ptr[r + 1] - csr->row_ptr[r]);
+  for (size_t k = 0; k < csr->nnz; k++)
+    degree[csr->col_idx[k]]++;
+  for (int r = 0; r < n; r++)
+    if (degree[r] > max_degree)
+      max_degree = degree[r];
+  start = alloc_calloc((size_t)max_degree + 2, sizeof(size_t), ALLOC_SPARSE);
+  if (!start)
+    goto fail;
+  for (int r = 0; r < n; r++)
+    start[max_degree - degree[r] + 1]++; // Bucket 0 holds the highest degree
+  for (int d = 0; d <= max_degree; d++)
+    start[d + 1] += start[d];
+  for (int r = 0; r < n; r++)
+    p->order[start[max_degree - degree[r]]++] = r;
+  reorder_fill_position(p);
+  alloc_free(degree, ALLOC_SPARSE);
+  alloc_free(start, ALLOC_SPARSE);
+  return p;
+
+fail:
+  if (p)
+    fprintf(stderr, "Error: Memory allocation failed for degree ordering.\n");
+  reorder_destroy(p);
+  alloc_free(degree, ALLOC_SPARSE);
+  alloc_free(start, ALLOC_SPARSE);
+  return NULL;
+}
+
+Reordering *reorder_compute(CsrMat *csr, ReorderMethod method)
+{
+  if (csr == NULL)
+  {
+    fprintf(stderr, "Error: Cannot reorder a NULL matrix.\n");
+    return NULL;
+  }
+  if (csr->nrows != csr->ncols)
+  {
+    fprintf(stderr, "Error: Symmetric reordering needs a square matrix (got %dx%d).\n", csr->nrows, csr->ncols);
+    return NULL;
+  }
+  return method == REORDER_RCM ? reorder_rcm(csr) : reorder_degree(csr);
+}
+
+Reordering *reorder_sparse(SparseMat *mat, ReorderMethod method)
+{
+  CsrMat *csr = csr_from_sparse(mat);
+  if (!csr)
+    return NULL;
+  Reordering *p = reorder_compute(csr, method);
+  csr_destroy(csr);
+  return p;
+}
+
+void reorder_destroy(Reordering *p)
+{
+  if (p == NULL)
+    return;
+  alloc_free(p->order, ALLOC_SPARSE);
+  alloc_free(p->position, ALLOC_SPARSE);
+  alloc_free(p, ALLOC_SPARSE);
+}
+
+static int reorder_check(int nrows, int ncols, Reordering *p)
+{
+  if (p == NULL)
+  {
+    fprintf(stderr, "Error: Cannot apply a NULL reordering.\n");
+    return 0;
+  }
+  if (nrows != p->n || ncols != p->n)
+  {
+    fprintf(stderr, "Error: Reordering of %d does not fit a %dx%d matrix.\n", p->n, nrows, ncols);
+    return 0;
+  }
+  return 1;
+}
+
+// Rows are copied in the new order with renumbered but unsorted columns; a
+// double transpose then sorts every row in O(nnz + n)
+CsrMat *reorder_apply(CsrMat *csr, Reordering *p)
+{
+  if (csr == NULL || !reorder_check(csr->nrows, csr->ncols, p))
+    return NULL;
+  CsrMat *moved = csr_new(csr->nrows, csr->ncols, csr->nnz);
+  if (!moved)
+    return NULL;
+  size_t out = 0;
+  for (int r = 0; r < p->n; r++)
+  {
+    int old = p->order[r];
+    moved->row_ptr[r] = out;
+    for (size_t k = csr->row_ptr[old]; k < csr->row_ptr[old + 1]; k++, out++)
+    {
+      moved->col_idx[out] = p->position[csr->col_idx[k]];
+      moved->values[out] = csr->values[k];
+    }
+  }
+  moved->row_ptr[p->n] = out;
+  moved->nnz = out;
+  CsrMat *t = csr_transpose(moved);
+  csr_destroy(moved);
+  CsrMat *result = t ? csr_transpose(t) : NULL;
+  csr_destroy(t);
+  return result;
+}
+
+SparseMat *reorder_apply_sparse(SparseMat *mat, Reordering *p)
+{
+  if (mat == NULL || !reorder_check(mat->nrows, mat->ncols, p))
+    return NULL;
+  SparseMat *moved = sparse_transpose(mat); // Same entries, same order, right capacity
+  if (!moved)
+    return NULL;
+  moved->nrows = mat->nrows;
+  moved->ncols = mat->ncols;
+  for (size_t k = 0; k < (size_t)mat->nnz; k++)
+  {
+    moved->data[k].row = (size_t)p->position[mat->data[k].row];
+    moved->data[k].col = (size_t)p->position[mat->data[k].col];
+  }
+  return moved;
+}
+
+void reorder_vector(Reordering *p, const int *x, int *px)
+{
+  for (int i = 0; i < p->n; i++)
+    px[i] = x[p->order[i]];
+}
+
+void reorder_vector_back(Reordering *p, const int *px, int *x)
+{
+  for (int i = 0; i < p->n; i++)
+    x[p->order[i]] = px[i];
+}
+
+BandStats reorder_band_stats(CsrMat *csr)
+{
+  BandStats s = {0, 0};
+  if (csr == NULL)
+    return s;
+  for (int r = 0; r < csr->nrows; r++)
+  {
+    size_t begin = csr->row_ptr[r], end = csr->row_ptr[r + 1];
+    if (begin == end)
+      continue;
+    int first = csr->col_idx[begin], last = csr->col_idx[end - 1]; // Columns are sorted
+    if (first < r)
+      s.profile += r - first;
+    if (r - first > s.bandwidth)
+      s.bandwidth = r - first;
+    if (last - r > s.bandwidth)
+      s.bandwidth = last - r;
+  }
+  return s;
+}
+
+void reorder_report(FILE *out, BandStats before, BandStats after)
+{
+  fprintf(out, "before: bandwidth %d, profile %lld\n", before.bandwidth, before.profile);
+  fprintf(out, "after:  bandwidth %d, profile %lld\n", after.bandwidth, after.profile);
+}
+
+const char *reorder_method_name(ReorderMethod method)
+{
+  return method == REORDER_RCM ? "rcm" : "degree";
+}
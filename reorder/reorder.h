@@ -0,0 +1,48 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include <stdio.h>
+#include "../csr/csr.h"
+#include "../sparse/sparse.h"
+
+// Symmetric reorderings B = P A P^T of a square matrix. Renumbering rows and
+// columns together keeps the neighbours of a row close in x, so SpMV reads x
+// almost sequentially instead of at random.
+typedef enum
+{
+  REORDER_RCM,   // Reverse Cuthill-McKee on the pattern of A + A^T: small bandwidth
+  REORDER_DEGREE // Descending degree: hub rows and their x entries first
+} ReorderMethod;
+
+// Both directions of the permutation, so results can be mapped back
+typedef struct
+{
+  int n;
+  int *order;    // New index -> old index
+  int *position; // Old index -> new index
+} Reordering;
+
+// Envelope statistics of a matrix
+typedef struct
+{
+  int bandwidth;     // max |row - col| over the stored entries
+  long long profile; // sum over rows of row - (first column), for entries left of the diagonal
+} BandStats;
+
+Reordering *reorder_compute(CsrMat *csr, ReorderMethod method); // NULL on error
+Reordering *reorder_sparse(SparseMat *mat, ReorderMethod method);
+void reorder_destroy(Reordering *p);
+
+// New matrices with entry (r, c) moved to (position[r], position[c])
+CsrMat *reorder_apply(CsrMat *csr, Reordering *p);
+SparseMat *reorder_apply_sparse(SparseMat *mat, Reordering *p);
+// px = P x (into the new numbering) and x = P^T px (back to the old one)
+void reorder_vector(Reordering *p, const int *x, int *px);
+void reorder_vector_back(Reordering *p, const int *px, int *x);
+
+BandStats reorder_band_stats(CsrMat *csr);
+// One line per matrix, e.g. "before: bandwidth 4093, profile 8372612"
+void reorder_report(FILE *out, BandStats before, BandStats after);
+const char *reorder_method_name(ReorderMethod method);
+
+#endif // REORDER_H
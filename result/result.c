@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include "result.h"
+#include "../alloc/alloc.h"
 
 int destroy_result(Result *r)
 {
@@ -9,7 +10,7 @@ int destroy_result(Result *r)
   }
   if (r->status == OK)
   {
-    free(r->data.ok);
+    alloc_free(r->data.ok, ALLOC_PARSER);
     r->data.ok = NULL;
     return 0;
   }
@@ -23,7 +24,7 @@ int destroy_read_result(ReadResult *r){
   }
   if (r->status == READ_OK)
   {
-    free(r->data.ok);
+    alloc_free(r->data.ok, ALLOC_PARSER);
     r->data.ok = NULL;
     return 0;
   }
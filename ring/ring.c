@@ -0,0 +1,146 @@
+#include "ring.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+
+Ring *ring_new(size_t capacity)
+{
+  size_t size = 2;
+  while (size < capacity)
+  {
+    if (size > SIZE_MAX / 4 / sizeof(int))
+    {
+      fprintf(stderr, "Error: Ring capacity %zu is too large.\n", capacity);
+      return NULL;
+    }
+    size *= 2;
+  }
+  // One block: alignment slack, the struct on its own lines, then the slots
+  void *block = alloc_malloc(RING_CACHE_LINE - 1 + sizeof(Ring) + sizeof(int) * size, ALLOC_QUEUE);
+  if (!block)
+  {
+    fprintf(stderr, "Memory allocation failed for ring (%zu slots).\n", size);
+    return NULL;
+  }
+  Ring *r = (Ring *)(((uintptr_t)block + RING_CACHE_LINE - 1) & ~(uintptr_t)(RING_CACHE_LINE - 1));
+  r->block = block;
+  r->slots = (int *)(r + 1);
+  r->mask = size - 1;
+  atomic_init(&r->tail, 0);
+  atomic_init(&r->head, 0);
+  r->head_cache = 0;
+  r->tail_cache = 0;
+  return r;
+}
+
+void ring_destroy(Ring *r)
+{
+  if (r == NULL)
+    return;
+  alloc_free(r->block, ALLOC_QUEUE);
+}
+
+size_t ring_capacity(Ring *r)
+{
+  return r ? r->mask + 1 : 0;
+}
+
+size_t ring_size(Ring *r)
+{
+  if (r == NULL)
+    return 0;
+  return atomic_load_explicit(&r->tail, memory_order_acquire) - atomic_load_explicit(&r->head, memory_order_acquire);
+}
+
+// Free slots as the producer sees them, refreshing the cached head when
+// fewer than want look free
+static size_t ring_free_slots(Ring *r, size_t tail, size_t want)
+{
+  size_t free_slots = r->mask + 1 - (tail - r->head_cache);
+  if (free_slots < want)
+  {
+    r->head_cache = atomic_load_explicit(&r->head, memory_order_acquire);
+    free_slots = r->mask + 1 - (tail - r->head_cache);
+  }
+  return free_slots;
+}
+
+// Filled slots as the consumer sees them, refreshing the cached tail likewise
+static size_t ring_filled_slots(Ring *r, size_t head, size_t want)
+{
+  size_t filled = r->tail_cache - head;
+  if (filled < want)
+  {
+    r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire);
+    filled = r->tail_cache - head;
+  }
+  return filled;
+}
+
+int ring_push(Ring *r, int value)
+{
+  size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  if (ring_free_slots(r, tail, 1) == 0)
+    return 0;
+  r->slots[tail & r->mask] = value;
+  atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+  return 1;
+}
+
+int ring_pop_back(Ring *r, int *out_value)
+{
+  size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  if (tail == atomic_load_explicit(&r->head, memory_order_acquire))
+    return 0;
+  if (out_value != NULL)
+    *out_value = r->slots[(tail - 1) & r->mask];
+  // The consumer is idle, so its cached tail can be pulled back safely
+  if (r->tail_cache > tail - 1)
+    r->tail_cache = tail - 1;
+  atomic_store_explicit(&r->tail, tail - 1, memory_order_release);
+  return 1;
+}
+
+int ring_pop(Ring *r, int *out_value)
+{
+  size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  if (ring_filled_slots(r, head, 1) == 0)
+    return 0;
+  if (out_value != NULL)
+    *out_value = r->slots[head & r->mask];
+  atomic_store_explicit(&r->head, head + 1, memory_order_release);
+  return 1;
+}
+
+size_t ring_push_batch(Ring *r, const int *values, size_t n)
+{
+  size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  size_t free_slots = ring_free_slots(r, tail, n);
+  if (n > free_slots)
+    n = free_slots;
+  if (n == 0)
+    return 0;
+  size_t start = tail & r->mask;
+  size_t first = r->mask + 1 - start < n ? r->mask + 1 - start : n; // Up to the wrap
+  memcpy(r->slots + start, values, sizeof(int) * first);
+  memcpy(r->slots, values + first, sizeof(int) * (n - first));
+  atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+  return n;
+}
+
+size_t ring_pop_batch(Ring *r, int *out, size_t n)
+{
+  size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  size_t filled = ring_filled_slots(r, head, n);
+  if (n > filled)
+    n = filled;
+  if (n == 0)
+    return 0;
+  size_t start = head & r->mask;
+  size_t first = r->mask + 1 - start < n ? r->mask + 1 - start : n;
+  memcpy(out, r->slots + start, sizeof(int) * first);
+  memcpy(out + first, r->slots, sizeof(int) * (n - first));
+  atomic_store_explicit(&r->head, head + n, memory_order_release);
+  return n;
+}
@@ -0,0 +1,52 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdatomic.h>
+#include <stddef.h> // for size_t
+
+// Fixed-capacity ring buffer of ints for one producer thread and one
+// consumer thread. The capacity is a power of two, so positions are free-
+// running counters masked into the slots. Producer and consumer state sit
+// on separate cache lines, and each side keeps a cached copy of the other's
+// index, so the shared lines only move when the cached view runs out
+// (the ring looks full or empty), not on every operation.
+//
+// FIFO: the producer pushes, the consumer pops. LIFO: ring_pop_back takes
+// the newest element from the producer side; it must only be used while no
+// consumer is popping concurrently (e.g. as a single-threaded stack).
+#define RING_CACHE_LINE 64
+
+typedef struct
+{
+  // Read-only after creation
+  int *slots;
+  size_t mask;
+  void *block; // Allocation holding the struct and the slots
+  char pad0[RING_CACHE_LINE - 2 * sizeof(void *) - sizeof(size_t)];
+  // Producer
+  atomic_size_t tail; // Next position to write
+  size_t head_cache;  // Last head the producer read
+  char pad1[RING_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+  // Consumer
+  atomic_size_t head; // Next position to read
+  size_t tail_cache;  // Last tail the consumer read
+  char pad2[RING_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+} Ring;
+
+// capacity is rounded up to a power of two (at least 2). NULL on error.
+Ring *ring_new(size_t capacity);
+void ring_destroy(Ring *r);
+size_t ring_capacity(Ring *r);
+size_t ring_size(Ring *r); // Exact only when neither side is running
+
+// Producer side (return 1 on success, 0 when full / empty)
+int ring_push(Ring *r, int value);
+int ring_pop_back(Ring *r, int *out_value); // LIFO; no concurrent consumer
+// Consumer side
+int ring_pop(Ring *r, int *out_value);
+// Batches publish their elements with one index update and return how many
+// were moved (possibly fewer than n)
+size_t ring_push_batch(Ring *r, const int *values, size_t n);
+size_t ring_pop_batch(Ring *r, int *out, size_t n);
+
+#endif // RING_H
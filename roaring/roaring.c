@@ -0,0 +1,654 @@
+#include "roaring.h"
+#include <stdio.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+#include "../bitset/bitset.h"
+
+#define ROARING_BITMAP_BYTES (ROARING_BITMAP_WORDS * sizeof(uint64_t))
+
+// --- Containers ---
+
+static int roaring_array_alloc(RoaringContainer *c, uint16_t key, uint32_t capacity)
+{
+  c->data.array = alloc_malloc(capacity * sizeof(uint16_t), ALLOC_BITSET);
+  if (!c->data.array)
+  {
+    fprintf(stderr, "Memory allocation failed for Roaring array container (%u values).\n", capacity);
+    return 0;
+  }
+  c->key = key;
+  c->kind = ROARING_ARRAY;
+  c->count = 0;
+  c->capacity = capacity;
+  return 1;
+}
+
+static int roaring_bitmap_alloc(RoaringContainer *c, uint16_t key)
+{
+  c->data.bitmap = alloc_calloc(ROARING_BITMAP_WORDS, sizeof(uint64_t), ALLOC_BITSET);
+  if (!c->data.bitmap)
+  {
+    fprintf(stderr, "Memory allocation failed for Roaring bitmap container.\n");
+    return 0;
+  }
+  c->key = key;
+  c->kind = ROARING_BITMAP;
+  c->count = 0;
+  c->capacity = 0;
+  return 1;
+}
+
+static void roaring_container_free(RoaringContainer *c)
+{
+  if (c->kind == ROARING_ARRAY)
+    alloc_free(c->data.array, ALLOC_BITSET);
+  else
+    alloc_free(c->data.bitmap, ALLOC_BITSET);
+}
+
+static int roaring_container_copy(RoaringContainer *dst, const RoaringContainer *src)
+{
+  if (src->kind == ROARING_ARRAY)
+  {
+    if (!roaring_array_alloc(dst, src->key, src->count))
+      return 0;
+    memcpy(dst->data.array, src->data.array, src->count * sizeof(uint16_t));
+  }
+  else
+  {
+    if (!roaring_bitmap_alloc(dst, src->key))
+      return 0;
+    memcpy(dst->data.bitmap, src->data.bitmap, ROARING_BITMAP_BYTES);
+  }
+  dst->count = src->count;
+  return 1;
+}
+
+static void roaring_array_to_words(uint64_t *words, const uint16_t *array, uint32_t count)
+{
+  memset(words, 0, ROARING_BITMAP_BYTES);
+  for (uint32_t i = 0; i < count; i++)
+    words[array[i] >> 6] |= 1ULL << (array[i] & 63);
+}
+
+static uint32_t roaring_words_to_array(uint16_t *array, const uint64_t *words)
+{
+  uint32_t n = 0;
+  for (uint32_t w = 0; w < ROARING_BITMAP_WORDS; w++)
+  {
+    for (uint64_t word = words[w]; word != 0; word &= word - 1)
+      array[n++] = (uint16_t)(w * 64 + (uint32_t)__builtin_ctzll(word));
+  }
+  return n;
+}
+
+// Switches kinds when the count crosses ROARING_ARRAY_MAX. 1 on success.
+static int roaring_container_normalize(RoaringContainer *c)
+{
+  RoaringContainer fresh;
+  if (c->kind == ROARING_BITMAP && c->count <= ROARING_ARRAY_MAX)
+  {
+    if (!roaring_array_alloc(&fresh, c->key, c->count > 0 ? c->count : 1))
+      return 0;
+    fresh.count = roaring_words_to_array(fresh.data.array, c->data.bitmap);
+  }
+  else if (c->kind == ROARING_ARRAY && c->count > ROARING_ARRAY_MAX)
+  {
+    if (!roaring_bitmap_alloc(&fresh, c->key))
+      return 0;
+    roaring_array_to_words(fresh.data.bitmap, c->data.array, c->count);
+    fresh.count = c->count;
+  }
+  else
+  {
+    return 1;
+  }
+  roaring_container_free(c);
+  *c = fresh;
+  return 1;
+}
+
+// First index whose value is >= low
+static uint32_t roaring_array_lower_bound(const RoaringContainer *c, uint16_t low)
+{
+  uint32_t lo = 0, hi = c->count;
+  while (lo < hi)
+  {
+    uint32_t mid = (lo + hi) / 2;
+    if (c->data.array[mid] < low)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static int roaring_container_contains(const RoaringContainer *c, uint16_t low)
+{
+  if (c->kind == ROARING_BITMAP)
+    return (int)((c->data.bitmap[low >> 6] >> (low & 63)) & 1);
+  uint32_t i = roaring_array_lower_bound(c, low);
+  return i < c->count && c->data.array[i] == low;
+}
+
+// Adds low; 1 on success (also when already present), 0 on error
+static int roaring_container_add(RoaringContainer *c, uint16_t low)
+{
+  if (c->kind == ROARING_BITMAP)
+  {
+    uint64_t bit = 1ULL << (low & 63);
+    if (!(c->data.bitmap[low >> 6] & bit))
+    {
+      c->data.bitmap[low >> 6] |= bit;
+      c->count++;
+    }
+    return 1;
+  }
+  // Appending in order is the common case for bulk loads
+  uint32_t i = c->count > 0 && c->data.array[c->count - 1] < low ? c->count : roaring_array_lower_bound(c, low);
+  if (i < c->count && c->data.array[i] == low)
+    return 1;
+  if (c->count == ROARING_ARRAY_MAX)
+  {
+    // Full array: continue as a bitmap
+    RoaringContainer fresh;
+    if (!roaring_bitmap_alloc(&fresh, c->key))
+      return 0;
+    roaring_array_to_words(fresh.data.bitmap, c->data.array, c->count);
+    fresh.count = c->count;
+    roaring_container_free(c);
+    *c = fresh;
+    return roaring_container_add(c, low);
+  }
+  if (c->count == c->capacity)
+  {
+    uint32_t capacity = c->capacity * 2 < ROARING_ARRAY_MAX ? c->capacity * 2 : ROARING_ARRAY_MAX;
+    uint16_t *array = alloc_realloc(c->data.array, capacity * sizeof(uint16_t), ALLOC_BITSET);
+    if (!array)
+    {
+      fprintf(stderr, "Memory allocation failed for Roaring array container (%u values).\n", capacity);
+      return 0;
+    }
+    c->data.array = array;
+    c->capacity = capacity;
+  }
+  memmove(c->data.array + i + 1, c->data.array + i, (c->count - i) * sizeof(uint16_t));
+  c->data.array[i] = low;
+  c->count++;
+  return 1;
+}
+
+// --- Container pairs ---
+
+// Merge of two sorted arrays keeping values found in a only, b only and
+// both as the flags say; returns how many were written to out
+static uint32_t roaring_merge(uint16_t *out, const uint16_t *a, uint32_t na, const uint16_t *b, uint32_t nb,
+                              int keep_a, int keep_b, int keep_both)
+{
+  uint32_t i = 0, j = 0, n = 0;
+  while (i < na && j < nb)
+  {
+    if (a[i] < b[j])
+    {
+      if (keep_a)
+        out[n++] = a[i];
+      i++;
+    }
+    else if (b[j] < a[i])
+    {
+      if (keep_b)
+        out[n++] = b[j];
+      j++;
+    }
+    else
+    {
+      if (keep_both)
+        out[n++] = a[i];
+      i++;
+      j++;
+    }
+  }
+  if (keep_a)
+  {
+    memcpy(out + n, a + i, (na - i) * sizeof(uint16_t));
+    n += na - i;
+  }
+  if (keep_b)
+  {
+    memcpy(out + n, b + j, (nb - j) * sizeof(uint16_t));
+    n += nb - j;
+  }
+  return n;
+}
+
+// out = x op y for containers with the same key. out->count may be 0.
+// Returns 1 on success, 0 on error.
+static int roaring_container_op(const RoaringContainer *x, const RoaringContainer *y, BitsetOp op,
+                                RoaringContainer *out)
+{
+  if (op == BITSET_AND && x->kind == ROARING_BITMAP)
+  {
+    const RoaringContainer *t = x;
+    x = y;
+    y = t;
+  }
+  if (x->kind == ROARING_ARRAY && y->kind == ROARING_ARRAY)
+  {
+    uint32_t capacity = op == BITSET_AND ? (x->count < y->count ? x->count : y->count)
+                        : op == BITSET_ANDNOT ? x->count
+                                              : x->count + y->count;
+    if (!roaring_array_alloc(out, x->key, capacity > 0 ? capacity : 1))
+      return 0;
+    out->count = roaring_merge(out->data.array, x->data.array, x->count, y->data.array, y->count,
+                               op != BITSET_AND, op == BITSET_OR || op == BITSET_XOR,
+                               op == BITSET_AND || op == BITSET_OR);
+    if (!roaring_container_normalize(out))
+    {
+      roaring_container_free(out);
+      return 0;
+    }
+    return 1;
+  }
+  if (x->kind == ROARING_ARRAY && (op == BITSET_AND || op == BITSET_ANDNOT))
+  {
+    // Filter the array through the bitmap
+    if (!roaring_array_alloc(out, x->key, x->count))
+      return 0;
+    uint32_t n = 0;
+    int want = op == BITSET_AND;
+    for (uint32_t i = 0; i < x->count; i++)
+    {
+      uint16_t v = x->data.array[i];
+      out->data.array[n] = v;
+      n += (int)((y->data.bitmap[v >> 6] >> (v & 63)) & 1) == want;
+    }
+    out->count = n;
+    return 1;
+  }
+  // Everything else runs on bitmaps, expanding an array operand first
+  uint64_t xs[ROARING_BITMAP_WORDS], ys[ROARING_BITMAP_WORDS];
+  const uint64_t *xw = x->data.bitmap, *yw = y->data.bitmap;
+  if (x->kind == ROARING_ARRAY)
+  {
+    roaring_array_to_words(xs, x->data.array, x->count);
+    xw = xs;
+  }
+  if (y->kind == ROARING_ARRAY)
+  {
+    roaring_array_to_words(ys, y->data.array, y->count);
+    yw = ys;
+  }
+  if (!roaring_bitmap_alloc(out, x->key))
+    return 0;
+  out->count = (uint32_t)bitset_words_op(out->data.bitmap, xw, yw, ROARING_BITMAP_WORDS, op);
+  if (!roaring_container_normalize(out))
+  {
+    roaring_container_free(out);
+    return 0;
+  }
+  return 1;
+}
+
+static uint32_t roaring_container_and_count(const RoaringContainer *x, const RoaringContainer *y)
+{
+  if (x->kind == ROARING_BITMAP && y->kind == ROARING_BITMAP)
+    return (uint32_t)bitset_words_op(NULL, x->data.bitmap, y->data.bitmap, ROARING_BITMAP_WORDS, BITSET_AND);
+  if (x->kind == ROARING_BITMAP)
+  {
+    const RoaringContainer *t = x;
+    x = y;
+    y = t;
+  }
+  uint32_t n = 0;
+  if (y->kind == ROARING_BITMAP)
+  {
+    for (uint32_t i = 0; i < x->count; i++)
+    {
+      uint16_t v = x->data.array[i];
+      n += (uint32_t)((y->data.bitmap[v >> 6] >> (v & 63)) & 1);
+    }
+    return n;
+  }
+  uint32_t i = 0, j = 0;
+  while (i < x->count && j < y->count)
+  {
+    uint16_t a = x->data.array[i], b = y->data.array[j];
+    n += a == b;
+    i += a <= b;
+    j += b <= a;
+  }
+  return n;
+}
+
+// --- Bitmap ---
+
+Roaring *roaring_new(void)
+{
+  Roaring *r = alloc_malloc(sizeof(Roaring), ALLOC_BITSET);
+  if (!r)
+  {
+    fprintf(stderr, "Memory allocation failed for Roaring struct.\n");
+    return NULL;
+  }
+  r->containers = NULL;
+  r->ncontainers = 0;
+  r->capacity = 0;
+  return r;
+}
+
+void roaring_destroy(Roaring *r)
+{
+  if (r == NULL)
+    return;
+  for (size_t i = 0; i < r->ncontainers; i++)
+    roaring_container_free(&r->containers[i]);
+  alloc_free(r->containers, ALLOC_BITSET);
+  alloc_free(r, ALLOC_BITSET);
+}
+
+// First container whose key is >= key
+static size_t roaring_lower_bound(const Roaring *r, uint16_t key)
+{
+  size_t lo = 0, hi = r->ncontainers;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (r->containers[mid].key < key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Takes ownership of c. 1 on success; on error c is freed.
+static int roaring_insert_container(Roaring *r, size_t index, RoaringContainer *c)
+{
+  if (r->ncontainers == r->capacity)
+  {
+    size_t capacity = r->capacity ? r->capacity * 2 : 4;
+    RoaringContainer *containers = alloc_realloc(r->containers, capacity * sizeof(RoaringContainer), ALLOC_BITSET);
+    if (!containers)
+    {
+      fprintf(stderr, "Memory allocation failed for Roaring container list (%zu containers).\n", capacity);
+      roaring_container_free(c);
+      return 0;
+    }
+    r->containers = containers;
+    r->capacity = capacity;
+  }
+  memmove(r->containers + index + 1, r->containers + index, (r->ncontainers - index) * sizeof(RoaringContainer));
+  r->containers[index] = *c;
+  r->ncontainers++;
+  return 1;
+}
+
+static void roaring_remove_container(Roaring *r, size_t index)
+{
+  roaring_container_free(&r->containers[index]);
+  memmove(r->containers + index, r->containers + index + 1, (r->ncontainers - index - 1) * sizeof(RoaringContainer));
+  r->ncontainers--;
+}
+
+// Index of the container for key, creating an empty one if needed; ncontainers on error
+static size_t roaring_container_for(Roaring *r, uint16_t key)
+{
+  size_t i = r->ncontainers > 0 && r->containers[r->ncontainers - 1].key < key ? r->ncontainers
+                                                                              : roaring_lower_bound(r, key);
+  if (i < r->ncontainers && r->containers[i].key == key)
+    return i;
+  RoaringContainer c;
+  if (!roaring_array_alloc(&c, key, 4) || !roaring_insert_container(r, i, &c))
+    return r->ncontainers;
+  return i;
+}
+
+int roaring_add(Roaring *r, uint32_t value)
+{
+  if (r == NULL)
+  {
+    fprintf(stderr, "Error: Cannot add to a NULL Roaring bitmap.\n");
+    return 0;
+  }
+  size_t i = roaring_container_for(r, (uint16_t)(value >> 16));
+  if (i == r->ncontainers)
+    return 0;
+  return roaring_container_add(&r->containers[i], (uint16_t)value);
+}
+
+int roaring_add_many(Roaring *r, const uint32_t *values, size_t n)
+{
+  if (r == NULL || (values == NULL && n > 0))
+  {
+    fprintf(stderr, "Error: Cannot add to a NULL Roaring bitmap or from a NULL array.\n");
+    return 0;
+  }
+  size_t i = r->ncontainers;
+  for (size_t k = 0; k < n; k++)
+  {
+    uint16_t key = (uint16_t)(values[k] >> 16);
+    if (i == r->ncontainers || r->containers[i].key != key)
+    {
+      i = roaring_container_for(r, key);
+      if (i == r->ncontainers)
+        return 0;
+    }
+    if (!roaring_container_add(&r->containers[i], (uint16_t)values[k]))
+      return 0;
+  }
+  return 1;
+}
+
+int roaring_remove(Roaring *r, uint32_t value)
+{
+  if (r == NULL)
+    return 0;
+  uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value;
+  size_t i = roaring_lower_bound(r, key);
+  if (i == r->ncontainers || r->containers[i].key != key)
+    return 0;
+  RoaringContainer *c = &r->containers[i];
+  if (c->kind == ROARING_BITMAP)
+  {
+    uint64_t bit = 1ULL << (low & 63);
+    if (!(c->data.bitmap[low >> 6] & bit))
+      return 0;
+    c->data.bitmap[low >> 6] &= ~bit;
+    c->count--;
+    roaring_container_normalize(c); // On failure the bitmap just stays
+  }
+  else
+  {
+    uint32_t j = roaring_array_lower_bound(c, low);
+    if (j == c->count || c->data.array[j] != low)
+      return 0;
+    memmove(c->data.array + j, c->data.array + j + 1, (c->count - j - 1) * sizeof(uint16_t));
+    c->count--;
+  }
+  if (c->count == 0)
+    roaring_remove_container(r, i);
+  return 1;
+}
+
+int roaring_contains(Roaring *r, uint32_t value)
+{
+  if (r == NULL)
+    return 0;
+  uint16_t key = (uint16_t)(value >> 16);
+  size_t i = roaring_lower_bound(r, key);
+  return i < r->ncontainers && r->containers[i].key == key &&
+         roaring_container_contains(&r->containers[i], (uint16_t)value);
+}
+
+size_t roaring_count(Roaring *r)
+{
+  size_t n = 0;
+  for (size_t i = 0; r != NULL && i < r->ncontainers; i++)
+    n += r->containers[i].count;
+  return n;
+}
+
+// Pairs containers by key. Containers of a alone are kept for every op but
+// AND; containers of b alone only for OR and XOR.
+static Roaring *roaring_op(Roaring *a, Roaring *b, BitsetOp op)
+{
+  if (a == NULL || b == NULL)
+  {
+    fprintf(stderr, "Error: Roaring operands must be non-NULL.\n");
+    return NULL;
+  }
+  Roaring *out = roaring_new();
+  if (!out)
+    return NULL;
+  int keep_a = op != BITSET_AND, keep_b = op == BITSET_OR || op == BITSET_XOR;
+  size_t i = 0, j = 0;
+  while (i < a->ncontainers || j < b->ncontainers)
+  {
+    const RoaringContainer *x = i < a->ncontainers ? &a->containers[i] : NULL;
+    const RoaringContainer *y = j < b->ncontainers ? &b->containers[j] : NULL;
+    RoaringContainer c;
+    int ok = 1, have = 0;
+    if (x && (!y || x->key < y->key))
+    {
+      if (keep_a)
+        have = ok = roaring_container_copy(&c, x);
+      i++;
+    }
+    else if (y && (!x || y->key < x->key))
+    {
+      if (keep_b)
+        have = ok = roaring_container_copy(&c, y);
+      j++;
+    }
+    else
+    {
+      ok = roaring_container_op(x, y, op, &c);
+      if (ok && c.count == 0)
+        roaring_container_free(&c);
+      else
+        have = ok;
+      i++;
+      j++;
+    }
+    if (!ok || (have && !roaring_insert_container(out, out->ncontainers, &c)))
+    {
+      roaring_destroy(out);
+      return NULL;
+    }
+  }
+  return out;
+}
+
+Roaring *roaring_and(Roaring *a, Roaring *b) { return roaring_op(a, b, BITSET_AND); }
+
+Roaring *roaring_or(Roaring *a, Roaring *b) { return roaring_op(a, b, BITSET_OR); }
+
+Roaring *roaring_xor(Roaring *a, Roaring *b) { return roaring_op(a, b, BITSET_XOR); }
+
+Roaring *roaring_andnot(Roaring *a, Roaring *b) { return roaring_op(a, b, BITSET_ANDNOT); }
+
+size_t roaring_and_count(Roaring *a, Roaring *b)
+{
+  if (a == NULL || b == NULL)
+    return 0;
+  size_t n = 0, i = 0, j = 0;
+  while (i < a->ncontainers && j < b->ncontainers)
+  {
+    uint16_t x = a->containers[i].key, y = b->containers[j].key;
+    if (x == y)
+      n += roaring_container_and_count(&a->containers[i], &b->containers[j]);
+    i += x <= y;
+    j += y <= x;
+  }
+  return n;
+}
+
+size_t roaring_rank(Roaring *r, uint32_t value)
+{
+  if (r == NULL)
+    return 0;
+  uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value;
+  size_t rank = 0;
+  for (size_t i = 0; i < r->ncontainers && r->containers[i].key <= key; i++)
+  {
+    const RoaringContainer *c = &r->containers[i];
+    if (c->key < key)
+    {
+      rank += c->count;
+    }
+    else if (c->kind == ROARING_ARRAY)
+    {
+      uint32_t j = roaring_array_lower_bound(c, low);
+      rank += j + (j < c->count && c->data.array[j] == low);
+    }
+    else
+    {
+      uint64_t mask = (low & 63) == 63 ? ~0ULL : (1ULL << ((low & 63) + 1)) - 1;
+      rank += bitset_words_count(c->data.bitmap, low >> 6) +
+              (size_t)bitset_word_count(c->data.bitmap[low >> 6] & mask);
+    }
+  }
+  return rank;
+}
+
+int roaring_select(Roaring *r, size_t k, uint32_t *out_value)
+{
+  if (r == NULL)
+    return 0;
+  for (size_t i = 0; i < r->ncontainers; i++)
+  {
+    const RoaringContainer *c = &r->containers[i];
+    if (k >= c->count)
+    {
+      k -= c->count;
+      continue;
+    }
+    uint32_t low;
+    if (c->kind == ROARING_ARRAY)
+    {
+      low = c->data.array[k];
+    }
+    else
+    {
+      uint32_t w = 0;
+      for (;; w++)
+      {
+        size_t bits = (size_t)bitset_word_count(c->data.bitmap[w]);
+        if (k < bits)
+          break;
+        k -= bits;
+      }
+      low = w * 64 + bitset_word_select(c->data.bitmap[w], (unsigned)k);
+    }
+    if (out_value != NULL)
+      *out_value = ((uint32_t)c->key << 16) | low;
+    return 1;
+  }
+  return 0;
+}
+
+size_t roaring_to_array(Roaring *r, uint32_t *out)
+{
+  if (r == NULL)
+    return 0;
+  size_t n = 0;
+  for (size_t i = 0; i < r->ncontainers; i++)
+  {
+    const RoaringContainer *c = &r->containers[i];
+    uint32_t high = (uint32_t)c->key << 16;
+    if (c->kind == ROARING_ARRAY)
+    {
+      for (uint32_t j = 0; j < c->count; j++)
+        out[n++] = high | c->data.array[j];
+    }
+    else
+    {
+      for (uint32_t w = 0; w < ROARING_BITMAP_WORDS; w++)
+      {
+        for (uint64_t word = c->data.bitmap[w]; word != 0; word &= word - 1)
+          out[n++] = high | (w * 64 + (uint32_t)__builtin_ctzll(word));
+      }
+    }
+  }
+  return n;
+}
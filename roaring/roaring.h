@@ -0,0 +1,64 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+#include <stddef.h> // for size_t
+#include <stdint.h>
+
+// Compressed bitmap of 32-bit values (Roaring layout). Values are grouped
+// by their high 16 bits into containers kept sorted by that key. A
+// container holding at most ROARING_ARRAY_MAX values stores their low 16
+// bits as a sorted array (2 bytes a value). A fuller one is a 65536-bit
+// bitmap (8 KiB) that goes through the bitset/ word kernels. Set
+// operations pair containers by key and pick the cheapest algorithm for
+// each pair of kinds; results are converted back to arrays when they thin
+// out, so memory stays near min(2 * n, 8 KiB per 65536 values).
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_BITMAP_WORDS 1024
+
+typedef enum
+{
+  ROARING_ARRAY,
+  ROARING_BITMAP
+} RoaringKind;
+
+typedef struct
+{
+  uint16_t key;      // High 16 bits of every value in the container
+  uint16_t kind;     // RoaringKind
+  uint32_t count;    // Values in the container, 1..65536
+  uint32_t capacity; // Array slots allocated (arrays only)
+  union
+  {
+    uint16_t *array;  // count sorted low halves
+    uint64_t *bitmap; // ROARING_BITMAP_WORDS words
+  } data;
+} RoaringContainer;
+
+typedef struct
+{
+  RoaringContainer *containers; // Sorted by key
+  size_t ncontainers;
+  size_t capacity;
+} Roaring;
+
+Roaring *roaring_new(void); // NULL on error
+void roaring_destroy(Roaring *r);
+int roaring_add(Roaring *r, uint32_t value); // Returns 1 on success, 0 on error
+// Adds values (any order, duplicates allowed); much faster when they are sorted
+int roaring_add_many(Roaring *r, const uint32_t *values, size_t n);
+int roaring_remove(Roaring *r, uint32_t value); // 1 if the value was present
+int roaring_contains(Roaring *r, uint32_t value);
+size_t roaring_count(Roaring *r);
+
+// New bitmap holding a op b; NULL on error
+Roaring *roaring_and(Roaring *a, Roaring *b);
+Roaring *roaring_or(Roaring *a, Roaring *b);
+Roaring *roaring_xor(Roaring *a, Roaring *b);
+Roaring *roaring_andnot(Roaring *a, Roaring *b); // a & ~b
+size_t roaring_and_count(Roaring *a, Roaring *b); // |a & b| without building it
+
+size_t roaring_rank(Roaring *r, uint32_t value); // Values <= value
+int roaring_select(Roaring *r, size_t k, uint32_t *out_value); // The k-th smallest value (from 0); 0 if none
+size_t roaring_to_array(Roaring *r, uint32_t *out); // Ascending values; returns how many
+
+#endif // ROARING_H
@@ -0,0 +1,17 @@
+#include "search.h"
+#include <stddef.h>
+#include "../types/types.h"
+#include "../vector/vector.h"
+
+// returns the index of the first element equal to el, or -1 if not found
+int get_index(Vec *vec, int el)
+{
+  for (size_t i = 0; i < vec->length; i++)
+  {
+    if (*(int *)vec_get(vec, i) == el)
+    {
+      return (int)i;
+    }
+  }
+  return -1; // Not found
+}
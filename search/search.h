@@ -0,0 +1,8 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "../types/types.h"
+
+int get_index(Vec *vec, int el);
+
+#endif // SEARCH_H
@@ -0,0 +1,160 @@
+#include "segvec.h"
+#include <stdio.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+
+SegVec *segvec_new(size_t elem_size, size_t first_segment)
+{
+  if (elem_size == 0)
+  {
+    fprintf(stderr, "Error: SegVec element size must be positive.\n");
+    return NULL;
+  }
+  SegVec *vec = alloc_malloc(sizeof(SegVec), ALLOC_VEC);
+  if (!vec)
+  {
+    fprintf(stderr, "Memory allocation failed for SegVec struct.\n");
+    return NULL;
+  }
+  vec->elem_size = elem_size;
+  vec->first_shift = 3;
+  while (vec->first_shift < 32 && ((size_t)1 << vec->first_shift) < first_segment)
+    vec->first_shift++;
+  atomic_init(&vec->length, 0);
+  for (int k = 0; k < SEGVEC_MAX_SEGMENTS; k++)
+    atomic_init(&vec->segments[k], NULL);
+  return vec;
+}
+
+void segvec_destroy(SegVec *vec)
+{
+  if (vec == NULL)
+    return;
+  for (int k = 0; k < SEGVEC_MAX_SEGMENTS; k++)
+    alloc_free(atomic_load_explicit(&vec->segments[k], memory_order_relaxed), ALLOC_VEC);
+  alloc_free(vec, ALLOC_VEC);
+}
+
+// Shifted by the first segment's size, index i lands in [first << k, first << (k + 1))
+static inline int segvec_segment(const SegVec *vec, size_t index, size_t *offset)
+{
+  size_t j = index + ((size_t)1 << vec->first_shift);
+  int top = 63 - __builtin_clzll((unsigned long long)j);
+  *offset = j - ((size_t)1 << top);
+  return top - vec->first_shift;
+}
+
+// Segment k, allocating it if no thread has yet
+static char *segvec_segment_data(SegVec *vec, int k)
+{
+  if (k >= SEGVEC_MAX_SEGMENTS)
+    return NULL;
+  char *data = atomic_load_explicit(&vec->segments[k], memory_order_acquire);
+  if (data != NULL)
+    return data;
+  size_t count = (size_t)1 << (vec->first_shift + k);
+  char *fresh = alloc_malloc(count * vec->elem_size, ALLOC_VEC);
+  if (!fresh)
+  {
+    fprintf(stderr, "Memory allocation failed for SegVec segment %d (%zu elements).\n", k, count);
+    return NULL;
+  }
+  if (atomic_compare_exchange_strong_explicit(&vec->segments[k], &data, fresh, memory_order_acq_rel,
+                                              memory_order_acquire))
+    return fresh;
+  alloc_free(fresh, ALLOC_VEC); // Another thread installed it first
+  return data;
+}
+
+// Allocates any missing segments holding indices [first, first + n)
+static int segvec_ensure(SegVec *vec, size_t first, size_t n)
+{
+  size_t offset;
+  int last = segvec_segment(vec, first + n - 1, &offset);
+  for (int k = segvec_segment(vec, first, &offset); k <= last; k++)
+  {
+    if (segvec_segment_data(vec, k) == NULL)
+      return 0;
+  }
+  return 1;
+}
+
+// Claims n consecutive indices whose segments already exist. The segments are
+// installed before the length is moved past them, so a failed allocation
+// claims nothing and never leaves a hole of unwritten indices.
+static int segvec_claim(SegVec *vec, size_t n, size_t *first)
+{
+  size_t length = atomic_load_explicit(&vec->length, memory_order_relaxed);
+  do
+  {
+    if (!segvec_ensure(vec, length, n))
+      return 0;
+  } while (!atomic_compare_exchange_weak_explicit(&vec->length, &length, length + n, memory_order_relaxed,
+                                                  memory_order_relaxed));
+  *first = length;
+  return 1;
+}
+
+int segvec_append(SegVec *vec, const void *elem, size_t *out_index)
+{
+  if (vec == NULL || elem == NULL)
+  {
+    fprintf(stderr, "Error: Cannot append to a NULL SegVec or from a NULL element.\n");
+    return 0;
+  }
+  size_t index;
+  if (!segvec_claim(vec, 1, &index))
+    return 0;
+  size_t offset;
+  int k = segvec_segment(vec, index, &offset);
+  char *data = atomic_load_explicit(&vec->segments[k], memory_order_acquire);
+  memcpy(data + offset * vec->elem_size, elem, vec->elem_size);
+  if (out_index != NULL)
+    *out_index = index;
+  return 1;
+}
+
+int segvec_append_batch(SegVec *vec, const void *elems, size_t n, size_t *out_index)
+{
+  if (vec == NULL || (elems == NULL && n > 0))
+  {
+    fprintf(stderr, "Error: Cannot append to a NULL SegVec or from a NULL array.\n");
+    return 0;
+  }
+  size_t first;
+  if (n == 0)
+    first = atomic_load_explicit(&vec->length, memory_order_relaxed);
+  else if (!segvec_claim(vec, n, &first))
+    return 0;
+  const char *src = elems;
+  for (size_t done = 0; done < n;)
+  {
+    size_t offset;
+    int k = segvec_segment(vec, first + done, &offset);
+    char *data = atomic_load_explicit(&vec->segments[k], memory_order_acquire);
+    size_t room = ((size_t)1 << (vec->first_shift + k)) - offset;
+    size_t count = n - done < room ? n - done : room;
+    memcpy(data + offset * vec->elem_size, src + done * vec->elem_size, count * vec->elem_size);
+    done += count;
+  }
+  if (out_index != NULL)
+    *out_index = first;
+  return 1;
+}
+
+void *segvec_get(SegVec *vec, size_t index)
+{
+  if (vec == NULL || index >= atomic_load_explicit(&vec->length, memory_order_relaxed))
+    return NULL;
+  size_t offset;
+  int k = segvec_segment(vec, index, &offset);
+  if (k >= SEGVEC_MAX_SEGMENTS)
+    return NULL;
+  char *data = atomic_load_explicit(&vec->segments[k], memory_order_acquire);
+  return data ? data + offset * vec->elem_size : NULL;
+}
+
+size_t segvec_length(SegVec *vec)
+{
+  return vec ? atomic_load_explicit(&vec->length, memory_order_relaxed) : 0;
+}
@@ -0,0 +1,40 @@
+#ifndef SEGVEC_H
+#define SEGVEC_H
+
+#include <stdatomic.h>
+#include <stddef.h> // for size_t
+
+// Segmented vector for concurrent appends. Segment k holds first << k
+// elements, so the segment and offset of an index come from its highest set
+// bit (no table, O(1)), and the segments never move: a pointer from
+// segvec_get stays valid until segvec_destroy. Appends claim indices with a
+// CAS on the length, after making sure the segments those indices fall in
+// exist (the first thread to need one installs it with a CAS). A failed
+// allocation therefore claims nothing and leaves no gap in the indices.
+//
+// An element is readable by other threads once its append has returned and
+// the reader has synchronized with the appender (e.g. by getting the index
+// from it, or joining it). segvec_length counts claimed indices, so while
+// appends are running it may include elements still being written.
+#define SEGVEC_MAX_SEGMENTS 48
+
+typedef struct
+{
+  size_t elem_size;
+  int first_shift;       // log2 of the first segment's size
+  atomic_size_t length;  // Claimed indices
+  _Atomic(char *) segments[SEGVEC_MAX_SEGMENTS];
+} SegVec;
+
+// first_segment is rounded up to a power of two (at least 8). NULL on error.
+SegVec *segvec_new(size_t elem_size, size_t first_segment);
+void segvec_destroy(SegVec *vec);
+// Thread-safe. Returns 1 on success (with the element's index in
+// *out_index if not NULL), 0 on allocation failure.
+int segvec_append(SegVec *vec, const void *elem, size_t *out_index);
+// Appends n elements at consecutive indices; same contract as segvec_append
+int segvec_append_batch(SegVec *vec, const void *elems, size_t n, size_t *out_index);
+void *segvec_get(SegVec *vec, size_t index); // NULL when index >= length
+size_t segvec_length(SegVec *vec);
+
+#endif // SEGVEC_H
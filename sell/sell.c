@@ -0,0 +1,429 @@
+#include "sell.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../alloc/alloc.h"
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SELL_HAVE_X86 1
+#endif
+
+// Below this fill SELL spends too many gathers on padding and CSR is chosen
+#define SELL_TUNE_MIN_FILL 0.6
+// The tuner stops widening the sorting window once the fill reaches this
+#define SELL_TUNE_GOOD_FILL 0.9
+// Each candidate window is this many times the previous one
+#define SELL_TUNE_SIGMA_STEP 4
+
+typedef struct
+{
+  int len;
+  int row;
+} SellRow;
+
+// longest first; ties keep row order so the layout is deterministic
+static int sell_row_cmp(const void *a, const void *b)
+{
+  const SellRow *x = a, *y = b;
+  if (x->len != y->len)
+    return x->len > y->len ? -1 : 1;
+  return (x->row > y->row) - (x->row < y->row);
+}
+
+static int sell_normal_sigma(int chunk, int sigma)
+{
+  if (sigma < chunk)
+    return chunk;
+  return (sigma + chunk - 1) / chunk * chunk;
+}
+
+// Rows in storage order: sorted by length within each window of sigma rows
+static SellRow *sell_sorted_rows(CsrMat *csr, int sigma)
+{
+  SellRow *rows = alloc_malloc(sizeof(SellRow) * (size_t)csr->nrows, ALLOC_SPARSE);
+  if (!rows)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for SELL row order.\n");
+    return NULL;
+  }
+  for (int r = 0; r < csr->nrows; r++)
+  {
+    rows[r].len = (int)(csr->row_ptr[r + 1] - csr->row_ptr[r]);
+    rows[r].row = r;
+  }
+  for (int w = 0; w < csr->nrows; w += sigma)
+  {
+    int n = csr->nrows - w < sigma ? csr->nrows - w : sigma;
+    qsort(rows + w, (size_t)n, sizeof(SellRow), sell_row_cmp);
+  }
+  return rows;
+}
+
+static int sell_check_chunk(CsrMat *csr, int chunk)
+{
+  if (csr == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL CSR matrix.\n");
+    return 0;
+  }
+  if (chunk < 1 || chunk > SELL_MAX_CHUNK)
+  {
+    fprintf(stderr, "Error: SELL chunk must be between 1 and %d (got %d).\n", SELL_MAX_CHUNK, chunk);
+    return 0;
+  }
+  return 1;
+}
+
+// longest row among storage positions [first, first + chunk)
+static int sell_chunk_len(const SellRow *rows, int nrows, int first, int chunk)
+{
+  int len = 0;
+  for (int l = 0; l < chunk && first + l < nrows; l++)
+    if (rows[first + l].len > len)
+      len = rows[first + l].len;
+  return len;
+}
+
+double sell_fill(CsrMat *csr, int chunk, int sigma)
+{
+  if (!sell_check_chunk(csr, chunk))
+    return 0.0;
+  SellRow *rows = sell_sorted_rows(csr, sell_normal_sigma(chunk, sigma));
+  if (!rows)
+    return 0.0;
+  size_t slots = 0;
+  for (int first = 0; first < csr->nrows; first += chunk)
+    slots += (size_t)sell_chunk_len(rows, csr->nrows, first, chunk) * chunk;
+  alloc_free(rows, ALLOC_SPARSE);
+  return slots > 0 ? (double)csr->nnz / (double)slots : 1.0;
+}
+
+void sell_destroy(SellMat *mat)
+{
+  if (mat == NULL)
+    return;
+  alloc_free(mat->chunk_ptr, ALLOC_SPARSE);
+  alloc_free(mat->col_idx, ALLOC_SPARSE);
+  alloc_free(mat->values, ALLOC_SPARSE);
+  alloc_free(mat->perm, ALLOC_SPARSE);
+  alloc_free(mat, ALLOC_SPARSE);
+}
+
+SellMat *sell_from_csr(CsrMat *csr, int chunk, int sigma)
+{
+  if (!sell_check_chunk(csr, chunk))
+    return NULL;
+  SellMat *mat = alloc_calloc(1, sizeof(SellMat), ALLOC_SPARSE);
+  if (!mat)
+  {
+    fprintf(stderr, "Memory allocation failed for SellMat struct.\n");
+    return NULL;
+  }
+  mat->nrows = csr->nrows;
+  mat->ncols = csr->ncols;
+  mat->chunk = chunk;
+  mat->sigma = sell_normal_sigma(chunk, sigma);
+  mat->nchunks = (csr->nrows + chunk - 1) / chunk;
+  mat->nnz = csr->nnz;
+  SellRow *rows = sell_sorted_rows(csr, mat->sigma);
+  mat->chunk_ptr = alloc_malloc(sizeof(size_t) * ((size_t)mat->nchunks + 1), ALLOC_SPARSE);
+  mat->perm = alloc_malloc(sizeof(int) * (size_t)mat->nchunks * chunk, ALLOC_SPARSE);
+  if (!rows || !mat->chunk_ptr || !mat->perm)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for SELL layout.\n");
+    alloc_free(rows, ALLOC_SPARSE);
+    sell_destroy(mat);
+    return NULL;
+  }
+
+  mat->chunk_ptr[0] = 0;
+  for (int c = 0; c < mat->nchunks; c++)
+    mat->chunk_ptr[c + 1] = mat->chunk_ptr[c] + (size_t)sell_chunk_len(rows, csr->nrows, c * chunk, chunk) * chunk;
+  size_t slots = mat->chunk_ptr[mat->nchunks] > 0 ? mat->chunk_ptr[mat->nchunks] : 1;
+  // Zeroed so padding multiplies x[0] by 0
+  mat->col_idx = alloc_calloc(slots, sizeof(int), ALLOC_SPARSE);
+  mat->values = alloc_calloc(slots, sizeof(int), ALLOC_SPARSE);
+  if (!mat->col_idx || !mat->values)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for %zu SELL slots.\n", slots);
+    alloc_free(rows, ALLOC_SPARSE);
+    sell_destroy(mat);
+    return NULL;
+  }
+
+  for (int c = 0; c < mat->nchunks; c++)
+  {
+    for (int l = 0; l < chunk; l++)
+    {
+      int pos = c * chunk + l;
+      if (pos >= csr->nrows)
+      {
+        mat->perm[pos] = -1;
+        continue;
+      }
+      int r = rows[pos].row;
+      mat->perm[pos] = r;
+      size_t slot = mat->chunk_ptr[c] + (size_t)l;
+      for (size_t k = csr->row_ptr[r]; k < csr->row_ptr[r + 1]; k++, slot += (size_t)chunk)
+      {
+        mat->col_idx[slot] = csr->col_idx[k];
+        mat->values[slot] = csr->values[k];
+      }
+    }
+  }
+  alloc_free(rows, ALLOC_SPARSE);
+  return mat;
+}
+
+SellMat *sell_from_sparse(SparseMat *mat, int chunk, int sigma)
+{
+  CsrMat *csr = csr_from_sparse(mat);
+  if (!csr)
+    return NULL;
+  SellMat *sell = sell_from_csr(csr, chunk, sigma);
+  csr_destroy(csr);
+  return sell;
+}
+
+// --- SpMV kernels ---
+
+static void sell_spmv_scalar(SellMat *mat, const int *x, int *y)
+{
+  unsigned acc[SELL_MAX_CHUNK];
+  int chunk = mat->chunk;
+  for (int c = 0; c < mat->nchunks; c++)
+  {
+    size_t base = mat->chunk_ptr[c];
+    size_t len = (mat->chunk_ptr[c + 1] - base) / (size_t)chunk;
+    for (int l = 0; l < chunk; l++)
+      acc[l] = 0;
+    for (size_t j = 0; j < len; j++)
+    {
+      const int *cols = mat->col_idx + base + j * chunk;
+      const int *vals = mat->values + base + j * chunk;
+      for (int l = 0; l < chunk; l++)
+        acc[l] += (unsigned)vals[l] * (unsigned)x[cols[l]];
+    }
+    for (int l = 0; l < chunk; l++)
+    {
+      int row = mat->perm[c * chunk + l];
+      if (row >= 0)
+        y[row] = (int)acc[l];
+    }
+  }
+}
+
+#ifdef SELL_HAVE_X86
+// One 8-lane group of a chunk at a time (chunk is a multiple of 8)
+__attribute__((target("avx2"))) static void sell_spmv_avx2(SellMat *mat, const int *x, int *y)
+{
+  int chunk = mat->chunk;
+  int lanes[8];
+  for (int c = 0; c < mat->nchunks; c++)
+  {
+    size_t base = mat->chunk_ptr[c];
+    size_t len = (mat->chunk_ptr[c + 1] - base) / (size_t)chunk;
+    for (int g = 0; g < chunk; g += 8)
+    {
+      __m256i acc = _mm256_setzero_si256();
+      const int *cols = mat->col_idx + base + g;
+      const int *vals = mat->values + base + g;
+      for (size_t j = 0; j < len; j++, cols += chunk, vals += chunk)
+      {
+        __m256i idx = _mm256_loadu_si256((const __m256i *)cols);
+        __m256i xv = _mm256_i32gather_epi32(x, idx, 4);
+        acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)vals), xv));
+      }
+      _mm256_storeu_si256((__m256i *)lanes, acc);
+      const int *perm = mat->perm + c * chunk + g;
+      for (int l = 0; l < 8; l++)
+        if (perm[l] >= 0)
+          y[perm[l]] = lanes[l];
+    }
+  }
+}
+
+// 16 lanes per step (chunk is a multiple of 16)
+__attribute__((target("avx512f"))) static void sell_spmv_avx512(SellMat *mat, const int *x, int *y)
+{
+  int chunk = mat->chunk;
+  int lanes[16];
+  for (int c = 0; c < mat->nchunks; c++)
+  {
+    size_t base = mat->chunk_ptr[c];
+    size_t len = (mat->chunk_ptr[c + 1] - base) / (size_t)chunk;
+    for (int g = 0; g < chunk; g += 16)
+    {
+      __m512i acc = _mm512_setzero_si512();
+      const int *cols = mat->col_idx + base + g;
+      const int *vals = mat->values + base + g;
+      for (size_t j = 0; j < len; j++, cols += chunk, vals += chunk)
+      {
+        __m512i idx = _mm512_loadu_si512(cols);
+        __m512i xv = _mm512_i32gather_epi32(idx, x, 4);
+        acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(_mm512_loadu_si512(vals), xv));
+      }
+      _mm512_storeu_si512(lanes, acc);
+      const int *perm = mat->perm + c * chunk + g;
+      for (int l = 0; l < 16; l++)
+        if (perm[l] >= 0)
+          y[perm[l]] = lanes[l];
+    }
+  }
+}
+#endif
+
+static pthread_once_t sell_cpu_once = PTHREAD_ONCE_INIT;
+static int sell_width = 0;
+
+static void sell_detect_cpu(void)
+{
+#ifdef SELL_HAVE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    sell_width = 16;
+  else if (__builtin_cpu_supports("avx2"))
+    sell_width = 8;
+#endif
+}
+
+// Widest gather the CPU supports, in int lanes (0 without AVX2); detected once
+// even when the first calls race
+static int sell_simd_width(void)
+{
+  pthread_once(&sell_cpu_once, sell_detect_cpu);
+  return sell_width;
+}
+
+int sell_spmv(SellMat *mat, const int *x, int *y)
+{
+  if (mat == NULL || x == NULL || y == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL SELL matrix or vector.\n");
+    return 0;
+  }
+#ifdef SELL_HAVE_X86
+  int width = sell_simd_width();
+  if (width >= 16 && mat->chunk % 16 == 0)
+  {
+    sell_spmv_avx512(mat, x, y);
+    return 1;
+  }
+  if (width >= 8 && mat->chunk % 8 == 0)
+  {
+    sell_spmv_avx2(mat, x, y);
+    return 1;
+  }
+#endif
+  sell_spmv_scalar(mat, x, y);
+  return 1;
+}
+
+// --- Format selection ---
+
+SpmvTuning spmv_tune(CsrMat *csr)
+{
+  SpmvTuning t = {SPMV_CSR, 0, 0, 0.0, 0.0, 0, 1.0};
+  if (csr == NULL || csr->nrows < 1)
+    return t;
+  double sum = 0.0, sum_sq = 0.0;
+  for (int r = 0; r < csr->nrows; r++)
+  {
+    int len = (int)(csr->row_ptr[r + 1] - csr->row_ptr[r]);
+    sum += len;
+    sum_sq += (double)len * len;
+    if (len > t.max_row)
+      t.max_row = len;
+  }
+  t.mean_row = sum / csr->nrows;
+  double var = sum_sq / csr->nrows - t.mean_row * t.mean_row;
+  t.row_cv = t.mean_row > 0.0 ? sqrt(var > 0.0 ? var : 0.0) / t.mean_row : 0.0;
+
+  int width = sell_simd_width();
+  if (width == 0 || csr->nnz == 0)
+    return t; // No gather to win with
+  // Uniform rows pack well unsorted; skewed ones need a wider window. Stop
+  // at the first window that packs well enough. A very long row pads its
+  // whole chunk, so with 16 lanes 8-row chunks are tried as well.
+  int best_chunk = width, best_sigma = width;
+  double best_fill = 0.0;
+  for (int chunk = width; chunk >= 8; chunk /= 2)
+  {
+    for (long sigma = chunk;; sigma *= SELL_TUNE_SIGMA_STEP)
+    {
+      double fill = sell_fill(csr, chunk, (int)sigma);
+      if (fill > best_fill + 1e-9)
+      {
+        best_fill = fill;
+        best_chunk = chunk;
+        best_sigma = (int)sigma;
+      }
+      if (fill >= SELL_TUNE_GOOD_FILL || sigma >= csr->nrows)
+        break;
+    }
+    if (best_fill >= SELL_TUNE_GOOD_FILL)
+      break;
+  }
+  t.fill = best_fill;
+  if (best_fill >= SELL_TUNE_MIN_FILL)
+  {
+    t.format = SPMV_SELL;
+    t.chunk = best_chunk;
+    t.sigma = best_sigma;
+  }
+  return t;
+}
+
+const char *spmv_format_name(SpmvFormat format)
+{
+  return format == SPMV_SELL ? "SELL-C-sigma" : "CSR";
+}
+
+SpmvMat *spmv_new(SparseMat *mat)
+{
+  SpmvMat *spmv = alloc_calloc(1, sizeof(SpmvMat), ALLOC_SPARSE);
+  if (!spmv)
+  {
+    fprintf(stderr, "Memory allocation failed for SpmvMat struct.\n");
+    return NULL;
+  }
+  spmv->csr = csr_from_sparse(mat);
+  if (!spmv->csr)
+  {
+    spmv_destroy(spmv);
+    return NULL;
+  }
+  spmv->tuning = spmv_tune(spmv->csr);
+  if (spmv->tuning.format == SPMV_SELL)
+  {
+    spmv->sell = sell_from_csr(spmv->csr, spmv->tuning.chunk, spmv->tuning.sigma);
+    if (!spmv->sell)
+    {
+      spmv_destroy(spmv);
+      return NULL;
+    }
+    csr_destroy(spmv->csr); // The SELL copy is all spmv_run needs
+    spmv->csr = NULL;
+  }
+  return spmv;
+}
+
+int spmv_run(SpmvMat *mat, const int *x, int *y)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL SpMV matrix.\n");
+    return 0;
+  }
+  return mat->sell ? sell_spmv(mat->sell, x, y) : csr_spmv(mat->csr, x, y);
+}
+
+void spmv_destroy(SpmvMat *mat)
+{
+  if (mat == NULL)
+    return;
+  csr_destroy(mat->csr);
+  sell_destroy(mat->sell);
+  alloc_free(mat, ALLOC_SPARSE);
+}
@@ -0,0 +1,78 @@
+#ifndef SELL_H
+#define SELL_H
+
+#include <stddef.h> // for size_t
+#include "../csr/csr.h"
+#include "../sparse/sparse.h"
+
+// SELL-C-sigma (sliced ELLPACK): rows are sorted by length inside windows of
+// sigma rows, then cut into chunks of C rows. Each chunk is padded to its
+// longest row and stored column-major, so one SIMD step handles C rows at
+// once: C column indices, a gather of x, a multiply-add. Sorting keeps rows
+// of similar length together and the padding small even for power-law rows.
+#define SELL_MAX_CHUNK 64
+
+typedef struct
+{
+  int nrows;
+  int ncols;
+  int chunk;         // C: rows per chunk (SIMD kernels need 8 or 16)
+  int sigma;         // Sorting window in rows, a multiple of chunk
+  int nchunks;
+  size_t nnz;        // Stored non-zeros
+  size_t *chunk_ptr; // nchunks + 1 offsets into col_idx/values
+  int *col_idx;      // Chunk c, column j, lane l at chunk_ptr[c] + j * chunk + l
+  int *values;       // Padding has value 0 and column 0
+  int *perm;         // Row held by each lane (nchunks * chunk), -1 past the last row
+} SellMat;
+
+// sigma is rounded up to a multiple of chunk; 0 sorts nothing (SELL-C-C
+// without reordering beyond the chunk). NULL on error.
+SellMat *sell_from_csr(CsrMat *csr, int chunk, int sigma);
+SellMat *sell_from_sparse(SparseMat *mat, int chunk, int sigma);
+void sell_destroy(SellMat *mat);
+// y = mat * x; wraps on overflow. Uses AVX-512 or AVX2 gathers when the CPU
+// has them and the chunk fits. Returns 1 on success, 0 on error.
+int sell_spmv(SellMat *mat, const int *x, int *y);
+// Stored non-zeros / stored slots the layout would have, without building it
+double sell_fill(CsrMat *csr, int chunk, int sigma);
+
+// --- Format selection ---
+
+typedef enum
+{
+  SPMV_CSR,
+  SPMV_SELL
+} SpmvFormat;
+
+// Row-length statistics and the choice made from them
+typedef struct
+{
+  SpmvFormat format;
+  int chunk;         // SELL parameters (0 when CSR is chosen)
+  int sigma;
+  double mean_row;   // Non-zeros per row
+  double row_cv;     // Standard deviation / mean of the row lengths
+  int max_row;
+  double fill;       // SELL fill at the chosen parameters
+} SpmvTuning;
+
+// Picks CSR when the CPU has no gather or SELL would waste too many lanes,
+// otherwise SELL with the SIMD width as C and the smallest window that packs
+// the chunks well (small windows keep x accesses local).
+SpmvTuning spmv_tune(CsrMat *csr);
+const char *spmv_format_name(SpmvFormat format);
+
+// A matrix stored in its tuned format
+typedef struct
+{
+  SpmvTuning tuning;
+  CsrMat *csr;   // Set when tuning.format is SPMV_CSR
+  SellMat *sell; // Set when tuning.format is SPMV_SELL
+} SpmvMat;
+
+SpmvMat *spmv_new(SparseMat *mat);
+int spmv_run(SpmvMat *mat, const int *x, int *y); // y = mat * x
+void spmv_destroy(SpmvMat *mat);
+
+#endif // SELL_H
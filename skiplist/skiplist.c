@@ -0,0 +1,279 @@
+#include "skiplist.h"
+#include <stdio.h>
+#include "../alloc/alloc.h"
+
+#define SKIPLIST_SLAB_BYTES 4096
+
+static SkipNode *skiplist_node_new(SkipList *list, int height, int data)
+{
+  Pool **pool = &list->pools[height - 1];
+  size_t size = sizeof(SkipNode) + sizeof(SkipLink) * (size_t)height;
+  if (*pool == NULL)
+  {
+    *pool = pool_new(size, SKIPLIST_SLAB_BYTES / size, ALLOC_LIST);
+    if (*pool == NULL)
+      return NULL;
+  }
+  SkipNode *node = pool_alloc(*pool);
+  if (node == NULL)
+    return NULL;
+  node->data = data;
+  node->height = height;
+  return node;
+}
+
+SkipList *skiplist_new(void)
+{
+  SkipList *list = alloc_calloc(1, sizeof(SkipList), ALLOC_LIST);
+  if (!list)
+  {
+    fprintf(stderr, "Memory allocation failed for SkipList struct.\n");
+    return NULL;
+  }
+  list->head = alloc_calloc(1, sizeof(SkipNode) + sizeof(SkipLink) * SKIPLIST_MAX_LEVEL, ALLOC_LIST);
+  if (!list->head)
+  {
+    fprintf(stderr, "Memory allocation failed for skip list head.\n");
+    alloc_free(list, ALLOC_LIST);
+    return NULL;
+  }
+  list->head->height = SKIPLIST_MAX_LEVEL;
+  list->level = 1;
+  list->seed = 0x9E3779B97F4A7C15ULL;
+  return list;
+}
+
+void skiplist_destroy(SkipList *list)
+{
+  if (list == NULL)
+    return;
+  for (int h = 0; h < SKIPLIST_MAX_LEVEL; h++)
+    pool_destroy(list->pools[h]);
+  alloc_free(list->head, ALLOC_LIST);
+  alloc_free(list, ALLOC_LIST);
+}
+
+size_t skiplist_length(SkipList *list)
+{
+  return list ? list->length : 0;
+}
+
+void skiplist_print(SkipList *list)
+{
+  if (list == NULL || list->length == 0)
+  {
+    printf("List is empty.\n");
+    return;
+  }
+  printf("List: ");
+  for (SkipNode *node = list->head->link[0].next; node != NULL; node = node->link[0].next)
+    printf("%d ", node->data);
+  printf("\n");
+}
+
+// Height with P(h > k) = 4^-k: two random bits per extra level
+static int skiplist_random_height(SkipList *list)
+{
+  list->seed ^= list->seed << 13;
+  list->seed ^= list->seed >> 7;
+  list->seed ^= list->seed << 17;
+  unsigned long long bits = list->seed | (1ULL << (2 * (SKIPLIST_MAX_LEVEL - 1)));
+  return 1 + __builtin_ctzll(bits) / 2;
+}
+
+// Fills update[l] with the last node at level l whose position is at most
+// pos (the head is position 0, element i is position i + 1) and rank[l]
+// with that node's position. Returns update[0].
+static SkipNode *skiplist_find(SkipList *list, size_t pos, SkipNode **update, size_t *rank)
+{
+  SkipNode *x = list->head;
+  size_t at = 0;
+  for (int l = list->level - 1; l >= 0; l--)
+  {
+    while (x->link[l].next != NULL && at + x->link[l].span <= pos)
+    {
+      at += x->link[l].span;
+      x = x->link[l].next;
+    }
+    update[l] = x;
+    rank[l] = at;
+  }
+  return x;
+}
+
+int skiplist_insert_at_index(SkipList *list, int data, size_t index)
+{
+  if (list == NULL)
+  {
+    fprintf(stderr, "Error: Cannot insert into a NULL skip list.\n");
+    return 0;
+  }
+  if (index > list->length)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, list->length);
+    return 0;
+  }
+  SkipNode *update[SKIPLIST_MAX_LEVEL];
+  size_t rank[SKIPLIST_MAX_LEVEL];
+  skiplist_find(list, index, update, rank);
+
+  int height = skiplist_random_height(list);
+  SkipNode *node = skiplist_node_new(list, height, data);
+  if (node == NULL)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for new node (data: %d).\n", data);
+    return 0;
+  }
+  for (int l = list->level; l < height; l++)
+  {
+    // A fresh head link spans the whole list
+    update[l] = list->head;
+    rank[l] = 0;
+    list->head->link[l].next = NULL;
+    list->head->link[l].span = list->length;
+  }
+  if (height > list->level)
+    list->level = height;
+
+  for (int l = 0; l < height; l++)
+  {
+    SkipLink *prev = &update[l]->link[l];
+    node->link[l].next = prev->next;
+    node->link[l].span = prev->span - (index - rank[l]);
+    prev->next = node;
+    prev->span = index - rank[l] + 1;
+  }
+  for (int l = height; l < list->level; l++)
+    update[l]->link[l].span++;
+  list->length++;
+  return 1;
+}
+
+int skiplist_delete_at_index(SkipList *list, size_t index, int *out_value)
+{
+  if (list == NULL || list->length == 0)
+  {
+    fprintf(stderr, "Error: List is empty. Cannot delete at index %zu.\n", index);
+    return 0;
+  }
+  if (index >= list->length)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, list->length);
+    return 0;
+  }
+  SkipNode *update[SKIPLIST_MAX_LEVEL];
+  size_t rank[SKIPLIST_MAX_LEVEL];
+  SkipNode *node = skiplist_find(list, index, update, rank)->link[0].next;
+  for (int l = 0; l < list->level; l++)
+  {
+    SkipLink *prev = &update[l]->link[l];
+    if (prev->next == node)
+    {
+      prev->span += node->link[l].span - 1;
+      prev->next = node->link[l].next;
+    }
+    else
+    {
+      prev->span--;
+    }
+  }
+  while (list->level > 1 && list->head->link[list->level - 1].next == NULL)
+    list->level--;
+  list->length--;
+  if (out_value != NULL)
+    *out_value = node->data;
+  pool_free(list->pools[node->height - 1], node);
+  return 1;
+}
+
+int skiplist_insert_at_head(SkipList *list, int data)
+{
+  return skiplist_insert_at_index(list, data, 0);
+}
+
+int skiplist_insert_at_tail(SkipList *list, int data)
+{
+  return skiplist_insert_at_index(list, data, skiplist_length(list));
+}
+
+int skiplist_delete_at_head(SkipList *list, int *out_value)
+{
+  return skiplist_delete_at_index(list, 0, out_value);
+}
+
+int skiplist_delete_at_tail(SkipList *list, int *out_value)
+{
+  if (list == NULL || list->length == 0)
+  {
+    fprintf(stderr, "Error: List is empty. Cannot delete from tail.\n");
+    return 0;
+  }
+  return skiplist_delete_at_index(list, list->length - 1, out_value);
+}
+
+// Node at index, or NULL when out of bounds
+static SkipNode *skiplist_node_at(SkipList *list, size_t index)
+{
+  if (list == NULL || index >= list->length)
+    return NULL;
+  SkipNode *x = list->head;
+  size_t at = 0;
+  for (int l = list->level - 1; l >= 0; l--)
+  {
+    while (x->link[l].next != NULL && at + x->link[l].span <= index + 1)
+    {
+      at += x->link[l].span;
+      x = x->link[l].next;
+    }
+    if (at == index + 1)
+      return x;
+  }
+  return NULL;
+}
+
+int skiplist_get(SkipList *list, size_t index, int *out_value)
+{
+  SkipNode *node = skiplist_node_at(list, index);
+  if (node == NULL)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, skiplist_length(list));
+    return 0;
+  }
+  if (out_value != NULL)
+    *out_value = node->data;
+  return 1;
+}
+
+int skiplist_set(SkipList *list, size_t index, int data)
+{
+  SkipNode *node = skiplist_node_at(list, index);
+  if (node == NULL)
+  {
+    fprintf(stderr, "Error: Index %zu is out of bounds for a list of %zu elements.\n", index, skiplist_length(list));
+    return 0;
+  }
+  node->data = data;
+  return 1;
+}
+
+size_t skiplist_rank(SkipList *list, int value)
+{
+  if (list == NULL)
+    return 0;
+  SkipNode *x = list->head;
+  size_t at = 0;
+  for (int l = list->level - 1; l >= 0; l--)
+  {
+    while (x->link[l].next != NULL && x->link[l].next->data < value)
+    {
+      at += x->link[l].span;
+      x = x->link[l].next;
+    }
+  }
+  return at;
+}
+
+int skiplist_insert_sorted(SkipList *list, int data)
+{
+  return skiplist_insert_at_index(list, data, skiplist_rank(list, data));
+}
@@ -0,0 +1,62 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <stddef.h> // for size_t
+#include "../pool/pool.h"
+
+// Indexable skip list: a positional list like list/ where every link also
+// records its span, the number of elements it skips. Summing spans on the
+// way down finds the node at any index, so head, tail and index operations
+// all take O(log n) expected time instead of a walk of up to n nodes.
+// Node heights are geometric with p = 1/4; nodes come from one pool per
+// height, so destroying the list frees slabs rather than single nodes.
+#define SKIPLIST_MAX_LEVEL 32
+
+typedef struct SkipNode SkipNode;
+
+typedef struct
+{
+  SkipNode *next;
+  size_t span; // Elements passed by following next (to the end when next is NULL)
+} SkipLink;
+
+struct SkipNode
+{
+  int data;
+  int height;
+  SkipLink link[]; // height entries
+};
+
+typedef struct
+{
+  SkipNode *head; // Sentinel with SKIPLIST_MAX_LEVEL links
+  int level;      // Links in use at the head
+  size_t length;
+  unsigned long long seed; // Level generator state
+  Pool *pools[SKIPLIST_MAX_LEVEL]; // pools[h - 1] holds nodes of height h, created on first use
+} SkipList;
+
+SkipList *skiplist_new(void); // NULL on error
+void skiplist_destroy(SkipList *list);
+size_t skiplist_length(SkipList *list);
+void skiplist_print(SkipList *list);
+
+// Insertion operations (return 1 on success, 0 on failure); index may equal the length
+int skiplist_insert_at_head(SkipList *list, int data);
+int skiplist_insert_at_tail(SkipList *list, int data);
+int skiplist_insert_at_index(SkipList *list, int data, size_t index);
+// Deletion operations (return 1 on success, 0 on failure; out_value may be NULL)
+int skiplist_delete_at_head(SkipList *list, int *out_value);
+int skiplist_delete_at_tail(SkipList *list, int *out_value);
+int skiplist_delete_at_index(SkipList *list, size_t index, int *out_value);
+// Element access by index (return 1 on success, 0 when out of bounds)
+int skiplist_get(SkipList *list, size_t index, int *out_value);
+int skiplist_set(SkipList *list, size_t index, int data);
+
+// Rank queries for a list kept in ascending order: the number of elements
+// less than value, which is also the index value would be inserted at.
+// skiplist_get is the matching select.
+size_t skiplist_rank(SkipList *list, int value);
+int skiplist_insert_sorted(SkipList *list, int data); // Before any equal elements
+
+#endif // SKIPLIST_H
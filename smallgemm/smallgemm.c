@@ -0,0 +1,342 @@
+#define _POSIX_C_SOURCE 200809L
+#include "smallgemm.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../alloc/alloc.h"
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SMALLGEMM_HAVE_X86 1
+#endif
+
+#define SMALLGEMM_MAX_THREADS 64
+// Multiply-adds each thread must get before the batch is split (thread start
+// costs tens of microseconds; 4x4 products are 64 multiply-adds each)
+#define SMALLGEMM_MIN_WORK (1 << 20)
+
+MatBatch *mat_batch_new(size_t count, int nrows, int ncols)
+{
+  if (count < 1 || nrows < 1 || ncols < 1)
+  {
+    fprintf(stderr, "Error: Batch needs a positive count and dimensions (got %zu of %dx%d).\n", count, nrows, ncols);
+    return NULL;
+  }
+  MatBatch *batch = alloc_malloc(sizeof(MatBatch), ALLOC_MATRIX);
+  if (!batch)
+  {
+    fprintf(stderr, "Memory allocation failed for batch struct.\n");
+    return NULL;
+  }
+  size_t per_line = SMALLGEMM_ALIGN / sizeof(int);
+  batch->count = count;
+  batch->nrows = nrows;
+  batch->ncols = ncols;
+  batch->stride = ((size_t)nrows * ncols + per_line - 1) / per_line * per_line;
+  batch->block = alloc_calloc(batch->stride * count * sizeof(int) + SMALLGEMM_ALIGN, 1, ALLOC_MATRIX);
+  if (!batch->block)
+  {
+    fprintf(stderr, "Memory allocation failed for batch data (%zu of %dx%d).\n", count, nrows, ncols);
+    alloc_free(batch, ALLOC_MATRIX);
+    return NULL;
+  }
+  batch->data = (int *)(((uintptr_t)batch->block + SMALLGEMM_ALIGN - 1) & ~(uintptr_t)(SMALLGEMM_ALIGN - 1));
+  return batch;
+}
+
+void mat_batch_destroy(MatBatch *batch)
+{
+  if (batch == NULL)
+    return;
+  alloc_free(batch->block, ALLOC_MATRIX);
+  alloc_free(batch, ALLOC_MATRIX);
+}
+
+int *mat_batch_at(MatBatch *batch, size_t index)
+{
+  return batch->data + index * batch->stride;
+}
+
+// --- Kernels ---
+// Arithmetic is unsigned so overflow wraps instead of being undefined.
+
+// N x N times N x N with N a compile-time constant: each C row is built in a
+// local array the compiler keeps in vector registers, then stored once
+#define SMALLGEMM_SQUARE(fn, N, attr)                                                                    \
+  attr static void fn(unsigned *restrict c, const unsigned *restrict a, const unsigned *restrict b,      \
+                      size_t count, size_t stride_a, size_t stride_b, size_t stride_c)                   \
+  {                                                                                                      \
+    for (size_t t = 0; t < count; t++, a += stride_a, b += stride_b, c += stride_c)                      \
+    {                                                                                                    \
+      for (int i = 0; i < N; i++)                                                                        \
+      {                                                                                                  \
+        unsigned row[N];                                                                                 \
+        unsigned ai0 = a[i * N];                                                                         \
+        for (int j = 0; j < N; j++)                                                                      \
+          row[j] = ai0 * b[j];                                                                           \
+        for (int k = 1; k < N; k++)                                                                      \
+        {                                                                                                \
+          unsigned aik = a[i * N + k];                                                                   \
+          for (int j = 0; j < N; j++)                                                                    \
+            row[j] += aik * b[k * N + j];                                                                \
+        }                                                                                                \
+        for (int j = 0; j < N; j++)                                                                      \
+          c[i * N + j] = row[j];                                                                         \
+      }                                                                                                  \
+    }                                                                                                    \
+  }
+
+// Any shape: i-k-j into the C row
+#define SMALLGEMM_GENERIC(fn, attr)                                                                      \
+  attr static void fn(unsigned *restrict c, const unsigned *restrict a, const unsigned *restrict b,      \
+                      size_t count, int m, int k, int n, size_t stride_a, size_t stride_b,               \
+                      size_t stride_c)                                                                   \
+  {                                                                                                      \
+    for (size_t t = 0; t < count; t++, a += stride_a, b += stride_b, c += stride_c)                      \
+    {                                                                                                    \
+      for (int i = 0; i < m; i++)                                                                        \
+      {                                                                                                  \
+        unsigned *crow = c + (size_t)i * n;                                                              \
+        for (int j = 0; j < n; j++)                                                                      \
+          crow[j] = 0;                                                                                   \
+        for (int p = 0; p < k; p++)                                                                      \
+        {                                                                                                \
+          unsigned aip = a[(size_t)i * k + p];                                                           \
+          const unsigned *brow = b + (size_t)p * n;                                                      \
+          for (int j = 0; j < n; j++)                                                                    \
+            crow[j] += aip * brow[j];                                                                    \
+        }                                                                                                \
+      }                                                                                                  \
+    }                                                                                                    \
+  }
+
+// One set per instruction set: name##4 .. name##32 and name##_any
+#define SMALLGEMM_KERNELS(name, attr)   \
+  SMALLGEMM_SQUARE(name##4, 4, attr)   \
+  SMALLGEMM_SQUARE(name##8, 8, attr)   \
+  SMALLGEMM_SQUARE(name##16, 16, attr) \
+  SMALLGEMM_SQUARE(name##32, 32, attr) \
+  SMALLGEMM_GENERIC(name##_any, attr)
+
+SMALLGEMM_KERNELS(smallgemm_base, )
+
+#ifdef SMALLGEMM_HAVE_X86
+// Baseline x86-64 has no packed 32-bit multiply (vpmulld), so AVX2 builds
+// are picked at run time when the CPU has it. For N >= 8 GCC turns the
+// portable square kernel into a transpose of B, so those are written out:
+// a C row is N / 8 accumulators, each k adds broadcast(a[i][k]) * B row k.
+#define SMALLGEMM_AVX2_SQUARE(fn, N)                                                                     \
+  __attribute__((target("avx2"))) static void fn(unsigned *restrict c, const unsigned *restrict a,       \
+                                                 const unsigned *restrict b, size_t count,               \
+                                                 size_t stride_a, size_t stride_b, size_t stride_c)      \
+  {                                                                                                      \
+    for (size_t t = 0; t < count; t++, a += stride_a, b += stride_b, c += stride_c)                      \
+    {                                                                                                    \
+      for (int i = 0; i < N; i++)                                                                        \
+      {                                                                                                  \
+        __m256i acc[N / 8];                                                                              \
+        for (int v = 0; v < N / 8; v++)                                                                  \
+          acc[v] = _mm256_setzero_si256();                                                               \
+        for (int k = 0; k < N; k++)                                                                      \
+        {                                                                                                \
+          __m256i aik = _mm256_set1_epi32((int)a[i * N + k]);                                            \
+          const unsigned *brow = b + k * N;                                                              \
+          for (int v = 0; v < N / 8; v++)                                                                \
+            acc[v] = _mm256_add_epi32(                                                                   \
+                acc[v], _mm256_mullo_epi32(aik, _mm256_loadu_si256((const __m256i *)(brow + 8 * v))));   \
+        }                                                                                                \
+        for (int v = 0; v < N / 8; v++)                                                                  \
+          _mm256_storeu_si256((__m256i *)(c + i * N + 8 * v), acc[v]);                                   \
+      }                                                                                                  \
+    }                                                                                                    \
+  }
+
+SMALLGEMM_SQUARE(smallgemm_avx2_4, 4, __attribute__((target("avx2"))))
+SMALLGEMM_AVX2_SQUARE(smallgemm_avx2_8, 8)
+SMALLGEMM_AVX2_SQUARE(smallgemm_avx2_16, 16)
+SMALLGEMM_AVX2_SQUARE(smallgemm_avx2_32, 32)
+SMALLGEMM_GENERIC(smallgemm_avx2_any, __attribute__((target("avx2"))))
+#endif
+
+typedef void (*SmallSquareKernel)(unsigned *, const unsigned *, const unsigned *, size_t, size_t, size_t, size_t);
+typedef void (*SmallGenericKernel)(unsigned *, const unsigned *, const unsigned *, size_t, int, int, int, size_t,
+                                   size_t, size_t);
+
+typedef struct
+{
+  SmallSquareKernel square[4]; // N = 4, 8, 16, 32
+  SmallGenericKernel any;
+} SmallKernels;
+
+static const SmallKernels *smallgemm_kernels(void)
+{
+  static const SmallKernels base = {{smallgemm_base4, smallgemm_base8, smallgemm_base16, smallgemm_base32},
+                                    smallgemm_base_any};
+#ifdef SMALLGEMM_HAVE_X86
+  static const SmallKernels avx2 = {{smallgemm_avx2_4, smallgemm_avx2_8, smallgemm_avx2_16, smallgemm_avx2_32},
+                                    smallgemm_avx2_any};
+  static int use_avx2 = -1;
+  if (use_avx2 < 0)
+  {
+    __builtin_cpu_init();
+    use_avx2 = __builtin_cpu_supports("avx2") != 0;
+  }
+  if (use_avx2)
+    return &avx2;
+#endif
+  return &base;
+}
+
+// --- Batch splitting ---
+
+typedef struct
+{
+  const SmallKernels *kernels;
+  int square; // Index into kernels->square, or -1 for the generic kernel
+  unsigned *c;
+  const unsigned *a;
+  const unsigned *b;
+  size_t count;
+  int m, k, n;
+  size_t stride_a, stride_b, stride_c;
+} SmallTask;
+
+static void *smallgemm_run(void *arg)
+{
+  SmallTask *task = arg;
+  if (task->square >= 0)
+    task->kernels->square[task->square](task->c, task->a, task->b, task->count, task->stride_a, task->stride_b,
+                                        task->stride_c);
+  else
+    task->kernels->any(task->c, task->a, task->b, task->count, task->m, task->k, task->n, task->stride_a,
+                       task->stride_b, task->stride_c);
+  return NULL;
+}
+
+static int smallgemm_max_threads(void)
+{
+  static int cached = 0;
+  if (cached == 0)
+  {
+    const char *env = getenv("LAB_THREADS");
+    long n = env ? strtol(env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+      n = 1;
+    if (n > SMALLGEMM_MAX_THREADS)
+      n = SMALLGEMM_MAX_THREADS;
+    cached = (int)n;
+  }
+  return cached;
+}
+
+// index of the unrolled kernel for an N x N by N x N product, -1 if none
+static int smallgemm_square_index(int m, int k, int n)
+{
+  if (m != k || k != n)
+    return -1;
+  switch (n)
+  {
+  case 4:
+    return 0;
+  case 8:
+    return 1;
+  case 16:
+    return 2;
+  case 32:
+    return 3;
+  default:
+    return -1;
+  }
+}
+
+int smallgemm(int *c, const int *a, const int *b, size_t count, int m, int k, int n, size_t stride_a,
+              size_t stride_b, size_t stride_c)
+{
+  if (c == NULL || a == NULL || b == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL batch.\n");
+    return 0;
+  }
+  if (m < 1 || k < 1 || n < 1)
+  {
+    fprintf(stderr, "Error: Dimensions must be positive integers (got %dx%d by %dx%d).\n", m, k, k, n);
+    return 0;
+  }
+  if (count == 0)
+    return 1;
+  if (count > 1 && stride_c < (size_t)m * n)
+  {
+    fprintf(stderr, "Error: Result stride %zu is smaller than a %dx%d matrix.\n", stride_c, m, n);
+    return 0;
+  }
+
+  SmallTask task = {smallgemm_kernels(), smallgemm_square_index(m, k, n), (unsigned *)c, (const unsigned *)a,
+                    (const unsigned *)b, count, m, k, n, stride_a, stride_b, stride_c};
+  size_t work = count * (size_t)m * k * n;
+  size_t nthreads = work / SMALLGEMM_MIN_WORK;
+  if (nthreads > (size_t)smallgemm_max_threads())
+    nthreads = (size_t)smallgemm_max_threads();
+  if (nthreads < 2)
+  {
+    smallgemm_run(&task);
+    return 1;
+  }
+
+  // Contiguous slices; the calling thread takes slice 0
+  SmallTask tasks[SMALLGEMM_MAX_THREADS];
+  pthread_t threads[SMALLGEMM_MAX_THREADS];
+  int started[SMALLGEMM_MAX_THREADS] = {0};
+  size_t begin = 0;
+  for (size_t t = 0; t < nthreads; t++)
+  {
+    size_t end = count * (t + 1) / nthreads;
+    tasks[t] = task;
+    tasks[t].c += begin * stride_c;
+    tasks[t].a += begin * stride_a;
+    tasks[t].b += begin * stride_b;
+    tasks[t].count = end - begin;
+    begin = end;
+  }
+  for (size_t t = 1; t < nthreads; t++)
+    started[t] = pthread_create(&threads[t], NULL, smallgemm_run, &tasks[t]) == 0;
+  smallgemm_run(&tasks[0]);
+  for (size_t t = 1; t < nthreads; t++)
+  {
+    if (started[t])
+      pthread_join(threads[t], NULL);
+    else
+      smallgemm_run(&tasks[t]); // Thread creation failed: do the slice here
+  }
+  return 1;
+}
+
+int mat_batch_mult(MatBatch *c, MatBatch *a, MatBatch *b)
+{
+  if (c == NULL || a == NULL || b == NULL)
+  {
+    fprintf(stderr, "Error: Cannot multiply a NULL batch.\n");
+    return 0;
+  }
+  if (a->ncols != b->nrows)
+  {
+    fprintf(stderr,
+            "Error: Incompatible matrix dimensions for multiplication. "
+            "Number of columns in first matrix (%d) must equal number of rows in second matrix (%d).\n",
+            a->ncols, b->nrows);
+    return 0;
+  }
+  if (c->nrows != a->nrows || c->ncols != b->ncols)
+  {
+    fprintf(stderr, "Error: Result batch holds %dx%d matrices, product is %dx%d.\n", c->nrows, c->ncols, a->nrows,
+            b->ncols);
+    return 0;
+  }
+  if (c->count != a->count || (b->count != a->count && b->count != 1))
+  {
+    fprintf(stderr, "Error: Batch sizes differ (%zu = %zu * %zu).\n", c->count, a->count, b->count);
+    return 0;
+  }
+  return smallgemm(c->data, a->data, b->data, a->count, a->nrows, a->ncols, b->ncols, a->stride,
+                   b->count == 1 ? 0 : b->stride, c->stride);
+}
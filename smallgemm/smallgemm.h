@@ -0,0 +1,42 @@
+#ifndef SMALLGEMM_H
+#define SMALLGEMM_H
+
+#include <stddef.h> // for size_t
+
+// Batched products of many small same-shaped matrices (4x4 .. 32x32). The
+// matrices live back to back in one buffer instead of one Mat (1 + nrows
+// allocations) each, so a batch costs a single allocation and every kernel
+// call covers the whole batch. Square 4, 8, 16 and 32 have fully unrolled
+// kernels; other shapes use a generic loop. Large batches are split across
+// threads (LAB_THREADS overrides the online CPU count).
+// Products wrap on int overflow like mat_mult.
+
+#define SMALLGEMM_ALIGN 64 // Every matrix in a MatBatch starts on this boundary
+
+typedef struct
+{
+  int *data;
+  size_t count;
+  int nrows;
+  int ncols;
+  size_t stride; // ints between consecutive matrices (>= nrows * ncols)
+  void *block;   // Allocation holding the aligned data
+} MatBatch;
+
+// count zeroed nrows x ncols matrices; NULL on error
+MatBatch *mat_batch_new(size_t count, int nrows, int ncols);
+void mat_batch_destroy(MatBatch *batch);
+// Matrix index of the batch, row-major with rows ncols ints apart
+int *mat_batch_at(MatBatch *batch, size_t index);
+
+// c[i] = a[i] * b[i] for every i. b may hold a single matrix that multiplies
+// every a[i]. c must not overlap a or b. Returns 1 on success, 0 on error.
+int mat_batch_mult(MatBatch *c, MatBatch *a, MatBatch *b);
+
+// Raw form over caller-owned strided buffers: count products of m x k by
+// k x n, matrix t at a + t * stride_a etc. A stride of 0 reuses one matrix
+// for the whole batch (not allowed for c). Returns 1 on success, 0 on error.
+int smallgemm(int *c, const int *a, const int *b, size_t count, int m, int k, int n, size_t stride_a,
+              size_t stride_b, size_t stride_c);
+
+#endif // SMALLGEMM_H
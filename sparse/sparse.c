@@ -0,0 +1,376 @@
+#include "sparse.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../alloc/alloc.h"
+#include "../writer/writer.h"
+#include "../vector/vector.h"
+#include "../csr/csr.h"
+
+// --- Sparse Matrix Operations Implementation ---
+
+#define INITIAL_SPARSE_CAPACITY 10
+#define RESIZE_FACTOR 2
+
+// Allocates memory for a new sparse matrix
+SparseMat *sparse_new(int nrows, int ncols)
+{
+  SparseMat *mat = alloc_malloc(sizeof(SparseMat), ALLOC_SPARSE);
+  if (!mat)
+  {
+    fprintf(stderr, "Memory allocation failed for SparseMat struct.\n");
+    return NULL;
+  }
+
+  mat->nrows = nrows;
+  mat->ncols = ncols;
+  mat->nnz = 0;
+  mat->capacity = INITIAL_SPARSE_CAPACITY; // Start with a default capacity
+
+  mat->data = alloc_malloc(sizeof(SparseEntry) * mat->capacity, ALLOC_SPARSE);
+  if (!mat->data)
+  {
+    fprintf(stderr, "Memory allocation failed for SparseEntry data array.\n");
+    alloc_free(mat, ALLOC_SPARSE); // Free the partially allocated struct
+    return NULL;
+  }
+  return mat;
+}
+
+// Adds a non-zero element to the sparse matrix. Handles dynamic resizing.
+void sparse_add(SparseMat *mat, int row, int col, int value)
+{
+  if (value == 0) // We only store non-zero values
+    return;
+
+  // Check if we need to resize the data array
+  if ((size_t)mat->nnz >= mat->capacity)
+  {
+    size_t new_capacity = mat->capacity * RESIZE_FACTOR;
+    SparseEntry *new_data = alloc_realloc(mat->data, sizeof(SparseEntry) * new_capacity, ALLOC_SPARSE);
+    if (!new_data)
+    {
+      fprintf(stderr, "Error: Failed to reallocate memory for sparse matrix data. Cannot add more elements.\n");
+      // In a real application, you might want to return an error status here.
+      // For now, we'll just stop adding new elements to prevent crash.
+      return;
+    }
+    mat->data = new_data;
+    mat->capacity = new_capacity;
+  }
+
+  // Add the new entry
+  mat->data[mat->nnz].row = row;
+  mat->data[mat->nnz].col = col;
+  mat->data[mat->nnz].value = value;
+  mat->nnz++;
+}
+
+// Prints the sparse matrix in COO format (row, col, value)
+void sparse_print(SparseMat *mat)
+{
+  if (mat == NULL)
+  {
+    printf("Cannot print a NULL sparse matrix.\n");
+    return;
+  }
+  printf("Sparse matrix (COO format) - %d non-zero elements:\n", mat->nnz);
+  if (mat->nnz == 0)
+  {
+    printf("No non-zero elements.\n");
+    return;
+  }
+  fflush(stdout); // The writer goes to fd 1 directly
+  Writer *w = writer_stdout();
+  if (!w)
+    return;
+  for (size_t i = 0; i < (size_t)mat->nnz; i++)
+  {
+    // 1-based indexing for user
+    writer_str(w, "(Row: ");
+    writer_int(w, (long long)mat->data[i].row + 1);
+    writer_str(w, ", Col: ");
+    writer_int(w, (long long)mat->data[i].col + 1);
+    writer_str(w, ", Value: ");
+    writer_int(w, mat->data[i].value);
+    writer_str(w, ")\n");
+  }
+  writer_flush(w);
+}
+
+// Retrieves the value at a specific row and column. Returns 0 if not found.
+int sparse_get(SparseMat *mat, int row, int col)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot get element from a NULL sparse matrix.\n");
+    return 0;
+  }
+  // Basic bounds checking (though `sparse_add` should enforce this for stored entries)
+  if (row < 0 || row >= mat->nrows || col < 0 || col >= mat->ncols)
+  {
+    fprintf(stderr, "Warning: Attempted to get element at out-of-bounds position (%d, %d).\n", row, col);
+    return 0;
+  }
+  for (size_t i = 0; i < (size_t)mat->nnz; i++)
+  {
+    if (mat->data[i].row == (size_t)row && mat->data[i].col == (size_t)col)
+    {
+      return mat->data[i].value;
+    }
+  }
+  return 0; // Return 0 if the element is not explicitly stored (meaning it's a zero)
+}
+
+// Groups entries by row with a counting sort (stable, so insertion order is kept
+// within a row). Returns the entry permutation and sets *out_row_start to nrows+1
+// offsets into it; both are freed by the caller. Returns NULL on allocation failure.
+static size_t *sparse_row_order(SparseMat *mat, size_t **out_row_start)
+{
+  size_t *row_start = alloc_calloc((size_t)mat->nrows + 1, sizeof(size_t), ALLOC_SPARSE);
+  size_t *order = alloc_malloc(sizeof(size_t) * (mat->nnz > 0 ? mat->nnz : 1), ALLOC_SPARSE);
+  if (!row_start || !order)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for sparse row order.\n");
+    alloc_free(row_start, ALLOC_SPARSE);
+    alloc_free(order, ALLOC_SPARSE);
+    return NULL;
+  }
+  for (size_t i = 0; i < (size_t)mat->nnz; i++)
+    row_start[mat->data[i].row + 1]++;
+  for (int r = 0; r < mat->nrows; r++)
+    row_start[r + 1] += row_start[r];
+  // row_start[r] is now the first slot of row r; advance it while placing, then shift back
+  for (size_t i = 0; i < (size_t)mat->nnz; i++)
+    order[row_start[mat->data[i].row]++] = i;
+  for (int r = mat->nrows; r > 0; r--)
+    row_start[r] = row_start[r - 1];
+  row_start[0] = 0;
+  *out_row_start = row_start;
+  return order;
+}
+
+// Streams the dense layout one row at a time: each row's entries are scattered
+// into a single zeroed row buffer, written, then cleared again.
+static int sparse_write_dense(SparseMat *mat, Writer *w, char sep, int trailing)
+{
+  size_t *row_start;
+  size_t *order = sparse_row_order(mat, &row_start);
+  int *row = alloc_calloc(mat->ncols > 0 ? (size_t)mat->ncols : 1, sizeof(int), ALLOC_SPARSE);
+  if (!order || !row)
+  {
+    if (order)
+    {
+      alloc_free(order, ALLOC_SPARSE);
+      alloc_free(row_start, ALLOC_SPARSE);
+    }
+    alloc_free(row, ALLOC_SPARSE);
+    return 0;
+  }
+  for (int r = 0; r < mat->nrows; r++)
+  {
+    // Scatter backwards so the first stored entry wins, as in sparse_get
+    for (size_t k = row_start[r + 1]; k-- > row_start[r];)
+      row[mat->data[order[k]].col] = mat->data[order[k]].value;
+    for (int j = 0; j < mat->ncols; j++)
+    {
+      if (j > 0)
+        writer_char(w, sep);
+      writer_int(w, row[j]);
+    }
+    if (trailing)
+      writer_char(w, sep);
+    writer_char(w, '\n');
+    for (size_t k = row_start[r]; k < row_start[r + 1]; k++)
+      row[mat->data[order[k]].col] = 0;
+  }
+  alloc_free(row, ALLOC_SPARSE);
+  alloc_free(order, ALLOC_SPARSE);
+  alloc_free(row_start, ALLOC_SPARSE);
+  return 1;
+}
+
+// Matrix Market coordinate format (1-based) or "LABS" binary triplets, in row order
+static int sparse_write_coordinates(SparseMat *mat, Writer *w, OutFormat format)
+{
+  size_t *row_start;
+  size_t *order = sparse_row_order(mat, &row_start);
+  if (!order)
+    return 0;
+  if (format == OUT_MM)
+  {
+    writer_str(w, "%%MatrixMarket matrix coordinate integer general\n");
+    writer_int(w, mat->nrows);
+    writer_char(w, ' ');
+    writer_int(w, mat->ncols);
+    writer_char(w, ' ');
+    writer_int(w, mat->nnz);
+    writer_char(w, '\n');
+    for (size_t k = 0; k < (size_t)mat->nnz; k++)
+    {
+      SparseEntry *e = &mat->data[order[k]];
+      writer_int(w, (long long)e->row + 1);
+      writer_char(w, ' ');
+      writer_int(w, (long long)e->col + 1);
+      writer_char(w, ' ');
+      writer_int(w, e->value);
+      writer_char(w, '\n');
+    }
+  }
+  else
+  {
+    int32_t header[3] = {mat->nrows, mat->ncols, mat->nnz};
+    writer_bytes(w, "LABS", 4);
+    writer_bytes(w, header, sizeof(header));
+    for (size_t k = 0; k < (size_t)mat->nnz; k++)
+    {
+      SparseEntry *e = &mat->data[order[k]];
+      int32_t triplet[3] = {(int32_t)e->row, (int32_t)e->col, e->value};
+      writer_bytes(w, triplet, sizeof(triplet));
+    }
+  }
+  alloc_free(order, ALLOC_SPARSE);
+  alloc_free(row_start, ALLOC_SPARSE);
+  return 1;
+}
+
+// Writes the sparse matrix to w without densifying it: TSV/CSV stream dense
+// rows, Matrix Market and binary write coordinates. Returns 1 on success, 0 on error.
+int sparse_write(SparseMat *mat, Writer *w, OutFormat format)
+{
+  if (mat == NULL || w == NULL)
+  {
+    fprintf(stderr, "Error: Cannot write a NULL sparse matrix.\n");
+    return 0;
+  }
+  int ok;
+  switch (format)
+  {
+  case OUT_TSV:
+    ok = sparse_write_dense(mat, w, '\t', 0);
+    break;
+  case OUT_CSV:
+    ok = sparse_write_dense(mat, w, ',', 0);
+    break;
+  default:
+    ok = sparse_write_coordinates(mat, w, format);
+    break;
+  }
+  return ok && !w->failed;
+}
+
+// Prints the sparse matrix in dense (full) format
+void mat_print(SparseMat *mat)
+{
+  if (mat == NULL)
+  {
+    printf("Cannot print a NULL matrix in dense format.\n");
+    return;
+  }
+  fflush(stdout); // The writer goes to fd 1 directly
+  Writer *w = writer_stdout();
+  if (!w)
+    return;
+  writer_str(w, "Matrix in Dense Format (");
+  writer_int(w, mat->nrows);
+  writer_char(w, 'x');
+  writer_int(w, mat->ncols);
+  writer_str(w, "):\n");
+  sparse_write_dense(mat, w, '\t', 1); // Tab after every value, as before
+  writer_flush(w);
+}
+
+SparseMat *sparse_from_mat(Mat *mat)
+{
+  CsrMat *csr = csr_from_mat(mat);
+  SparseMat *sparse = csr_to_sparse(csr);
+  csr_destroy(csr);
+  return sparse;
+}
+
+Mat *sparse_to_mat(SparseMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot convert a NULL sparse matrix.\n");
+    return NULL;
+  }
+  Mat *dense = mat_new(mat->nrows, mat->ncols);
+  if (!dense)
+    return NULL;
+  for (int i = 0; i < mat->nrows; i++)
+    memset((*(Vec **)vec_get(dense->rows, i))->data, 0, sizeof(int) * (size_t)mat->ncols);
+  // Scatter backwards so the first stored entry wins
+  for (size_t k = mat->nnz; k-- > 0;)
+  {
+    SparseEntry *e = &mat->data[k];
+    ((int *)(*(Vec **)vec_get(dense->rows, e->row))->data)[e->col] = e->value;
+  }
+  return dense;
+}
+
+SparseMat *sparse_transpose(SparseMat *mat)
+{
+  if (mat == NULL)
+  {
+    fprintf(stderr, "Error: Cannot transpose a NULL sparse matrix.\n");
+    return NULL;
+  }
+  SparseMat *t = sparse_new(mat->ncols, mat->nrows);
+  if (!t)
+    return NULL;
+  if ((size_t)mat->nnz > t->capacity)
+  {
+    SparseEntry *data = alloc_realloc(t->data, sizeof(SparseEntry) * mat->nnz, ALLOC_SPARSE);
+    if (!data)
+    {
+      fprintf(stderr, "Error: Memory allocation failed for %d sparse entries.\n", mat->nnz);
+      sparse_mat_destroy(t);
+      return NULL;
+    }
+    t->data = data;
+    t->capacity = mat->nnz;
+  }
+  for (size_t k = 0; k < (size_t)mat->nnz; k++)
+  {
+    t->data[k].row = mat->data[k].col;
+    t->data[k].col = mat->data[k].row;
+    t->data[k].value = mat->data[k].value;
+  }
+  t->nnz = mat->nnz;
+  return t;
+}
+
+SparseMat *sparse_sum(SparseMat *a, SparseMat *b)
+{
+  if (a == NULL || b == NULL)
+  {
+    fprintf(stderr, "Error: Cannot add a NULL sparse matrix.\n");
+    return NULL;
+  }
+  CsrMat *ca = csr_from_sparse(a);
+  CsrMat *cb = ca ? csr_from_sparse(b) : NULL;
+  CsrMat *sum = cb ? csr_add(ca, cb) : NULL;
+  SparseMat *result = sum ? csr_to_sparse(sum) : NULL;
+  csr_destroy(ca);
+  csr_destroy(cb);
+  csr_destroy(sum);
+  return result;
+}
+
+// Frees all memory allocated for the sparse matrix
+void sparse_mat_destroy(SparseMat *mat)
+{
+  if (mat == NULL)
+  {
+    return; // Nothing to destroy
+  }
+  if (mat->data != NULL)
+  {
+    alloc_free(mat->data, ALLOC_SPARSE); // Free the array of SparseEntry structs
+    mat->data = NULL;
+  }
+  alloc_free(mat, ALLOC_SPARSE); // Free the SparseMat struct itself
+}
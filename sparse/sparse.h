@@ -0,0 +1,39 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include <stddef.h> // for size_t
+#include "../writer/writer.h"
+#include "../matrix/matrix.h"
+
+typedef struct
+{
+  size_t row;
+  size_t col;
+  int value;
+} SparseEntry;
+
+typedef struct
+{
+  int nrows;
+  int ncols;
+  int nnz;           // Number of non-zero elements
+  size_t capacity;   // Current allocated capacity for data
+  SparseEntry *data; // Array of non-zero entries
+} SparseMat;
+
+SparseMat *sparse_new(int nrows, int ncols);
+void sparse_add(SparseMat *mat, int row, int col, int value);
+void sparse_print(SparseMat *mat);
+int sparse_get(SparseMat *mat, int row, int col);
+void sparse_mat_destroy(SparseMat *mat);
+void mat_print(SparseMat *mat);
+int sparse_write(SparseMat *mat, Writer *w, OutFormat format);
+
+// Conversions and arithmetic without densifying (see csr/ for the CSR form).
+// Repeated coordinates resolve as in sparse_get: the first stored entry wins.
+SparseMat *sparse_from_mat(Mat *mat);              // Stores the non-zero elements, row by row
+Mat *sparse_to_mat(SparseMat *mat);                // O(nrows * ncols + nnz)
+SparseMat *sparse_transpose(SparseMat *mat);       // O(nnz): swaps coordinates
+SparseMat *sparse_sum(SparseMat *a, SparseMat *b); // O(nnz) merge through CSR; result is row-major
+
+#endif // SPARSE_H
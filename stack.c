@@ -4,32 +4,27 @@
 #include "./input/input.h"  
 #include "./types/types.h"   
 #include "./vector/vector.h" 
-
-// --- Stack Structure Definition ---
-typedef struct
-{
-  Vec *elements; // The Vec will now manage the underlying array
-} Stack;
+#include "./stack/stack.h"
+#include "./perf/perf.h"     // perf_init, perf_begin, perf_end (enabled by LAB_PERF)
+#include "./batch/batch.h"   // batch_requested, batch_start, batch_next, batch_finish (--batch mode)
 
 // --- Function Prototypes ---
 
-// Stack Operations
-Stack *stack_new(size_t initial_capacity);
-void stack_destroy(Stack *s);
-int stack_push(Stack *s, int value);      // Returns 1 on success, 0 on failure
-int stack_pop(Stack *s, int *out_value);  // Returns 1 on success, 0 on failure
-int stack_peek(Stack *s, int *out_value); // Returns 1 on success, 0 on failure
-int stack_is_empty(Stack *s);
-size_t stack_size(Stack *s);
-void stack_display(Stack *s);
-
 // Input Helper Functions (using your int_read_line)
 int get_menu_choice_input(const char *prompt_text);
 int get_integer_value_input(const char *prompt_text); // Returns specific sentinel on 'q' or error
+// Runs the program non-interactively from a script (see Batch Mode below)
+int run_batch(const char *path);
 
 // --- Main Function (remains mostly the same) ---
-int main()
+int main(int argc, char **argv)
 {
+  perf_init();
+  const char *batch_path;
+  if (batch_requested(argc, argv, &batch_path))
+  {
+    return run_batch(batch_path);
+  }
   Stack *myStack = stack_new(5); // Initial capacity of 5
 
   if (myStack == NULL)
@@ -37,11 +32,14 @@ int main()
     fprintf(stderr, "Error: Failed to create stack. Exiting.\n");
     return 1;
   }
+  printf("Stack created with initial capacity: %zu\n", myStack->elements->capacity);
 
   int choice;
   int value;
   int popped_value;
   int peeked_value;
+  int ok;
+  PerfScope scope;
 
   printf("--- Array-based Stack Operations (using your Vec) ---\n");
 
@@ -71,7 +69,10 @@ int main()
         fprintf(stderr, "Push operation cancelled or invalid input. Returning to menu.\n");
         break;
       }
-      if (stack_push(myStack, value))
+      perf_begin(&scope, "stack_push");
+      ok = stack_push(myStack, value);
+      perf_end(&scope);
+      if (ok)
       {
         printf("%d pushed onto the stack.\n", value);
       }
@@ -81,7 +82,10 @@ int main()
       }
       break;
     case 2: // Pop
-      if (stack_pop(myStack, &popped_value))
+      perf_begin(&scope, "stack_pop");
+      ok = stack_pop(myStack, &popped_value);
+      perf_end(&scope);
+      if (ok)
       {
         printf("%d popped from the stack.\n", popped_value);
       }
@@ -91,7 +95,10 @@ int main()
       }
       break;
     case 3: // Peek
-      if (stack_peek(myStack, &peeked_value))
+      perf_begin(&scope, "stack_peek");
+      ok = stack_peek(myStack, &peeked_value);
+      perf_end(&scope);
+      if (ok)
       {
         printf("Top element: %d\n", peeked_value);
       }
@@ -115,6 +122,7 @@ int main()
 cleanup:
   printf("Cleaning up stack memory...\n");
   stack_destroy(myStack);
+  printf("Stack destroyed.\n");
   printf("Program terminated.\n");
   return 0;
 }
@@ -184,162 +192,64 @@ int get_integer_value_input(const char *prompt_text)
   }
 }
 
-// --- Stack Operations Implementation (MODIFIED to use Vec) ---
-
-// Creates a new stack by creating an underlying Vec
-Stack *stack_new(size_t initial_capacity)
+// --- Batch Mode ---
+// Script: the interactive menu numbers, "1 value" push, "2" pop, "3" peek, "4" display,
+// "5" (or 'q') exit. Pop and peek print the value, or "empty"; push is silent.
+int run_batch(const char *path)
 {
-  Stack *s = malloc(sizeof(Stack));
-  if (s == NULL)
-  {
-    fprintf(stderr, "Error: Memory allocation failed for Stack struct.\n");
-    return NULL;
-  }
-
-  // Use your vec_new to create the underlying dynamic array for integers
-  // The elem_size for int is sizeof(int)
-  s->elements = vec_new(sizeof(int), initial_capacity);
-  if (s->elements == NULL)
-  {
-    fprintf(stderr, "Error: Failed to create underlying Vec for stack data.\n");
-    free(s); // Free the partially allocated Stack struct
-    return NULL;
-  }
-
-  printf("Stack created with initial capacity: %zu\n", s->elements->capacity);
-  return s;
-}
-
-// Destroys the stack by destroying the underlying Vec
-void stack_destroy(Stack *s)
-{
-  if (s == NULL)
-  {
-    return;
-  }
-  // Use your vec_destroy to free the underlying dynamic array
-  vec_destroy(s->elements); // This handles freeing s->elements->data and s->elements itself
-  s->elements = NULL;       // Prevent double-free issues if stack_destroy is called again
-  free(s);                  // Free the Stack struct itself
-  printf("Stack destroyed.\n");
-}
-
-// Pushes an element onto the stack using vec_append
-int stack_push(Stack *s, int value)
-{
-  if (s == NULL || s->elements == NULL)
-  {
-    fprintf(stderr, "Error: Cannot push to an uninitialized stack.\n");
-    return 0;
-  }
-  // vec_append handles the dynamic resizing internally
-  if (vec_append(s->elements, &value))
-  {
-    return 1; // Success
-  }
-  else
-  {
-    fprintf(stderr, "Error: Failed to append value to underlying vector (memory allocation?).\n");
-    return 0; // Failure
-  }
-}
-
-// Pops an element from the stack. Returns 1 on success, 0 on failure.
-int stack_pop(Stack *s, int *out_value)
-{
-  if (s == NULL || s->elements == NULL)
-  {
-    fprintf(stderr, "Error: Cannot pop from an uninitialized stack.\n");
-    return 0;
-  }
-  if (stack_is_empty(s))
-  {
-    return 0; // Stack is empty
-  }
-
-  // Get the element at the 'top' (last element in the Vec)
-  // The top of the stack corresponds to vec->length - 1
-  if (out_value != NULL)
-  {
-    *out_value = *(int *)vec_get(s->elements, s->elements->length - 1);
-  }
-
-  // Manually decrease the length to simulate pop.
-  // Vec doesn't have a direct 'pop_back' or 'remove_last' function,
-  // so we just decrement length. The memory for the 'popped' element
-  // is technically still there but no longer considered part of the active length.
-  s->elements->length--;
-
-  return 1; // Success
-}
-
-// Peeks at the top element without removing it. Returns 1 on success, 0 on failure.
-int stack_peek(Stack *s, int *out_value)
-{
-  if (s == NULL || s->elements == NULL)
-  {
-    fprintf(stderr, "Error: Cannot peek from an uninitialized stack.\n");
-    return 0;
-  }
-  if (stack_is_empty(s))
-  {
-    return 0; // Stack is empty
-  }
-
-  // Get the element at the 'top' (last element in the Vec)
-  if (out_value != NULL)
-  {
-    *out_value = *(int *)vec_get(s->elements, s->elements->length - 1);
-  }
-  return 1; // Success
-}
-
-// Checks if the stack is empty.
-int stack_is_empty(Stack *s)
-{
-  if (s == NULL || s->elements == NULL)
-  {
-    return 1; // Consider uninitialized or NULL stack as empty
-  }
-  return (s->elements->length == 0); // Stack is empty if its underlying Vec has 0 length
-}
-
-// Returns the current number of elements in the stack.
-size_t stack_size(Stack *s)
-{
-  if (s == NULL || s->elements == NULL)
-  {
-    return 0;
-  }
-  return s->elements->length;
-}
-
-// Displays the elements of the stack from top to bottom.
-void stack_display(Stack *s)
-{
-  if (s == NULL || s->elements == NULL)
-  {
-    printf("Stack is NULL or uninitialized and cannot be displayed.\n");
-    return;
-  }
-  if (stack_is_empty(s))
+  BatchRun *run = batch_start("stack", path);
+  if (!run)
+    return 1;
+  Stack *myStack = stack_new(5);
+  if (myStack == NULL)
   {
-    printf("Stack is empty. (Size: %zu, Capacity: %zu)\n", stack_size(s), s->elements->capacity);
-    return;
+    batch_finish(run);
+    return 1;
   }
 
-  printf("Stack (Size: %zu, Capacity: %zu): \n", stack_size(s), s->elements->capacity);
-  printf("TOP -> ");
-  // Iterate from the last element (top) down to the first element (base)
-  printf("| %d |\n", *(int *)vec_get(s->elements, s->elements->length - 1));
-  printf("       -----\n");
-  for (int i = s->elements->length - 2; i >= 0; i--)
+  int choice, value;
+  int running = 1;
+  while (running && batch_next(run, &choice) == READ_OK)
   {
-    printf("       | %d |\n", *(int *)vec_get(s->elements, i));
-    if (i > 0)
+    switch (choice)
     {
-      printf("       -----\n");
+    case 1: // Push
+      if (batch_operand(run, &value) != READ_OK)
+      {
+        running = 0;
+        continue;
+      }
+      if (!stack_push(myStack, value))
+        run->errors++;
+      break;
+    case 2: // Pop
+      if (stack_pop(myStack, &value))
+        printf("%d\n", value);
+      else
+        printf("empty\n");
+      break;
+    case 3: // Peek
+      if (stack_peek(myStack, &value))
+        printf("%d\n", value);
+      else
+        printf("empty\n");
+      break;
+    case 4: // Display
+      stack_display(myStack);
+      break;
+    case 5: // Exit
+      running = 0;
+      continue;
+    default:
+      fprintf(stderr, "stack: invalid choice %d, skipped.\n", choice);
+      run->errors++;
+      continue;
     }
+    run->ops++;
   }
-  printf("       BASE\n");
-}
\ No newline at end of file
+
+  stack_destroy(myStack);
+  int status = run->errors > 0;
+  batch_finish(run);
+  return status;
+}
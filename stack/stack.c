@@ -0,0 +1,164 @@
+#include "stack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "../types/types.h"
+#include "../vector/vector.h"
+#include "../alloc/alloc.h"
+
+// --- Stack Operations Implementation ---
+
+// Creates a new stack by creating an underlying Vec
+Stack *stack_new(size_t initial_capacity)
+{
+  Stack *s = alloc_malloc(sizeof(Stack), ALLOC_STACK);
+  if (s == NULL)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for Stack struct.\n");
+    return NULL;
+  }
+
+  // Use your vec_new to create the underlying dynamic array for integers
+  // The elem_size for int is sizeof(int)
+  s->elements = vec_new(sizeof(int), initial_capacity);
+  if (s->elements == NULL)
+  {
+    fprintf(stderr, "Error: Failed to create underlying Vec for stack data.\n");
+    alloc_free(s, ALLOC_STACK); // Free the partially allocated Stack struct
+    return NULL;
+  }
+
+  return s;
+}
+
+// Destroys the stack by destroying the underlying Vec
+void stack_destroy(Stack *s)
+{
+  if (s == NULL)
+  {
+    return;
+  }
+  // Use your vec_destroy to free the underlying dynamic array
+  vec_destroy(s->elements);   // This handles freeing s->elements->data and s->elements itself
+  s->elements = NULL;         // Prevent double-free issues if stack_destroy is called again
+  alloc_free(s, ALLOC_STACK); // Free the Stack struct itself
+}
+
+// Pushes an element onto the stack using vec_append
+int stack_push(Stack *s, int value)
+{
+  if (s == NULL || s->elements == NULL)
+  {
+    fprintf(stderr, "Error: Cannot push to an uninitialized stack.\n");
+    return 0;
+  }
+  // vec_append handles the dynamic resizing internally
+  if (vec_append(s->elements, &value))
+  {
+    return 1; // Success
+  }
+  else
+  {
+    fprintf(stderr, "Error: Failed to append value to underlying vector (memory allocation?).\n");
+    return 0; // Failure
+  }
+}
+
+// Pops an element from the stack. Returns 1 on success, 0 on failure.
+int stack_pop(Stack *s, int *out_value)
+{
+  if (s == NULL || s->elements == NULL)
+  {
+    fprintf(stderr, "Error: Cannot pop from an uninitialized stack.\n");
+    return 0;
+  }
+  if (stack_is_empty(s))
+  {
+    return 0; // Stack is empty
+  }
+
+  // Get the element at the 'top' (last element in the Vec)
+  // The top of the stack corresponds to vec->length - 1
+  if (out_value != NULL)
+  {
+    *out_value = *(int *)vec_get(s->elements, s->elements->length - 1);
+  }
+
+  // Manually decrease the length to simulate pop.
+  // Vec doesn't have a direct 'pop_back' or 'remove_last' function,
+  // so we just decrement length. The memory for the 'popped' element
+  // is technically still there but no longer considered part of the active length.
+  s->elements->length--;
+
+  return 1; // Success
+}
+
+// Peeks at the top element without removing it. Returns 1 on success, 0 on failure.
+int stack_peek(Stack *s, int *out_value)
+{
+  if (s == NULL || s->elements == NULL)
+  {
+    fprintf(stderr, "Error: Cannot peek from an uninitialized stack.\n");
+    return 0;
+  }
+  if (stack_is_empty(s))
+  {
+    return 0; // Stack is empty
+  }
+
+  // Get the element at the 'top' (last element in the Vec)
+  if (out_value != NULL)
+  {
+    *out_value = *(int *)vec_get(s->elements, s->elements->length - 1);
+  }
+  return 1; // Success
+}
+
+// Checks if the stack is empty.
+int stack_is_empty(Stack *s)
+{
+  if (s == NULL || s->elements == NULL)
+  {
+    return 1; // Consider uninitialized or NULL stack as empty
+  }
+  return (s->elements->length == 0); // Stack is empty if its underlying Vec has 0 length
+}
+
+// Returns the current number of elements in the stack.
+size_t stack_size(Stack *s)
+{
+  if (s == NULL || s->elements == NULL)
+  {
+    return 0;
+  }
+  return s->elements->length;
+}
+
+// Displays the elements of the stack from top to bottom.
+void stack_display(Stack *s)
+{
+  if (s == NULL || s->elements == NULL)
+  {
+    printf("Stack is NULL or uninitialized and cannot be displayed.\n");
+    return;
+  }
+  if (stack_is_empty(s))
+  {
+    printf("Stack is empty. (Size: %zu, Capacity: %zu)\n", stack_size(s), s->elements->capacity);
+    return;
+  }
+
+  printf("Stack (Size: %zu, Capacity: %zu): \n", stack_size(s), s->elements->capacity);
+  printf("TOP -> ");
+  // Iterate from the last element (top) down to the first element (base)
+  printf("| %d |\n", *(int *)vec_get(s->elements, s->elements->length - 1));
+  printf("       -----\n");
+  for (int i = s->elements->length - 2; i >= 0; i--)
+  {
+    printf("       | %d |\n", *(int *)vec_get(s->elements, i));
+    if (i > 0)
+    {
+      printf("       -----\n");
+    }
+  }
+  printf("       BASE\n");
+}
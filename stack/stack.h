@@ -0,0 +1,22 @@
+#ifndef STACK_H
+#define STACK_H
+
+#include <stddef.h> // for size_t
+#include "../types/types.h"
+
+// --- Stack Structure Definition ---
+typedef struct
+{
+  Vec *elements; // The Vec will now manage the underlying array
+} Stack;
+
+Stack *stack_new(size_t initial_capacity);
+void stack_destroy(Stack *s);
+int stack_push(Stack *s, int value);      // Returns 1 on success, 0 on failure
+int stack_pop(Stack *s, int *out_value);  // Returns 1 on success, 0 on failure
+int stack_peek(Stack *s, int *out_value); // Returns 1 on success, 0 on failure
+int stack_is_empty(Stack *s);
+size_t stack_size(Stack *s);
+void stack_display(Stack *s);
+
+#endif // STACK_H
@@ -0,0 +1,151 @@
+#include "strassen.h"
+#include <stdio.h>
+#include "../gemm/gemm.h"
+#include "../alloc/alloc.h"
+
+// a level recurses only while every dimension is at least the crossover
+static int strassen_recurses(int m, int k, int n, int crossover)
+{
+  return m >= crossover && k >= crossover && n >= crossover;
+}
+
+StrassenWorkspace *strassen_workspace_new(int m, int k, int n, int crossover)
+{
+  if (crossover < 2)
+    crossover = 2; // Halving must leave at least one row and column
+  StrassenWorkspace *ws = alloc_calloc(1, sizeof(StrassenWorkspace), ALLOC_MATRIX);
+  if (!ws)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for Strassen workspace.\n");
+    return NULL;
+  }
+  ws->m = m;
+  ws->k = k;
+  ws->n = n;
+  ws->crossover = crossover;
+
+  // First pass: count levels and scratch sizes
+  size_t nints = 0, nptrs = 0;
+  for (int lm = m, lk = k, ln = n; strassen_recurses(lm, lk, ln, crossover); ws->depth++)
+  {
+    lm /= 2;
+    lk /= 2;
+    ln /= 2;
+    nints += (size_t)lm * (size_t)(lk > ln ? lk : ln) + (size_t)lk * ln;
+    nptrs += (size_t)lm + (size_t)lk;
+  }
+  if (ws->depth == 0)
+    return ws; // Blocked kernel only; no scratch needed
+
+  ws->x = alloc_malloc(sizeof(MatView) * ws->depth, ALLOC_MATRIX);
+  ws->y = alloc_malloc(sizeof(MatView) * ws->depth, ALLOC_MATRIX);
+  ws->data = alloc_malloc(sizeof(int) * nints, ALLOC_MATRIX);
+  ws->row_ptrs = alloc_malloc(sizeof(int *) * nptrs, ALLOC_MATRIX);
+  if (!ws->x || !ws->y || !ws->data || !ws->row_ptrs)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for Strassen workspace (%zu ints).\n", nints);
+    strassen_workspace_destroy(ws);
+    return NULL;
+  }
+
+  // Second pass: carve X and Y for each level out of the two blocks
+  int *data = ws->data;
+  int **ptrs = ws->row_ptrs;
+  int lm = m, lk = k, ln = n;
+  for (int level = 0; level < ws->depth; level++)
+  {
+    lm /= 2;
+    lk /= 2;
+    ln /= 2;
+    int xcols = lk > ln ? lk : ln;
+    ws->x[level] = (MatView){ptrs, 0, lm, xcols};
+    for (int i = 0; i < lm; i++, data += xcols)
+      *ptrs++ = data;
+    ws->y[level] = (MatView){ptrs, 0, lk, ln};
+    for (int i = 0; i < lk; i++, data += ln)
+      *ptrs++ = data;
+  }
+  return ws;
+}
+
+// One level of Strassen-Winograd on the even part of the operands, using the
+// two-temporary schedule of Douglas et al. (C quadrants double as scratch),
+// followed by the peeling fix-ups for an odd m, k or n.
+static void strassen_level(StrassenWorkspace *ws, int level, MatView c, MatView a, MatView b)
+{
+  if (level == ws->depth)
+  {
+    gemm_blocked(c, a, b, 0);
+    return;
+  }
+  int m = a.nrows, k = a.ncols, n = b.ncols;
+  int hm = m / 2, hk = k / 2, hn = n / 2;
+
+  MatView a11 = mat_view_block(a, 0, 0, hm, hk), a12 = mat_view_block(a, 0, hk, hm, hk);
+  MatView a21 = mat_view_block(a, hm, 0, hm, hk), a22 = mat_view_block(a, hm, hk, hm, hk);
+  MatView b11 = mat_view_block(b, 0, 0, hk, hn), b12 = mat_view_block(b, 0, hn, hk, hn);
+  MatView b21 = mat_view_block(b, hk, 0, hk, hn), b22 = mat_view_block(b, hk, hn, hk, hn);
+  MatView c11 = mat_view_block(c, 0, 0, hm, hn), c12 = mat_view_block(c, 0, hn, hm, hn);
+  MatView c21 = mat_view_block(c, hm, 0, hm, hn), c22 = mat_view_block(c, hm, hn, hm, hn);
+  MatView xs = mat_view_block(ws->x[level], 0, 0, hm, hk); // S sums
+  MatView xp = mat_view_block(ws->x[level], 0, 0, hm, hn); // P1
+  MatView y = ws->y[level];                                // T sums
+
+  mat_view_sub(xs, a11, a21);                     // S3 = A11 - A21
+  mat_view_sub(y, b22, b12);                      // T3 = B22 - B12
+  strassen_level(ws, level + 1, c21, xs, y);      // P7 = S3 T3
+  mat_view_add(xs, a21, a22);                     // S1 = A21 + A22
+  mat_view_sub(y, b12, b11);                      // T1 = B12 - B11
+  strassen_level(ws, level + 1, c22, xs, y);      // P5 = S1 T1
+  mat_view_sub(xs, xs, a11);                      // S2 = S1 - A11
+  mat_view_sub(y, b22, y);                        // T2 = B22 - T1
+  strassen_level(ws, level + 1, c12, xs, y);      // P6 = S2 T2
+  mat_view_sub(xs, a12, xs);                      // S4 = A12 - S2
+  strassen_level(ws, level + 1, c11, xs, b22);    // P3 = S4 B22
+  strassen_level(ws, level + 1, xp, a11, b11);    // P1 = A11 B11
+  mat_view_add(c12, xp, c12);                     // U2 = P1 + P6
+  mat_view_add(c21, c12, c21);                    // U3 = U2 + P7
+  mat_view_add(c12, c12, c22);                    // U4 = U2 + P5
+  mat_view_add(c22, c21, c22);                    // U7 = U3 + P5  -> C22
+  mat_view_add(c12, c12, c11);                    // U5 = U4 + P3  -> C12
+  mat_view_sub(y, y, b21);                        // T4 = T2 - B21
+  strassen_level(ws, level + 1, c11, a22, y);     // P4 = A22 T4
+  mat_view_sub(c21, c21, c11);                    // U6 = U3 - P4  -> C21
+  strassen_level(ws, level + 1, c11, a12, b21);   // P2 = A12 B21
+  mat_view_add(c11, xp, c11);                     // U1 = P1 + P2  -> C11
+
+  // Dynamic peeling: fold in the row/column the halving dropped
+  int me = 2 * hm, ke = 2 * hk, ne = 2 * hn;
+  if (k > ke) // Rank-1 update from the last column of A and row of B
+    gemm_blocked(mat_view_block(c, 0, 0, me, ne), mat_view_block(a, 0, ke, me, 1),
+                 mat_view_block(b, ke, 0, 1, ne), 1);
+  if (n > ne) // Last column of C over all of A
+    gemm_blocked(mat_view_block(c, 0, ne, m, 1), a, mat_view_block(b, 0, ne, k, 1), 0);
+  if (m > me) // Last row of C over all of B
+    gemm_blocked(mat_view_block(c, me, 0, 1, ne), mat_view_block(a, me, 0, 1, k),
+                 mat_view_block(b, 0, 0, k, ne), 0);
+}
+
+int strassen_mult(StrassenWorkspace *ws, MatView c, MatView a, MatView b)
+{
+  if (a.nrows != ws->m || a.ncols != ws->k || b.nrows != ws->k || b.ncols != ws->n ||
+      c.nrows != ws->m || c.ncols != ws->n)
+  {
+    fprintf(stderr, "Error: Strassen workspace is for %dx%d by %dx%d, got %dx%d by %dx%d.\n", ws->m, ws->k,
+            ws->k, ws->n, a.nrows, a.ncols, b.nrows, b.ncols);
+    return 0;
+  }
+  strassen_level(ws, 0, c, a, b);
+  return 1;
+}
+
+void strassen_workspace_destroy(StrassenWorkspace *ws)
+{
+  if (ws == NULL)
+    return;
+  alloc_free(ws->x, ALLOC_MATRIX);
+  alloc_free(ws->y, ALLOC_MATRIX);
+  alloc_free(ws->data, ALLOC_MATRIX);
+  alloc_free(ws->row_ptrs, ALLOC_MATRIX);
+  alloc_free(ws, ALLOC_MATRIX);
+}
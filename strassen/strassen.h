@@ -0,0 +1,34 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include "../gemm/gemm.h"
+
+// A level recurses while all three dimensions are at least this, so the
+// blocked kernel sees blocks of crossover/2 up to crossover. Tuned with
+// `bench --filter mat_mult_strassen` (rebuild with -DSTRASSEN_CROSSOVER=N):
+// 128 beat 64, 256 and 512 at 1024 and 2048, and is 1.8x the blocked kernel at 2048.
+#ifndef STRASSEN_CROSSOVER
+#define STRASSEN_CROSSOVER 128
+#endif
+
+// Scratch for every recursion level of one m x k by k x n product, allocated
+// once up front. Level l owns X (S sums and P1) and Y (T sums); the seven
+// products of a level run one after another, so they share level l+1.
+typedef struct
+{
+  int m, k, n;
+  int crossover;
+  int depth; // Levels that recurse; level `depth` is the blocked kernel
+  MatView *x;
+  MatView *y;
+  int *data;
+  int **row_ptrs;
+} StrassenWorkspace;
+
+StrassenWorkspace *strassen_workspace_new(int m, int k, int n, int crossover);
+// c = a * b (Strassen-Winograd, odd sizes by dynamic peeling). The shapes must
+// match the workspace; returns 1 on success, 0 otherwise.
+int strassen_mult(StrassenWorkspace *ws, MatView c, MatView a, MatView b);
+void strassen_workspace_destroy(StrassenWorkspace *ws);
+
+#endif // STRASSEN_H
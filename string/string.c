@@ -5,16 +5,17 @@
 #include <stdbool.h>
 #include "../result/result.h"
 #include "../types/types.h"
+#include "../alloc/alloc.h"
 
 String *String_new(size_t init_capacity)
 {
-  String *s = malloc(sizeof(String));
+  String *s = alloc_malloc(sizeof(String), ALLOC_STRING);
   if (!s)
     return NULL;
-  s->data = malloc(init_capacity);
+  s->data = alloc_malloc(init_capacity, ALLOC_STRING);
   if (!s->data)
   {
-    free(s);
+    alloc_free(s, ALLOC_STRING);
     return NULL;
   }
   s->length = 0;
@@ -30,7 +31,7 @@ int String_append(String *s, const char *suffix)
   if (new_length + 1 > s->capacity)
   {
     size_t new_capacity = (new_length + 1) * 2;
-    char *new_data = realloc(s->data, new_capacity);
+    char *new_data = alloc_realloc(s->data, new_capacity, ALLOC_STRING);
     if (!new_data)
       return 0; // Allocation failed
     s->data = new_data;
@@ -45,8 +46,8 @@ void String_destroy(String *s)
 {
   if (s)
   {
-    free(s->data);
-    free(s);
+    alloc_free(s->data, ALLOC_STRING);
+    alloc_free(s, ALLOC_STRING);
   }
 }
 
@@ -58,9 +59,11 @@ Result String_read_line(String *s)
   s->length = 0; // Reset the string for new input
   if (s->capacity == 0)
   {
-    s->data = malloc(16);
-    if (!s->data)
+    // String_new(0) still owns a zero-sized block; grow it instead of leaking it
+    char *new_data = alloc_realloc(s->data, 16, ALLOC_STRING);
+    if (!new_data)
       return (Result){ERR, .data.err_str = "Memory allocation failed"};
+    s->data = new_data;
     s->capacity = 16;
     s->data[0] = '\0';
   }
@@ -0,0 +1,122 @@
+// Allocation accounting: counters from concurrent threads add up exactly,
+// including the first allocations that race to initialise the module, and a
+// matrix's row vectors are charged to "matrix" rather than "vec"
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../alloc/alloc.h"
+#include "../matrix/matrix.h"
+#include "check.h"
+
+#define ALLOC_TEST_THREADS 8
+#define ALLOC_TEST_ROUNDS 2000
+#define ALLOC_TEST_ROWS 7
+
+static void *alloc_worker(void *arg)
+{
+  AllocSite site = (AllocSite)(long)arg;
+  for (int i = 0; i < ALLOC_TEST_ROUNDS; i++)
+  {
+    char *p = alloc_malloc(16 + (size_t)(i % 64), site);
+    char *q = alloc_calloc(4, 8, site);
+    p = alloc_realloc(p, 256, site);
+    alloc_free(p, site);
+    alloc_free(q, site);
+  }
+  return NULL;
+}
+
+typedef struct
+{
+  unsigned long long allocs, frees, reallocs, bytes;
+  long long live, peak;
+} SiteCounts;
+
+// Parses the report line of one site; 1 when found. A null peak (the total's) reads as -1.
+static int read_site(const char *report, const char *site, SiteCounts *c)
+{
+  char key[64];
+  snprintf(key, sizeof(key), "{\"site\": \"%s\"", site);
+  const char *p = strstr(report, key);
+  if (!p)
+    return 0;
+  c->peak = -1;
+  int n = sscanf(p + strlen(key),
+                 ", \"allocs\": %llu, \"frees\": %llu, \"reallocs\": %llu, \"bytes\": %llu, \"live_bytes\": %lld, "
+                 "\"peak_bytes\": %lld",
+                 &c->allocs, &c->frees, &c->reallocs, &c->bytes, &c->live, &c->peak);
+  return n == 6 || (n == 5 && strncmp(strstr(p, "\"peak_bytes\": ") + 14, "null", 4) == 0);
+}
+
+// Writes the report into buf
+static void read_report(char *buf, size_t size)
+{
+  buf[0] = '\0';
+  FILE *tmp = tmpfile();
+  CHECK(tmp != NULL);
+  if (tmp)
+  {
+    alloc_report(tmp);
+    rewind(tmp);
+    size_t len = fread(buf, 1, size - 1, tmp);
+    buf[len] = '\0';
+    fclose(tmp);
+  }
+}
+
+int main(void)
+{
+  setenv("LAB_ALLOC", "/dev/null", 1); // Read lazily by the first allocation below
+  pthread_t threads[ALLOC_TEST_THREADS];
+  for (int t = 0; t < ALLOC_TEST_THREADS; t++)
+  {
+    AllocSite site = t % 2 ? ALLOC_HASH : ALLOC_QUEUE;
+    CHECK(pthread_create(&threads[t], NULL, alloc_worker, (void *)(long)site) == 0);
+  }
+  for (int t = 0; t < ALLOC_TEST_THREADS; t++)
+    pthread_join(threads[t], NULL);
+  CHECK(alloc_enabled());
+
+  char report[4096];
+  read_report(report, sizeof(report));
+  const unsigned long long per_site = ALLOC_TEST_THREADS / 2 * ALLOC_TEST_ROUNDS;
+  const char *sites[2] = {"hash", "queue"};
+  for (int s = 0; s < 2; s++)
+  {
+    SiteCounts c;
+    CHECK(read_site(report, sites[s], &c));
+    CHECK_EQ(c.allocs, 2 * per_site);
+    CHECK_EQ(c.frees, 2 * per_site);
+    CHECK_EQ(c.reallocs, per_site);
+    CHECK_EQ(c.live, 0);
+    CHECK(c.peak > 0);
+  }
+  SiteCounts total;
+  CHECK(read_site(report, "total", &total));
+  CHECK_EQ(total.allocs, 4 * per_site); // Summed from the sites at report time
+  CHECK_EQ(total.reallocs, 2 * per_site);
+  CHECK_EQ(total.live, 0);
+  CHECK_EQ(total.peak, -1);
+  CHECK(strstr(report, "\"site\": \"vec\"") == NULL); // Unused sites are left out
+
+  // The Mat struct, then a header and a buffer for the row table and for each row
+  const long long mat_allocs = 1 + 2 * (ALLOC_TEST_ROWS + 1);
+  Mat *mat = mat_new(ALLOC_TEST_ROWS, 5);
+  CHECK(mat != NULL);
+  read_report(report, sizeof(report));
+  SiteCounts c;
+  CHECK(read_site(report, "matrix", &c));
+  CHECK_EQ(c.allocs, mat_allocs);
+  CHECK_EQ(c.frees, 0);
+  CHECK(c.live > 0);
+  mat_destroy(mat);
+  read_report(report, sizeof(report));
+  CHECK(read_site(report, "matrix", &c));
+  CHECK_EQ(c.allocs, mat_allocs);
+  CHECK_EQ(c.frees, mat_allocs);
+  CHECK_EQ(c.live, 0);
+  CHECK(strstr(report, "\"site\": \"vec\"") == NULL);
+  return check_finish("alloc");
+}
@@ -0,0 +1,166 @@
+// Bitsets against bool arrays: single-bit ops, counts, the four bulk ops
+// (also in place), rank/select/next with and without the rank directory,
+// over sizes that end mid-word and mid-block
+#include <stdlib.h>
+#include "../bitset/bitset.h"
+#include "check.h"
+
+static void fill(Bitset *bs, char *ref, size_t nbits, unsigned density)
+{
+  bitset_clear_all(bs);
+  for (size_t i = 0; i < nbits; i++)
+  {
+    ref[i] = check_rand() % 100 < density;
+    if (ref[i])
+      CHECK(bitset_set(bs, i));
+  }
+}
+
+static int apply(int a, int b, BitsetOp op)
+{
+  switch (op)
+  {
+  case BITSET_AND:
+    return a && b;
+  case BITSET_OR:
+    return a || b;
+  case BITSET_XOR:
+    return a != b;
+  default:
+    return a && !b;
+  }
+}
+
+static void check_bits(Bitset *bs, const char *ref, size_t nbits)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < nbits; i++)
+  {
+    CHECK_EQ(bitset_test(bs, i), ref[i]);
+    count += (size_t)ref[i];
+  }
+  CHECK_EQ(bitset_count(bs), count);
+  if (nbits % 64)
+    CHECK_EQ(bs->words[bs->nwords - 1] >> (nbits % 64), 0); // Tail bits stay clear
+}
+
+static void test_size(size_t nbits)
+{
+  Bitset *a = bitset_new(nbits), *b = bitset_new(nbits), *dst = bitset_new(nbits);
+  char *ra = malloc(nbits), *rb = malloc(nbits), *rd = malloc(nbits);
+  CHECK(a && b && dst);
+  fill(a, ra, nbits, 1 + check_rand() % 99);
+  fill(b, rb, nbits, 1 + check_rand() % 99);
+  check_bits(a, ra, nbits);
+
+  CHECK(!bitset_set(a, nbits));
+  CHECK(!bitset_test(a, nbits));
+  size_t pos = check_rand() % nbits;
+  CHECK(bitset_clear(a, pos));
+  ra[pos] = 0;
+  if ((pos ^ 1) < nbits)
+  {
+    CHECK(bitset_set(a, pos ^ 1));
+    ra[pos ^ 1] = 1;
+  }
+
+  for (BitsetOp op = BITSET_AND; op <= BITSET_ANDNOT; op++)
+  {
+    size_t count = 0, stored;
+    for (size_t i = 0; i < nbits; i++)
+    {
+      rd[i] = (char)apply(ra[i], rb[i], op);
+      count += (size_t)rd[i];
+    }
+    CHECK_EQ(bitset_op_count(a, b, op), count);
+    CHECK(bitset_op(dst, a, b, op, &stored));
+    CHECK_EQ(stored, count);
+    check_bits(dst, rd, nbits);
+  }
+  // In place: a = a xor b, then b = a andnot b
+  CHECK(bitset_op(a, a, b, BITSET_XOR, NULL));
+  for (size_t i = 0; i < nbits; i++)
+    ra[i] = ra[i] != rb[i];
+  CHECK(bitset_op(b, a, b, BITSET_ANDNOT, NULL));
+  for (size_t i = 0; i < nbits; i++)
+    rb[i] = ra[i] && !rb[i];
+  check_bits(a, ra, nbits);
+  check_bits(b, rb, nbits);
+
+  BitsetIndex *index = bitset_index_new(a);
+  CHECK(index != NULL);
+  size_t rank = 0, next = nbits;
+  for (size_t i = nbits; i-- > 0;) // next set bit at or after i, built backwards
+  {
+    if (ra[i])
+      next = i;
+    if (i % 7 == 0 || i + 1 == nbits)
+      CHECK_EQ(bitset_next(a, i), next);
+  }
+  for (size_t i = 0; i < nbits; i++)
+  {
+    if (i % 5 == 0)
+    {
+      CHECK_EQ(bitset_rank(a, i), rank);
+      CHECK_EQ(bitset_index_rank(index, i), rank);
+    }
+    if (ra[i])
+    {
+      size_t at = nbits, at_index = nbits;
+      CHECK(bitset_select(a, rank, &at));
+      CHECK(bitset_index_select(index, rank, &at_index));
+      CHECK_EQ(at, i);
+      CHECK_EQ(at_index, i);
+      rank++;
+    }
+  }
+  CHECK_EQ(bitset_rank(a, nbits), rank);
+  size_t unused;
+  CHECK(!bitset_select(a, rank, &unused));
+  CHECK(!bitset_index_select(index, rank, &unused));
+  CHECK_EQ(bitset_next(a, nbits), nbits);
+
+  size_t *indices = malloc(sizeof(size_t) * (rank + 1));
+  CHECK_EQ(bitset_to_indices(a, indices), rank);
+  for (size_t k = 1; k < rank; k++)
+    CHECK(indices[k - 1] < indices[k] && ra[indices[k]]);
+
+  Bitset *other = bitset_new(nbits + 64);
+  CHECK(!bitset_op(dst, a, other, BITSET_OR, NULL)); // Sizes differ
+  bitset_destroy(other);
+  free(indices);
+  bitset_index_destroy(index);
+  free(ra);
+  free(rb);
+  free(rd);
+  bitset_destroy(a);
+  bitset_destroy(b);
+  bitset_destroy(dst);
+}
+
+static void test_word_helpers(void)
+{
+  for (int trial = 0; trial < 1000; trial++)
+  {
+    uint64_t word = ((uint64_t)check_rand() << 32 | check_rand()) & ((uint64_t)check_rand() << 32 | check_rand());
+    unsigned count = 0;
+    for (unsigned bit = 0; bit < 64; bit++)
+    {
+      if (word >> bit & 1)
+      {
+        CHECK_EQ(bitset_word_select(word, count), bit);
+        count++;
+      }
+    }
+    CHECK_EQ(bitset_word_count(word), count);
+  }
+}
+
+int main(void)
+{
+  static const size_t sizes[] = {1, 63, 64, 65, 511, 512, 1000, 4097, 70001};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    test_size(sizes[s]);
+  test_word_helpers();
+  return check_finish("bitset");
+}
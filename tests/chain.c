@@ -0,0 +1,123 @@
+// Planned matrix chains against left-to-right mat_mult, with dense and
+// sparse operands (including repeated sparse coordinates, first-wins)
+#include <stdio.h>
+#include "../chain/chain.h"
+#include "../matrix/matrix.h"
+#include "../sparse/sparse.h"
+#include "check.h"
+
+#define CHAIN_MAX 6
+#define CHAIN_TRIALS 80
+
+static void check_equal(Mat *actual, Mat *expected)
+{
+  CHECK(actual != NULL && expected != NULL);
+  if (!actual || !expected)
+    return;
+  CHECK_EQ(actual->nrows, expected->nrows);
+  CHECK_EQ(actual->ncols, expected->ncols);
+  for (int i = 0; i < expected->nrows; i++)
+  {
+    for (int j = 0; j < expected->ncols; j++)
+      CHECK_EQ(matrix_get(actual, i, j), matrix_get(expected, i, j));
+  }
+}
+
+static void test_mixed(void)
+{
+  for (int trial = 0; trial < CHAIN_TRIALS; trial++)
+  {
+    int count = 1 + (int)(check_rand() % CHAIN_MAX);
+    int dims[CHAIN_MAX + 1];
+    for (int i = 0; i <= count; i++)
+      dims[i] = 1 + (int)(check_rand() % 24);
+    SparseMat *sparse[CHAIN_MAX] = {0};
+    Mat *dense[CHAIN_MAX];
+    ChainOperand ops[CHAIN_MAX];
+    for (int i = 0; i < count; i++)
+    {
+      sparse[i] = sparse_new(dims[i], dims[i + 1]);
+      int writes = (int)(check_rand() % (unsigned)(dims[i] * dims[i + 1] + 1));
+      for (int w = 0; w < writes; w++)
+        sparse_add(sparse[i], (int)(check_rand() % (unsigned)dims[i]), (int)(check_rand() % (unsigned)dims[i + 1]),
+                   (int)(check_rand() % 7) - 3);
+      dense[i] = sparse_to_mat(sparse[i]); // The first-wins reading of the same entries
+      ops[i] = (check_rand() % 2 && sparse[i]->nnz > 0) ? chain_sparse(sparse[i]) : chain_dense(dense[i]);
+    }
+
+    ChainPlan *plan = chain_plan_new(ops, count);
+    CHECK(plan != NULL);
+    if (plan)
+    {
+      CHECK(chain_plan_cost(plan) <= chain_plan_left_to_right_cost(plan));
+      Mat *expected = mat_new(dims[0], dims[0]);
+      for (int i = 0; i < dims[0]; i++)
+      {
+        for (int j = 0; j < dims[0]; j++)
+          matrix_set(expected, i, j, i == j); // mat_new does not zero
+      }
+      for (int i = 0; i < count; i++)
+      {
+        Mat *next = mat_mult(expected, dense[i]);
+        mat_destroy(expected);
+        expected = next;
+      }
+      for (int run = 0; run < 2; run++) // A plan reuses its buffers across runs
+      {
+        Mat *actual = chain_plan_run(plan, ops);
+        check_equal(actual, expected);
+        mat_destroy(actual);
+      }
+      mat_destroy(expected);
+      chain_plan_destroy(plan);
+    }
+    for (int i = 0; i < count; i++)
+    {
+      sparse_mat_destroy(sparse[i]);
+      mat_destroy(dense[i]);
+    }
+  }
+}
+
+static void test_dense_helper(void)
+{
+  int dims[5] = {30, 2, 40, 3, 25}; // The written order is far from optimal
+  Mat *mats[4];
+  for (int i = 0; i < 4; i++)
+  {
+    mats[i] = mat_new(dims[i], dims[i + 1]);
+    for (int r = 0; r < dims[i]; r++)
+    {
+      for (int c = 0; c < dims[i + 1]; c++)
+        matrix_set(mats[i], r, c, (int)(check_rand() % 9) - 4);
+    }
+  }
+  Mat *ab = mat_mult(mats[0], mats[1]), *abc = mat_mult(ab, mats[2]), *abcd = mat_mult(abc, mats[3]);
+  Mat *chained = mat_chain_mult(mats, 4);
+  check_equal(chained, abcd);
+
+  ChainOperand ops[4];
+  for (int i = 0; i < 4; i++)
+    ops[i] = chain_dense(mats[i]);
+  ChainPlan *plan = chain_plan_new(ops, 4);
+  CHECK(plan && chain_plan_cost(plan) < chain_plan_left_to_right_cost(plan));
+  chain_plan_destroy(plan);
+
+  CHECK(chain_plan_run(NULL, ops) == NULL);
+  Mat *wrong[2] = {mats[0], mats[0]}; // 30x2 * 30x2
+  CHECK(mat_chain_mult(wrong, 2) == NULL);
+
+  mat_destroy(chained);
+  mat_destroy(ab);
+  mat_destroy(abc);
+  mat_destroy(abcd);
+  for (int i = 0; i < 4; i++)
+    mat_destroy(mats[i]);
+}
+
+int main(void)
+{
+  test_mixed();
+  test_dense_helper();
+  return check_finish("chain");
+}
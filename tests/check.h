@@ -0,0 +1,54 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// Minimal assertions for the module tests. A failed check reports its
+// location and the test keeps going, so one run lists every mismatch; main
+// returns check_finish() so ctest sees the failure.
+static int check_failures = 0;
+
+#define CHECK(cond)                                                            \
+  do                                                                           \
+  {                                                                            \
+    if (!(cond))                                                               \
+    {                                                                          \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      check_failures++;                                                        \
+    }                                                                          \
+  } while (0)
+
+// Compares two integer expressions and prints both values on a mismatch
+#define CHECK_EQ(actual, expected)                                                                   \
+  do                                                                                                 \
+  {                                                                                                  \
+    long long check_a = (long long)(actual), check_e = (long long)(expected);                        \
+    if (check_a != check_e)                                                                          \
+    {                                                                                                \
+      fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #actual, \
+              #expected, check_a, check_e);                                                          \
+      check_failures++;                                                                              \
+    }                                                                                                \
+  } while (0)
+
+// Deterministic xorshift generator so every run checks the same inputs
+static unsigned long long check_rng_state = 0x9E3779B97F4A7C15ULL;
+
+static inline unsigned int check_rand(void)
+{
+  check_rng_state ^= check_rng_state << 13;
+  check_rng_state ^= check_rng_state >> 7;
+  check_rng_state ^= check_rng_state << 17;
+  return (unsigned int)(check_rng_state >> 32);
+}
+
+static inline int check_finish(const char *name)
+{
+  if (check_failures > 0)
+    fprintf(stderr, "%s: %d check(s) failed\n", name, check_failures);
+  else
+    printf("%s: ok\n", name);
+  return check_failures > 0;
+}
+
+#endif // CHECK_H
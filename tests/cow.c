@@ -0,0 +1,207 @@
+// Copy-on-write arrays: a family of handles (the original and snapshots of
+// snapshots) each checked against its own array through random writes and
+// appends, chunk sharing after writes, a snapshot read on another thread
+// while the original is written, and the matrix wrapper
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../cow/cow.h"
+#include "../vector/vector.h"
+#include "check.h"
+
+#define COW_HANDLES 6
+#define COW_MAX 6000
+
+static CowVec *handles[COW_HANDLES];
+static int *refs[COW_HANDLES];
+static size_t ref_lens[COW_HANDLES];
+
+static void check_handle(int h)
+{
+  CHECK_EQ(cow_vec_length(handles[h]), ref_lens[h]);
+  for (size_t i = 0; i < ref_lens[h]; i++)
+  {
+    const int *elem = cow_vec_get(handles[h], i);
+    CHECK(elem != NULL);
+    if (elem)
+      CHECK_EQ(*elem, refs[h][i]);
+  }
+  CHECK(cow_vec_get(handles[h], ref_lens[h]) == NULL);
+}
+
+static void replace_with_snapshot(int h, int from)
+{
+  CowVec *snap = cow_vec_snapshot(handles[from]); // Before the destroy: from may equal h
+  CHECK(snap != NULL);
+  cow_vec_destroy(handles[h]);
+  handles[h] = snap;
+  if (from != h)
+    memcpy(refs[h], refs[from], ref_lens[from] * sizeof(int));
+  ref_lens[h] = ref_lens[from];
+}
+
+static void test_family(void)
+{
+  for (int h = 0; h < COW_HANDLES; h++)
+    refs[h] = malloc(COW_MAX * sizeof(int));
+  handles[0] = cow_vec_new(sizeof(int));
+  ref_lens[0] = 0;
+  for (int i = 0; i < 3000; i++)
+  {
+    refs[0][i] = i;
+    CHECK(cow_vec_append(handles[0], &i));
+    ref_lens[0]++;
+  }
+  for (int h = 1; h < COW_HANDLES; h++)
+    replace_with_snapshot(h, h - 1);
+  CHECK(handles[1]->table == handles[0]->table); // A snapshot only shares the table
+
+  for (int op = 0; op < 20000; op++)
+  {
+    int h = (int)(check_rand() % COW_HANDLES);
+    unsigned kind = check_rand() % 20;
+    int value = (int)check_rand();
+    if (kind == 0)
+      replace_with_snapshot(h, (int)(check_rand() % COW_HANDLES));
+    else if (kind < 4 && ref_lens[h] < COW_MAX)
+    {
+      CHECK(cow_vec_append(handles[h], &value));
+      refs[h][ref_lens[h]++] = value;
+    }
+    else if (ref_lens[h] > 0)
+    {
+      size_t index = check_rand() % ref_lens[h];
+      if (kind % 2)
+        CHECK(cow_vec_set(handles[h], index, &value));
+      else
+      {
+        int *elem = cow_vec_get_mut(handles[h], index);
+        CHECK(elem != NULL);
+        if (elem)
+          *elem = value;
+      }
+      refs[h][index] = value;
+    }
+    if (op % 2000 == 0)
+    {
+      for (int k = 0; k < COW_HANDLES; k++)
+        check_handle(k);
+    }
+  }
+  for (int h = 0; h < COW_HANDLES; h++)
+  {
+    check_handle(h);
+    cow_vec_destroy(handles[h]);
+    free(refs[h]);
+  }
+}
+
+// One write copies the table and the chunk written; the other chunks stay shared
+static void test_sharing(void)
+{
+  CowVec *vec = cow_vec_new(sizeof(int));
+  for (int i = 0; i < 5000; i++)
+    cow_vec_append(vec, &i);
+  CowVec *snap = cow_vec_snapshot(vec);
+  int value = -1;
+  CHECK(cow_vec_set(vec, 0, &value));
+  CHECK(vec->table != snap->table);
+  CHECK(vec->table->chunks[0] != snap->table->chunks[0]);
+  for (size_t k = 1; k < snap->table->count; k++)
+    CHECK(vec->table->chunks[k] == snap->table->chunks[k]);
+  CHECK_EQ(*(const int *)cow_vec_get(snap, 0), 0);
+
+  Vec *flat = cow_vec_to_vec(vec);
+  CowVec *back = cow_vec_from_vec(flat);
+  CHECK(flat && back && flat->length == 5000);
+  for (size_t i = 0; flat && back && i < 5000; i++)
+  {
+    CHECK_EQ(*(int *)vec_get(flat, i), i == 0 ? -1 : (int)i);
+    CHECK_EQ(*(const int *)cow_vec_get(back, i), *(int *)vec_get(flat, i));
+  }
+  vec_destroy(flat);
+  cow_vec_destroy(back);
+  cow_vec_destroy(vec);
+  cow_vec_destroy(snap);
+}
+
+static CowVec *reader_snapshot;
+static atomic_int reader_errors;
+
+static void *reader(void *arg)
+{
+  (void)arg;
+  for (int pass = 0; pass < 20; pass++)
+  {
+    for (size_t i = 0; i < cow_vec_length(reader_snapshot); i++)
+    {
+      if (*(const int *)cow_vec_get(reader_snapshot, i) != (int)i)
+        atomic_fetch_add(&reader_errors, 1);
+    }
+  }
+  return NULL;
+}
+
+static void test_threaded_reader(void)
+{
+  CowVec *vec = cow_vec_new(sizeof(int));
+  for (int i = 0; i < 4000; i++)
+    cow_vec_append(vec, &i);
+  reader_snapshot = cow_vec_snapshot(vec);
+  pthread_t thread;
+  pthread_create(&thread, NULL, reader, NULL);
+  for (int i = 0; i < 20000; i++)
+  {
+    int value = -i;
+    cow_vec_set(vec, check_rand() % 4000, &value);
+    if (i % 1000 == 0)
+      cow_vec_append(vec, &value);
+  }
+  pthread_join(thread, NULL);
+  CHECK_EQ(atomic_load(&reader_errors), 0);
+  cow_vec_destroy(reader_snapshot);
+  cow_vec_destroy(vec);
+}
+
+static void test_matrix(void)
+{
+  Mat *dense = mat_new(40, 70);
+  for (int r = 0; r < 40; r++)
+  {
+    for (int c = 0; c < 70; c++)
+      matrix_set(dense, r, c, r * 100 + c);
+  }
+  CowMat *mat = cow_mat_from_mat(dense);
+  CowMat *snap = cow_mat_snapshot(mat);
+  CHECK(mat && snap);
+  CHECK(cow_mat_set(mat, 39, 69, -5));
+  CHECK(!cow_mat_set(mat, 40, 0, 1));
+  CHECK_EQ(cow_mat_get(snap, 39, 69), 3969);
+  Mat *out = cow_mat_to_mat(mat);
+  for (int r = 0; r < 40; r++)
+  {
+    for (int c = 0; c < 70; c++)
+    {
+      int expected = r == 39 && c == 69 ? -5 : r * 100 + c;
+      CHECK_EQ(cow_mat_get(mat, r, c), expected);
+      CHECK_EQ(matrix_get(out, r, c), expected);
+      CHECK_EQ(cow_mat_get(snap, r, c), r * 100 + c);
+    }
+  }
+  CowMat *zeros = cow_mat_new(3, 3);
+  CHECK(zeros && cow_mat_get(zeros, 2, 2) == 0);
+  cow_mat_destroy(zeros);
+  mat_destroy(out);
+  mat_destroy(dense);
+  cow_mat_destroy(mat);
+  cow_mat_destroy(snap);
+}
+
+int main(void)
+{
+  test_family();
+  test_sharing();
+  test_threaded_reader();
+  test_matrix();
+  return check_finish("cow");
+}
@@ -0,0 +1,167 @@
+// CSR matrices against dense arrays: conversions (first-wins for repeated
+// COO coordinates), transpose, add with cancellation, and spmv with
+// full-range vectors summed in wrapping unsigned arithmetic
+#include <stdlib.h>
+#include "../csr/csr.h"
+#include "check.h"
+
+#define CSR_TRIALS 30
+#define CSR_MAX_DIM 40
+
+// Sorted columns, no stored zeros, consistent offsets
+static void check_shape(CsrMat *mat, int nrows, int ncols)
+{
+  CHECK_EQ(mat->nrows, nrows);
+  CHECK_EQ(mat->ncols, ncols);
+  CHECK_EQ(mat->row_ptr[0], 0);
+  CHECK_EQ(mat->row_ptr[nrows], mat->nnz);
+  for (int r = 0; r < nrows; r++)
+  {
+    CHECK(mat->row_ptr[r] <= mat->row_ptr[r + 1]);
+    for (size_t k = mat->row_ptr[r]; k < mat->row_ptr[r + 1]; k++)
+    {
+      CHECK(mat->values[k] != 0);
+      CHECK(mat->col_idx[k] >= 0 && mat->col_idx[k] < ncols);
+      if (k > mat->row_ptr[r])
+        CHECK(mat->col_idx[k - 1] < mat->col_idx[k]);
+    }
+  }
+}
+
+// Every entry of mat against ref (row-major), transposed when flip is set
+static void check_values(CsrMat *mat, const int *ref, int ref_cols, int flip)
+{
+  check_shape(mat, mat->nrows, mat->ncols);
+  Mat *dense = csr_to_mat(mat);
+  for (int r = 0; r < mat->nrows; r++)
+  {
+    for (int c = 0; c < mat->ncols; c++)
+    {
+      int expected = flip ? ref[(size_t)c * ref_cols + r] : ref[(size_t)r * ref_cols + c];
+      CHECK_EQ(csr_get(mat, r, c), expected);
+      CHECK_EQ(matrix_get(dense, r, c), expected);
+    }
+  }
+  mat_destroy(dense);
+}
+
+// Random COO matrix with repeated coordinates; ref gets the first value stored
+static SparseMat *random_sparse(int nrows, int ncols, int *ref)
+{
+  SparseMat *mat = sparse_new(nrows, ncols);
+  char *stored = calloc((size_t)nrows * ncols, 1);
+  int writes = (int)(check_rand() % (unsigned)(2 * nrows * ncols + 1));
+  for (int w = 0; w < writes; w++)
+  {
+    int r = (int)(check_rand() % (unsigned)nrows), c = (int)(check_rand() % (unsigned)ncols);
+    int value = (int)(check_rand() % 11) - 5;
+    sparse_add(mat, r, c, value);
+    size_t at = (size_t)r * ncols + c;
+    if (value != 0 && !stored[at])
+    {
+      ref[at] = value;
+      stored[at] = 1;
+    }
+  }
+  free(stored);
+  return mat;
+}
+
+static void test_random(void)
+{
+  for (int trial = 0; trial < CSR_TRIALS; trial++)
+  {
+    int nrows = 1 + (int)(check_rand() % CSR_MAX_DIM), ncols = 1 + (int)(check_rand() % CSR_MAX_DIM);
+    size_t size = (size_t)nrows * ncols;
+    int *ref_a = calloc(size, sizeof(int)), *ref_b = calloc(size, sizeof(int));
+    SparseMat *sa = random_sparse(nrows, ncols, ref_a);
+    // b negates a in every other row so those sums cancel
+    for (int r = 0; r < nrows; r += 2)
+    {
+      for (int c = 0; c < ncols; c++)
+        ref_b[(size_t)r * ncols + c] = -ref_a[(size_t)r * ncols + c];
+    }
+    SparseMat *sb = sparse_new(nrows, ncols);
+    for (size_t at = 0; at < size; at++)
+    {
+      if (ref_b[at] == 0 && check_rand() % 4 == 0)
+        ref_b[at] = (int)(check_rand() % 5) + 1;
+      if (ref_b[at] != 0)
+        sparse_add(sb, (int)(at / (size_t)ncols), (int)(at % (size_t)ncols), ref_b[at]);
+    }
+
+    CsrMat *a = csr_from_sparse(sa), *b = csr_from_sparse(sb);
+    CHECK(a && b);
+    if (!a || !b)
+      break;
+    check_values(a, ref_a, ncols, 0);
+    check_values(b, ref_b, ncols, 0);
+
+    CsrMat *t = csr_transpose(a);
+    check_values(t, ref_a, ncols, 1);
+    CsrMat *tt = csr_transpose(t);
+    check_values(tt, ref_a, ncols, 0);
+
+    int *ref_sum = malloc(size * sizeof(int));
+    for (size_t at = 0; at < size; at++)
+      ref_sum[at] = ref_a[at] + ref_b[at];
+    CsrMat *sum = csr_add(a, b);
+    check_values(sum, ref_sum, ncols, 0);
+
+    // Round trips through COO and a dense Mat
+    SparseMat *coo = csr_to_sparse(a);
+    CsrMat *again = csr_from_sparse(coo);
+    check_values(again, ref_a, ncols, 0);
+    Mat *dense = csr_to_mat(a);
+    CsrMat *from_dense = csr_from_mat(dense);
+    check_values(from_dense, ref_a, ncols, 0);
+
+    int *x = malloc((size_t)ncols * sizeof(int)), *y = malloc((size_t)nrows * sizeof(int));
+    for (int c = 0; c < ncols; c++)
+      x[c] = (int)check_rand();
+    CHECK(csr_spmv(a, x, y));
+    for (int r = 0; r < nrows; r++)
+    {
+      unsigned expected = 0;
+      for (int c = 0; c < ncols; c++)
+        expected += (unsigned)ref_a[(size_t)r * ncols + c] * (unsigned)x[c];
+      CHECK_EQ(y[r], (int)expected);
+    }
+
+    free(x);
+    free(y);
+    free(ref_a);
+    free(ref_b);
+    free(ref_sum);
+    mat_destroy(dense);
+    sparse_mat_destroy(sa);
+    sparse_mat_destroy(sb);
+    sparse_mat_destroy(coo);
+    csr_destroy(a);
+    csr_destroy(b);
+    csr_destroy(t);
+    csr_destroy(tt);
+    csr_destroy(sum);
+    csr_destroy(again);
+    csr_destroy(from_dense);
+  }
+}
+
+static void test_errors(void)
+{
+  CsrMat *a = csr_new(3, 4, 0), *b = csr_new(4, 3, 0);
+  CHECK(a && b);
+  CHECK(csr_add(a, b) == NULL);
+  CHECK(csr_from_sparse(NULL) == NULL);
+  int x[4] = {0};
+  CHECK(!csr_spmv(a, x, NULL));
+  csr_destroy(a);
+  csr_destroy(b);
+}
+
+int main(void)
+{
+  test_random();
+  test_errors();
+  return check_finish("csr");
+}
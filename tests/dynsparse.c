@@ -0,0 +1,143 @@
+// Concurrent updates against a dense array per writer, with the background
+// compactor folding them in and a reader holding snapshots meanwhile; then
+// snapshot isolation and spmv after compaction
+#include <pthread.h>
+#include <stdlib.h>
+#include "../dynsparse/dynsparse.h"
+#include "check.h"
+
+#define DYN_N 64
+#define DYN_WRITERS 4
+#define DYN_BAND (DYN_N / DYN_WRITERS) // Rows owned by each writer
+#define DYN_SETS 5000
+
+static DynSparse *dyn;
+static int dense[DYN_N][DYN_N];
+static atomic_int writers_done;
+static int snapshot_failures; // Written by the reader only, read after join
+
+// Each writer owns a band of rows, so its updates to the reference are ordered
+static void *writer(void *arg)
+{
+  int t = (int)(long)arg;
+  unsigned long long state = 0x9E3779B97F4A7C15ULL + (unsigned long long)t;
+  for (int i = 0; i < DYN_SETS; i++)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    int row = t * DYN_BAND + (int)(state % DYN_BAND), col = (int)((state >> 16) % DYN_N);
+    int value = (int)((state >> 32) % 5) - 2; // 0 deletes
+    if (dyn_sparse_set(dyn, row, col, value))
+      dense[row][col] = value;
+  }
+  atomic_fetch_add(&writers_done, 1);
+  return NULL;
+}
+
+// Snapshots published mid-stream are well-formed CSR and stay so while held
+static void *reader(void *arg)
+{
+  (void)arg;
+  unsigned long last = 0;
+  while (atomic_load(&writers_done) < DYN_WRITERS)
+  {
+    DynSnapshot *snap = dyn_sparse_snapshot(dyn);
+    CsrMat *csr = snap->csr;
+    if (snap->version < last || csr->row_ptr[DYN_N] != csr->nnz)
+      snapshot_failures++;
+    last = snap->version;
+    for (int r = 0; r < DYN_N; r++)
+    {
+      for (size_t k = csr->row_ptr[r]; k < csr->row_ptr[r + 1]; k++)
+      {
+        if (csr->values[k] == 0 || (k > csr->row_ptr[r] && csr->col_idx[k - 1] >= csr->col_idx[k]))
+          snapshot_failures++;
+      }
+    }
+    dyn_snapshot_release(snap);
+  }
+  return NULL;
+}
+
+static void check_contents(void)
+{
+  for (int r = 0; r < DYN_N; r++)
+  {
+    for (int c = 0; c < DYN_N; c++)
+      CHECK_EQ(dyn_sparse_get(dyn, r, c), dense[r][c]);
+  }
+}
+
+static void test_concurrent(void)
+{
+  SparseMat *initial = sparse_new(DYN_N, DYN_N);
+  for (int r = 0; r < DYN_N; r++)
+  {
+    for (int c = (r * 7) % 5; c < DYN_N; c += 5)
+    {
+      dense[r][c] = r - c;
+      sparse_add(initial, r, c, r - c);
+    }
+  }
+  dyn = dyn_sparse_from_sparse(initial);
+  sparse_mat_destroy(initial);
+  CHECK(dyn != NULL);
+  if (!dyn)
+    return;
+  check_contents();
+
+  CHECK(dyn_sparse_start_compactor(dyn, 100));
+  pthread_t writers[DYN_WRITERS], read_thread;
+  pthread_create(&read_thread, NULL, reader, NULL);
+  for (long t = 0; t < DYN_WRITERS; t++)
+    pthread_create(&writers[t], NULL, writer, (void *)t);
+  for (int t = 0; t < DYN_WRITERS; t++)
+    pthread_join(writers[t], NULL);
+  pthread_join(read_thread, NULL);
+  dyn_sparse_stop_compactor(dyn);
+  CHECK_EQ(snapshot_failures, 0);
+  DynSnapshot *background = dyn_sparse_snapshot(dyn);
+  CHECK(background->version > 0); // The compactor woke up during the writes
+  dyn_snapshot_release(background);
+  check_contents();
+
+  // A held snapshot keeps its contents through later compactions
+  CHECK(dyn_sparse_compact(dyn));
+  CHECK_EQ(dyn_sparse_pending(dyn), 0);
+  DynSnapshot *held = dyn_sparse_snapshot(dyn);
+  CHECK(held->version > 0);
+  for (int r = 0; r < DYN_N; r++)
+    dyn_sparse_set(dyn, r, r, 1000 + r);
+  CHECK_EQ(dyn_sparse_pending(dyn), DYN_N);
+  CHECK(dyn_sparse_compact(dyn));
+  for (int r = 0; r < DYN_N; r++)
+  {
+    for (int c = 0; c < DYN_N; c++)
+      CHECK_EQ(csr_get(held->csr, r, c), dense[r][c]);
+    dense[r][r] = 1000 + r;
+  }
+  dyn_snapshot_release(held);
+  check_contents();
+
+  int x[DYN_N], y[DYN_N];
+  for (int c = 0; c < DYN_N; c++)
+    x[c] = (int)(check_rand() % 201) - 100;
+  CHECK(dyn_sparse_spmv(dyn, x, y));
+  for (int r = 0; r < DYN_N; r++)
+  {
+    int expected = 0;
+    for (int c = 0; c < DYN_N; c++)
+      expected += dense[r][c] * x[c];
+    CHECK_EQ(y[r], expected);
+  }
+
+  CHECK(!dyn_sparse_set(dyn, DYN_N, 0, 1));
+  dyn_sparse_destroy(dyn);
+}
+
+int main(void)
+{
+  test_concurrent();
+  return check_finish("dynsparse");
+}
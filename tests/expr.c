@@ -0,0 +1,168 @@
+// Random expression trees evaluated by expr_eval against a direct recursive
+// evaluation, including destinations that appear inside the expression
+#include <stdlib.h>
+#include <string.h>
+#include "../expr/expr.h"
+#include "check.h"
+
+#define EXPR_LEAVES 16
+#define EXPR_TREES 300
+
+static Mat *leaves[EXPR_LEAVES]; // Every leaf of the current tree (at most 2^3 + 1)
+static int nleaves = 0;
+
+static void free_leaves(void)
+{
+  for (int i = 0; i < nleaves; i++)
+    mat_destroy(leaves[i]);
+  nleaves = 0;
+}
+
+static Mat *leaf(int nrows, int ncols)
+{
+  // Reuse a leaf of this shape half the time, so matrices repeat within a tree
+  for (int i = 0; i < nleaves; i++)
+  {
+    if (leaves[i]->nrows == nrows && leaves[i]->ncols == ncols && check_rand() % 2)
+      return leaves[i];
+  }
+  Mat *mat = mat_new(nrows, ncols);
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      matrix_set(mat, i, j, (int)(check_rand() % 7) - 3);
+  }
+  leaves[nleaves++] = mat;
+  return mat;
+}
+
+static Expr *random_expr(int nrows, int ncols, int depth)
+{
+  unsigned kind = depth == 0 ? 0 : check_rand() % 5;
+  switch (kind)
+  {
+  case 0:
+    return expr_mat(leaf(nrows, ncols));
+  case 1:
+    return expr_add(random_expr(nrows, ncols, depth - 1), random_expr(nrows, ncols, depth - 1));
+  case 2:
+    return expr_sub(random_expr(nrows, ncols, depth - 1), random_expr(nrows, ncols, depth - 1));
+  case 3:
+    return expr_scale((int)(check_rand() % 5) - 2, random_expr(nrows, ncols, depth - 1));
+  default:
+  {
+    int inner = 1 + (int)(check_rand() % 9);
+    return expr_mul(random_expr(nrows, inner, depth - 1), random_expr(inner, ncols, depth - 1));
+  }
+  }
+}
+
+// Reference: evaluates e into a new nrows x ncols array
+static int *reference(Expr *e)
+{
+  int *out = calloc((size_t)e->nrows * (size_t)e->ncols, sizeof(int));
+  int *l = NULL, *r = NULL;
+  if (e->kind != EXPR_MAT)
+    l = reference(e->lhs);
+  if (e->kind == EXPR_ADD || e->kind == EXPR_SUB || e->kind == EXPR_MUL)
+    r = reference(e->rhs);
+  for (int i = 0; i < e->nrows; i++)
+  {
+    for (int j = 0; j < e->ncols; j++)
+    {
+      int *cell = &out[(size_t)i * e->ncols + j];
+      size_t at = (size_t)i * e->ncols + j;
+      switch (e->kind)
+      {
+      case EXPR_MAT:
+        *cell = matrix_get(e->mat, i, j);
+        break;
+      case EXPR_ADD:
+        *cell = l[at] + r[at];
+        break;
+      case EXPR_SUB:
+        *cell = l[at] - r[at];
+        break;
+      case EXPR_SCALE:
+        *cell = e->scalar * l[at];
+        break;
+      case EXPR_MUL:
+        for (int p = 0; p < e->lhs->ncols; p++)
+          *cell += l[(size_t)i * e->lhs->ncols + p] * r[(size_t)p * e->ncols + j];
+        break;
+      }
+    }
+  }
+  free(l);
+  free(r);
+  return out;
+}
+
+static void check_mat(Mat *mat, const int *expected, const int *base)
+{
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    for (int j = 0; j < mat->ncols; j++)
+    {
+      size_t at = (size_t)i * mat->ncols + j;
+      CHECK_EQ(matrix_get(mat, i, j), expected[at] + (base ? base[at] : 0));
+    }
+  }
+}
+
+static void test_trees(void)
+{
+  for (int t = 0; t < EXPR_TREES; t++)
+  {
+    int nrows = 1 + (int)(check_rand() % 12), ncols = 1 + (int)(check_rand() % 12);
+    Expr *e = random_expr(nrows, ncols, 1 + (int)(check_rand() % 3));
+    CHECK(e != NULL);
+    if (!e)
+    {
+      free_leaves();
+      continue;
+    }
+    int *expected = reference(e);
+    Mat *fresh = expr_eval_new(e);
+    CHECK(fresh != NULL);
+    if (fresh)
+      check_mat(fresh, expected, NULL);
+
+    // Accumulate into the fresh result: fresh + e
+    if (fresh && expr_eval_accumulate(e, fresh))
+      check_mat(fresh, expected, expected);
+    mat_destroy(fresh);
+
+    // Destination aliased with a leaf of the tree
+    Mat *dst = leaf(nrows, ncols);
+    Expr *aliased = expr_add(expr_mat(dst), e);
+    int *expected_aliased = reference(aliased);
+    CHECK(expr_eval(aliased, dst));
+    check_mat(dst, expected_aliased, NULL);
+    expr_destroy(aliased); // Also frees e
+    free(expected);
+    free(expected_aliased);
+    free_leaves();
+  }
+}
+
+static void test_errors(void)
+{
+  Mat *a = mat_new(2, 3), *b = mat_new(3, 2);
+  CHECK(expr_add(expr_mat(a), expr_mat(b)) == NULL);
+  CHECK(expr_mul(expr_mat(a), expr_mat(a)) == NULL);
+  CHECK(expr_add(expr_mat(a), NULL) == NULL);
+  Expr *e = expr_mul(expr_mat(a), expr_mat(b));
+  CHECK(e != NULL);
+  CHECK(!expr_eval(e, a)); // 2x2 result, 2x3 destination
+  expr_destroy(e);
+  mat_destroy(a);
+  mat_destroy(b);
+}
+
+int main(void)
+{
+  test_trees();
+  test_errors();
+  return check_finish("expr");
+}
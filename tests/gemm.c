@@ -0,0 +1,193 @@
+// Blocked, transposed and Strassen products against a naive triple loop
+#include <stdlib.h>
+#include <string.h>
+#include "../gemm/gemm.h"
+#include "../matrix/matrix.h"
+#include "../strassen/strassen.h"
+#include "check.h"
+
+// A contiguous matrix with its row pointers, viewed as a MatView
+typedef struct
+{
+  int *data;
+  int **rows;
+  MatView view;
+} Block;
+
+static Block block_new(int nrows, int ncols, int fill)
+{
+  Block b;
+  b.data = malloc(sizeof(int) * (size_t)(nrows > 0 ? nrows : 1) * (size_t)(ncols > 0 ? ncols : 1));
+  b.rows = malloc(sizeof(int *) * (size_t)(nrows > 0 ? nrows : 1));
+  for (int i = 0; i < nrows; i++)
+  {
+    b.rows[i] = b.data + (size_t)i * ncols;
+    for (int j = 0; j < ncols; j++)
+      b.rows[i][j] = fill ? (int)(check_rand() % 41) - 20 : 0;
+  }
+  b.view = (MatView){b.rows, 0, nrows, ncols};
+  return b;
+}
+
+static void block_free(Block *b)
+{
+  free(b->data);
+  free(b->rows);
+}
+
+#define AT(v, i, j) ((v).rows[i][(v).col + (j)])
+
+// Checks c == base + alpha * a * b, where base is c's value before the call
+static void check_product(MatView c, MatView base, MatView a, MatView b, int alpha)
+{
+  for (int i = 0; i < c.nrows; i++)
+  {
+    for (int j = 0; j < c.ncols; j++)
+    {
+      int sum = 0;
+      for (int p = 0; p < a.ncols; p++)
+        sum += AT(a, i, p) * AT(b, p, j);
+      CHECK_EQ(AT(c, i, j), AT(base, i, j) + alpha * sum);
+    }
+  }
+}
+
+static void copy_view(MatView dst, MatView src)
+{
+  for (int i = 0; i < src.nrows; i++)
+    memcpy(&AT(dst, i, 0), &AT(src, i, 0), sizeof(int) * (size_t)src.ncols);
+}
+
+static void test_kernels(int m, int k, int n)
+{
+  Block a = block_new(m, k, 1), b = block_new(k, n, 1), bt = block_new(n, k, 0);
+  Block c = block_new(m, n, 1), base = block_new(m, n, 1), zero = block_new(m, n, 0);
+  for (int i = 0; i < k; i++)
+  {
+    for (int j = 0; j < n; j++)
+      bt.rows[j][i] = b.rows[i][j];
+  }
+
+  gemm_blocked(c.view, a.view, b.view, 0);
+  check_product(c.view, zero.view, a.view, b.view, 1);
+  copy_view(c.view, base.view);
+  gemm_blocked(c.view, a.view, b.view, 1);
+  check_product(c.view, base.view, a.view, b.view, 1);
+  copy_view(c.view, base.view);
+  gemm_blocked_update(c.view, a.view, b.view, -3);
+  check_product(c.view, base.view, a.view, b.view, -3);
+
+  gemm_transposed(c.view, a.view, bt.view, 0);
+  check_product(c.view, zero.view, a.view, b.view, 1);
+  copy_view(c.view, base.view);
+  gemm_transposed(c.view, a.view, bt.view, 1);
+  check_product(c.view, base.view, a.view, b.view, 1);
+
+  // Strassen with a small crossover so odd sizes peel at several levels
+  int crossovers[2] = {4, STRASSEN_CROSSOVER};
+  for (int t = 0; t < 2; t++)
+  {
+    StrassenWorkspace *ws = strassen_workspace_new(m, k, n, crossovers[t]);
+    CHECK(ws != NULL);
+    if (ws)
+    {
+      CHECK(strassen_mult(ws, c.view, a.view, b.view));
+      check_product(c.view, zero.view, a.view, b.view, 1);
+      strassen_workspace_destroy(ws);
+    }
+  }
+
+  block_free(&a);
+  block_free(&b);
+  block_free(&bt);
+  block_free(&c);
+  block_free(&base);
+  block_free(&zero);
+}
+
+// Sub-blocks: a product written into the middle of a larger matrix leaves
+// the rest untouched, and element-wise ops work on offset windows
+static void test_windows(void)
+{
+  Block big = block_new(20, 30, 1), saved = block_new(20, 30, 0), a = block_new(20, 30, 1);
+  Block zero = block_new(7, 11, 0);
+  copy_view(saved.view, big.view);
+  MatView c = mat_view_block(big.view, 3, 5, 7, 11);
+  MatView x = mat_view_block(a.view, 2, 1, 7, 9);
+  MatView y = mat_view_block(a.view, 10, 20, 9, 11);
+  gemm_blocked(c, x, y, 0);
+  for (int i = 0; i < 20; i++)
+  {
+    for (int j = 0; j < 30; j++)
+    {
+      if (i >= 3 && i < 10 && j >= 5 && j < 16)
+        continue;
+      CHECK_EQ(big.rows[i][j], saved.rows[i][j]);
+    }
+  }
+  check_product(c, zero.view, x, y, 1);
+  MatView p = mat_view_block(a.view, 0, 0, 5, 6), q = mat_view_block(a.view, 5, 6, 5, 6);
+  MatView d = mat_view_block(big.view, 12, 20, 5, 6);
+  mat_view_add(d, p, q);
+  for (int i = 0; i < 5; i++)
+  {
+    for (int j = 0; j < 6; j++)
+      CHECK_EQ(AT(d, i, j), AT(p, i, j) + AT(q, i, j));
+  }
+  mat_view_sub(d, p, q);
+  for (int i = 0; i < 5; i++)
+  {
+    for (int j = 0; j < 6; j++)
+      CHECK_EQ(AT(d, i, j), AT(p, i, j) - AT(q, i, j));
+  }
+  block_free(&big);
+  block_free(&saved);
+  block_free(&a);
+  block_free(&zero);
+}
+
+// mat_mult_mode on Mats: every kernel choice gives the naive product
+static void test_modes(int m, int k, int n)
+{
+  Mat *a = mat_new(m, k), *b = mat_new(k, n);
+  for (int i = 0; i < m; i++)
+  {
+    for (int j = 0; j < k; j++)
+      matrix_set(a, i, j, (int)(check_rand() % 41) - 20);
+  }
+  for (int i = 0; i < k; i++)
+  {
+    for (int j = 0; j < n; j++)
+      matrix_set(b, i, j, (int)(check_rand() % 41) - 20);
+  }
+  MatMultMode modes[3] = {MAT_MULT_AUTO, MAT_MULT_BLOCKED, MAT_MULT_STRASSEN};
+  for (int t = 0; t < 3; t++)
+  {
+    Mat *c = mat_mult_mode(a, b, modes[t]);
+    CHECK(c != NULL);
+    for (int i = 0; c && i < m; i++)
+    {
+      for (int j = 0; j < n; j++)
+      {
+        int sum = 0;
+        for (int p = 0; p < k; p++)
+          sum += matrix_get(a, i, p) * matrix_get(b, p, j);
+        CHECK_EQ(matrix_get(c, i, j), sum);
+      }
+    }
+    mat_destroy(c);
+  }
+  mat_destroy(a);
+  mat_destroy(b);
+}
+
+int main(void)
+{
+  int shapes[][3] = {{1, 1, 1}, {3, 5, 7}, {64, 64, 64}, {65, 63, 67}, {33, 300, 17}, {130, 129, 131}};
+  for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+    test_kernels(shapes[s][0], shapes[s][1], shapes[s][2]);
+  test_windows();
+  test_modes(5, 3, 9);
+  test_modes(129, 128, 140); // AUTO takes the Strassen path from the crossover up
+  return check_finish("gemm");
+}
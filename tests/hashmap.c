@@ -0,0 +1,200 @@
+// Hash tables against direct-address arrays over a small key universe, so
+// inserts, overwrites and many removes (tombstones) all recur. The generic
+// map also runs with a degenerate hash that puts every key on one probe
+// sequence, and iteration must visit each entry once.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hashmap/hashmap.h"
+#include "../string/string.h"
+#include "check.h"
+
+#define HASH_KEYS 4096
+#define HASH_OPS 60000
+
+static void test_intmap(void)
+{
+  IntMap *map = intmap_new();
+  CHECK(map != NULL);
+  if (!map)
+    return;
+  static int present[HASH_KEYS], values[HASH_KEYS];
+  size_t size = 0;
+  for (int op = 0; op < HASH_OPS; op++)
+  {
+    int slot = (int)(check_rand() % HASH_KEYS), key = slot - HASH_KEYS / 2; // Negative keys too
+    unsigned kind = check_rand() % 4;
+    int value = (int)check_rand(), got = 0;
+    if (kind < 2)
+    {
+      CHECK(intmap_put(map, key, value));
+      size += !present[slot];
+      present[slot] = 1;
+      values[slot] = value;
+    }
+    else if (kind == 2)
+    {
+      CHECK_EQ(intmap_remove(map, key), present[slot]);
+      size -= present[slot];
+      present[slot] = 0;
+    }
+    else
+    {
+      CHECK_EQ(intmap_get(map, key, &got), present[slot]);
+      if (present[slot])
+        CHECK_EQ(got, values[slot]);
+      CHECK_EQ(intmap_contains(map, key), present[slot]);
+    }
+    CHECK_EQ(intmap_size(map), size);
+  }
+  for (int slot = 0; slot < HASH_KEYS; slot++)
+  {
+    int got = 0;
+    CHECK_EQ(intmap_get(map, slot - HASH_KEYS / 2, &got), present[slot]);
+    if (present[slot])
+      CHECK_EQ(got, values[slot]);
+  }
+  CHECK(map->table.size * 8 <= map->table.capacity * 7);
+  intmap_destroy(map);
+}
+
+typedef struct
+{
+  int a;
+  short b;
+  char c;
+} Key; // Padded: keys are zeroed before use so the bytes hash consistently
+
+static uint64_t one_bucket(const void *key, size_t key_size)
+{
+  (void)key;
+  (void)key_size;
+  return 42;
+}
+
+static int key_eq(const void *a, const void *b, size_t key_size)
+{
+  (void)key_size;
+  const Key *x = a, *y = b;
+  return x->a == y->a && x->b == y->b && x->c == y->c;
+}
+
+static Key make_key(int slot)
+{
+  Key key;
+  memset(&key, 0, sizeof(key));
+  key.a = slot * 7919;
+  key.b = (short)(slot % 300);
+  key.c = (char)(slot % 7);
+  return key;
+}
+
+static void run_generic(HashFn hash, HashEqFn eq, int keys, int ops)
+{
+  HashMap *map = hashmap_new(sizeof(Key), sizeof(long long), hash, eq);
+  CHECK(map != NULL);
+  if (!map)
+    return;
+  int *present = calloc((size_t)keys, sizeof(int));
+  long long *values = calloc((size_t)keys, sizeof(long long));
+  for (int op = 0; op < ops; op++)
+  {
+    int slot = (int)(check_rand() % (unsigned)keys);
+    Key key = make_key(slot);
+    long long value = (long long)check_rand() << 20;
+    switch (check_rand() % 5)
+    {
+    case 0:
+    case 1:
+      CHECK(hashmap_put(map, &key, &value));
+      present[slot] = 1;
+      values[slot] = value;
+      break;
+    case 2:
+      CHECK_EQ(hashmap_remove(map, &key), present[slot]);
+      present[slot] = 0;
+      break;
+    case 3:
+      CHECK(hashmap_put(map, &key, NULL)); // Stores zeros
+      present[slot] = 1;
+      values[slot] = 0;
+      break;
+    default:
+    {
+      long long *got = hashmap_get(map, &key);
+      CHECK_EQ(got != NULL, present[slot]);
+      if (got && present[slot])
+        CHECK_EQ(*got, values[slot]);
+    }
+    }
+  }
+
+  size_t expected_size = 0;
+  for (int slot = 0; slot < keys; slot++)
+    expected_size += (size_t)present[slot];
+  CHECK_EQ(hashmap_size(map), expected_size);
+  int *visits = calloc((size_t)keys, sizeof(int));
+  size_t pos = 0;
+  void *k, *v;
+  while (hashmap_next(map, &pos, &k, &v))
+  {
+    const Key *key = k;
+    int slot = key->a / 7919;
+    CHECK(slot >= 0 && slot < keys && present[slot]);
+    if (slot >= 0 && slot < keys)
+    {
+      visits[slot]++;
+      CHECK_EQ(*(long long *)v, values[slot]);
+    }
+  }
+  for (int slot = 0; slot < keys; slot++)
+    CHECK_EQ(visits[slot], present[slot]);
+
+  hashmap_clear(map);
+  CHECK_EQ(hashmap_size(map), 0);
+  Key first = make_key(0);
+  CHECK(!hashmap_contains(map, &first));
+  free(visits);
+  free(present);
+  free(values);
+  hashmap_destroy(map);
+}
+
+static void test_strings(void)
+{
+  HashSet *set = hashset_new(sizeof(String *), hash_string, hash_string_eq);
+  String *words[64], *probes[64];
+  char text[32];
+  for (int i = 0; i < 64; i++)
+  {
+    snprintf(text, sizeof(text), "word-%d", i);
+    words[i] = String_new(8);
+    probes[i] = String_new(8); // Same contents, different object
+    String_append(words[i], text);
+    String_append(probes[i], text);
+  }
+  for (int i = 0; i < 64; i += 2)
+    CHECK(hashset_add(set, &words[i]));
+  CHECK(hashset_add(set, &words[0])); // Already present
+  CHECK_EQ(hashset_size(set), 32);
+  for (int i = 0; i < 64; i++)
+    CHECK_EQ(hashset_contains(set, &probes[i]), i % 2 == 0);
+  CHECK(hashset_remove(set, &probes[10]));
+  CHECK(!hashset_contains(set, &words[10]));
+  for (int i = 0; i < 64; i++)
+  {
+    String_destroy(words[i]);
+    String_destroy(probes[i]);
+  }
+  hashset_destroy(set);
+}
+
+int main(void)
+{
+  test_intmap();
+  run_generic(NULL, NULL, HASH_KEYS, HASH_OPS);
+  run_generic(one_bucket, key_eq, 200, 4000);
+  test_strings();
+  CHECK(hash_bytes("abc", 3) == hash_bytes("abc", 3) && hash_bytes("abc", 3) != hash_bytes("abd", 3));
+  return check_finish("hashmap");
+}
@@ -0,0 +1,90 @@
+// IntReader against parse_to_int on the same tokens, over a script larger
+// than the reader's block so tokens straddle refills
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../batch/batch.h"
+#include "../input/input.h"
+#include "../parser/parser.h"
+#include "check.h"
+
+#define INPUT_TOKENS 60000
+
+static void random_token(char *out, size_t size)
+{
+  static const char *odd[] = {"2147483647", "-2147483648", "2147483648", "-2147483649", "-", "--1", "12a",
+                              "+5", "0", "-0", "007", "99999999999"};
+  unsigned kind = check_rand() % 8;
+  if (kind == 0)
+    snprintf(out, size, "%s", odd[check_rand() % (sizeof(odd) / sizeof(odd[0]))]);
+  else
+    snprintf(out, size, "%d", (int)check_rand());
+}
+
+static void test_reader(const char *path)
+{
+  FILE *script = fopen(path, "w");
+  CHECK(script != NULL);
+  if (!script)
+    return;
+  static char tokens[INPUT_TOKENS][24];
+  for (int t = 0; t < INPUT_TOKENS; t++)
+  {
+    random_token(tokens[t], sizeof(tokens[t]));
+    fputs(tokens[t], script);
+    unsigned sep = check_rand() % 16;
+    fputs(sep == 0 ? " # comment 123 q\n" : sep < 4 ? "\n" : sep < 6 ? "\t " : " ", script);
+  }
+  fputs("q 5\n", script); // Nothing after q is read
+  fclose(script);
+
+  IntReader *r = int_reader_open(path);
+  CHECK(r != NULL);
+  if (!r)
+    return;
+  for (int t = 0; t < INPUT_TOKENS; t++)
+  {
+    int value = 0;
+    ReadStatus status = int_reader_next(r, &value);
+    Result expected = parse_to_int(tokens[t]);
+    CHECK_EQ(status, expected.status == OK ? READ_OK : READ_ERR);
+    if (status == READ_OK && expected.status == OK)
+      CHECK_EQ(value, *(int *)expected.data.ok);
+    destroy_result(&expected);
+  }
+  int value;
+  CHECK_EQ(int_reader_next(r, &value), READ_STOPPED);
+  int_reader_close(r);
+}
+
+static void test_args(void)
+{
+  const char *path = NULL;
+  char *argv1[] = {"prog", "--batch", "script.txt", "--format", "tsv"};
+  CHECK(batch_requested(5, argv1, &path));
+  CHECK(path && strcmp(path, "script.txt") == 0);
+  CHECK(strcmp(batch_option(5, argv1, "--format"), "tsv") == 0);
+  char *argv2[] = {"prog", "--batch", "--format", "tsv"};
+  CHECK(batch_requested(4, argv2, &path));
+  CHECK(path && strcmp(path, "-") == 0);
+  char *argv3[] = {"prog"};
+  CHECK(!batch_requested(1, argv3, &path));
+  CHECK(batch_option(1, argv3, "--format") == NULL);
+}
+
+int main(void)
+{
+  char path[] = "/tmp/lab-input-XXXXXX";
+  int fd = mkstemp(path);
+  CHECK(fd >= 0);
+  if (fd >= 0)
+  {
+    close(fd);
+    test_reader(path);
+    unlink(path);
+  }
+  test_args();
+  return check_finish("input");
+}
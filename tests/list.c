@@ -0,0 +1,386 @@
+// Linked list operations against an array holding the same sequence, and
+// list_sort against qsort with ties broken by original position (stability),
+// and jump-table walks against the plain walk, also after edits the table has
+// not seen
+#include <stdlib.h>
+#include "../list/list.h"
+#include "check.h"
+
+#define LIST_OPS 4000
+#define LIST_MAX 512
+
+// Walks the list and compares it with ref[0..n)
+static void check_list(Node *head, const int *ref, int n)
+{
+  int i = 0;
+  for (Node *node = head; node != NULL; node = node->next, i++)
+  {
+    if (i < n)
+      CHECK_EQ(node->data, ref[i]);
+  }
+  CHECK_EQ(i, n);
+}
+
+static void test_random_ops(void)
+{
+  Node *head = NULL;
+  int ref[LIST_MAX + 1];
+  int n = 0;
+  for (int op = 0; op < LIST_OPS; op++)
+  {
+    int kind = (int)(check_rand() % 6);
+    int value = (int)(check_rand() % 1000);
+    int out = -1;
+    if (n == LIST_MAX && kind < 3)
+      kind += 3; // Full: delete instead
+    if (n == 0 && kind >= 3)
+      kind -= 3; // Empty: insert instead
+    switch (kind)
+    {
+    case 0:
+      CHECK(insert_at_head(&head, value));
+      for (int i = n; i > 0; i--)
+        ref[i] = ref[i - 1];
+      ref[0] = value;
+      n++;
+      break;
+    case 1:
+      CHECK(insert_at_tail(&head, value));
+      ref[n++] = value;
+      break;
+    case 2:
+    {
+      int index = (int)(check_rand() % (unsigned)(n + 1));
+      CHECK(insert_at_index(&head, value, index));
+      for (int i = n; i > index; i--)
+        ref[i] = ref[i - 1];
+      ref[index] = value;
+      n++;
+      break;
+    }
+    case 3:
+      CHECK(delete_at_head(&head, &out));
+      CHECK_EQ(out, ref[0]);
+      for (int i = 0; i + 1 < n; i++)
+        ref[i] = ref[i + 1];
+      n--;
+      break;
+    case 4:
+      CHECK(delete_at_tail(&head, &out));
+      CHECK_EQ(out, ref[n - 1]);
+      n--;
+      break;
+    default:
+    {
+      int index = (int)(check_rand() % (unsigned)n);
+      CHECK(delete_at_index(&head, index, &out));
+      CHECK_EQ(out, ref[index]);
+      for (int i = index; i + 1 < n; i++)
+        ref[i] = ref[i + 1];
+      n--;
+      break;
+    }
+    }
+  }
+  check_list(head, ref, n);
+  destroy_list(&head);
+  CHECK(head == NULL);
+}
+
+static void test_empty(void)
+{
+  Node *head = NULL;
+  int out;
+  CHECK(!delete_at_head(&head, &out));
+  CHECK(!delete_at_tail(&head, &out));
+  CHECK(!delete_at_index(&head, 0, NULL));
+  CHECK(!insert_at_index(&head, 1, -1));
+  CHECK(head == NULL);
+}
+
+typedef struct
+{
+  Node *node;
+  int position;
+} SortKey;
+
+static int sort_key_cmp(const void *a, const void *b)
+{
+  const SortKey *x = a, *y = b;
+  if (x->node->data != y->node->data)
+    return x->node->data < y->node->data ? -1 : 1;
+  return x->position - y->position;
+}
+
+static int count_visit(Node *node, void *ctx)
+{
+  int *remaining = ctx;
+  (void)node;
+  return --*remaining > 0;
+}
+
+static int free_visit(Node *node, void *ctx)
+{
+  (void)ctx;
+  free_node(node);
+  return 1;
+}
+
+static void test_bulk_and_sort(void)
+{
+  for (int trial = 0; trial < 20; trial++)
+  {
+    // A few heap nodes followed by two slabs, with deletes punching holes in the slabs
+    Node *head = NULL;
+    int n = (int)(check_rand() % 5);
+    for (int i = 0; i < n; i++)
+      insert_at_tail(&head, (int)(check_rand() % 50));
+    for (int slab = 0; slab < 2; slab++)
+    {
+      int count = (int)(check_rand() % (LIST_MAX / 2)), values[LIST_MAX / 2];
+      for (int i = 0; i < count; i++)
+        values[i] = (int)(check_rand() % 50); // Many ties
+      CHECK(list_from_array(&head, values, (size_t)count));
+      n += count;
+    }
+    for (int d = 0; d < n / 4; d++)
+    {
+      delete_at_index(&head, (int)(check_rand() % (unsigned)n), NULL);
+      n--;
+    }
+
+    int ref[LIST_MAX + 5];
+    SortKey keys[LIST_MAX + 5];
+    CHECK_EQ(list_length(head), n);
+    CHECK_EQ(list_to_array(head, ref, LIST_MAX + 5), n);
+    check_list(head, ref, n);
+    if (n > 0)
+      CHECK_EQ(list_to_array(head, ref, 1), n); // Clipped copy still counts the whole list
+    int position = 0;
+    for (Node *node = head; node; node = node->next, position++)
+      keys[position] = (SortKey){node, position};
+    qsort(keys, (size_t)n, sizeof(SortKey), sort_key_cmp);
+
+    list_sort(&head);
+    int i = 0;
+    for (Node *node = head; node; node = node->next, i++)
+    {
+      if (i < n)
+        CHECK(node == keys[i].node); // Same node, so equal values kept their order
+    }
+    CHECK_EQ(i, n);
+
+    int remaining = n / 2 + 1;
+    CHECK_EQ(list_visit(head, count_visit, &remaining), n > 0 ? n / 2 + 1 : 0);
+    if (trial % 2)
+      destroy_list(&head);
+    else
+      list_visit(head, free_visit, NULL); // A visitor may free the node it is given
+  }
+  Node *head = NULL;
+  list_sort(&head);
+  CHECK(head == NULL);
+  CHECK(list_from_array(&head, NULL, 0));
+  CHECK(head == NULL);
+}
+
+typedef struct
+{
+  int values[LIST_MAX];
+  int count;
+  int stop_after; // 0 walks everything
+} Collected;
+
+static int collect_visit(Node *node, void *ctx)
+{
+  Collected *c = ctx;
+  if (c->count < LIST_MAX)
+    c->values[c->count] = node->data;
+  c->count++;
+  return c->stop_after == 0 || c->count < c->stop_after;
+}
+
+// A jump-table walk, sum and find agree with the plain walk over ref
+static void check_jumps(Node *head, ListJumps *jumps, const int *ref, int n)
+{
+  Collected all = {.count = 0, .stop_after = 0};
+  CHECK_EQ(list_visit_jumps(head, jumps, collect_visit, &all), n);
+  CHECK_EQ(all.count, n);
+  for (int i = 0; i < n && i < all.count; i++)
+    CHECK_EQ(all.values[i], ref[i]);
+  if (n > 2)
+  {
+    Collected part = {.count = 0, .stop_after = n / 2};
+    CHECK_EQ(list_visit_jumps(head, jumps, collect_visit, &part), n / 2);
+  }
+
+  long long sum = 0;
+  for (int i = 0; i < n; i++)
+    sum += ref[i];
+  CHECK_EQ(list_sum(head, jumps), sum);
+  CHECK_EQ(list_sum(head, NULL), sum);
+  for (int probe = 0; probe < 20; probe++)
+  {
+    int value = (int)(check_rand() % 120);
+    int first = -1;
+    for (int i = 0; i < n && first < 0; i++)
+    {
+      if (ref[i] == value)
+        first = i;
+    }
+    Node *expected = head;
+    for (int i = 0; i < first; i++)
+      expected = expected->next;
+    CHECK(list_find(head, jumps, value) == (first < 0 ? NULL : expected));
+    CHECK(list_find(head, NULL, value) == (first < 0 ? NULL : expected));
+  }
+}
+
+static void test_jumps(void)
+{
+  static const size_t strides[] = {0, 1, 3, 8, LIST_JUMP_MAX_STRIDE, 1000};
+  for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++)
+  {
+    Node *head = NULL;
+    int ref[LIST_MAX], n = (int)(check_rand() % (LIST_MAX - 40));
+    for (int i = 0; i < n; i++)
+      ref[i] = (int)(check_rand() % 100);
+    list_from_array(&head, ref, (size_t)n);
+    ListJumps *jumps = list_jumps_build(head, strides[s]);
+    CHECK(jumps != NULL);
+    if (!jumps)
+    {
+      destroy_list(&head);
+      continue;
+    }
+    CHECK(jumps->stride >= 1 && jumps->stride <= LIST_JUMP_MAX_STRIDE);
+    CHECK_EQ(jumps->length, n);
+    check_jumps(head, jumps, ref, n);
+
+    // Changing data needs no refresh; inserts and deletes do
+    for (Node *node = head; node; node = node->next)
+      node->data += 1;
+    for (int i = 0; i < n; i++)
+      ref[i] += 1;
+    check_jumps(head, jumps, ref, n);
+    for (int k = 0; k < 40; k++)
+    {
+      int index = (int)(check_rand() % (unsigned)(n + 1)), value = (int)(check_rand() % 100);
+      insert_at_index(&head, value, index);
+      for (int i = n; i > index; i--)
+        ref[i] = ref[i - 1];
+      ref[index] = value;
+      n++;
+    }
+    for (int k = 0; k < 20 && n > 0; k++)
+    {
+      int index = (int)(check_rand() % (unsigned)n);
+      delete_at_index(&head, index, NULL);
+      for (int i = index; i + 1 < n; i++)
+        ref[i] = ref[i + 1];
+      n--;
+    }
+    CHECK(list_jumps_refresh(jumps, head));
+    CHECK_EQ(jumps->length, n);
+    check_jumps(head, jumps, ref, n);
+
+    destroy_list_jumps(&head, jumps);
+    CHECK(head == NULL);
+    CHECK_EQ(jumps->count, 0);
+    CHECK(list_jumps_valid(jumps, NULL));
+    CHECK_EQ(list_visit_jumps(NULL, jumps, collect_visit, &(Collected){.count = 0}), 0);
+    list_jumps_destroy(jumps);
+  }
+}
+
+// Edits between refresh and walk: each one makes the table stale, walks fall
+// back to the plain visit and still match ref, and a refresh makes it valid again
+static void test_stale_jumps(void)
+{
+  int ref[LIST_MAX], n = 100;
+  for (int i = 0; i < n; i++)
+    ref[i] = (int)(check_rand() % 100);
+  Node *head = NULL, *other = NULL;
+  list_from_array(&head, ref, (size_t)n);
+  list_from_array(&other, ref, 10);
+  ListJumps *jumps = list_jumps_build(head, 8);
+  CHECK(jumps != NULL);
+  if (!jumps)
+    return;
+  CHECK(list_jumps_valid(jumps, head));
+  CHECK(!list_jumps_valid(jumps, other)); // Built for another list
+  long long other_sum = 0;
+  for (int i = 0; i < 10; i++)
+    other_sum += ref[i];
+  CHECK_EQ(list_sum(other, jumps), other_sum);
+  head->next->data = ref[1] = -5; // Data changes keep the table valid
+  CHECK(list_jumps_valid(jumps, head));
+
+  for (int edit = 0; edit < 7; edit++)
+  {
+    int value = 1000 + edit;
+    switch (edit)
+    {
+    case 0:
+      insert_at_head(&head, value);
+      for (int i = n; i > 0; i--)
+        ref[i] = ref[i - 1];
+      ref[0] = value;
+      n++;
+      break;
+    case 1: // Behind the first mark: the head is unchanged
+      insert_at_index(&head, value, 20);
+      for (int i = n; i > 20; i--)
+        ref[i] = ref[i - 1];
+      ref[20] = value;
+      n++;
+      break;
+    case 2:
+      delete_at_index(&head, 30, NULL);
+      for (int i = 30; i + 1 < n; i++)
+        ref[i] = ref[i + 1];
+      n--;
+      break;
+    case 3:
+      delete_at_tail(&head, NULL);
+      n--;
+      break;
+    case 4:
+      list_from_array(&head, (int[]){7, 8, 9}, 3);
+      ref[n++] = 7;
+      ref[n++] = 8;
+      ref[n++] = 9;
+      break;
+    case 5:
+      list_sort(&head);
+      for (int i = 1; i < n; i++) // Insertion sort; stable like list_sort
+      {
+        int key = ref[i], j = i - 1;
+        for (; j >= 0 && ref[j] > key; j--)
+          ref[j + 1] = ref[j];
+        ref[j + 1] = key;
+      }
+      break;
+    default: // Any list changing invalidates every table
+      destroy_list(&other);
+      break;
+    }
+    CHECK(!list_jumps_valid(jumps, head));
+    check_jumps(head, jumps, ref, n);
+    CHECK(list_jumps_refresh(jumps, head));
+    CHECK(list_jumps_valid(jumps, head));
+    check_jumps(head, jumps, ref, n);
+  }
+  destroy_list_jumps(&head, jumps);
+  list_jumps_destroy(jumps);
+}
+
+int main(void)
+{
+  test_random_ops();
+  test_empty();
+  test_bulk_and_sort();
+  test_jumps();
+  test_stale_jumps();
+  return check_finish("list");
+}
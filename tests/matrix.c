@@ -0,0 +1,145 @@
+// Dense matrix sum and product against naive triple loops, and batch reads
+// that tell a clean end of script from a malformed or truncated matrix
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../matrix/matrix.h"
+#include "check.h"
+
+static Mat *random_mat(int nrows, int ncols)
+{
+  Mat *mat = mat_new(nrows, ncols);
+  CHECK(mat != NULL);
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      matrix_set(mat, i, j, (int)(check_rand() % 201) - 100);
+  }
+  return mat;
+}
+
+static void test_add(int nrows, int ncols)
+{
+  Mat *a = random_mat(nrows, ncols), *b = random_mat(nrows, ncols);
+  Mat *c = mat_add(a, b);
+  CHECK(c != NULL);
+  for (int i = 0; c && i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      CHECK_EQ(matrix_get(c, i, j), matrix_get(a, i, j) + matrix_get(b, i, j));
+  }
+  mat_destroy(a);
+  mat_destroy(b);
+  mat_destroy(c);
+}
+
+static void test_mult(int m, int k, int n)
+{
+  Mat *a = random_mat(m, k), *b = random_mat(k, n);
+  Mat *c = mat_mult(a, b);
+  CHECK(c != NULL);
+  for (int i = 0; c && i < m; i++)
+  {
+    for (int j = 0; j < n; j++)
+    {
+      int sum = 0;
+      for (int p = 0; p < k; p++)
+        sum += matrix_get(a, i, p) * matrix_get(b, p, j);
+      CHECK_EQ(matrix_get(c, i, j), sum);
+    }
+  }
+  mat_destroy(a);
+  mat_destroy(b);
+  mat_destroy(c);
+}
+
+// Starts a batch run over script, written to a temporary file
+static BatchRun *start_script(const char *script, char *path)
+{
+  strcpy(path, "/tmp/lab-matrix-XXXXXX");
+  int fd = mkstemp(path);
+  CHECK(fd >= 0);
+  if (fd < 0)
+    return NULL;
+  CHECK(write(fd, script, strlen(script)) == (ssize_t)strlen(script));
+  close(fd);
+  BatchRun *run = batch_start("test-matrix", path);
+  CHECK(run != NULL);
+  return run;
+}
+
+// Reads every matrix in script; returns the status that ended the reads and
+// sets *count to the matrices read and *errors to the run's error count
+static ReadStatus read_script(const char *script, int *count, size_t *errors)
+{
+  char path[32];
+  BatchRun *run = start_script(script, path);
+  *count = 0;
+  *errors = 0;
+  if (!run)
+    return READ_ERR;
+  Mat *mat;
+  ReadStatus status;
+  while ((status = mat_read_batch(run, &mat)) == READ_OK)
+  {
+    CHECK(mat != NULL);
+    if (*count == 0)
+    {
+      CHECK_EQ(mat->nrows, 2);
+      CHECK_EQ(matrix_get(mat, 1, 0), 3);
+    }
+    mat_destroy(mat);
+    (*count)++;
+  }
+  CHECK(mat == NULL);
+  *errors = run->errors;
+  batch_finish(run);
+  unlink(path);
+  return status;
+}
+
+static void test_read_batch(void)
+{
+  int count;
+  size_t errors;
+  CHECK_EQ(read_script("2 2 1 2 3 4\n1 3 5 6 7\n", &count, &errors), READ_STOPPED);
+  CHECK_EQ(count, 2);
+  CHECK_EQ(errors, 0);
+  CHECK_EQ(read_script("", &count, &errors), READ_STOPPED);
+  CHECK_EQ(count, 0);
+  CHECK_EQ(read_script("2 2 1 2 3 4 q", &count, &errors), READ_STOPPED);
+  CHECK_EQ(count, 1);
+  CHECK_EQ(errors, 0);
+
+  const char *bad[] = {"2 2 1 2", "2", "0 3", "2 2 1 2 3 4 3 1 1"};
+  const int good_before[] = {0, 0, 0, 1};
+  for (int b = 0; b < 4; b++)
+  {
+    CHECK_EQ(read_script(bad[b], &count, &errors), READ_ERR);
+    CHECK_EQ(count, good_before[b]);
+    CHECK_EQ(errors, 1);
+  }
+  CHECK_EQ(read_script("2 2 1 x 2 3 4", &count, &errors), READ_STOPPED); // Bad token skipped but counted
+  CHECK_EQ(count, 1);
+  CHECK_EQ(errors, 1);
+}
+
+int main(void)
+{
+  test_add(1, 1);
+  test_add(13, 7);
+  test_mult(1, 1, 1);
+  test_mult(5, 9, 3);
+  test_mult(33, 17, 41);
+  test_mult(70, 70, 70);
+  Mat *a = random_mat(3, 4), *b = random_mat(3, 4), *t = random_mat(4, 3);
+  CHECK(mat_mult(a, b) == NULL); // Inner dimensions differ
+  CHECK(mat_add(a, t) == NULL);
+  mat_destroy(a);
+  mat_destroy(b);
+  mat_destroy(t);
+  test_read_batch();
+  return check_finish("matrix");
+}
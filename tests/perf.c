@@ -0,0 +1,109 @@
+// Perf regions: per-name totals survive many distinct names, worker threads
+// racing on perf_init each record regions on their own counters, a region
+// ended on another thread is dropped, and names are escaped in the JSON.
+// Counter values depend on the machine, so only calls and the JSON shape are
+// checked.
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../perf/perf.h"
+#include "check.h"
+
+#define PERF_TEST_REGIONS 300 // More than the old fixed table held
+#define PERF_TEST_THREADS 4
+
+static void *region_worker(void *arg)
+{
+  (void)arg;
+  perf_init();
+  for (int i = 0; i < 100; i++)
+  {
+    PerfScope scope;
+    perf_begin(&scope, "worker");
+    perf_end(&scope);
+  }
+  return NULL;
+}
+
+// Ends a region begun on the main thread
+static void *end_elsewhere(void *arg)
+{
+  perf_end(arg);
+  return NULL;
+}
+
+// Reads the dump into a string; returns NULL on error
+static char *dump(void)
+{
+  FILE *tmp = tmpfile();
+  if (!tmp)
+    return NULL;
+  perf_dump_json(tmp);
+  long size = ftell(tmp);
+  char *text = calloc((size_t)size + 1, 1);
+  rewind(tmp);
+  if (text && fread(text, 1, (size_t)size, tmp) != (size_t)size)
+  {
+    free(text);
+    text = NULL;
+  }
+  fclose(tmp);
+  return text;
+}
+
+static int count_substr(const char *text, const char *needle)
+{
+  int n = 0;
+  for (const char *p = strstr(text, needle); p != NULL; p = strstr(p + 1, needle))
+    n++;
+  return n;
+}
+
+int main(void)
+{
+  setenv("LAB_PERF", "/dev/null", 1); // The exit report goes nowhere; the test reads perf_dump_json
+  pthread_t threads[PERF_TEST_THREADS];
+  for (int t = 0; t < PERF_TEST_THREADS; t++)
+    CHECK(pthread_create(&threads[t], NULL, region_worker, NULL) == 0);
+  perf_init();
+  CHECK(perf_enabled());
+
+  char name[32];
+  for (int round = 0; round < 2; round++)
+  {
+    for (int r = 0; r < PERF_TEST_REGIONS; r++)
+    {
+      PerfScope scope;
+      snprintf(name, sizeof(name), "region-%d", r);
+      perf_begin(&scope, name);
+      perf_end(&scope);
+    }
+  }
+  for (int t = 0; t < PERF_TEST_THREADS; t++)
+    pthread_join(threads[t], NULL);
+
+  PerfScope scope;
+  perf_begin(&scope, "quote\"back\\slash");
+  perf_end(&scope);
+  perf_begin(&scope, "moved");
+  pthread_t other;
+  CHECK(pthread_create(&other, NULL, end_elsewhere, &scope) == 0);
+  pthread_join(other, NULL);
+
+  char *text = dump();
+  CHECK(text != NULL);
+  if (text)
+  {
+    CHECK_EQ(count_substr(text, "\"name\""), PERF_TEST_REGIONS + 2);
+    CHECK(strstr(text, "{\"name\": \"region-0\", \"calls\": 2,") != NULL);
+    snprintf(name, sizeof(name), "\"region-%d\", \"calls\": 2,", PERF_TEST_REGIONS - 1);
+    CHECK(strstr(text, name) != NULL);
+    CHECK(strstr(text, "\"worker\", \"calls\": 400,") != NULL);
+    CHECK(strstr(text, "{\"name\": \"quote\\\"back\\\\slash\", \"calls\": 1,") != NULL);
+    CHECK(strstr(text, "\"moved\"") == NULL);
+    free(text);
+  }
+  return check_finish("perf");
+}
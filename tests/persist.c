@@ -0,0 +1,158 @@
+// Persistent lists and stacks: every live version is checked against its own
+// array while new versions are derived from random old ones, and the pool's
+// live-node count shows the sharing and that releasing every version frees
+// every node
+#include <stdlib.h>
+#include <string.h>
+#include "../persist/persist.h"
+#include "check.h"
+
+#define PERSIST_VERSIONS 16
+#define PERSIST_MAX 300
+
+static PList versions[PERSIST_VERSIONS];
+static int refs[PERSIST_VERSIONS][PERSIST_MAX];
+static size_t lens[PERSIST_VERSIONS];
+
+static void check_version(int v)
+{
+  int out[PERSIST_MAX];
+  CHECK_EQ(plist_to_array(versions[v], out, PERSIST_MAX), lens[v]);
+  CHECK_EQ(versions[v].length, lens[v]);
+  for (size_t i = 0; i < lens[v]; i++)
+    CHECK_EQ(out[i], refs[v][i]);
+  int value;
+  if (lens[v] > 0)
+  {
+    size_t index = check_rand() % lens[v];
+    CHECK(plist_get(versions[v], index, &value));
+    CHECK_EQ(value, refs[v][index]);
+  }
+  CHECK(!plist_get(versions[v], lens[v], &value));
+}
+
+static void test_lists(void)
+{
+  PersistStore *store = persist_store_new();
+  CHECK(store != NULL);
+  if (!store)
+    return;
+  int initial[100];
+  for (int i = 0; i < 100; i++)
+    initial[i] = i;
+  CHECK(plist_from_array(store, initial, 100, &versions[0]));
+  memcpy(refs[0], initial, sizeof(initial));
+  lens[0] = 100;
+  for (int v = 1; v < PERSIST_VERSIONS; v++)
+  {
+    versions[v] = plist_retain(versions[0]);
+    memcpy(refs[v], refs[0], sizeof(initial));
+    lens[v] = 100;
+  }
+  CHECK_EQ(store->pool->live, 100); // Sixteen handles, one copy of the nodes
+
+  for (int op = 0; op < 5000; op++)
+  {
+    int from = (int)(check_rand() % PERSIST_VERSIONS), to = (int)(check_rand() % PERSIST_VERSIONS);
+    unsigned kind = check_rand() % 3;
+    int value = (int)check_rand(), removed;
+    int next[PERSIST_MAX];
+    size_t next_len = lens[from];
+    memcpy(next, refs[from], lens[from] * sizeof(int));
+    PList result;
+    if ((kind == 0 && lens[from] < PERSIST_MAX) || lens[from] == 0)
+    {
+      size_t index = check_rand() % (lens[from] + 1);
+      CHECK(plist_insert_at(store, versions[from], index, value, &result));
+      memmove(&next[index + 1], &next[index], (next_len - index) * sizeof(int));
+      next[index] = value;
+      next_len++;
+    }
+    else if (kind == 1)
+    {
+      size_t index = check_rand() % lens[from];
+      CHECK(plist_delete_at(store, versions[from], index, &removed, &result));
+      CHECK_EQ(removed, next[index]);
+      memmove(&next[index], &next[index + 1], (next_len - index - 1) * sizeof(int));
+      next_len--;
+    }
+    else
+    {
+      size_t index = check_rand() % lens[from];
+      CHECK(plist_set(store, versions[from], index, value, &result));
+      next[index] = value;
+    }
+    plist_release(store, versions[to]); // from stays valid even when it is to
+    versions[to] = result;
+    memcpy(refs[to], next, next_len * sizeof(int));
+    lens[to] = next_len;
+    if (op % 500 == 0)
+    {
+      for (int v = 0; v < PERSIST_VERSIONS; v++)
+        check_version(v);
+    }
+  }
+  PList unused;
+  CHECK(!plist_delete_at(store, plist_empty(), 0, NULL, &unused));
+  for (int v = 0; v < PERSIST_VERSIONS; v++)
+  {
+    check_version(v);
+    plist_release(store, versions[v]);
+  }
+  CHECK_EQ(store->pool->live, 0);
+  persist_store_destroy(store);
+}
+
+static void test_stacks(void)
+{
+  PersistStore *store = persist_store_new();
+  PStack base = pstack_empty(), next;
+  for (int i = 0; i < 50; i++)
+  {
+    CHECK(pstack_push(store, base, i, &next));
+    pstack_release(store, base);
+    base = next;
+  }
+  // Ten pushes onto the same base share all of it
+  PStack branches[10];
+  for (int b = 0; b < 10; b++)
+    CHECK(pstack_push(store, base, 1000 + b, &branches[b]));
+  CHECK_EQ(store->pool->live, 60);
+  for (int b = 0; b < 10; b++)
+  {
+    int top;
+    CHECK(pstack_peek(branches[b], &top));
+    CHECK_EQ(top, 1000 + b);
+    PStack popped;
+    CHECK(pstack_pop(store, branches[b], &top, &popped));
+    CHECK_EQ(top, 1000 + b);
+    CHECK(popped.head == base.head);
+    pstack_release(store, popped);
+    pstack_release(store, branches[b]);
+  }
+  CHECK_EQ(store->pool->live, 50);
+
+  // Popping the whole stack walks back through the pushes
+  PStack cur = pstack_retain(base);
+  for (int i = 49; i >= 0; i--)
+  {
+    int top;
+    CHECK(pstack_pop(store, cur, &top, &next));
+    CHECK_EQ(top, i);
+    pstack_release(store, cur);
+    cur = next;
+  }
+  int top;
+  CHECK(!pstack_pop(store, cur, &top, &next));
+  CHECK(!pstack_peek(cur, &top));
+  pstack_release(store, base);
+  CHECK_EQ(store->pool->live, 0);
+  persist_store_destroy(store);
+}
+
+int main(void)
+{
+  test_lists();
+  test_stacks();
+  return check_finish("persist");
+}
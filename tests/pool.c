@@ -0,0 +1,60 @@
+// Object pool: live objects are distinct, aligned and keep their contents,
+// freed objects are reused before a new slab is taken, and reset returns
+// everything without growing the pool
+#include <stdint.h>
+#include <string.h>
+#include "../pool/pool.h"
+#include "check.h"
+
+#define POOL_OBJECTS 1000
+
+static void test_pool(void)
+{
+  Pool *pool = pool_new(24, 64, ALLOC_LIST);
+  CHECK(pool != NULL);
+  if (!pool)
+    return;
+  unsigned char *objects[POOL_OBJECTS];
+  for (int i = 0; i < POOL_OBJECTS; i++)
+  {
+    objects[i] = pool_alloc(pool);
+    CHECK(objects[i] != NULL);
+    CHECK((uintptr_t)objects[i] % _Alignof(max_align_t) == 0);
+    memset(objects[i], i & 0xFF, 24);
+  }
+  CHECK_EQ(pool->live, POOL_OBJECTS);
+  CHECK(pool->capacity >= POOL_OBJECTS && pool->capacity < POOL_OBJECTS + 64);
+  for (int i = 0; i < POOL_OBJECTS; i++)
+  {
+    for (int b = 0; b < 24; b++)
+      CHECK_EQ(objects[i][b], i & 0xFF); // No two objects overlap
+  }
+
+  // Freed objects come back before the pool grows
+  size_t capacity = pool->capacity;
+  for (int i = 0; i < POOL_OBJECTS; i += 2)
+    pool_free(pool, objects[i]);
+  CHECK_EQ(pool->live, POOL_OBJECTS / 2);
+  for (int i = 0; i < POOL_OBJECTS; i += 2)
+    objects[i] = pool_alloc(pool);
+  CHECK_EQ(pool->capacity, capacity);
+  CHECK_EQ(pool->live, POOL_OBJECTS);
+
+  pool_reset(pool);
+  CHECK_EQ(pool->live, 0);
+  for (int i = 0; i < POOL_OBJECTS; i++)
+    CHECK(pool_alloc(pool) != NULL);
+  CHECK_EQ(pool->capacity, capacity);
+  pool_destroy(pool);
+
+  CHECK(pool_new(0, 0, ALLOC_LIST) == NULL);
+  Pool *defaults = pool_new(40, 0, ALLOC_LIST);
+  CHECK(defaults && pool_alloc(defaults) && defaults->slab_objects > 1);
+  pool_destroy(defaults);
+}
+
+int main(void)
+{
+  test_pool();
+  return check_finish("pool");
+}
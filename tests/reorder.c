@@ -0,0 +1,147 @@
+// Symmetric reorderings: the permutation and its inverse agree, B = P A P^T
+// holds every entry of A at its new coordinates, spmv commutes with the
+// renumbering, and RCM recovers a small bandwidth from a shuffled band matrix
+#include <stdlib.h>
+#include "../reorder/reorder.h"
+#include "check.h"
+
+#define REORDER_N 200
+#define REORDER_BAND 3
+
+static void check_permutation(Reordering *p, int n)
+{
+  CHECK_EQ(p->n, n);
+  for (int i = 0; i < n; i++)
+  {
+    CHECK(p->order[i] >= 0 && p->order[i] < n);
+    if (p->order[i] >= 0 && p->order[i] < n)
+      CHECK_EQ(p->position[p->order[i]], i);
+  }
+}
+
+// A shuffled band matrix split into two components, plus isolated rows and
+// a few one-directional entries so the pattern is not symmetric
+static SparseMat *shuffled_band(int n, int *label)
+{
+  for (int i = 0; i < n; i++)
+    label[i] = i;
+  for (int i = n - 1; i > 0; i--)
+  {
+    int j = (int)(check_rand() % (unsigned)(i + 1)), tmp = label[i];
+    label[i] = label[j];
+    label[j] = tmp;
+  }
+  SparseMat *mat = sparse_new(n, n);
+  for (int r = 0; r < n - 10; r++)
+  {
+    for (int c = r - REORDER_BAND; c <= r + REORDER_BAND; c++)
+    {
+      if (c >= 0 && c < n - 10 && (r < n / 2) == (c < n / 2) && (c <= r || check_rand() % 4))
+        sparse_add(mat, label[r], label[c], 1 + (int)(check_rand() % 9));
+    }
+  }
+  return mat;
+}
+
+static void check_method(CsrMat *csr, ReorderMethod method)
+{
+  int n = csr->nrows;
+  Reordering *p = reorder_compute(csr, method);
+  CHECK(p != NULL && n > 0);
+  if (!p || n < 1)
+    return;
+  check_permutation(p, n);
+  CsrMat *b = reorder_apply(csr, p);
+  CHECK_EQ(b->nnz, csr->nnz);
+  for (int r = 0; r < n; r++)
+  {
+    for (int c = 0; c < n; c++)
+      CHECK_EQ(csr_get(b, p->position[r], p->position[c]), csr_get(csr, r, c));
+  }
+
+  // B (P x) = P (A x), and mapping back recovers A x
+  int *x = malloc(sizeof(int) * (size_t)n), *px = malloc(sizeof(int) * (size_t)n);
+  int *ax = malloc(sizeof(int) * (size_t)n), *bpx = malloc(sizeof(int) * (size_t)n);
+  int *back = malloc(sizeof(int) * (size_t)n);
+  for (int i = 0; i < n; i++)
+    x[i] = (int)(check_rand() % 1000) - 500;
+  reorder_vector(p, x, px);
+  for (int i = 0; i < n; i++)
+    CHECK_EQ(px[p->position[i]], x[i]);
+  csr_spmv(csr, x, ax);
+  csr_spmv(b, px, bpx);
+  reorder_vector_back(p, bpx, back);
+  for (int i = 0; i < n; i++)
+    CHECK_EQ(back[i], ax[i]);
+
+  if (method == REORDER_RCM)
+  {
+    BandStats before = reorder_band_stats(csr), after = reorder_band_stats(b);
+    CHECK(after.bandwidth <= 4 * REORDER_BAND);
+    CHECK(after.bandwidth <= before.bandwidth);
+    CHECK(after.profile <= before.profile);
+  }
+  else
+  {
+    // Descending degree, counting each stored entry in its row and its column
+    int *degree = calloc((size_t)n, sizeof(int));
+    for (int r = 0; r < n; r++)
+    {
+      for (size_t k = csr->row_ptr[r]; k < csr->row_ptr[r + 1]; k++)
+      {
+        degree[r]++;
+        degree[csr->col_idx[k]]++;
+      }
+    }
+    for (int i = 1; i < n; i++)
+      CHECK(degree[p->order[i - 1]] >= degree[p->order[i]]);
+    free(degree);
+  }
+  free(x);
+  free(px);
+  free(ax);
+  free(bpx);
+  free(back);
+  csr_destroy(b);
+  reorder_destroy(p);
+}
+
+static void test_band(void)
+{
+  int label[REORDER_N];
+  SparseMat *mat = shuffled_band(REORDER_N, label);
+  CsrMat *csr = csr_from_sparse(mat);
+  CHECK(reorder_band_stats(csr).bandwidth > 4 * REORDER_BAND); // The shuffle really scattered it
+  check_method(csr, REORDER_RCM);
+  check_method(csr, REORDER_DEGREE);
+
+  // The COO entry point gives the same matrix as the CSR one
+  Reordering *p = reorder_sparse(mat, REORDER_RCM);
+  SparseMat *moved = reorder_apply_sparse(mat, p);
+  CHECK(p && moved);
+  for (int k = 0; p && moved && k < mat->nnz; k++)
+  {
+    SparseEntry *e = &mat->data[k];
+    CHECK_EQ(sparse_get(moved, p->position[e->row], p->position[e->col]), e->value);
+  }
+  CHECK_EQ(moved ? moved->nnz : -1, mat->nnz);
+  sparse_mat_destroy(moved);
+  reorder_destroy(p);
+  csr_destroy(csr);
+  sparse_mat_destroy(mat);
+}
+
+static void test_errors(void)
+{
+  CsrMat *wide = csr_new(3, 4, 0);
+  CHECK(reorder_compute(wide, REORDER_RCM) == NULL);
+  CHECK(reorder_compute(NULL, REORDER_DEGREE) == NULL);
+  csr_destroy(wide);
+}
+
+int main(void)
+{
+  test_band();
+  test_errors();
+  return check_finish("reorder");
+}
@@ -0,0 +1,142 @@
+// SPSC ring against a deque array: single, batch and LIFO operations across
+// wrap-around on one thread, then a producer and a consumer thread mixing
+// single and batch calls, which must see 0, 1, 2, ... in order
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include "../ring/ring.h"
+#include "check.h"
+
+#define RING_CAPACITY 16
+#define RING_STREAM 200000
+
+static void test_single_thread(void)
+{
+  Ring *r = ring_new(RING_CAPACITY - 3); // Rounded up
+  CHECK(r != NULL);
+  if (!r)
+    return;
+  CHECK_EQ(ring_capacity(r), RING_CAPACITY);
+  CHECK(((uintptr_t)&r->tail - (uintptr_t)&r->head) % RING_CACHE_LINE == 0);
+
+  int ref[RING_CAPACITY], head = 0, n = 0; // ref[(head + i) % capacity] is element i
+  int next_value = 0;
+  for (int op = 0; op < 20000; op++)
+  {
+    unsigned kind = check_rand() % 6;
+    int value, buf[RING_CAPACITY + 4];
+    size_t want = check_rand() % (RING_CAPACITY + 4), moved;
+    switch (kind)
+    {
+    case 0:
+      CHECK_EQ(ring_push(r, next_value), n < RING_CAPACITY);
+      if (n < RING_CAPACITY)
+        ref[(head + n++) % RING_CAPACITY] = next_value;
+      next_value++;
+      break;
+    case 1:
+      CHECK_EQ(ring_pop(r, &value), n > 0);
+      if (n > 0)
+      {
+        CHECK_EQ(value, ref[head]);
+        head = (head + 1) % RING_CAPACITY;
+        n--;
+      }
+      break;
+    case 2:
+      CHECK_EQ(ring_pop_back(r, &value), n > 0);
+      if (n > 0)
+        CHECK_EQ(value, ref[(head + --n) % RING_CAPACITY]);
+      break;
+    case 3:
+    case 4:
+      for (size_t i = 0; i < want; i++)
+        buf[i] = next_value + (int)i;
+      moved = ring_push_batch(r, buf, want);
+      CHECK_EQ(moved, want < (size_t)(RING_CAPACITY - n) ? want : (size_t)(RING_CAPACITY - n));
+      for (size_t i = 0; i < moved; i++)
+        ref[(head + n++) % RING_CAPACITY] = buf[i];
+      next_value += (int)want;
+      break;
+    default:
+      moved = ring_pop_batch(r, buf, want);
+      CHECK_EQ(moved, want < (size_t)n ? want : (size_t)n);
+      for (size_t i = 0; i < moved; i++)
+      {
+        CHECK_EQ(buf[i], ref[head]);
+        head = (head + 1) % RING_CAPACITY;
+        n--;
+      }
+      break;
+    }
+    CHECK_EQ(ring_size(r), n);
+  }
+  ring_destroy(r);
+}
+
+static Ring *stream;
+
+static void *producer(void *arg)
+{
+  (void)arg;
+  int next = 0, buf[RING_CAPACITY];
+  unsigned long long state = 0x243F6A8885A308D3ULL;
+  while (next < RING_STREAM)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    if (state % 2)
+    {
+      if (ring_push(stream, next))
+        next++;
+      else
+        sched_yield();
+      continue;
+    }
+    size_t want = 1 + state % RING_CAPACITY;
+    if (want > (size_t)(RING_STREAM - next))
+      want = (size_t)(RING_STREAM - next);
+    for (size_t i = 0; i < want; i++)
+      buf[i] = next + (int)i;
+    size_t moved = ring_push_batch(stream, buf, want);
+    next += (int)moved;
+    if (moved == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void test_spsc(void)
+{
+  stream = ring_new(RING_CAPACITY);
+  CHECK(stream != NULL);
+  if (!stream)
+    return;
+  pthread_t thread;
+  pthread_create(&thread, NULL, producer, NULL);
+  int expected = 0, errors = 0, buf[RING_CAPACITY];
+  while (expected < RING_STREAM)
+  {
+    size_t got;
+    if (check_rand() % 2)
+      got = ring_pop(stream, buf);
+    else
+      got = ring_pop_batch(stream, buf, 1 + check_rand() % RING_CAPACITY);
+    if (got == 0)
+      sched_yield();
+    for (size_t i = 0; i < got; i++)
+      errors += buf[i] != expected++;
+  }
+  pthread_join(thread, NULL);
+  CHECK_EQ(errors, 0);
+  CHECK_EQ(ring_size(stream), 0);
+  ring_destroy(stream);
+}
+
+int main(void)
+{
+  test_single_thread();
+  test_spsc();
+  return check_finish("ring");
+}
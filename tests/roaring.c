@@ -0,0 +1,178 @@
+// Roaring bitmaps against sorted arrays of distinct values: sets that mix
+// sparse array containers with dense bitmap containers (and values at the
+// container edges), the set operations against a merge, rank/select, and
+// removes that thin a bitmap container back out
+#include <stdlib.h>
+#include <string.h>
+#include "../roaring/roaring.h"
+#include "check.h"
+
+typedef struct
+{
+  uint32_t *values;
+  size_t n;
+} Sorted;
+
+static int u32_cmp(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static void normalize(Sorted *s)
+{
+  qsort(s->values, s->n, sizeof(uint32_t), u32_cmp);
+  size_t out = 0;
+  for (size_t i = 0; i < s->n; i++)
+  {
+    if (out == 0 || s->values[out - 1] != s->values[i])
+      s->values[out++] = s->values[i];
+  }
+  s->n = out;
+}
+
+// Random values in a few keys: one dense (bitmap) and others sparse; the raw
+// list keeps duplicates and arrival order for roaring_add_many
+static Sorted random_set(uint32_t *raw, size_t *raw_n)
+{
+  size_t n = 0;
+  uint32_t dense_key = check_rand() % 4;
+  for (int i = 0; i < 9000; i++) // Past ROARING_ARRAY_MAX within one key
+    raw[n++] = dense_key << 16 | (check_rand() % 20000);
+  for (int i = 0; i < 3000; i++)
+    raw[n++] = (check_rand() % 8) << 16 | (check_rand() & 0xFFFF);
+  for (int i = 0; i < 200; i++)
+    raw[n++] = check_rand();
+  raw[n++] = 0;
+  raw[n++] = 0xFFFF;
+  raw[n++] = 0x10000;
+  raw[n++] = UINT32_MAX;
+  *raw_n = n;
+  Sorted s = {malloc(n * sizeof(uint32_t)), n};
+  memcpy(s.values, raw, n * sizeof(uint32_t));
+  normalize(&s);
+  return s;
+}
+
+static void check_equal(Roaring *r, const Sorted *s)
+{
+  CHECK(r != NULL);
+  if (!r)
+    return;
+  CHECK_EQ(roaring_count(r), s->n);
+  uint32_t *out = malloc((s->n + 1) * sizeof(uint32_t));
+  CHECK_EQ(roaring_to_array(r, out), s->n);
+  for (size_t i = 0; i < s->n; i++)
+    CHECK_EQ(out[i], s->values[i]);
+  free(out);
+  for (size_t k = 1; k < r->ncontainers; k++)
+    CHECK(r->containers[k - 1].key < r->containers[k].key);
+  for (size_t k = 0; k < r->ncontainers; k++)
+    CHECK_EQ(r->containers[k].kind, r->containers[k].count > ROARING_ARRAY_MAX ? ROARING_BITMAP : ROARING_ARRAY);
+}
+
+typedef enum
+{
+  OP_AND,
+  OP_OR,
+  OP_XOR,
+  OP_ANDNOT
+} Op;
+
+static Sorted merge(const Sorted *a, const Sorted *b, Op op)
+{
+  Sorted out = {malloc((a->n + b->n + 1) * sizeof(uint32_t)), 0};
+  size_t i = 0, j = 0;
+  while (i < a->n || j < b->n)
+  {
+    int in_a = j == b->n || (i < a->n && a->values[i] <= b->values[j]);
+    int in_b = i == a->n || (j < b->n && b->values[j] <= a->values[i]);
+    uint32_t v = in_a ? a->values[i++] : b->values[j];
+    if (in_b)
+      j++;
+    int keep = op == OP_AND ? in_a && in_b : op == OP_OR ? 1 : op == OP_XOR ? in_a != in_b : in_a && !in_b;
+    if (keep)
+      out.values[out.n++] = v;
+  }
+  return out;
+}
+
+static void test_operations(void)
+{
+  uint32_t *raw = malloc(20000 * sizeof(uint32_t));
+  for (int trial = 0; trial < 6; trial++)
+  {
+    size_t raw_n;
+    Sorted sa = random_set(raw, &raw_n);
+    Roaring *a = roaring_new();
+    CHECK(roaring_add_many(a, raw, raw_n)); // Unsorted, with duplicates
+    Sorted sb = random_set(raw, &raw_n);
+    Roaring *b = roaring_new();
+    for (size_t i = 0; i < raw_n; i++)
+      CHECK(roaring_add(b, raw[i]));
+    check_equal(a, &sa);
+    check_equal(b, &sb);
+
+    Roaring *(*const fns[])(Roaring *, Roaring *) = {roaring_and, roaring_or, roaring_xor, roaring_andnot};
+    for (Op op = OP_AND; op <= OP_ANDNOT; op++)
+    {
+      Sorted expected = merge(&sa, &sb, op);
+      Roaring *result = fns[op](a, b);
+      check_equal(result, &expected);
+      if (op == OP_AND)
+        CHECK_EQ(roaring_and_count(a, b), expected.n);
+      roaring_destroy(result);
+      free(expected.values);
+    }
+
+    // rank counts values <= v; select inverts it
+    for (int probe = 0; probe < 300; probe++)
+    {
+      uint32_t v = probe % 3 ? sa.values[check_rand() % sa.n] + (check_rand() % 3) - 1 : check_rand();
+      size_t lo = 0, hi = sa.n;
+      while (lo < hi)
+      {
+        size_t mid = (lo + hi) / 2;
+        if (sa.values[mid] <= v)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      CHECK_EQ(roaring_rank(a, v), lo);
+      CHECK_EQ(roaring_contains(a, v), lo > 0 && sa.values[lo - 1] == v);
+      size_t k = check_rand() % sa.n;
+      uint32_t got = 0;
+      CHECK(roaring_select(a, k, &got));
+      CHECK_EQ(got, sa.values[k]);
+    }
+    uint32_t unused;
+    CHECK(!roaring_select(a, sa.n, &unused));
+
+    // Remove every other value: the dense container drops back to an array
+    uint32_t gone = sa.values[1];
+    size_t kept = 0;
+    for (size_t i = 0; i < sa.n; i++)
+    {
+      if (i % 2)
+        CHECK(roaring_remove(a, sa.values[i]));
+      else
+        sa.values[kept++] = sa.values[i];
+    }
+    sa.n = kept;
+    CHECK(!roaring_remove(a, gone));
+    CHECK(!roaring_contains(a, gone));
+    check_equal(a, &sa);
+
+    roaring_destroy(a);
+    roaring_destroy(b);
+    free(sa.values);
+    free(sb.values);
+  }
+  free(raw);
+}
+
+int main(void)
+{
+  test_operations();
+  return check_finish("roaring");
+}
@@ -0,0 +1,30 @@
+// get_index against a direct scan of the source array
+#include "../search/search.h"
+#include "../vector/vector.h"
+#include "check.h"
+
+#define SEARCH_LEN 500
+
+int main(void)
+{
+  Vec *vec = vec_new(sizeof(int), 4);
+  CHECK(vec != NULL);
+  int values[SEARCH_LEN];
+  for (int i = 0; i < SEARCH_LEN; i++)
+  {
+    values[i] = (int)(check_rand() % 200); // Repeats, so the first match must win
+    CHECK(vec_append(vec, &values[i]));
+  }
+  for (int el = -5; el < 205; el++)
+  {
+    int expected = -1;
+    for (int i = 0; i < SEARCH_LEN && expected < 0; i++)
+    {
+      if (values[i] == el)
+        expected = i;
+    }
+    CHECK_EQ(get_index(vec, el), expected);
+  }
+  vec_destroy(vec);
+  return check_finish("search");
+}
@@ -0,0 +1,129 @@
+// Segmented vector: single-threaded appends against an array (batches that
+// span segments, stable pointers), then concurrent appenders whose elements
+// must each appear once, at the index returned, in per-thread order
+#include <pthread.h>
+#include <stdlib.h>
+#include "../segvec/segvec.h"
+#include "check.h"
+
+#define SEG_THREADS 4
+#define SEG_PER_THREAD 20000
+
+typedef struct
+{
+  int thread;
+  int seq;
+} SegItem;
+
+static void test_single_thread(void)
+{
+  SegVec *vec = segvec_new(sizeof(int), 5); // Rounded up to 8
+  CHECK(vec != NULL);
+  if (!vec)
+    return;
+  int ref[5000], n = 0;
+  int *first = NULL;
+  while (n < 4900)
+  {
+    size_t index;
+    if (check_rand() % 3)
+    {
+      ref[n] = (int)check_rand();
+      CHECK(segvec_append(vec, &ref[n], &index));
+      CHECK_EQ(index, n);
+      n++;
+    }
+    else
+    {
+      int count = (int)(check_rand() % 90);
+      for (int i = 0; i < count; i++)
+        ref[n + i] = (int)check_rand();
+      CHECK(segvec_append_batch(vec, &ref[n], (size_t)count, &index));
+      CHECK_EQ(index, n);
+      n += count;
+    }
+    if (!first)
+      first = segvec_get(vec, 0);
+  }
+  CHECK(segvec_get(vec, 0) == first); // Segments never move
+  CHECK_EQ(segvec_length(vec), n);
+  for (int i = 0; i < n; i++)
+  {
+    int *elem = segvec_get(vec, (size_t)i);
+    CHECK(elem != NULL);
+    if (elem)
+      CHECK_EQ(*elem, ref[i]);
+  }
+  CHECK(segvec_get(vec, (size_t)n) == NULL);
+  CHECK(!segvec_append(vec, NULL, NULL));
+  segvec_destroy(vec);
+  CHECK(segvec_new(0, 8) == NULL);
+}
+
+static SegVec *shared;
+static atomic_int index_errors;
+
+static void *appender(void *arg)
+{
+  int t = (int)(long)arg;
+  for (int seq = 0; seq < SEG_PER_THREAD;)
+  {
+    size_t index;
+    if (seq % 7 == 0 && seq + 3 <= SEG_PER_THREAD)
+    {
+      SegItem batch[3] = {{t, seq}, {t, seq + 1}, {t, seq + 2}};
+      if (!segvec_append_batch(shared, batch, 3, &index))
+        break;
+      seq += 3;
+    }
+    else
+    {
+      SegItem item = {t, seq};
+      if (!segvec_append(shared, &item, &index))
+        break;
+      seq++;
+    }
+    // The returned index holds what this thread wrote
+    SegItem *stored = segvec_get(shared, index);
+    if (!stored || stored->thread != t)
+      atomic_fetch_add(&index_errors, 1);
+  }
+  return NULL;
+}
+
+static void test_concurrent(void)
+{
+  shared = segvec_new(sizeof(SegItem), 8);
+  CHECK(shared != NULL);
+  if (!shared)
+    return;
+  pthread_t threads[SEG_THREADS];
+  for (long t = 0; t < SEG_THREADS; t++)
+    pthread_create(&threads[t], NULL, appender, (void *)t);
+  for (int t = 0; t < SEG_THREADS; t++)
+    pthread_join(threads[t], NULL);
+  CHECK_EQ(atomic_load(&index_errors), 0);
+  CHECK_EQ(segvec_length(shared), SEG_THREADS * SEG_PER_THREAD);
+
+  // Each thread's items appear once each, in the order it appended them
+  int next[SEG_THREADS] = {0};
+  for (size_t i = 0; i < segvec_length(shared); i++)
+  {
+    SegItem *item = segvec_get(shared, i);
+    CHECK(item != NULL && item->thread >= 0 && item->thread < SEG_THREADS);
+    if (!item || item->thread < 0 || item->thread >= SEG_THREADS)
+      continue;
+    CHECK_EQ(item->seq, next[item->thread]);
+    next[item->thread] = item->seq + 1;
+  }
+  for (int t = 0; t < SEG_THREADS; t++)
+    CHECK_EQ(next[t], SEG_PER_THREAD);
+  segvec_destroy(shared);
+}
+
+int main(void)
+{
+  test_single_thread();
+  test_concurrent();
+  return check_finish("segvec");
+}
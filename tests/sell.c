@@ -0,0 +1,178 @@
+// SELL-C-sigma layouts against CSR and a dense reference: every chunk and
+// window size gives a valid row permutation and the same y = A * x, also
+// when the first products race on the CPU feature check
+#include <pthread.h>
+#include <stdlib.h>
+#include "../sell/sell.h"
+#include "check.h"
+
+#define SELL_TRIALS 12
+#define SELL_THREADS 4
+
+// Row lengths from a rough power law, so sorting windows matter
+static SparseMat *random_matrix(int nrows, int ncols)
+{
+  SparseMat *mat = sparse_new(nrows, ncols);
+  for (int r = 0; r < nrows; r++)
+  {
+    int len = (int)(check_rand() % 4);
+    if (check_rand() % 8 == 0)
+      len = (int)(check_rand() % (unsigned)ncols);
+    for (int k = 0; k < len; k++)
+      sparse_add(mat, r, (int)(check_rand() % (unsigned)ncols), (int)check_rand());
+  }
+  return mat;
+}
+
+static void check_layout(SellMat *sell)
+{
+  int *seen = calloc((size_t)sell->nrows, sizeof(int));
+  for (int lane = 0; lane < sell->nchunks * sell->chunk; lane++)
+  {
+    int row = sell->perm[lane];
+    CHECK(row >= -1 && row < sell->nrows);
+    if (row >= 0)
+      seen[row]++;
+  }
+  for (int r = 0; r < sell->nrows; r++)
+    CHECK_EQ(seen[r], 1);
+  CHECK_EQ(sell->chunk_ptr[0], 0);
+  for (int c = 0; c < sell->nchunks; c++)
+    CHECK_EQ((sell->chunk_ptr[c + 1] - sell->chunk_ptr[c]) % (size_t)sell->chunk, 0);
+  free(seen);
+}
+
+static void test_random(void)
+{
+  static const int chunks[] = {1, 3, 4, 8, 16, 32};
+  for (int trial = 0; trial < SELL_TRIALS; trial++)
+  {
+    int nrows = 1 + (int)(check_rand() % 300), ncols = 1 + (int)(check_rand() % 200);
+    SparseMat *sparse = random_matrix(nrows, ncols);
+    CsrMat *csr = csr_from_sparse(sparse);
+    int *x = malloc((size_t)ncols * sizeof(int));
+    int *expected = malloc((size_t)nrows * sizeof(int)), *y = malloc((size_t)nrows * sizeof(int));
+    for (int c = 0; c < ncols; c++)
+      x[c] = (int)check_rand();
+    CHECK(csr_spmv(csr, x, expected));
+    Mat *dense = csr_to_mat(csr);
+    for (int r = 0; r < nrows; r++) // The CSR result itself against a dense loop
+    {
+      unsigned sum = 0;
+      for (int c = 0; c < ncols; c++)
+        sum += (unsigned)matrix_get(dense, r, c) * (unsigned)x[c];
+      CHECK_EQ(expected[r], (int)sum);
+    }
+
+    for (int i = 0; i < (int)(sizeof(chunks) / sizeof(chunks[0])); i++)
+    {
+      for (int sigma_chunks = 0; sigma_chunks <= 8; sigma_chunks += 4)
+      {
+        int chunk = chunks[i], sigma = sigma_chunks * chunk;
+        SellMat *sell = sell_from_csr(csr, chunk, sigma);
+        CHECK(sell != NULL);
+        if (!sell)
+          continue;
+        check_layout(sell);
+        CHECK_EQ(sell->nnz, csr->nnz);
+        double slots = (double)sell->chunk_ptr[sell->nchunks];
+        CHECK(slots == 0 || sell_fill(csr, chunk, sigma) == (double)sell->nnz / slots);
+        for (int r = 0; r < nrows; r++)
+          y[r] = 12345;
+        CHECK(sell_spmv(sell, x, y));
+        for (int r = 0; r < nrows; r++)
+          CHECK_EQ(y[r], expected[r]);
+        sell_destroy(sell);
+      }
+    }
+
+    SpmvMat *tuned = spmv_new(sparse);
+    CHECK(tuned != NULL);
+    if (tuned)
+    {
+      CHECK(spmv_run(tuned, x, y));
+      for (int r = 0; r < nrows; r++)
+        CHECK_EQ(y[r], expected[r]);
+      CHECK((tuned->tuning.format == SPMV_CSR) == (tuned->csr != NULL));
+    }
+    spmv_destroy(tuned);
+    mat_destroy(dense);
+    free(x);
+    free(y);
+    free(expected);
+    csr_destroy(csr);
+    sparse_mat_destroy(sparse);
+  }
+}
+
+typedef struct
+{
+  SellMat *sell;
+  const int *x;
+  const int *expected;
+  int ok;
+} SpmvJob;
+
+static void *spmv_worker(void *arg)
+{
+  SpmvJob *job = arg;
+  int nrows = job->sell->nrows;
+  int *y = malloc((size_t)nrows * sizeof(int));
+  job->ok = y != NULL && sell_spmv(job->sell, job->x, y);
+  for (int r = 0; job->ok && r < nrows; r++)
+    job->ok = y[r] == job->expected[r];
+  free(y);
+  return NULL;
+}
+
+// Runs before anything else has asked for the SIMD width
+static void test_racing_first_use(void)
+{
+  int nrows = 200, ncols = 150;
+  SparseMat *sparse = random_matrix(nrows, ncols);
+  CsrMat *csr = csr_from_sparse(sparse);
+  int *x = malloc((size_t)ncols * sizeof(int)), *expected = malloc((size_t)nrows * sizeof(int));
+  for (int c = 0; c < ncols; c++)
+    x[c] = (int)check_rand();
+  CHECK(csr_spmv(csr, x, expected));
+  SellMat *sell = sell_from_csr(csr, 16, 64);
+  CHECK(sell != NULL);
+  if (sell)
+  {
+    pthread_t threads[SELL_THREADS];
+    SpmvJob jobs[SELL_THREADS];
+    for (int t = 0; t < SELL_THREADS; t++)
+    {
+      jobs[t] = (SpmvJob){sell, x, expected, 0};
+      CHECK(pthread_create(&threads[t], NULL, spmv_worker, &jobs[t]) == 0);
+    }
+    for (int t = 0; t < SELL_THREADS; t++)
+    {
+      pthread_join(threads[t], NULL);
+      CHECK(jobs[t].ok);
+    }
+  }
+  sell_destroy(sell);
+  free(x);
+  free(expected);
+  csr_destroy(csr);
+  sparse_mat_destroy(sparse);
+}
+
+static void test_errors(void)
+{
+  CsrMat *csr = csr_new(4, 4, 0);
+  CHECK(sell_from_csr(csr, 0, 0) == NULL);
+  CHECK(sell_from_csr(csr, SELL_MAX_CHUNK + 1, 0) == NULL);
+  CHECK(sell_from_csr(NULL, 8, 0) == NULL);
+  CHECK(!sell_spmv(NULL, NULL, NULL));
+  csr_destroy(csr);
+}
+
+int main(void)
+{
+  test_racing_first_use();
+  test_random();
+  test_errors();
+  return check_finish("sell");
+}
@@ -0,0 +1,149 @@
+// Indexable skip list against a plain array under random positional inserts,
+// deletes and updates, with the link spans checked on every level; then rank
+// queries against a sorted array
+#include <stdlib.h>
+#include <string.h>
+#include "../skiplist/skiplist.h"
+#include "check.h"
+
+#define SKIP_OPS 20000
+#define SKIP_MAX 4096
+
+static int ref[SKIP_MAX];
+static size_t ref_len = 0;
+
+static void ref_insert(size_t index, int value)
+{
+  memmove(&ref[index + 1], &ref[index], (ref_len - index) * sizeof(int));
+  ref[index] = value;
+  ref_len++;
+}
+
+static int ref_delete(size_t index)
+{
+  int value = ref[index];
+  memmove(&ref[index], &ref[index + 1], (ref_len - index - 1) * sizeof(int));
+  ref_len--;
+  return value;
+}
+
+// Spans on each level add up to the length and land on the right nodes
+static void check_structure(SkipList *list)
+{
+  CHECK_EQ(skiplist_length(list), ref_len);
+  for (int lvl = 0; lvl < list->level; lvl++)
+  {
+    size_t pos = 0; // Elements passed so far; the head sits before index 0
+    for (SkipNode *node = list->head; node; node = node->link[lvl].next)
+    {
+      pos += node->link[lvl].span;
+      if (node->link[lvl].next)
+        CHECK_EQ(node->link[lvl].next->data, ref[pos - 1]);
+      else
+        CHECK_EQ(pos, ref_len);
+    }
+  }
+  size_t i = 0;
+  for (SkipNode *node = list->head->link[0].next; node && i < ref_len; node = node->link[0].next, i++)
+    CHECK_EQ(node->data, ref[i]);
+}
+
+static void test_positional(void)
+{
+  SkipList *list = skiplist_new();
+  CHECK(list != NULL);
+  ref_len = 0;
+  for (int op = 0; op < SKIP_OPS; op++)
+  {
+    unsigned kind = check_rand() % 10; // Inserts outnumber deletes, so the list grows
+    int value = (int)check_rand();
+    int got = 0;
+    if (ref_len == 0 || (kind < 5 && ref_len < SKIP_MAX))
+    {
+      size_t index = check_rand() % (ref_len + 1);
+      if (kind == 0)
+      {
+        index = 0;
+        CHECK(skiplist_insert_at_head(list, value));
+      }
+      else if (kind == 1)
+      {
+        index = ref_len;
+        CHECK(skiplist_insert_at_tail(list, value));
+      }
+      else
+        CHECK(skiplist_insert_at_index(list, value, index));
+      ref_insert(index, value);
+    }
+    else if (kind < 8)
+    {
+      size_t index = check_rand() % ref_len;
+      if (kind == 5)
+      {
+        index = 0;
+        CHECK(skiplist_delete_at_head(list, &got));
+      }
+      else if (kind == 6)
+      {
+        index = ref_len - 1;
+        CHECK(skiplist_delete_at_tail(list, &got));
+      }
+      else
+        CHECK(skiplist_delete_at_index(list, index, &got));
+      CHECK_EQ(got, ref_delete(index));
+    }
+    else
+    {
+      size_t index = check_rand() % ref_len;
+      if (kind == 8)
+      {
+        CHECK(skiplist_set(list, index, value));
+        ref[index] = value;
+      }
+      CHECK(skiplist_get(list, index, &got));
+      CHECK_EQ(got, ref[index]);
+    }
+    if (op % 1000 == 0)
+      check_structure(list);
+  }
+  check_structure(list);
+  CHECK(!skiplist_get(list, ref_len, NULL));
+  CHECK(!skiplist_insert_at_index(list, 0, ref_len + 1));
+  CHECK(!skiplist_delete_at_index(list, ref_len, NULL));
+  while (ref_len > 0)
+  {
+    int got;
+    CHECK(skiplist_delete_at_tail(list, &got));
+    CHECK_EQ(got, ref_delete(ref_len - 1));
+  }
+  CHECK(!skiplist_delete_at_head(list, NULL));
+  check_structure(list);
+  skiplist_destroy(list);
+}
+
+static void test_sorted(void)
+{
+  SkipList *list = skiplist_new();
+  ref_len = 0;
+  for (int i = 0; i < 2000; i++)
+  {
+    int value = (int)(check_rand() % 500); // Plenty of duplicates
+    size_t rank = 0;
+    while (rank < ref_len && ref[rank] < value)
+      rank++;
+    CHECK_EQ(skiplist_rank(list, value), rank);
+    CHECK(skiplist_insert_sorted(list, value));
+    ref_insert(rank, value);
+  }
+  check_structure(list);
+  CHECK_EQ(skiplist_rank(list, 1000), ref_len);
+  CHECK_EQ(skiplist_rank(list, -1), 0);
+  skiplist_destroy(list);
+}
+
+int main(void)
+{
+  test_positional();
+  test_sorted();
+  return check_finish("skiplist");
+}
@@ -0,0 +1,95 @@
+// Batched small products against a naive per-matrix loop (summed unsigned, so
+// full-range entries wrap the same way), for the unrolled square kernels,
+// generic shapes, a shared right operand and batches split across threads
+#include <stdint.h>
+#include <stdlib.h>
+#include "../smallgemm/smallgemm.h"
+#include "check.h"
+
+static void fill(MatBatch *batch, int full)
+{
+  for (size_t t = 0; t < batch->count; t++)
+  {
+    int *m = mat_batch_at(batch, t);
+    for (int i = 0; i < batch->nrows * batch->ncols; i++)
+      m[i] = full ? (int)check_rand() : (int)(check_rand() % 9) - 4;
+  }
+}
+
+static void check_batch(MatBatch *c, MatBatch *a, MatBatch *b)
+{
+  for (size_t t = 0; t < c->count; t++)
+  {
+    const int *am = mat_batch_at(a, t), *bm = mat_batch_at(b, b->count == 1 ? 0 : t), *cm = mat_batch_at(c, t);
+    for (int i = 0; i < c->nrows; i++)
+    {
+      for (int j = 0; j < c->ncols; j++)
+      {
+        unsigned sum = 0;
+        for (int p = 0; p < a->ncols; p++)
+          sum += (unsigned)am[i * a->ncols + p] * (unsigned)bm[p * b->ncols + j];
+        CHECK_EQ(cm[i * c->ncols + j], (int)sum);
+      }
+    }
+  }
+}
+
+static void run(size_t count, int m, int k, int n, int shared_b, int full)
+{
+  MatBatch *a = mat_batch_new(count, m, k), *b = mat_batch_new(shared_b ? 1 : count, k, n);
+  MatBatch *c = mat_batch_new(count, m, n);
+  CHECK(a && b && c);
+  if (a && b && c)
+  {
+    CHECK((uintptr_t)mat_batch_at(c, count - 1) % SMALLGEMM_ALIGN == 0);
+    fill(a, full);
+    fill(b, full);
+    CHECK(mat_batch_mult(c, a, b));
+    check_batch(c, a, b);
+  }
+  mat_batch_destroy(a);
+  mat_batch_destroy(b);
+  mat_batch_destroy(c);
+}
+
+static void test_shapes(void)
+{
+  static const int squares[] = {4, 8, 16, 32};
+  for (int s = 0; s < 4; s++)
+  {
+    run(7, squares[s], squares[s], squares[s], 0, 0);
+    run(5, squares[s], squares[s], squares[s], 1, 1);
+  }
+  for (int trial = 0; trial < 40; trial++)
+  {
+    int m = 1 + (int)(check_rand() % 32), k = 1 + (int)(check_rand() % 32), n = 1 + (int)(check_rand() % 32);
+    run(1 + check_rand() % 9, m, k, n, (int)(check_rand() % 2), trial % 2);
+  }
+  // Enough work to be split across threads, with a slice boundary mid-batch
+  run(1001, 16, 16, 16, 0, 1);
+  run(20003, 5, 7, 6, 1, 0);
+}
+
+static void test_errors(void)
+{
+  MatBatch *a = mat_batch_new(3, 4, 5), *b = mat_batch_new(3, 4, 5), *c = mat_batch_new(3, 4, 4);
+  CHECK(!mat_batch_mult(c, a, b)); // 4x5 by 4x5
+  CHECK(!mat_batch_mult(NULL, a, b));
+  MatBatch *bt = mat_batch_new(2, 5, 4);
+  CHECK(!mat_batch_mult(c, a, bt)); // 3 products, 2 right operands
+  int one = 1;
+  CHECK(!smallgemm(&one, &one, &one, 2, 1, 1, 1, 1, 1, 0)); // Shared result
+  CHECK(mat_batch_new(3, 0, 4) == NULL);
+  mat_batch_destroy(a);
+  mat_batch_destroy(b);
+  mat_batch_destroy(c);
+  mat_batch_destroy(bt);
+}
+
+int main(void)
+{
+  setenv("LAB_THREADS", "4", 1); // Split large batches even on one CPU
+  test_shapes();
+  test_errors();
+  return check_finish("smallgemm");
+}
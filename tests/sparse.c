@@ -0,0 +1,137 @@
+// Sparse COO matrices and their conversions against a dense array where the
+// first value stored at a coordinate wins
+#include <string.h>
+#include "../sparse/sparse.h"
+#include "check.h"
+
+#define SPARSE_ROWS 23
+#define SPARSE_COLS 17
+
+static int dense[SPARSE_ROWS][SPARSE_COLS];
+static int stored[SPARSE_ROWS][SPARSE_COLS];
+
+// Makes random writes to mat and the reference, repeated coordinates included
+static void fill(SparseMat *mat, int writes)
+{
+  memset(dense, 0, sizeof(dense));
+  memset(stored, 0, sizeof(stored));
+  for (int w = 0; w < writes; w++)
+  {
+    int r = (int)(check_rand() % SPARSE_ROWS), c = (int)(check_rand() % SPARSE_COLS);
+    int value = (int)(check_rand() % 19) - 9;
+    sparse_add(mat, r, c, value);
+    if (value != 0 && !stored[r][c])
+    {
+      dense[r][c] = value;
+      stored[r][c] = 1;
+    }
+  }
+}
+
+static void test_get(void)
+{
+  SparseMat *mat = sparse_new(SPARSE_ROWS, SPARSE_COLS);
+  CHECK(mat != NULL);
+  fill(mat, SPARSE_ROWS * SPARSE_COLS);
+  for (int r = 0; r < SPARSE_ROWS; r++)
+  {
+    for (int c = 0; c < SPARSE_COLS; c++)
+      CHECK_EQ(sparse_get(mat, r, c), dense[r][c]);
+  }
+  CHECK_EQ(sparse_get(mat, SPARSE_ROWS, 0), 0);
+  sparse_mat_destroy(mat);
+}
+
+// Entries in row-major order with no zeros and no repeated coordinates
+static void check_canonical(SparseMat *mat)
+{
+  for (int k = 0; k < mat->nnz; k++)
+  {
+    CHECK(mat->data[k].value != 0);
+    if (k > 0)
+      CHECK(mat->data[k - 1].row < mat->data[k].row ||
+            (mat->data[k - 1].row == mat->data[k].row && mat->data[k - 1].col < mat->data[k].col));
+  }
+}
+
+static void test_conversions(void)
+{
+  SparseMat *a = sparse_new(SPARSE_ROWS, SPARSE_COLS);
+  fill(a, SPARSE_ROWS * SPARSE_COLS);
+  int first[SPARSE_ROWS][SPARSE_COLS];
+  memcpy(first, dense, sizeof(dense));
+
+  Mat *m = sparse_to_mat(a);
+  SparseMat *back = sparse_from_mat(m);
+  SparseMat *t = sparse_transpose(a);
+  CHECK(m && back && t);
+  if (m && back && t)
+  {
+    int nonzero = 0;
+    for (int r = 0; r < SPARSE_ROWS; r++)
+    {
+      for (int c = 0; c < SPARSE_COLS; c++)
+      {
+        CHECK_EQ(matrix_get(m, r, c), first[r][c]);
+        CHECK_EQ(sparse_get(back, r, c), first[r][c]);
+        CHECK_EQ(sparse_get(t, c, r), first[r][c]);
+        nonzero += first[r][c] != 0;
+      }
+    }
+    CHECK_EQ(back->nnz, nonzero);
+    check_canonical(back);
+    CHECK(t->nrows == SPARSE_COLS && t->ncols == SPARSE_ROWS);
+  }
+
+  // b repeats a negated at some coordinates, so parts of the sum cancel
+  SparseMat *b = sparse_new(SPARSE_ROWS, SPARSE_COLS);
+  for (int r = 0; r < SPARSE_ROWS; r += 3)
+  {
+    for (int c = 0; c < SPARSE_COLS; c++)
+    {
+      if (first[r][c])
+        sparse_add(b, r, c, -first[r][c]);
+    }
+  }
+  int negated[SPARSE_ROWS][SPARSE_COLS];
+  memset(negated, 0, sizeof(negated));
+  for (int k = 0; k < b->nnz; k++)
+    negated[b->data[k].row][b->data[k].col] = b->data[k].value;
+  SparseMat *extra = sparse_new(SPARSE_ROWS, SPARSE_COLS);
+  fill(extra, SPARSE_ROWS * 4);
+  for (int k = 0; k < extra->nnz; k++)
+    sparse_add(b, (int)extra->data[k].row, (int)extra->data[k].col, extra->data[k].value);
+
+  SparseMat *sum = sparse_sum(a, b);
+  CHECK(sum != NULL);
+  if (sum)
+  {
+    check_canonical(sum);
+    for (int r = 0; r < SPARSE_ROWS; r++)
+    {
+      for (int c = 0; c < SPARSE_COLS; c++)
+      {
+        int bv = negated[r][c] ? negated[r][c] : dense[r][c]; // b's own first value
+        CHECK_EQ(sparse_get(sum, r, c), first[r][c] + bv);
+      }
+    }
+  }
+  SparseMat *wrong = sparse_new(SPARSE_COLS, SPARSE_ROWS);
+  CHECK(sparse_sum(a, wrong) == NULL);
+
+  mat_destroy(m);
+  sparse_mat_destroy(a);
+  sparse_mat_destroy(b);
+  sparse_mat_destroy(back);
+  sparse_mat_destroy(t);
+  sparse_mat_destroy(extra);
+  sparse_mat_destroy(sum);
+  sparse_mat_destroy(wrong);
+}
+
+int main(void)
+{
+  test_get();
+  test_conversions();
+  return check_finish("sparse");
+}
@@ -0,0 +1,45 @@
+// Stack against an array used as a stack
+#include "../stack/stack.h"
+#include "check.h"
+
+#define STACK_OPS 20000
+
+int main(void)
+{
+  Stack *s = stack_new(1);
+  CHECK(s != NULL);
+  int ref[STACK_OPS];
+  size_t n = 0;
+  int out;
+  CHECK(stack_is_empty(s));
+  CHECK(!stack_pop(s, &out));
+  CHECK(!stack_peek(s, &out));
+  for (int op = 0; op < STACK_OPS; op++)
+  {
+    if (n == 0 || check_rand() % 3 != 0) // Grows on average, so the Vec resizes
+    {
+      int value = (int)check_rand();
+      CHECK(stack_push(s, value));
+      ref[n++] = value;
+    }
+    else if (check_rand() % 2)
+    {
+      CHECK(stack_pop(s, &out));
+      CHECK_EQ(out, ref[--n]);
+    }
+    else
+    {
+      CHECK(stack_peek(s, &out));
+      CHECK_EQ(out, ref[n - 1]);
+    }
+    CHECK_EQ(stack_size(s), n);
+  }
+  while (n > 0)
+  {
+    CHECK(stack_pop(s, &out));
+    CHECK_EQ(out, ref[--n]);
+  }
+  CHECK(stack_is_empty(s));
+  stack_destroy(s);
+  return check_finish("stack");
+}
@@ -0,0 +1,202 @@
+// Typed products against a naive triple loop summed in the same wrapping
+// unsigned type, over shapes that exercise the padded rows, the odd-k pair
+// packing and the partial column chunks of the vector kernels. The first
+// products run on several threads at once, racing on the CPU feature check.
+#include <pthread.h>
+#include <stdint.h>
+#include "../tmat/tmat.h"
+#include "check.h"
+
+#define TMAT_TRIALS 40
+#define TMAT_MAX_DIM 70
+#define TMAT_THREADS 4
+
+// Full-range values half the time (sums wrap), small ones otherwise
+static int64_t random_value(int full)
+{
+  if (full)
+    return (int64_t)(((uint64_t)check_rand() << 32) | check_rand());
+  return (int)(check_rand() % 7) - 3;
+}
+
+static int random_dim(void)
+{
+  return 1 + (int)(check_rand() % TMAT_MAX_DIM);
+}
+
+// test_i8() etc.: Arith is the wrapping type the reference sums in
+#define TEST_PRODUCT(suffix, Name, T, AccT, Arith, full_range)                  \
+  static void test_##suffix(void)                                               \
+  {                                                                             \
+    for (int trial = 0; trial < TMAT_TRIALS; trial++)                           \
+    {                                                                           \
+      int n = random_dim(), k = random_dim(), m = random_dim();                 \
+      int full = (full_range) && trial % 2;                                     \
+      Name *a = tmat_new_##suffix(n, k), *b = tmat_new_##suffix(k, m);          \
+      CHECK(((uintptr_t)a->data | (uintptr_t)b->data) % TMAT_ALIGN == 0);       \
+      CHECK(a->stride * sizeof(T) % TMAT_ALIGN == 0);                           \
+      for (int i = 0; i < n; i++)                                               \
+      {                                                                         \
+        for (int p = 0; p < k; p++)                                             \
+          tmat_set(a, i, p, (T)random_value(full));                             \
+      }                                                                         \
+      for (int p = 0; p < k; p++)                                               \
+      {                                                                         \
+        for (int j = 0; j < m; j++)                                             \
+          tmat_set(b, p, j, (T)random_value(full));                             \
+      }                                                                         \
+      __typeof__(tmat_mult(a, b)) c = tmat_mult(a, b);                          \
+      CHECK(c != NULL && c->nrows == n && c->ncols == m);                       \
+      for (int i = 0; c && i < n; i++)                                          \
+      {                                                                         \
+        for (int j = 0; j < m; j++)                                             \
+        {                                                                       \
+          Arith sum = 0;                                                        \
+          for (int p = 0; p < k; p++)                                           \
+            sum += (Arith)tmat_get(a, i, p) * (Arith)tmat_get(b, p, j);         \
+          CHECK_EQ(tmat_get(c, i, j), (AccT)sum);                               \
+        }                                                                       \
+      }                                                                         \
+      tmat_destroy(a);                                                          \
+      tmat_destroy(b);                                                          \
+      tmat_destroy(c);                                                          \
+    }                                                                           \
+  }
+
+TEST_PRODUCT(i8, MatI8, int8_t, int32_t, uint32_t, 1)
+TEST_PRODUCT(i16, MatI16, int16_t, int32_t, uint32_t, 1)
+TEST_PRODUCT(i32, MatI32, int32_t, int64_t, uint64_t, 1)
+TEST_PRODUCT(i64, MatI64, int64_t, int64_t, uint64_t, 1)
+// Small integers keep every float sum exact
+TEST_PRODUCT(f32, MatF32, float, float, float, 0)
+TEST_PRODUCT(f64, MatF64, double, double, double, 0)
+
+// mat_mult_exact holds sums past int: the int32 extremes at k = 1, and
+// entries within +-2^24 (the documented bound) for longer rows
+static void test_exact(void)
+{
+  Mat *a = mat_new(2, 1), *b = mat_new(1, 2);
+  matrix_set(a, 0, 0, INT32_MIN);
+  matrix_set(a, 1, 0, INT32_MAX);
+  matrix_set(b, 0, 0, INT32_MIN);
+  matrix_set(b, 0, 1, INT32_MAX);
+  MatI64 *c = mat_mult_exact(a, b);
+  CHECK(c != NULL);
+  if (c)
+  {
+    CHECK_EQ(tmat_get(c, 0, 0), (int64_t)INT32_MIN * INT32_MIN);
+    CHECK_EQ(tmat_get(c, 0, 1), (int64_t)INT32_MIN * INT32_MAX);
+    CHECK_EQ(tmat_get(c, 1, 1), (int64_t)INT32_MAX * INT32_MAX);
+  }
+  tmat_destroy(c);
+  mat_destroy(a);
+  mat_destroy(b);
+
+  int n = 9, k = 300, m = 11, limit = 1 << 24;
+  a = mat_new(n, k);
+  b = mat_new(k, m);
+  for (int i = 0; i < n; i++)
+  {
+    for (int p = 0; p < k; p++)
+      matrix_set(a, i, p, (int)(check_rand() % (2u * limit + 1)) - limit);
+  }
+  for (int p = 0; p < k; p++)
+  {
+    for (int j = 0; j < m; j++)
+      matrix_set(b, p, j, (int)(check_rand() % (2u * limit + 1)) - limit);
+  }
+  c = mat_mult_exact(a, b);
+  CHECK(c != NULL);
+  for (int i = 0; c && i < n; i++)
+  {
+    for (int j = 0; j < m; j++)
+    {
+      int64_t sum = 0;
+      for (int p = 0; p < k; p++)
+        sum += (int64_t)matrix_get(a, i, p) * matrix_get(b, p, j);
+      CHECK_EQ(tmat_get(c, i, j), sum);
+    }
+  }
+
+  // from_mat narrows with plain C casts
+  MatI8 *a8 = tmat_from_mat(i8, a);
+  MatF64 *a64 = tmat_from_mat(f64, a);
+  CHECK(a8 != NULL && a64 != NULL);
+  for (int i = 0; a8 && a64 && i < n; i++)
+  {
+    for (int p = 0; p < k; p++)
+    {
+      CHECK_EQ(tmat_get(a8, i, p), (int8_t)matrix_get(a, i, p));
+      CHECK_EQ(tmat_get(a64, i, p), matrix_get(a, i, p));
+    }
+  }
+  tmat_destroy(a8);
+  tmat_destroy(a64);
+  tmat_destroy(c);
+
+  CHECK(mat_mult_exact(a, a) == NULL); // 9x300 * 9x300
+  CHECK(tmat_new_i32(0, 3) == NULL);
+  mat_destroy(a);
+  mat_destroy(b);
+}
+
+// One int8 product (the AVX2 pair kernel when available); *arg is set to 1 when it matches
+static void *product_worker(void *arg)
+{
+  int *ok = arg;
+  int n = 7, k = 9, m = 10;
+  MatI8 *a = tmat_new_i8(n, k), *b = tmat_new_i8(k, m);
+  for (int i = 0; i < n; i++)
+  {
+    for (int p = 0; p < k; p++)
+      tmat_set(a, i, p, (int8_t)(i + p));
+  }
+  for (int p = 0; p < k; p++)
+  {
+    for (int j = 0; j < m; j++)
+      tmat_set(b, p, j, (int8_t)(p - j));
+  }
+  MatI32 *c = tmat_mult(a, b);
+  *ok = c != NULL;
+  for (int i = 0; c && i < n; i++)
+  {
+    for (int j = 0; j < m; j++)
+    {
+      int32_t sum = 0;
+      for (int p = 0; p < k; p++)
+        sum += (i + p) * (p - j);
+      if (tmat_get(c, i, j) != sum)
+        *ok = 0;
+    }
+  }
+  tmat_destroy(a);
+  tmat_destroy(b);
+  tmat_destroy(c);
+  return NULL;
+}
+
+static void test_racing_first_use(void)
+{
+  pthread_t threads[TMAT_THREADS];
+  int ok[TMAT_THREADS] = {0};
+  for (int t = 0; t < TMAT_THREADS; t++)
+    CHECK(pthread_create(&threads[t], NULL, product_worker, &ok[t]) == 0);
+  for (int t = 0; t < TMAT_THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+    CHECK(ok[t]);
+  }
+}
+
+int main(void)
+{
+  test_racing_first_use();
+  test_i8();
+  test_i16();
+  test_i32();
+  test_i64();
+  test_f32();
+  test_f64();
+  test_exact();
+  return check_finish("tmat");
+}
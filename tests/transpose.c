@@ -0,0 +1,89 @@
+// Cache-oblivious transposes and the transposed-B product against direct indexing
+#include <stdlib.h>
+#include "../matrix/matrix.h"
+#include "../transpose/transpose.h"
+#include "check.h"
+
+static Mat *random_mat(int nrows, int ncols)
+{
+  Mat *mat = mat_new(nrows, ncols);
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      matrix_set(mat, i, j, (int)(check_rand() % 41) - 20);
+  }
+  return mat;
+}
+
+static void test_transpose(int nrows, int ncols)
+{
+  Mat *mat = random_mat(nrows, ncols);
+  Mat *t = mat_transpose(mat);
+  CHECK(t != NULL && t->nrows == ncols && t->ncols == nrows);
+  for (int i = 0; t && i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      CHECK_EQ(matrix_get(t, j, i), matrix_get(mat, i, j));
+  }
+
+  // The view kernel into a window of a larger destination
+  Mat *big = mat_new(ncols + 3, nrows + 5);
+  MatView src = mat_view(mat), whole = mat_view(big);
+  transpose_view(mat_view_block(whole, 2, 4, ncols, nrows), src);
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      CHECK_EQ(matrix_get(big, j + 2, i + 4), matrix_get(mat, i, j));
+  }
+  mat_view_release(src);
+  mat_view_release(whole);
+
+  if (nrows == ncols)
+  {
+    Mat *copy = mat_transpose(t); // The original again
+    CHECK(mat_transpose_inplace(copy));
+    for (int i = 0; i < nrows; i++)
+    {
+      for (int j = 0; j < ncols; j++)
+        CHECK_EQ(matrix_get(copy, i, j), matrix_get(t, i, j));
+    }
+    mat_destroy(copy);
+  }
+  else
+    CHECK(!mat_transpose_inplace(mat)); // Square only
+  mat_destroy(big);
+  mat_destroy(t);
+  mat_destroy(mat);
+}
+
+static void test_mult_transposed(int m, int k, int n)
+{
+  Mat *a = random_mat(m, k), *b = random_mat(k, n);
+  Mat *bt = mat_transpose(b);
+  Mat *c = mat_mult_transposed(a, bt);
+  CHECK(c != NULL);
+  for (int i = 0; c && i < m; i++)
+  {
+    for (int j = 0; j < n; j++)
+    {
+      int sum = 0;
+      for (int p = 0; p < k; p++)
+        sum += matrix_get(a, i, p) * matrix_get(b, p, j);
+      CHECK_EQ(matrix_get(c, i, j), sum);
+    }
+  }
+  mat_destroy(a);
+  mat_destroy(b);
+  mat_destroy(bt);
+  mat_destroy(c);
+}
+
+int main(void)
+{
+  int shapes[][2] = {{1, 1}, {1, 40}, {40, 1}, {31, 33}, {32, 32}, {64, 64}, {97, 97}, {150, 70}};
+  for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+    test_transpose(shapes[s][0], shapes[s][1]);
+  test_mult_transposed(1, 1, 1);
+  test_mult_transposed(37, 300, 65);
+  return check_finish("transpose");
+}
@@ -0,0 +1,332 @@
+// Writer output and the matrix writers against text built with snprintf, and
+// the print functions sharing one stdout writer in order with stdio
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../matrix/matrix.h"
+#include "../sparse/sparse.h"
+#include "../writer/writer.h"
+#include "check.h"
+
+// Growing reference buffer
+typedef struct
+{
+  char *data;
+  size_t len;
+  size_t capacity;
+} Text;
+
+static void text_add(Text *t, const void *data, size_t n)
+{
+  if (t->len + n > t->capacity)
+  {
+    t->capacity = (t->len + n) * 2;
+    t->data = realloc(t->data, t->capacity);
+  }
+  memcpy(t->data + t->len, data, n);
+  t->len += n;
+}
+
+static void text_str(Text *t, const char *s)
+{
+  text_add(t, s, strlen(s));
+}
+
+static void text_printf(Text *t, const char *fmt, long long value)
+{
+  char tmp[32];
+  int n = snprintf(tmp, sizeof(tmp), fmt, value);
+  text_add(t, tmp, (size_t)n);
+}
+
+// Runs fill on a writer with the given buffer capacity and compares the bytes
+// that reach the file with expected
+static void check_output(size_t capacity, void (*fill)(Writer *w, void *ctx), void *ctx, const Text *expected)
+{
+  FILE *tmp = tmpfile();
+  CHECK(tmp != NULL);
+  if (!tmp)
+    return;
+  Writer *w = writer_new(fileno(tmp), capacity);
+  CHECK(w != NULL);
+  fill(w, ctx);
+  CHECK(writer_destroy(w));
+  fseek(tmp, 0, SEEK_END); // The writer moved the descriptor's offset, not the stream's
+  long size = ftell(tmp);
+  CHECK_EQ(size, expected->len);
+  char *actual = malloc(expected->len + 1);
+  rewind(tmp);
+  if (size == (long)expected->len && fread(actual, 1, expected->len, tmp) == expected->len)
+    CHECK(memcmp(actual, expected->data, expected->len) == 0);
+  free(actual);
+  fclose(tmp);
+}
+
+// --- Raw writer calls ---
+
+#define WRITER_OPS 20000
+
+typedef struct
+{
+  int kind[WRITER_OPS];
+  long long value[WRITER_OPS];
+} WriterScript;
+
+static void fill_script(Writer *w, void *ctx)
+{
+  WriterScript *s = ctx;
+  static char big[3000];
+  for (int i = 0; i < WRITER_OPS; i++)
+  {
+    switch (s->kind[i])
+    {
+    case 0:
+      writer_int(w, s->value[i]);
+      break;
+    case 1:
+      writer_char(w, (char)('a' + s->value[i] % 26));
+      break;
+    case 2:
+      writer_str(w, "xyz\t");
+      break;
+    default:
+      memset(big, (int)('A' + s->value[i] % 26), sizeof(big));
+      writer_bytes(w, big, (size_t)(s->value[i] % (long long)sizeof(big))); // Often larger than the buffer
+      break;
+    }
+  }
+}
+
+static void test_raw(size_t capacity)
+{
+  static const long long edges[] = {0, -1, 9, 10, -10, INT_MAX, INT_MIN, LLONG_MAX, LLONG_MIN};
+  WriterScript *s = malloc(sizeof(WriterScript));
+  Text expected = {0};
+  char big[3000];
+  for (int i = 0; i < WRITER_OPS; i++)
+  {
+    s->kind[i] = (int)(check_rand() % 16);
+    s->kind[i] = s->kind[i] < 10 ? 0 : s->kind[i] < 13 ? 1 : s->kind[i] < 15 ? 2 : 3;
+    s->value[i] = (check_rand() % 8 == 0) ? edges[check_rand() % (sizeof(edges) / sizeof(edges[0]))]
+                                          : (long long)(int)check_rand();
+    if (s->kind[i] != 0)
+      s->value[i] = (long long)(check_rand() % 100000);
+    switch (s->kind[i])
+    {
+    case 0:
+      text_printf(&expected, "%lld", s->value[i]);
+      break;
+    case 1:
+      text_add(&expected, (char[]){(char)('a' + s->value[i] % 26)}, 1);
+      break;
+    case 2:
+      text_str(&expected, "xyz\t");
+      break;
+    default:
+      memset(big, (int)('A' + s->value[i] % 26), sizeof(big));
+      text_add(&expected, big, (size_t)(s->value[i] % (long long)sizeof(big)));
+      break;
+    }
+  }
+  check_output(capacity, fill_script, s, &expected);
+  free(expected.data);
+  free(s);
+}
+
+// --- Matrix writers ---
+
+typedef struct
+{
+  Mat *mat;
+  SparseMat *sparse;
+  OutFormat format;
+} MatJob;
+
+static void fill_mat(Writer *w, void *ctx)
+{
+  MatJob *job = ctx;
+  if (job->mat)
+    CHECK(mat_write(job->mat, w, job->format));
+  else
+    CHECK(sparse_write(job->sparse, w, job->format));
+}
+
+static void expect_delimited(Text *t, Mat *mat, char sep)
+{
+  for (int i = 0; i < mat->nrows; i++)
+  {
+    for (int j = 0; j < mat->ncols; j++)
+    {
+      if (j > 0)
+        text_add(t, &sep, 1);
+      text_printf(t, "%lld", matrix_get(mat, i, j));
+    }
+    text_add(t, "\n", 1);
+  }
+}
+
+static void test_mat(int nrows, int ncols)
+{
+  Mat *mat = mat_new(nrows, ncols);
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      matrix_set(mat, i, j, (int)check_rand());
+  }
+  MatJob job = {mat, NULL, OUT_TSV};
+  Text t = {0};
+  expect_delimited(&t, mat, '\t');
+  check_output(64, fill_mat, &job, &t);
+
+  job.format = OUT_CSV;
+  t.len = 0;
+  expect_delimited(&t, mat, ',');
+  check_output(WRITER_DEFAULT_CAPACITY, fill_mat, &job, &t);
+
+  job.format = OUT_MM;
+  t.len = 0;
+  text_str(&t, "%%MatrixMarket matrix array integer general\n");
+  text_printf(&t, "%lld ", nrows);
+  text_printf(&t, "%lld\n", ncols);
+  for (int j = 0; j < ncols; j++)
+  {
+    for (int i = 0; i < nrows; i++)
+      text_printf(&t, "%lld\n", matrix_get(mat, i, j));
+  }
+  check_output(100, fill_mat, &job, &t);
+
+  job.format = OUT_BINARY;
+  t.len = 0;
+  int32_t dims[2] = {nrows, ncols};
+  text_add(&t, "LABM", 4);
+  text_add(&t, dims, sizeof(dims));
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+    {
+      int32_t v = matrix_get(mat, i, j);
+      text_add(&t, &v, sizeof(v));
+    }
+  }
+  check_output(64, fill_mat, &job, &t);
+  free(t.data);
+  mat_destroy(mat);
+}
+
+// Sparse writers: dense rows resolve repeats first-wins; coordinates come out
+// in row order, keeping insertion order within a row
+static void test_sparse(int nrows, int ncols, int writes)
+{
+  SparseMat *sparse = sparse_new(nrows, ncols);
+  for (int k = 0; k < writes; k++)
+    sparse_add(sparse, (int)(check_rand() % (unsigned)nrows), (int)(check_rand() % (unsigned)ncols),
+               (int)(check_rand() % 21) - 10);
+  Mat *dense = mat_new(nrows, ncols);
+  for (int i = 0; i < nrows; i++)
+  {
+    for (int j = 0; j < ncols; j++)
+      matrix_set(dense, i, j, sparse_get(sparse, i, j));
+  }
+  MatJob job = {NULL, sparse, OUT_TSV};
+  Text t = {0};
+  expect_delimited(&t, dense, '\t');
+  check_output(64, fill_mat, &job, &t);
+
+  job.format = OUT_MM;
+  t.len = 0;
+  text_str(&t, "%%MatrixMarket matrix coordinate integer general\n");
+  text_printf(&t, "%lld ", nrows);
+  text_printf(&t, "%lld ", ncols);
+  text_printf(&t, "%lld\n", sparse->nnz);
+  for (int r = 0; r < nrows; r++)
+  {
+    for (int k = 0; k < sparse->nnz; k++)
+    {
+      SparseEntry *e = &sparse->data[k];
+      if (e->row != (size_t)r)
+        continue;
+      text_printf(&t, "%lld ", (long long)e->row + 1);
+      text_printf(&t, "%lld ", (long long)e->col + 1);
+      text_printf(&t, "%lld\n", e->value);
+    }
+  }
+  check_output(WRITER_DEFAULT_CAPACITY, fill_mat, &job, &t);
+  free(t.data);
+  mat_destroy(dense);
+  sparse_mat_destroy(sparse);
+}
+
+// print_mat, sparse_print and mat_print interleaved with printf, with fd 1
+// redirected to a temporary file
+static void test_print(void)
+{
+  Mat *mat = mat_new(2, 3);
+  for (int i = 0; i < 2; i++)
+  {
+    for (int j = 0; j < 3; j++)
+      matrix_set(mat, i, j, i * 10 - j);
+  }
+  SparseMat *sparse = sparse_new(2, 2);
+  sparse_add(sparse, 1, 0, -7);
+  FILE *tmp = tmpfile();
+  CHECK(tmp != NULL);
+  if (!tmp)
+    return;
+  fflush(stdout);
+  int saved = dup(STDOUT_FILENO);
+  CHECK(saved >= 0 && dup2(fileno(tmp), STDOUT_FILENO) >= 0);
+  printf("before\n");
+  print_mat(mat);
+  printf("between\n");
+  print_mat(mat);
+  sparse_print(sparse);
+  mat_print(sparse);
+  printf("after\n");
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+
+  Text t = {0};
+  const char *block = "Matrix (2x3):\n0\t-1\t-2\t\n10\t9\t8\t\n";
+  text_str(&t, "before\n");
+  text_str(&t, block);
+  text_str(&t, "between\n");
+  text_str(&t, block);
+  text_str(&t, "Sparse matrix (COO format) - 1 non-zero elements:\n(Row: 2, Col: 1, Value: -7)\n");
+  text_str(&t, "Matrix in Dense Format (2x2):\n0\t0\t\n-7\t0\t\n");
+  text_str(&t, "after\n");
+  fseek(tmp, 0, SEEK_END);
+  long size = ftell(tmp);
+  CHECK_EQ(size, t.len);
+  char *actual = calloc(t.len + 1, 1);
+  rewind(tmp);
+  if (size == (long)t.len && fread(actual, 1, t.len, tmp) == t.len)
+    CHECK(memcmp(actual, t.data, t.len) == 0);
+  free(actual);
+  free(t.data);
+  fclose(tmp);
+  CHECK(writer_stdout() == writer_stdout()); // One writer for every print
+  mat_destroy(mat);
+  sparse_mat_destroy(sparse);
+}
+
+int main(void)
+{
+  test_raw(16);
+  test_raw(WRITER_DEFAULT_CAPACITY);
+  test_mat(1, 1);
+  test_mat(17, 29);
+  test_mat(300, 40);
+  test_sparse(1, 1, 3);
+  test_sparse(40, 25, 300);
+  test_print();
+  OutFormat format;
+  CHECK(writer_parse_format("csv", &format) && format == OUT_CSV);
+  CHECK(writer_parse_format("mtx", &format) && format == OUT_MM);
+  CHECK(writer_parse_format("bin", &format) && format == OUT_BINARY);
+  CHECK(!writer_parse_format("xml", &format));
+  return check_finish("writer");
+}
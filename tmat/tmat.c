@@ -0,0 +1,322 @@
+#include "tmat.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../matrix/matrix.h"
+#include "../vector/vector.h"
+#include "../alloc/alloc.h"
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define TMAT_HAVE_X86 1
+#endif
+
+// Blocking for the generic i-k-j kernels: a TMAT_BLOCK_K x TMAT_BLOCK_J panel
+// of B stays in L2 while the rows of A stream past it
+#define TMAT_BLOCK_K 128
+#define TMAT_BLOCK_J 256
+// Columns of C kept in registers by the AVX2 pair kernel (four 8-lane vectors)
+#define TMAT_PAIR_CHUNK 32
+
+// --- Storage ---
+
+#define TMAT_DEFINE(Name, suffix, T)                                                                  \
+  Name *tmat_new_##suffix(int nrows, int ncols)                                                       \
+  {                                                                                                   \
+    if (nrows < 1 || ncols < 1)                                                                       \
+    {                                                                                                 \
+      fprintf(stderr, "Error: Dimensions must be positive integers (got %dx%d).\n", nrows, ncols);    \
+      return NULL;                                                                                    \
+    }                                                                                                 \
+    Name *m = alloc_malloc(sizeof(Name), ALLOC_MATRIX);                                               \
+    if (!m)                                                                                           \
+    {                                                                                                 \
+      fprintf(stderr, "Memory allocation failed for " #Name " struct.\n");                            \
+      return NULL;                                                                                    \
+    }                                                                                                 \
+    size_t per_line = TMAT_ALIGN / sizeof(T);                                                         \
+    m->nrows = nrows;                                                                                 \
+    m->ncols = ncols;                                                                                 \
+    m->stride = ((size_t)ncols + per_line - 1) / per_line * per_line;                                 \
+    /* Zeroed so the row padding reads as 0 (the pair kernels rely on it) */                          \
+    m->block = alloc_calloc(m->stride * (size_t)nrows * sizeof(T) + TMAT_ALIGN, 1, ALLOC_MATRIX);     \
+    if (!m->block)                                                                                    \
+    {                                                                                                 \
+      fprintf(stderr, "Memory allocation failed for " #Name " data (%dx%d).\n", nrows, ncols);        \
+      alloc_free(m, ALLOC_MATRIX);                                                                    \
+      return NULL;                                                                                    \
+    }                                                                                                 \
+    m->data = (T *)(((uintptr_t)m->block + TMAT_ALIGN - 1) & ~(uintptr_t)(TMAT_ALIGN - 1));           \
+    return m;                                                                                         \
+  }                                                                                                   \
+                                                                                                      \
+  void tmat_destroy_##suffix(Name *m)                                                                 \
+  {                                                                                                   \
+    if (m == NULL)                                                                                    \
+      return;                                                                                         \
+    alloc_free(m->block, ALLOC_MATRIX);                                                               \
+    alloc_free(m, ALLOC_MATRIX);                                                                      \
+  }                                                                                                   \
+                                                                                                      \
+  T tmat_get_##suffix(Name *m, int i, int j)                                                          \
+  {                                                                                                   \
+    return m->data[(size_t)i * m->stride + j];                                                        \
+  }                                                                                                   \
+                                                                                                      \
+  void tmat_set_##suffix(Name *m, int i, int j, T value)                                              \
+  {                                                                                                   \
+    m->data[(size_t)i * m->stride + j] = value;                                                       \
+  }                                                                                                   \
+                                                                                                      \
+  Name *tmat_from_mat_##suffix(Mat *mat)                                                              \
+  {                                                                                                   \
+    if (mat == NULL)                                                                                  \
+    {                                                                                                 \
+      fprintf(stderr, "Error: Cannot convert a NULL matrix.\n");                                      \
+      return NULL;                                                                                    \
+    }                                                                                                 \
+    Name *m = tmat_new_##suffix(mat->nrows, mat->ncols);                                              \
+    if (!m)                                                                                           \
+      return NULL;                                                                                    \
+    for (int i = 0; i < mat->nrows; i++)                                                              \
+    {                                                                                                 \
+      const int *row = (*(Vec **)vec_get(mat->rows, i))->data;                                        \
+      T *dst = m->data + (size_t)i * m->stride;                                                       \
+      for (int j = 0; j < mat->ncols; j++)                                                            \
+        dst[j] = (T)row[j];                                                                           \
+    }                                                                                                 \
+    return m;                                                                                         \
+  }
+
+TMAT_TYPES(TMAT_DEFINE)
+
+// --- Generic kernels ---
+
+#ifdef TMAT_HAVE_X86
+// The build targets baseline x86-64, so wider kernels are chosen at run time
+static pthread_once_t tmat_cpu_once = PTHREAD_ONCE_INIT;
+static int tmat_avx2 = 0;
+
+static void tmat_detect_cpu(void)
+{
+  __builtin_cpu_init();
+  tmat_avx2 = __builtin_cpu_supports("avx2") != 0;
+}
+
+static int tmat_use_avx2(void)
+{
+  pthread_once(&tmat_cpu_once, tmat_detect_cpu);
+  return tmat_avx2;
+}
+
+#endif
+
+
+// c += a * b with i-k-j loops over B panels. Arith is the type the sums are
+// formed in: the unsigned twin of the accumulator type for the integer
+// kernels, so a sum that leaves the accumulator's range wraps (mod 2^32 or
+// 2^64, as vpmaddwd does) instead of being undefined signed overflow.
+#define TMAT_DEFINE_KERNEL(suffix, Name, T, AccName, Arith)                       \
+  TMAT_DEFINE_KERNEL_AS(tmat_kernel_##suffix, Name, T, AccName, Arith, )
+
+#define TMAT_DEFINE_KERNEL_AS(fn, Name, T, AccName, Arith, attr)                  \
+  attr static void fn(AccName *c, Name *a, Name *b)                               \
+  {                                                                               \
+    for (int jj = 0; jj < c->ncols; jj += TMAT_BLOCK_J)                           \
+    {                                                                             \
+      int jend = jj + TMAT_BLOCK_J < c->ncols ? jj + TMAT_BLOCK_J : c->ncols;     \
+      for (int kk = 0; kk < a->ncols; kk += TMAT_BLOCK_K)                         \
+      {                                                                           \
+        int kend = kk + TMAT_BLOCK_K < a->ncols ? kk + TMAT_BLOCK_K : a->ncols;   \
+        for (int i = 0; i < c->nrows; i++)                                        \
+        {                                                                         \
+          Arith *restrict crow = (Arith *)(c->data + (size_t)i * c->stride);      \
+          const T *arow = a->data + (size_t)i * a->stride;                        \
+          for (int k = kk; k < kend; k++)                                         \
+          {                                                                       \
+            Arith aik = (Arith)arow[k];                                           \
+            const T *restrict brow = b->data + (size_t)k * b->stride;             \
+            for (int j = jj; j < jend; j++)                                       \
+              crow[j] += aik * (Arith)brow[j];                                    \
+          }                                                                       \
+        }                                                                         \
+      }                                                                           \
+    }                                                                             \
+  }
+
+TMAT_DEFINE_KERNEL(i8, MatI8, int8_t, MatI32, uint32_t)
+TMAT_DEFINE_KERNEL(i16, MatI16, int16_t, MatI32, uint32_t)
+TMAT_DEFINE_KERNEL(i32, MatI32, int32_t, MatI64, uint64_t)
+TMAT_DEFINE_KERNEL(i64, MatI64, int64_t, MatI64, uint64_t)
+TMAT_DEFINE_KERNEL(f32, MatF32, float, MatF32, float)
+TMAT_DEFINE_KERNEL(f64, MatF64, double, MatF64, double)
+
+#ifdef TMAT_HAVE_X86
+// The baseline x86-64 target has no packed 32x32->64 multiply, so the int32
+// kernel also gets an AVX2 build (vpmuldq) picked at run time
+TMAT_DEFINE_KERNEL_AS(tmat_kernel_i32_avx2, MatI32, int32_t, MatI64, uint64_t, __attribute__((target("avx2"))))
+#endif
+
+static void tmat_kernel_i32_dispatch(MatI64 *c, MatI32 *a, MatI32 *b)
+{
+#ifdef TMAT_HAVE_X86
+  if (tmat_use_avx2())
+  {
+    tmat_kernel_i32_avx2(c, a, b);
+    return;
+  }
+#endif
+  tmat_kernel_i32(c, a, b);
+}
+
+// --- int8/int16: pairwise multiply-add ---
+
+#ifdef TMAT_HAVE_X86
+// c += A * B where apairs holds A as (a[i][2p], a[i][2p+1]) int16 pairs and
+// panel holds rows 2p and 2p+1 of B interleaved. One vpmaddwd multiplies 8
+// column pairs and adds each pair into an int32 lane (VNNI's vpdpwssd fused
+// with the add). Four accumulators cover TMAT_PAIR_CHUNK columns of a C row
+// for the whole k loop, so C is loaded and stored once.
+__attribute__((target("avx2"))) static void tmat_pairs_avx2(MatI32 *c, const int32_t *apairs, const int16_t *panel,
+                                                             int kp, int npad)
+{
+  size_t prow_len = (size_t)npad * 2;
+  for (int j0 = 0; j0 < npad; j0 += TMAT_PAIR_CHUNK)
+  {
+    int chunk = npad - j0 < TMAT_PAIR_CHUNK ? npad - j0 : TMAT_PAIR_CHUNK; // A multiple of 8
+    for (int i = 0; i < c->nrows; i++)
+    {
+      int32_t *crow = c->data + (size_t)i * c->stride + j0;
+      const int32_t *arow = apairs + (size_t)i * kp;
+      const int16_t *pcol = panel + (size_t)j0 * 2;
+      if (chunk == TMAT_PAIR_CHUNK)
+      {
+        __m256i acc0 = _mm256_loadu_si256((const __m256i *)crow);
+        __m256i acc1 = _mm256_loadu_si256((const __m256i *)(crow + 8));
+        __m256i acc2 = _mm256_loadu_si256((const __m256i *)(crow + 16));
+        __m256i acc3 = _mm256_loadu_si256((const __m256i *)(crow + 24));
+        for (int p = 0; p < kp; p++)
+        {
+          __m256i av = _mm256_set1_epi32(arow[p]);
+          const int16_t *prow = pcol + (size_t)p * prow_len;
+          acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)prow), av));
+          acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(prow + 16)), av));
+          acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(prow + 32)), av));
+          acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(prow + 48)), av));
+        }
+        _mm256_storeu_si256((__m256i *)crow, acc0);
+        _mm256_storeu_si256((__m256i *)(crow + 8), acc1);
+        _mm256_storeu_si256((__m256i *)(crow + 16), acc2);
+        _mm256_storeu_si256((__m256i *)(crow + 24), acc3);
+      }
+      else
+      {
+        for (int v = 0; v < chunk; v += 8)
+        {
+          __m256i acc = _mm256_loadu_si256((const __m256i *)(crow + v));
+          for (int p = 0; p < kp; p++)
+          {
+            __m256i bv = _mm256_loadu_si256((const __m256i *)(pcol + (size_t)p * prow_len + 2 * v));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(bv, _mm256_set1_epi32(arow[p])));
+          }
+          _mm256_storeu_si256((__m256i *)(crow + v), acc);
+        }
+      }
+    }
+  }
+}
+
+// Packs A into int16 pairs and B into the interleaved panel, then runs the AVX2
+// kernel. The columns past ncols (row padding) read as zero, which also pads
+// an odd k and the C columns up to a multiple of 8.
+#define TMAT_DEFINE_PAIR_KERNEL(suffix, Name, T)                                                          \
+  static void tmat_kernel_pairs_##suffix(MatI32 *c, Name *a, Name *b)                                     \
+  {                                                                                                       \
+    if (!tmat_use_avx2())                                                                                 \
+    {                                                                                                     \
+      tmat_kernel_##suffix(c, a, b);                                                                      \
+      return;                                                                                             \
+    }                                                                                                     \
+    int k = a->ncols, kp = (k + 1) / 2, npad = (b->ncols + 7) / 8 * 8;                                    \
+    int32_t *apairs = alloc_malloc(sizeof(int32_t) * (size_t)a->nrows * kp, ALLOC_MATRIX);                \
+    int16_t *panel = alloc_calloc((size_t)kp * npad * 2, sizeof(int16_t), ALLOC_MATRIX);                  \
+    if (!apairs || !panel)                                                                                \
+    {                                                                                                     \
+      alloc_free(apairs, ALLOC_MATRIX);                                                                   \
+      alloc_free(panel, ALLOC_MATRIX);                                                                    \
+      tmat_kernel_##suffix(c, a, b); /* No scratch: fall back to the generic loop */                      \
+      return;                                                                                             \
+    }                                                                                                     \
+    for (int i = 0; i < a->nrows; i++)                                                                    \
+    {                                                                                                     \
+      const T *arow = a->data + (size_t)i * a->stride; /* arow[k] is padding when k is odd */             \
+      for (int p = 0; p < kp; p++)                                                                        \
+        apairs[(size_t)i * kp + p] =                                                                      \
+            (int32_t)((uint32_t)(uint16_t)arow[2 * p] | ((uint32_t)(uint16_t)arow[2 * p + 1] << 16));     \
+    }                                                                                                     \
+    for (int p = 0; p < kp; p++)                                                                          \
+    {                                                                                                     \
+      const T *b0 = b->data + (size_t)(2 * p) * b->stride;                                                \
+      const T *b1 = 2 * p + 1 < k ? b0 + b->stride : NULL;                                                \
+      int16_t *prow = panel + (size_t)p * npad * 2;                                                       \
+      for (int j = 0; j < b->ncols; j++)                                                                  \
+      {                                                                                                   \
+        prow[2 * j] = b0[j];                                                                              \
+        prow[2 * j + 1] = b1 ? b1[j] : 0;                                                                 \
+      }                                                                                                   \
+    }                                                                                                     \
+    tmat_pairs_avx2(c, apairs, panel, kp, npad);                                                          \
+    alloc_free(apairs, ALLOC_MATRIX);                                                                     \
+    alloc_free(panel, ALLOC_MATRIX);                                                                      \
+  }
+#else
+#define TMAT_DEFINE_PAIR_KERNEL(suffix, Name, T)                      \
+  static void tmat_kernel_pairs_##suffix(MatI32 *c, Name *a, Name *b) \
+  {                                                                   \
+    tmat_kernel_##suffix(c, a, b);                                    \
+  }
+#endif
+
+TMAT_DEFINE_PAIR_KERNEL(i8, MatI8, int8_t)
+TMAT_DEFINE_PAIR_KERNEL(i16, MatI16, int16_t)
+
+// --- Products ---
+
+#define TMAT_DEFINE_MULT(suffix, Name, acc_suffix, AccName, kernel)                                       \
+  AccName *tmat_mult_##suffix(Name *a, Name *b)                                                           \
+  {                                                                                                       \
+    if (a == NULL || b == NULL)                                                                           \
+    {                                                                                                     \
+      fprintf(stderr, "Error: Cannot multiply a NULL matrix.\n");                                         \
+      return NULL;                                                                                        \
+    }                                                                                                     \
+    if (a->ncols != b->nrows)                                                                             \
+    {                                                                                                     \
+      fprintf(stderr, "Error: Incompatible matrix dimensions for multiplication. "                        \
+                      "Number of columns in first matrix (%d) must equal number of rows in second matrix (%d).\n", \
+              a->ncols, b->nrows);                                                                        \
+      return NULL;                                                                                        \
+    }                                                                                                     \
+    AccName *c = tmat_new_##acc_suffix(a->nrows, b->ncols); /* Zeroed, so kernels accumulate */          \
+    if (!c)                                                                                               \
+      return NULL;                                                                                        \
+    kernel(c, a, b);                                                                                      \
+    return c;                                                                                             \
+  }
+
+TMAT_DEFINE_MULT(i8, MatI8, i32, MatI32, tmat_kernel_pairs_i8)
+TMAT_DEFINE_MULT(i16, MatI16, i32, MatI32, tmat_kernel_pairs_i16)
+TMAT_DEFINE_MULT(i32, MatI32, i64, MatI64, tmat_kernel_i32_dispatch)
+TMAT_DEFINE_MULT(i64, MatI64, i64, MatI64, tmat_kernel_i64)
+TMAT_DEFINE_MULT(f32, MatF32, f32, MatF32, tmat_kernel_f32)
+TMAT_DEFINE_MULT(f64, MatF64, f64, MatF64, tmat_kernel_f64)
+
+MatI64 *mat_mult_exact(Mat *mat1, Mat *mat2)
+{
+  MatI32 *a = tmat_from_mat_i32(mat1);
+  MatI32 *b = tmat_from_mat_i32(mat2);
+  MatI64 *c = (a && b) ? tmat_mult_i32(a, b) : NULL;
+  tmat_destroy_i32(a);
+  tmat_destroy_i32(b);
+  return c;
+}
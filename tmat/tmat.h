@@ -0,0 +1,83 @@
+#ifndef TMAT_H
+#define TMAT_H
+
+#include <stddef.h> // for size_t
+#include <stdint.h>
+#include "../matrix/matrix.h"
+
+// Typed dense matrices. Mat stays int-only for the lab programs; these are
+// contiguous row-major matrices generated per element type by macro, with a
+// product kernel per type that accumulates in a wider type:
+//   int8, int16 -> int32 (pairwise multiply-add, VNNI style, AVX2 when available)
+//   int32, int64 -> int64
+//   float -> float, double -> double
+// An integer result is exact while k * max|a| * max|b| < 2^31 (int32) or
+// 2^63 (int64), where k is the inner dimension. int8 inputs are therefore
+// exact for any k below 2^17, and int32 inputs within +-2^24 for any k up
+// to 2^14; at the int16/int32 extremes even k = 2 can overflow. Past the
+// bound an entry wraps modulo 2^32 or 2^64 on every path.
+// Rows are padded to TMAT_ALIGN bytes so every row starts on a vector boundary.
+#define TMAT_ALIGN 64
+
+// X(Name, suffix, element type)
+#define TMAT_TYPES(X)        \
+  X(MatI8, i8, int8_t)       \
+  X(MatI16, i16, int16_t)    \
+  X(MatI32, i32, int32_t)    \
+  X(MatI64, i64, int64_t)    \
+  X(MatF32, f32, float)      \
+  X(MatF64, f64, double)
+
+#define TMAT_STRUCT(Name, suffix, T)                         \
+  typedef struct                                             \
+  {                                                          \
+    T *data;                                                 \
+    int nrows;                                               \
+    int ncols;                                               \
+    size_t stride; /* Elements between row starts */         \
+    void *block;   /* Allocation holding the aligned data */ \
+  } Name;
+TMAT_TYPES(TMAT_STRUCT)
+#undef TMAT_STRUCT
+
+// Per-type functions: tmat_new_i8(), tmat_get_f64(), ...
+// from_mat converts an int Mat with plain C casts (narrowing wraps for int8/int16).
+#define TMAT_DECLARE(Name, suffix, T)                         \
+  Name *tmat_new_##suffix(int nrows, int ncols);              \
+  void tmat_destroy_##suffix(Name *m);                        \
+  T tmat_get_##suffix(Name *m, int i, int j);                 \
+  void tmat_set_##suffix(Name *m, int i, int j, T value);     \
+  Name *tmat_from_mat_##suffix(Mat *mat);
+TMAT_TYPES(TMAT_DECLARE)
+#undef TMAT_DECLARE
+
+// Products return a new matrix of the accumulator type (NULL on error)
+MatI32 *tmat_mult_i8(MatI8 *a, MatI8 *b);
+MatI32 *tmat_mult_i16(MatI16 *a, MatI16 *b);
+MatI64 *tmat_mult_i32(MatI32 *a, MatI32 *b);
+MatI64 *tmat_mult_i64(MatI64 *a, MatI64 *b);
+MatF32 *tmat_mult_f32(MatF32 *a, MatF32 *b);
+MatF64 *tmat_mult_f64(MatF64 *a, MatF64 *b);
+
+// Product of two int matrices with int64 sums: exact under the bound above,
+// so it holds results that overflow mat_mult's int
+MatI64 *mat_mult_exact(Mat *mat1, Mat *mat2);
+
+// Type-generic front end, e.g. MatI32 *c = tmat_mult(a8, b8);
+#define TMAT_GENERIC(fn, m)  \
+  _Generic((m),              \
+      MatI8 *: fn##_i8,      \
+      MatI16 *: fn##_i16,    \
+      MatI32 *: fn##_i32,    \
+      MatI64 *: fn##_i64,    \
+      MatF32 *: fn##_f32,    \
+      MatF64 *: fn##_f64)
+
+#define tmat_new(suffix, nrows, ncols) tmat_new_##suffix(nrows, ncols)
+#define tmat_from_mat(suffix, mat) tmat_from_mat_##suffix(mat)
+#define tmat_destroy(m) TMAT_GENERIC(tmat_destroy, m)(m)
+#define tmat_get(m, i, j) TMAT_GENERIC(tmat_get, m)(m, i, j)
+#define tmat_set(m, i, j, value) TMAT_GENERIC(tmat_set, m)(m, i, j, value)
+#define tmat_mult(a, b) TMAT_GENERIC(tmat_mult, a)(a, b)
+
+#endif // TMAT_H
@@ -0,0 +1,86 @@
+#include "transpose.h"
+#include "../gemm/gemm.h"
+
+// Cache-oblivious transposes: halve the longer side until a tile is small,
+// so every level of the memory hierarchy sees blocks that fit it.
+
+void transpose_view(MatView dst, MatView src)
+{
+  if (src.nrows <= TRANSPOSE_LEAF && src.ncols <= TRANSPOSE_LEAF)
+  {
+    for (int i = 0; i < src.nrows; i++)
+    {
+      const int *srow = src.rows[i] + src.col;
+      for (int j = 0; j < src.ncols; j++)
+        dst.rows[j][dst.col + i] = srow[j];
+    }
+    return;
+  }
+  if (src.nrows >= src.ncols)
+  {
+    int h = src.nrows / 2;
+    transpose_view(mat_view_block(dst, 0, 0, src.ncols, h), mat_view_block(src, 0, 0, h, src.ncols));
+    transpose_view(mat_view_block(dst, 0, h, src.ncols, src.nrows - h),
+                   mat_view_block(src, h, 0, src.nrows - h, src.ncols));
+  }
+  else
+  {
+    int h = src.ncols / 2;
+    transpose_view(mat_view_block(dst, 0, 0, h, src.nrows), mat_view_block(src, 0, 0, src.nrows, h));
+    transpose_view(mat_view_block(dst, h, 0, src.ncols - h, src.nrows),
+                   mat_view_block(src, 0, h, src.nrows, src.ncols - h));
+  }
+}
+
+// swaps a with b^T, where a is r x c and b is c x r (the two off-diagonal blocks)
+static void transpose_swap(MatView a, MatView b)
+{
+  if (a.nrows <= TRANSPOSE_LEAF && a.ncols <= TRANSPOSE_LEAF)
+  {
+    for (int i = 0; i < a.nrows; i++)
+    {
+      int *arow = a.rows[i] + a.col;
+      for (int j = 0; j < a.ncols; j++)
+      {
+        int tmp = arow[j];
+        arow[j] = b.rows[j][b.col + i];
+        b.rows[j][b.col + i] = tmp;
+      }
+    }
+    return;
+  }
+  if (a.nrows >= a.ncols)
+  {
+    int h = a.nrows / 2;
+    transpose_swap(mat_view_block(a, 0, 0, h, a.ncols), mat_view_block(b, 0, 0, a.ncols, h));
+    transpose_swap(mat_view_block(a, h, 0, a.nrows - h, a.ncols), mat_view_block(b, 0, h, a.ncols, a.nrows - h));
+  }
+  else
+  {
+    int h = a.ncols / 2;
+    transpose_swap(mat_view_block(a, 0, 0, a.nrows, h), mat_view_block(b, 0, 0, h, a.nrows));
+    transpose_swap(mat_view_block(a, 0, h, a.nrows, a.ncols - h), mat_view_block(b, h, 0, a.ncols - h, a.nrows));
+  }
+}
+
+void transpose_view_inplace(MatView v)
+{
+  int n = v.nrows;
+  if (n <= TRANSPOSE_LEAF)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = i + 1; j < n; j++)
+      {
+        int tmp = v.rows[i][v.col + j];
+        v.rows[i][v.col + j] = v.rows[j][v.col + i];
+        v.rows[j][v.col + i] = tmp;
+      }
+    }
+    return;
+  }
+  int h = n / 2;
+  transpose_view_inplace(mat_view_block(v, 0, 0, h, h));
+  transpose_view_inplace(mat_view_block(v, h, h, n - h, n - h));
+  transpose_swap(mat_view_block(v, 0, h, h, n - h), mat_view_block(v, h, 0, n - h, h));
+}
@@ -0,0 +1,15 @@
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include "../gemm/gemm.h"
+
+// Recursion stops at tiles of at most TRANSPOSE_LEAF x TRANSPOSE_LEAF ints
+// (4 KiB), which fit in L1 next to their mirror tile whatever the cache size.
+#define TRANSPOSE_LEAF 32
+
+// dst = src^T; dst must be src.ncols x src.nrows and must not overlap src
+void transpose_view(MatView dst, MatView src);
+// Transposes a square view in place
+void transpose_view_inplace(MatView v);
+
+#endif // TRANSPOSE_H
@@ -9,6 +9,7 @@ typedef struct
   size_t length;
   size_t capacity;
   size_t elem_size;
+  int site; // AllocSite the header and data are charged to
 } Vec;
 
 typedef struct
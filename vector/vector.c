@@ -2,21 +2,28 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../types/types.h"
+#include "../alloc/alloc.h"
 
 Vec *vec_new(size_t elem_size, size_t init_capacity)
 {
-  Vec *vec = malloc(sizeof(Vec));
+  return vec_new_site(elem_size, init_capacity, ALLOC_VEC);
+}
+
+Vec *vec_new_site(size_t elem_size, size_t init_capacity, AllocSite site)
+{
+  Vec *vec = alloc_malloc(sizeof(Vec), site);
   if (!vec)
     return NULL;
-  vec->data = malloc(elem_size * init_capacity);
+  vec->data = alloc_malloc(elem_size * init_capacity, site);
   if (!vec->data)
   {
-    free(vec);
+    alloc_free(vec, site);
     return NULL;
   }
   vec->length = 0;
   vec->capacity = init_capacity;
   vec->elem_size = elem_size;
+  vec->site = site;
   return vec;
 }
 
@@ -25,7 +32,7 @@ int vec_append(Vec *vec, void *elem)
   if (vec->length >= vec->capacity)
   {
     size_t new_capacity = (vec->capacity == 0) ? 1 : vec->capacity * 2;
-    void *new_data = realloc(vec->data, new_capacity * vec->elem_size);
+    void *new_data = alloc_realloc(vec->data, new_capacity * vec->elem_size, vec->site);
     if (!new_data)
       return 0; // failure
     vec->data = new_data;
@@ -47,7 +54,7 @@ void vec_destroy(Vec *vec)
 {
   if (vec)
   {
-    free(vec->data);
-    free(vec);
+    alloc_free(vec->data, vec->site);
+    alloc_free(vec, vec->site);
   }
 }
\ No newline at end of file
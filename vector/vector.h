@@ -4,8 +4,12 @@
 #include <stddef.h> // for size_t
 #include "../result/result.h"
 #include "../types/types.h"
+#include "../alloc/alloc.h"
 
 Vec *vec_new(size_t elem_size, size_t init_capacity);
+// vec_new for a vector owned by another subsystem: its header and data are
+// charged to site instead of ALLOC_VEC
+Vec *vec_new_site(size_t elem_size, size_t init_capacity, AllocSite site);
 int vec_append(Vec *vec, void *elem);
 void *vec_get(Vec *vec, size_t index);
 void vec_destroy(Vec *vec);
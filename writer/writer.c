@@ -0,0 +1,218 @@
+#define _POSIX_C_SOURCE 200809L
+#include "writer.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "../alloc/alloc.h"
+
+#define WRITER_INT_MAX_CHARS 20 // "-9223372036854775808"
+
+// "00".."99": lets writer_int emit two digits per division
+static const char writer_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// allocates a writer for fd with a buffer of the given size (0 means the default)
+Writer *writer_new(int fd, size_t capacity)
+{
+  if (capacity < WRITER_INT_MAX_CHARS)
+    capacity = WRITER_DEFAULT_CAPACITY;
+  Writer *w = alloc_malloc(sizeof(Writer), ALLOC_WRITER);
+  if (!w)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for Writer struct.\n");
+    return NULL;
+  }
+  w->buf = alloc_malloc(capacity, ALLOC_WRITER);
+  if (!w->buf)
+  {
+    fprintf(stderr, "Error: Memory allocation failed for writer buffer.\n");
+    alloc_free(w, ALLOC_WRITER);
+    return NULL;
+  }
+  w->fd = fd;
+  w->len = 0;
+  w->capacity = capacity;
+  w->failed = 0;
+  return w;
+}
+
+// writes every iovec completely, retrying on short writes and EINTR
+static int writer_writev_all(int fd, struct iovec *iov, int iovcnt)
+{
+  while (iovcnt > 0)
+  {
+    ssize_t n = writev(fd, iov, iovcnt);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return 0;
+    }
+    while (iovcnt > 0 && (size_t)n >= iov->iov_len)
+    {
+      n -= (ssize_t)iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0)
+    {
+      iov->iov_base = (char *)iov->iov_base + n;
+      iov->iov_len -= (size_t)n;
+    }
+  }
+  return 1;
+}
+
+int writer_flush(Writer *w)
+{
+  if (w->len > 0 && !w->failed)
+  {
+    struct iovec iov = {w->buf, w->len};
+    if (!writer_writev_all(w->fd, &iov, 1))
+    {
+      fprintf(stderr, "Error: Write to fd %d failed: %s.\n", w->fd, strerror(errno));
+      w->failed = 1;
+    }
+  }
+  w->len = 0;
+  return !w->failed;
+}
+
+// copies small chunks into the buffer; a chunk that does not fit is sent
+// straight from the caller's memory in the same writev as the pending bytes
+void writer_bytes(Writer *w, const void *data, size_t n)
+{
+  if (n <= w->capacity - w->len)
+  {
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+    return;
+  }
+  if (n < w->capacity / 2)
+  {
+    writer_flush(w);
+    memcpy(w->buf, data, n);
+    w->len = n;
+    return;
+  }
+  if (!w->failed)
+  {
+    struct iovec iov[2] = {{w->buf, w->len}, {(void *)data, n}};
+    if (!writer_writev_all(w->fd, iov, 2))
+    {
+      fprintf(stderr, "Error: Write to fd %d failed: %s.\n", w->fd, strerror(errno));
+      w->failed = 1;
+    }
+  }
+  w->len = 0;
+}
+
+void writer_str(Writer *w, const char *s)
+{
+  writer_bytes(w, s, strlen(s));
+}
+
+void writer_char(Writer *w, char c)
+{
+  if (w->len == w->capacity)
+    writer_flush(w);
+  w->buf[w->len++] = c;
+}
+
+// formats value in decimal directly into the buffer (no printf, no locale)
+void writer_int(Writer *w, long long value)
+{
+  if (w->capacity - w->len < WRITER_INT_MAX_CHARS)
+    writer_flush(w);
+
+  char tmp[WRITER_INT_MAX_CHARS];
+  char *end = tmp + sizeof(tmp);
+  char *p = end;
+  unsigned long long u = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+  while (u >= 100)
+  {
+    unsigned idx = (unsigned)(u % 100) * 2;
+    u /= 100;
+    *--p = writer_digit_pairs[idx + 1];
+    *--p = writer_digit_pairs[idx];
+  }
+  if (u >= 10)
+  {
+    *--p = writer_digit_pairs[u * 2 + 1];
+    *--p = writer_digit_pairs[u * 2];
+  }
+  else
+  {
+    *--p = (char)('0' + u);
+  }
+  if (value < 0)
+    *--p = '-';
+
+  size_t n = (size_t)(end - p);
+  memcpy(w->buf + w->len, p, n);
+  w->len += n;
+}
+
+int writer_destroy(Writer *w)
+{
+  if (w == NULL)
+    return 1;
+  int ok = writer_flush(w);
+  alloc_free(w->buf, ALLOC_WRITER);
+  alloc_free(w, ALLOC_WRITER);
+  return ok;
+}
+
+static pthread_once_t writer_stdout_once = PTHREAD_ONCE_INIT;
+static Writer *writer_stdout_w = NULL;
+
+static void writer_stdout_at_exit(void)
+{
+  writer_destroy(writer_stdout_w);
+  writer_stdout_w = NULL;
+}
+
+static void writer_stdout_init(void)
+{
+  writer_stdout_w = writer_new(STDOUT_FILENO, 0);
+  if (writer_stdout_w)
+    atexit(writer_stdout_at_exit);
+}
+
+// the shared stdout writer, created on first use and flushed and freed at exit
+Writer *writer_stdout(void)
+{
+  pthread_once(&writer_stdout_once, writer_stdout_init);
+  return writer_stdout_w;
+}
+
+int writer_parse_format(const char *name, OutFormat *out_format)
+{
+  if (strcmp(name, "tsv") == 0)
+    *out_format = OUT_TSV;
+  else if (strcmp(name, "csv") == 0)
+    *out_format = OUT_CSV;
+  else if (strcmp(name, "bin") == 0 || strcmp(name, "binary") == 0)
+    *out_format = OUT_BINARY;
+  else if (strcmp(name, "mm") == 0 || strcmp(name, "mtx") == 0)
+    *out_format = OUT_MM;
+  else
+  {
+    fprintf(stderr, "Error: Unknown output format '%s' (expected tsv, csv, bin or mm).\n", name);
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,44 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stddef.h> // for size_t
+
+// Output formats understood by mat_write and sparse_write
+typedef enum
+{
+  OUT_TSV,    // Tab separated rows
+  OUT_CSV,    // Comma separated rows
+  OUT_BINARY, // "LABM"/"LABS" header followed by native-endian int32 data
+  OUT_MM      // Matrix Market (array for dense, coordinate for sparse)
+} OutFormat;
+
+// Buffered writer on a raw file descriptor: integers are formatted in place
+// and the buffer is flushed with write(), large payloads go out with writev()
+// together with the buffered bytes instead of being copied.
+typedef struct
+{
+  int fd;
+  char *buf;
+  size_t len;
+  size_t capacity;
+  int failed; // Set once a write fails; later output is dropped
+} Writer;
+
+#define WRITER_DEFAULT_CAPACITY (1 << 16)
+
+Writer *writer_new(int fd, size_t capacity);
+void writer_bytes(Writer *w, const void *data, size_t n);
+void writer_str(Writer *w, const char *s);
+void writer_char(Writer *w, char c);
+void writer_int(Writer *w, long long value);
+int writer_flush(Writer *w);   // Returns 1 on success, 0 if any write failed
+int writer_destroy(Writer *w); // Flushes, frees and returns the writer_flush status
+// Shared writer on stdout for the print functions, so printing does not
+// allocate a buffer per call. Created on first use; not for concurrent use.
+// Callers drain stdio first and flush it before returning, keeping output in order.
+Writer *writer_stdout(void);
+
+// Parses "tsv", "csv", "bin"/"binary" or "mm"/"mtx"; returns 1 on success
+int writer_parse_format(const char *name, OutFormat *out_format);
+
+#endif // WRITER_H